@@ -15,6 +15,8 @@
 #include "Jacobian.h"
 #include "MechanicsModel.h"
 #include "EigenNRsolver.h"
+#include "EikonalSolver.h"
+#include "ElectroMechanicsSolver.h"
 
 using namespace voom;
 
@@ -28,7 +30,7 @@ int main(int argc, char** argv)
   time_t start, end;
   time(&start);
 
-  // Activation Sequence? Set True to make activation a function of z
+  // Activation Sequence? Set True to compute activation times with the eikonal solver from the apex
   bool activationSequence = true;
 
   // Constant Activation?
@@ -42,11 +44,12 @@ int main(int argc, char** argv)
   // Calculate Ejection Fraction?
   bool calculateEjectionFractionFlag = false;
 
-  // Use Conduction Velocity (if false - uses activation Time file)
-  bool useConductionVelocity = false;
-
-  // Conduction Velocity (cm/ms)
+  // Conduction Velocity along and across the fibers (cm/ms)
   double cv = 0.06;
+  double cvTransverse = 0.02;
+
+  // Activation starts from the nodes within apexHeight (cm) of the apex
+  double apexHeight = 0.1;
 
   // Pressure File
   bool pressureFlag = true;
@@ -71,6 +74,12 @@ int main(int argc, char** argv)
   // Printing Volume to File
   string volumeFile = outputString + "_Volume.txt";
 
+  // Checkpoint every checkpointInterval steps (0 = never); restart from
+  // checkpointFile if restartFlag is set
+  int checkpointInterval = 100;
+  bool restartFlag = false;
+  string checkpointFile = outputString + "_Checkpoint.bin";
+
   // Spring BC:
   int SpringBCflag = 1;
 
@@ -86,16 +95,15 @@ int main(int argc, char** argv)
   // Initialize Mesh
   // Assumptions to use this main as is: strip has a face at z=0; tetrahedral mesh
   FEMesh Cube("Mesh/EllipsoidMeshCoarse_Quadratic/EllipsoidCoarseQuadratic.node", "Mesh/EllipsoidMeshCoarse_Quadratic/EllipsoidCoarseQuadratic.ele");
-  FEMesh surfMesh("Mesh/EllipsoidMeshCoarse_Quadratic/EllipsoidCoarseQuadratic.node", "Mesh/EllipsoidMeshCoarse_Quadratic/EllipsoidCoarseQuadratic.EpicardiumElset");
-  FEMesh innerSurfMesh("Mesh/EllipsoidMeshCoarse_Quadratic/EllipsoidCoarseQuadratic.node", "Mesh/EllipsoidMeshCoarse_Quadratic/EllipsoidCoarseQuadratic.EndocardiumElset");
+  // Surfaces share the nodes of the volume mesh
+  FEMesh surfMesh(Cube, "Mesh/EllipsoidMeshCoarse_Quadratic/EllipsoidCoarseQuadratic.EpicardiumElset");
+  FEMesh innerSurfMesh(Cube, "Mesh/EllipsoidMeshCoarse_Quadratic/EllipsoidCoarseQuadratic.EndocardiumElset");
   string FiberFile = "Mesh/EllipsoidMeshCoarse_Quadratic/EllipsoidCoarseQuadratic.fiber";
   string BCfile = "Mesh/EllipsoidMeshCoarse_Quadratic/EllipsoidCoarseQuadratic.Null.bc";
   // string BCfile = "Mesh/EllipsoidMeshCoarse_Quadratic/EllipsoidCoarseQuadratic.BaseNodeset";
   string torsionalSpringBC = "Mesh/EllipsoidMeshCoarse_Quadratic/EllipsoidCoarseQuadratic.BaseNodeset";
-  string ActivationTimeFile = "Mesh/EllipsoidMeshFiner/Small_B.activationTime";   // This is the Element Activation Time File
   string ActivationFile = "InputFiles/ActFunc_600ms_1msInterval.dat";  // This is the Calcium Transient
   ifstream FiberInp(FiberFile.c_str());
-  ifstream ActTime(ActivationTimeFile.c_str());
 
   // Code for calculating Ejection Fraction
   MechanicsModel* cavityModel = NULL;
@@ -157,7 +165,9 @@ int main(int argc, char** argv)
   cout << endl;
   cout << "Number Of Nodes   : " << Cube.getNumberOfNodes() << endl;
   cout << "Number Of Element : " << Cube.getNumberOfElements() << endl;
-  cout << "Mesh Dimension    : " << Cube.getDimension() << endl << endl;
+  cout << "Mesh Dimension    : " << Cube.getDimension() << endl;
+  Cube.printColoring();
+  cout << endl;
   
   // Initialize Material
   uint NumMat =  Cube.getNumberOfElements();
@@ -233,33 +243,11 @@ int main(int argc, char** argv)
       ActivationFactor.push_back(activationValue);
   }
   
-  double cycleLength = Time[Time.size() - 1];
   myfile.close();
   deltaT = Time[1] - Time[0];
   
 
-  // Calculate the activation time for each quadrature point in each element
-  vector <double> activationTimesQP;
-
-  if (!useConductionVelocity)
-  {
-    if (ActTime.is_open())
-        cout << "** Opened Time Activation File Successfully." << endl;
-    else
-    {
-        cout << "** Cannot Open Time Activation File." << endl;
-        exit(1);
-    }
-  }
-
-
-
   for (int el_iter = 0; el_iter < meshElements.size(); el_iter++) {
-    // Figure out Element Activation Time:
-    double eleActivationTime = 0.0;
-    if (ActTime.is_open())
-      ActTime >> eleActivationTime;
-
     int el_numQuadPoints = meshElements[el_iter]->getNumberOfQuadPoints();
     int el_numNodes = meshElements[el_iter]->getNodesPerElement();
     vector<int> el_nodeIds = meshElements[el_iter]->getNodesID();
@@ -272,16 +260,6 @@ int main(int argc, char** argv)
 	quadPointZ += meshElements[el_iter]->getN(quadPt_iter, el_node_iter) * Cube.getX(el_nodeIds[el_node_iter], 2);
     }
       
-      // Activation Time Calculations:
-      if(activationSequence) {
-	if (useConductionVelocity)
-	  activationTimesQP.push_back((quadPointZ - z_min)/cv);
-	else
-	  activationTimesQP.push_back(eleActivationTime);  // THIS IS WRONG BECAUSE ALL OF THE ELEMENT GETS ACTIVATED ONCE AND NOT BY EACH QUADRATURE POINT.
-      }
-      else
-	activationTimesQP.push_back(0.0);  // Everything gets activated right away
-      
       out << quadPointX << " " << quadPointY << " " << quadPointZ << endl;
 
       vector <Vector3d> el_vectors(3, Vector3d::Zero(3,1));
@@ -328,7 +306,34 @@ int main(int argc, char** argv)
     for (int quadPt_iter = 0; quadPt_iter < numQuadPoints; quadPt_iter++)
     out << fiberVectors[el_iter * numQuadPoints + quadPt_iter][0] << " " << fiberVectors[el_iter * numQuadPoints + quadPt_iter][1] << " " << fiberVectors[el_iter * numQuadPoints + quadPt_iter][2] << endl;
   out.close();
-  ActTime.close();
+
+  // Calculate the activation time of each node
+  vector <double> activationTimes(Cube.getNumberOfNodes(), 0.0);  // Everything gets activated right away
+
+  if (activationSequence) {
+    // Eikonal solve from the apex with the element averaged fiber direction
+    vector <Vector3d> elementFibers(NumMat, Vector3d::Zero());
+    for (int el_iter = 0; el_iter < NumMat; el_iter++)
+      for (int quadPt_iter = 0; quadPt_iter < numQuadPoints; quadPt_iter++) {
+	// Fibers are axes, align the sign before averaging
+	Vector3d tempFiber = fiberVectors[el_iter * numQuadPoints + quadPt_iter];
+	if (tempFiber.dot(elementFibers[el_iter]) < 0.0)
+	  tempFiber = -tempFiber;
+	elementFibers[el_iter] += tempFiber;
+      }
+
+    EikonalSolver activationSolver(&Cube, elementFibers, cv, cvTransverse);
+    for (int node_iter = 0; node_iter < Cube.getNumberOfNodes(); node_iter++)
+      if (Cube.getX(node_iter, 2) < z_min + apexHeight)
+	activationSolver.addSource(node_iter);
+    activationSolver.solve();
+    activationTimes = activationSolver.getNodalTimes();
+
+    if (activationSolver.getNumberOfUnreachedNodes() > 0) {
+      cout << "** " << activationSolver.getNumberOfUnreachedNodes() << " nodes are not reached by the activation." << endl;
+      exit(1);
+    }
+  }
 
   // Initialize Model
   int NodeDoF = 3;
@@ -367,8 +372,18 @@ int main(int argc, char** argv)
   // myModel.checkDmat(myResults, perturbationFactor, myH, myTol);
 
 
-  // Print initial configuration
-  myModel.writeOutputVTK(outputString, 0);
+  // Restart from the last checkpoint
+  int startStep = 0;
+  Real startTime = 0.0;
+  if (restartFlag) {
+    myModel.readCheckpoint(checkpointFile, startStep, startTime);
+    cout << "Restarting from step " << startStep << endl;
+  }
+
+  // Print initial configuration, files are written in the background
+  myModel.setAsynchronousOutput();
+  if (!restartFlag)
+    myModel.writeOutputVTK(outputString, 0);
 
   // EBC
   cout << "********" << " Setting up EBCs " << "********" << endl;
@@ -405,15 +420,34 @@ int main(int argc, char** argv)
   EigenNRsolver mySolver(&myModel, BCid, BCvalues, CHOL, NRtol, NRmaxIter);
 
   
-  // SOLVE:
+  // Coupled time loop
+  for (int k = 0; k < PLmaterials.size(); k++)
+    PLmaterials[k]->setTimestep(deltaT/1000);
+  TimeTableActivation activation(activationTimes, ActivationFactor, deltaT, minActivationFactor);
+  ElectroMechanicsSolver coupledSolver(&activation, &mySolver, &myModel, &Cube, PLmaterials, deltaT, startTime);
 
-  ind = 0;
-  myModel.finalizeCompute();
+  // SOLVE:
 
+  ind = startStep;
+  if (!restartFlag)
+    myModel.finalizeCompute();
+
+  // On restart keep the volume lines of the steps before the checkpoint
+  // (one line per step): later lines were written after the checkpoint and
+  // are computed again
+  vector<string > volumeLines;
+  if (restartFlag) {
+    ifstream inVolume(volumeFile.c_str());
+    string line;
+    while (int(volumeLines.size()) < startStep && getline(inVolume, line))
+      volumeLines.push_back(line);
+  }
   ofstream outVolume;
   outVolume.open(volumeFile.c_str());
+  for (uint i = 0; i < volumeLines.size(); i++)
+    outVolume << volumeLines[i] << endl;
 
-  for (int s = 0; s < simTime/deltaT; s++)
+  for (int s = startStep; s < simTime/deltaT; s++)
   {
     cout << "Step " << s << endl;
     if (SpringBCflag) myModel.computeNormals();
@@ -430,29 +464,10 @@ int main(int argc, char** argv)
       }
     }
 
-    for (int k = 0; k < NumMat; k++)
-    {
-      for (int q = 0; q < numQuadPoints; q++) {
-	(PLmaterials[k * numQuadPoints + q])->setTimestep(deltaT/1000);
-	
-	if (s * deltaT < activationTimesQP[k * numQuadPoints + q] || s * deltaT > activationTimesQP[k * numQuadPoints + q] + cycleLength)
-	  (PLmaterials[k * numQuadPoints + q])->setActivationMultiplier(minActivationFactor);
-	else
-	{
-	  // Figure out time in cycle
-	  double tempNormalizedTime = s * deltaT - activationTimesQP[k];
-          double tempActivationMultiplier = ActivationFactor[tempNormalizedTime/deltaT];
-          if (tempActivationMultiplier < minActivationFactor)
-            tempActivationMultiplier = minActivationFactor;
-	  (PLmaterials[k * numQuadPoints + q])->setActivationMultiplier(tempActivationMultiplier);
-	}
-      }
-    }
-      
+    // Activate, solve and update the state variables; the activation of
+    // the next step is computed while the mechanics is solved
     ind++;
-    mySolver.solve(DISP);
-    // myModel.setPrevField();
-    myModel.finalizeCompute();  // This sets the previous field for the spring normals.
+    coupledSolver.step();
 
     // Print out myocardium volume and ejection fraction (if requested)
     outVolume << s * deltaT << "\t" << myModel.computeCurrentVolume();
@@ -468,17 +483,11 @@ int main(int argc, char** argv)
 
     cout << "Volume data written." << endl;
 
-    // Update State Variables:     
-    for (int k = 0; k < NumMat; k++)
-    {
-      (PLmaterials[k])->updateStateVariables();
-    }    
-
-    cout << "State Variables Updated." << endl;
-    
     // Write Output
     myModel.writeOutputVTK(outputString, ind);
     cout << "Output Written for step." << endl;
+    if (checkpointInterval > 0 && (s + 1) % checkpointInterval == 0)
+      myModel.writeCheckpoint(checkpointFile, s + 1, coupledSolver.getTime());
     cout << "Reference Volume: " << myModel.computeRefVolume() << "\t Current Volume: " << myModel.computeCurrentVolume() << endl;
   }
   outVolume.close();
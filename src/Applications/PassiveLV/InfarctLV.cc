@@ -19,7 +19,7 @@ int main(int argc, char** argv)
 
   // Initialize Mesh
   FEMesh LVmesh("../CoarseLV.node", "../CoarseLV.ele");
-  FEMesh LVsurf("../CoarseLV.node", "../CoarseLV.surf");
+  FEMesh LVsurf(LVmesh, "../CoarseLV.surf");
   string BCfile = "../CoarseLV.BaseSurfBC";
  
   cout << endl;
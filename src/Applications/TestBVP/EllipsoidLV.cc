@@ -108,6 +108,7 @@ int main(int argc, char** argv)
 			 NodalForcesFlag);
   myModel.updatePressure(Pressure);
   myModel.updateNodalForces(&ForcesID, &Forces);
+  myModel.setKeepOutputState(true);
  
   // Initialize Result
   uint myRequest;
@@ -200,6 +201,7 @@ int main(int argc, char** argv)
       {
 	(PLmaterials[k])->updateStateVariables();
       }
+      myModel.invalidateOutputState();
       myModel.writeOutputVTK(outputString, ind);
     }
     */
@@ -228,6 +230,7 @@ int main(int argc, char** argv)
       {
     	(PLmaterials[k])->updateStateVariables();
       }
+      myModel.invalidateOutputState();
       myModel.writeOutputVTK(outputString, ind);
       // myModel.writeField("CubeSmall_", 1);
       
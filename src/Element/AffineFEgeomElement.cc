@@ -0,0 +1,50 @@
+//-*-C++-*-
+
+#include "AffineFEgeomElement.h"
+
+namespace voom{
+
+  AffineFEgeomElement::AffineFEgeomElement(const int elemID, const vector<int > & nodesID,
+					   const vector<VectorXd > & nodesX,
+					   const vector<Shape* > & shape, Quadrature* quadrature):
+    GeomElement(elemID, nodesID), _detJ(1.0), _shapes(&shape),
+    _quadWeights(&quadrature->getQuadWeights())
+  {
+    const uint nodePerElem = _nodesID.size();
+    const uint dim = nodesX[0].size();
+    assert(nodePerElem == nodesX.size() && shape.size() == _quadWeights->size());
+    if (nodePerElem*dim > 12) {
+      cout << "** AffineFEgeomElement: " << nodePerElem << " nodes in dimension "
+	   << dim << " is not a linear simplex" << endl;
+      exit(1);
+    }
+
+    // The derivatives do not depend on the quadrature point: use the first one
+    if ( ((quadrature->getQuadPoints())[0]).size() == dim) {
+      _dim = dim;
+      MatrixXd J = MatrixXd::Zero(dim, dim);
+      for(uint i = 0; i < dim; i++)
+	for(uint j = 0; j < dim; j++)
+	  for(uint a = 0; a < nodePerElem; a++)
+	    J(i,j) += shape[0]->getDN(a,j)*nodesX[a](i);
+      _detJ = fabs(J.determinant());
+      MatrixXd Jinv = J.inverse();
+
+      for(uint a = 0; a < nodePerElem; a++)
+	for(uint i = 0; i < dim; i++) {
+	  _DN[a*dim + i] = 0.0;
+	  for(uint j = 0; j < dim; j++)
+	    _DN[a*dim + i] += shape[0]->getDN(a,j)*Jinv(j,i);
+	}
+    }
+    else {
+      // Surface element: isoparametric derivatives, as in FEgeomElement
+      _dim = 2;
+      for(uint a = 0; a < nodePerElem; a++) {
+	_DN[a*2]     = shape[0]->getDN(a,0);
+	_DN[a*2 + 1] = shape[0]->getDN(a,1);
+      }
+    }
+  } // end AffineFEgeomElement constructor
+
+} // namespace voom
@@ -0,0 +1,66 @@
+//-*-C++-*-
+/*!
+  \file AffineFEgeomElement.h
+
+  \brief Geometry element for linear simplices (C3D4, TD3). The map from
+  the isoparametric element is affine, so the shape function derivatives
+  are the same at all quadrature points: only one gradient per node and
+  the Jacobian determinant are stored, instead of N, DN and the weights at
+  every quadrature point as in FEgeomElement. Shape function values and
+  quadrature weights are read from the shapes and quadrature rule of the
+  mesh, which must outlive the element.
+*/
+
+#if !defined(__AffineFEgeomElement_h__)
+#define __AffineFEgeomElement_h__
+
+#include "GeomElement.h"
+
+namespace voom {
+
+  class AffineFEgeomElement: public GeomElement {
+  public:
+
+    //! Same arguments as FEgeomElement; Shapes and Quad are kept by pointer
+    AffineFEgeomElement(const int elemID, const vector<int > & nodesID,
+			const vector<VectorXd > & nodesX,
+			const vector<Shape* > & shape, Quadrature* quadrature);
+
+    //! Get number of quadrature points
+    uint getNumberOfQuadPoints() { return _shapes->size(); }
+
+    //! Get weight for quadrature point q
+    Real getQPweights(uint q) { return (*_quadWeights)[q]*_detJ; }
+
+    //! Get shape functions values at quadrature point q, node a
+    Real getN(uint q, uint a) { return (*_shapes)[q]->getN(a); }
+
+    //! Get shape functions derivatives at node a, direction i; the gradient
+    //! is constant in the element, so the quadrature point is not needed
+    Real getDN(uint, uint a, uint i) { return _DN[a*_dim + i]; }
+
+    //! Derivatives are constant in the element
+    bool isAffine() { return true; }
+
+    //! Shape function derivatives, node by node (NodesPerElement x dim)
+    const Real * getGradients() const { return _DN; }
+
+    //! Jacobian determinant (volume of the element over the volume of the
+    //! parent element); 1 for surface elements, as in FEgeomElement
+    Real getDetJ() const { return _detJ; }
+
+  protected:
+    //! Shape function derivatives, at most 4 nodes x 3 directions
+    Real                     _DN[12];
+    Real                     _detJ;
+    uint                     _dim;
+
+    //! Shapes (one per quadrature point) and weights of the mesh
+    const vector<Shape* >  * _shapes;
+    const vector<Real >    * _quadWeights;
+
+  }; // AffineFEgeomElement
+
+} // namespace voom
+
+#endif
@@ -26,6 +26,9 @@ namespace voom {
     */
     GeomElement(const int elemID, const vector<int > & nodesID):
       _elemID(elemID), _nodesID(nodesID) {}
+
+    //! Destructor (elements are deleted through GeomElement pointers)
+    virtual ~GeomElement() {}
     
     //! Get element ID
     int getGeomElementID() {return _elemID; }
@@ -49,6 +52,10 @@ namespace voom {
     //! Get shape functions derivatives at quadrature point q, node a, direction i
     virtual Real getDN(uint q, uint a, uint i) = 0;
 
+    //! True if the shape functions derivatives are the same at all
+    //! quadrature points (AffineFEgeomElement)
+    virtual bool isAffine() { return false; }
+
   protected:
     //! GeomElement ID
     int                    _elemID;
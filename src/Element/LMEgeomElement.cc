@@ -11,16 +11,22 @@ namespace voom{
 		                 Real beta, Real tol, uint MaxIter):
     GeomElement(elemID, nodesID), _nodesX(NodesX), _QPweights(Weights)
   {
-    uint NumMP = Weights.size();
-    assert(NumMP == MaterialPoints.size());
-    _LMEshapes.reserve(NumMP);
-    // Compute LME shape functions at given MaterialPoints
-    for(uint q=0; q<NumMP; q++)
-    {
-      LMEShape* LMEshape = new LMEShape(_nodesX, MaterialPoints[q], 
-					beta, tol, MaxIter);
-      _LMEshapes.push_back(LMEshape);
-    } // loop over material points
+    const int NumMP = Weights.size();
+    assert(NumMP == int(MaterialPoints.size()));
+    _LMEshapes.assign(NumMP, NULL);
+    if (NumMP == 0) return;
+
+    // Compute LME shape functions at given MaterialPoints. The first one
+    // is solved from lambda = 0, the others in parallel starting from its
+    // multiplier (same nodes, nearby point)
+    _LMEshapes[0] = new LMEShape(_nodesX, MaterialPoints[0], beta, tol, MaxIter);
+    const VectorXd & lambda0 = _LMEshapes[0]->getLambda();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for(int q = 1; q < NumMP; q++)
+      _LMEshapes[q] = new LMEShape(_nodesX, MaterialPoints[q], 
+				   beta, tol, MaxIter, lambda0);
 
   } // end LMEgeomElement constructor
 
@@ -1,4 +1,5 @@
 #include "FEgeomElement.h"
+#include "AffineFEgeomElement.h"
 #include "HexShape.h"
 #include "HexQuadrature.h"
 #include "LinTetShape.h"
@@ -6,6 +7,7 @@
 #include "TetQuadrature.h"
 #include "QuadTriShape.h"
 #include "TriQuadrature.h"
+#include "LinTriShape.h"
 
 using namespace voom;
 
@@ -332,4 +334,74 @@ int main()
     
   }// End of test for linear tet element
 
+
+ {
+    cout << "Comparing affine and full linear tet and triangle elements" << endl;
+    vector<int > nodesID(4,0);
+    for (uint i=0; i<4; i++)
+      nodesID[i] = i;
+
+    vector<VectorXd > nodesX;
+    Vector3d X;
+    X << 0., 0., 0.; X = X + getRand();
+    nodesX.push_back(X);
+    X << 1., 0., 0.; X = X + getRand();
+    nodesX.push_back(X);
+    X << 0., 1., 0.; X = X + getRand();
+    nodesX.push_back(X);
+    X << 0., 0., 1.; X = X + getRand();
+    nodesX.push_back(X);
+
+    // More than one quadrature point
+    TetQuadrature QuadRule(2);
+    const vector<VectorXd > QuadPoints = QuadRule.getQuadPoints();
+    vector<Shape *> shapePointers;
+    for (uint q = 0; q < QuadPoints.size(); q++)
+      shapePointers.push_back(new LinTetShape(QuadPoints[q]));
+
+    FEgeomElement TetElement(0, nodesID, nodesX, shapePointers, &QuadRule);
+    AffineFEgeomElement AffineTet(0, nodesID, nodesX, shapePointers, &QuadRule);
+
+    bool pass = AffineTet.isAffine() && !TetElement.isAffine() &&
+      AffineTet.getNumberOfQuadPoints() == TetElement.getNumberOfQuadPoints();
+    for (uint q = 0; q < QuadPoints.size(); q++) {
+      pass = pass && fabs(AffineTet.getQPweights(q) - TetElement.getQPweights(q)) < 1.0e-14;
+      for (uint a = 0; a < 4; a++) {
+	pass = pass && AffineTet.getN(q, a) == TetElement.getN(q, a);
+	for (uint i = 0; i < 3; i++)
+	  pass = pass && fabs(AffineTet.getDN(q, a, i) - TetElement.getDN(q, a, i)) < 1.0e-12;
+      }
+    }
+    cout << "Affine linear tet - " << (pass ? "PASSED" : "FAILED") << endl;
+
+    // Surface triangle: parametric derivatives, unit Jacobian
+    nodesID.resize(3);
+    nodesX.resize(3);
+    TriQuadrature TriRule(2);
+    const vector<VectorXd > TriPoints = TriRule.getQuadPoints();
+    vector<Shape *> triShapes;
+    for (uint q = 0; q < TriPoints.size(); q++)
+      triShapes.push_back(new LinTriShape(TriPoints[q]));
+
+    FEgeomElement TriElement(0, nodesID, nodesX, triShapes, &TriRule);
+    AffineFEgeomElement AffineTri(0, nodesID, nodesX, triShapes, &TriRule);
+
+    pass = AffineTri.getNumberOfQuadPoints() == TriElement.getNumberOfQuadPoints();
+    for (uint q = 0; q < TriPoints.size(); q++) {
+      pass = pass && AffineTri.getQPweights(q) == TriElement.getQPweights(q);
+      for (uint a = 0; a < 3; a++) {
+	pass = pass && AffineTri.getN(q, a) == TriElement.getN(q, a);
+	for (uint i = 0; i < 2; i++)
+	  pass = pass && AffineTri.getDN(q, a, i) == TriElement.getDN(q, a, i);
+      }
+    }
+    cout << "Affine surface triangle - " << (pass ? "PASSED" : "FAILED") << endl;
+
+    for (uint q = 0; q < QuadPoints.size(); q++)
+      delete shapePointers[q];
+    for (uint q = 0; q < TriPoints.size(); q++)
+      delete triShapes[q];
+
+  }// End of comparison of affine elements
+
 }
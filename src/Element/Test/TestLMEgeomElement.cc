@@ -84,5 +84,18 @@ int main()
     cout << endl;
   } // q loop
 
+  // Shapes of the element (warm started, built in parallel) against
+  // shapes solved from lambda = 0
+  bool pass = true;
+  for (uint q = 0; q < MaterialPoints.size(); q++) {
+    LMEShape shape(nodesX, MaterialPoints[q], beta, tol, MaxIter);
+    for (uint a = 0; a < 9; a++) {
+      pass = pass && fabs(LMEelement.getN(q, a) - shape.getN(a)) < 1.0e-12;
+      for (uint i = 0; i < 3; i++)
+	pass = pass && fabs(LMEelement.getDN(q, a, i) - shape.getDN(a, i)) < 1.0e-10;
+    }
+  }
+  cout << "Warm started shapes - " << (pass ? "PASSED" : "FAILED") << endl;
+
   cout << "All done " << endl;
 } // main
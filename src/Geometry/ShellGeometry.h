@@ -135,5 +135,27 @@ namespace voom
   };
 
 
+
+  /*! Part of ShellGeometry needed by scalar fields on a fixed surface
+    (LBModel): computed once per quadrature point and stored, so that
+    compute calls only form the field quantities.
+  */
+  struct ShellMetric
+  {
+    Real     metric;               //!< sqrt(det a_ab)
+    Matrix2d metricTensorInverse;  //!< a^ab
+    Vector3d d;                    //!< unit normal
+    Vector2d gklGammaI_kl;         //!< a^kl Gamma^i_kl, Laplacian term
+
+    ShellMetric(): metric(0.0), metricTensorInverse(Matrix2d::Zero()),
+		   d(Vector3d::Zero()), gklGammaI_kl(Vector2d::Zero()) {};
+    ShellMetric(ShellGeometry & geom): metric(geom.metric()),
+				       metricTensorInverse(geom.metricTensorInverse()),
+				       d(geom.d()), gklGammaI_kl(geom.gklGammaI_kl()) {};
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+
+
 } // namespace voom
 #endif // __ShellGeometry_h__
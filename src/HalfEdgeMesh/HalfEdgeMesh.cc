@@ -11,117 +11,82 @@
 
 namespace voom {
 
-HalfEdgeMesh::HalfEdgeMesh(const ConnectivityContainer & connectivities, 
+HalfEdgeMesh::HalfEdgeMesh(const ConnectivityContainer & connectivities,
 			   int nVertices)
 {
 
   std::cout << "Building HalfEdgeMesh..." << std::endl;
 
-  // size containers
-  faces.resize( connectivities.size() );
-  for(int f=0; f<faces.size(); f++) faces[f] = new Face();
-  halfEdges.resize( 3*connectivities.size() );
-  for(int h=0; h<halfEdges.size(); h++) halfEdges[h] = new HalfEdge();
-  vertices.resize(nVertices);
-  for(int v=0; v<vertices.size(); v++) vertices[v] = new Vertex();
-
-  // set vertex ids      
-  for(int i=0; i<nVertices; i++) vertices[i]->id = i;
-
-  // Link HalfEdges, Vertices, and Faces for each element; 
-  // opposites remain undefined
-  for(int f=0; f<connectivities.size(); f++) {
-    Face * F = faces[f];
-    F->id = f;
-    for(int i=0; i<3; i++) {
-      HalfEdge * HE = halfEdges[3*f+i];
-      HE->id = 3*f+i;
-      int id=connectivities[f](i);
-      Vertex * V = vertices[id];
-
-      // set vertex from connectivities
-      HE->vertex = V;
-      V->halfEdges.push_back( HE );
-
-      // link HalfEdges to Face
-      HE->face = F;
-      F->halfEdges[i] = HE;
-
-      // identify next HalfEdge (i+1 mod 3)
-      int j = (i==2) ? 0 : i+1;
-      HE->next = halfEdges[3*f+j];
-
-      // identify prev HalfEdge (i-1 mod 3)
-      j = (i==0) ? 2 : i-1;
-      HE->prev = halfEdges[3*f+j];
+  const int nHalfEdges = 3*connectivities.size();
+  vertex.resize(nHalfEdges);
+  opposite.assign(nHalfEdges, -1);
+  vertexHalfEdge.assign(nVertices, -1);
+  valence.assign(nVertices, 0);
+  boundary.assign(nVertices, false);
+
+  // set vertex from connectivities, count the HalfEdges leaving each
+  // vertex
+  std::vector< int > outOffsets(nVertices + 1, 0);
+  for(int h=0; h<nHalfEdges; h++) {
+    const int id = connectivities[h/3](h%3);
+    if( id < 0 || id >= nVertices ) {
+      std::cout << "** HalfEdgeMesh: face " << h/3 << " refers to vertex " << id
+		<< " out of " << nVertices << std::endl;
+      exit(1);
     }
+    vertex[h] = id;
+    valence[id]++;
+    vertexHalfEdge[id] = h;
+    outOffsets[connectivities[h/3]((h + 2)%3) + 1]++;
   }
-  std::cout << "Linked " 
-	    << halfEdges.size() << " half-edges, "
-	    << faces.size() << " faces, and "
-	    << vertices.size() << " vertices. "
-	    << std::endl;
-
-  std::cout << "Determining half-edge opposites." << std::endl;
-  // For each  HalfEdge, find its opposite
-  for(int h=0; h<halfEdges.size(); h++) {
-    HalfEdge * H = halfEdges[h];
-    // check if next is already set
-    if( H->opposite != 0 ) continue;
-
-    // if not, then look at all HalfEdges incident to my vertex and
-    // check to see if they duplicate me (i.e., orientations are not
-    // consistent) or if their next is my opposite
 
-    for(int hv=0; hv<H->vertex->halfEdges.size(); hv++) {
-      HalfEdge * Hv = H->vertex->halfEdges[hv];
+  // HalfEdges grouped by the vertex they leave (counting sort), so that
+  // the directed edge (a,b) is found among the few HalfEdges leaving a
+  for(int v=0; v<nVertices; v++) outOffsets[v+1] += outOffsets[v];
+  std::vector< int > outHalfEdges(nHalfEdges);
+  {
+    std::vector< int > fill(outOffsets.begin(), outOffsets.end() - 1);
+    for(int h=0; h<nHalfEdges; h++)
+      outHalfEdges[ fill[origin(h)]++ ] = h;
+  }
 
-      if( H == Hv ) continue;
-    
-      // Hv is a duplicate of H if both previous HalfEdges point to
-      // the same vertex
-      if( H->prev->vertex->id == Hv->prev->vertex->id ) {
-	std::cout << "Error:  half-edges " << H->id << " and " << Hv->id
-		  << " are duplicates.  " << std::endl
-		  << "Adjacent faces " << H->face->id
-		  << " and " << Hv->face->id 
+  // For each HalfEdge (a,b), its opposite is the HalfEdge (b,a); a
+  // second HalfEdge (a,b) means that the orientations of two faces are
+  // not consistent
+  int nBoundary = 0;
+  for(int h=0; h<nHalfEdges; h++) {
+    const int a = origin(h), b = vertex[h];
+    for(int i=outOffsets[a]; i<outOffsets[a+1]; i++) {
+      const int Hv = outHalfEdges[i];
+      if( Hv != h && vertex[Hv] == b ) {
+	std::cout << "** HalfEdgeMesh: half-edges " << h << " and " << Hv
+		  << " are duplicates. Adjacent faces " << face(h)
+		  << " and " << face(Hv)
 		  << " must have opposite orientations." << std::endl;
-	exit(0);
+	exit(1);
       }
-
-      // Hv's next is my opposite if it points to the vertex of
-      // my previous HalfEdge
-      if( H->prev->vertex->id == Hv->next->vertex->id ) {
-	H->opposite = Hv->next;
+    }
+    for(int i=outOffsets[b]; i<outOffsets[b+1]; i++)
+      if( vertex[outHalfEdges[i]] == a ) {
+	opposite[h] = outHalfEdges[i];
 	break;
       }
-    }
 
-    if(H->opposite == 0 ) {
-      std::cout << "  Warning."
-		<< "  Couldn't find HalfEdge opposite to HalfEdge " << H->id 
-		<< ".  This HalfEdge is on the boundary."
-		<< std::endl;
-
-      H->vertex->boundary = true;
-
-//       for(int hv=0; hv<H->vertex->halfEdges.size(); hv++) {
-// 	HalfEdge * Hv = H->vertex->halfEdges[hv];
-// 	std::cout << "h: "<< Hv->id << std::endl
-// 		  << "v: "<< Hv->vertex->id << std::endl
-// 		  << "n: "<< Hv->next->id << std::endl
-// 		  << "nv: "<< Hv->next->vertex->id << std::endl
-// 		  << "p: "<< Hv->prev->id << std::endl
-// 		  << "pv: "<< Hv->prev->vertex->id << std::endl;
-// 	std::cout << std::endl;
-//       }
-//      exit(0);
+    if( opposite[h] < 0 ) {
+      // This HalfEdge is on the boundary
+      boundary[b] = true;
+      vertexHalfEdge[b] = h;
+      nBoundary++;
     }
-	
   }
 
-  std::cout << "HalfEdgeMesh built." << std::endl;
-	  
+  std::cout << "Linked "
+	    << nHalfEdges << " half-edges, "
+	    << nHalfEdges/3 << " faces, and "
+	    << nVertices << " vertices; "
+	    << nBoundary << " half-edges on the boundary."
+	    << std::endl;
+
 }
 
 }
@@ -15,71 +15,20 @@
 
 namespace voom {
 
-  struct HalfEdge;
-  struct Vertex;
-  struct Face;
-
-  //! A HalfEdge is the Left half of an edge, pointing CCW around a Face.
-  struct HalfEdge {
-    //! Default constructor
-    HalfEdge() {
-      opposite = next = prev = 0;
-      face = 0; 
-      vertex = 0;
-      id = -1;
-    }
-
-    //! Adjacent HalfEdge
-    HalfEdge * opposite;
-    //! HalfEdge Counter-Clockwise around Face on left
-    HalfEdge * next;
-    //! HalfEdge Clockwise around Face on left (stored for convenience)
-    HalfEdge * prev;
-    //! Face on left
-    Face * face;
-    //! vertex at the end of the HalfEdge
-    Vertex * vertex;
-
-    //! HalfEdge id
-    int id;
-  };
-  
-  struct Face {
-    //! Default constructor
-    Face() { halfEdges[0] = halfEdges[1] = halfEdges[2] = 0; id=-1; }
-
-    //! HalfEdges looping Counter-Clockwise around Face
-    HalfEdge * halfEdges[3];
-
-    //! Face id
-    int id;
-  };
-
-  struct Vertex {
-    //! Default constructor
-    Vertex() { id = -1; boundary = false; }
-
-    //! vertex id
-    int id;
-
-    //! is this a boundary vertex?
-    bool boundary;
-
-    //! list of incident HalfEdges (pointing towards the vertex)
-    std::vector< HalfEdge* > halfEdges;
-  };
-
-
   //! HalfEdge data structure to store a triangle mesh
   /*!  This class is built to convert a connectivity array into a
-    HalfEdge data structure.
+    HalfEdge data structure. Half-edges are plain indices: half-edge
+    3f+i is the Left half of an edge of face f, pointing CCW around it
+    to the vertex connectivities[f](i). Face, next and previous
+    half-edges follow from the index; only the vertex and the opposite
+    half-edge are stored, as int arrays.
+
+    Walking around a vertex: if h points to v, opposite(next(h)) is the
+    next half-edge pointing to v, CW around it, and prev(opposite(h))
+    the next one CCW.
   */
   struct HalfEdgeMesh {
 
-    std::vector< HalfEdge* > halfEdges;
-    std::vector< Face* > faces;
-    std::vector< Vertex* > vertices;
-
     //! Connectivity of a single triangle
     //typedef tvmet::Vector<int,3> TriangleConnectivity;
     typedef Eigen::Vector3i TriangleConnectivity;
@@ -87,18 +36,40 @@ namespace voom {
     //! Container of connectivities for a mesh of triangles
     typedef std::vector<TriangleConnectivity> ConnectivityContainer;
 
+    //! Vertex at the end of each HalfEdge
+    std::vector< int > vertex;
+    //! Adjacent HalfEdge, -1 on the boundary
+    std::vector< int > opposite;
+
+    //! One HalfEdge pointing to each vertex (-1 if unused). For a
+    //! boundary vertex it is the boundary one, so that walking CW from
+    //! it visits all incident faces.
+    std::vector< int > vertexHalfEdge;
+    //! Number of incident HalfEdges (pointing towards the vertex)
+    std::vector< int > valence;
+    //! Is this a boundary vertex?
+    std::vector< bool > boundary;
+
     // construct HalfEdge data structure from a connectivity array
     HalfEdgeMesh(const ConnectivityContainer & connectivities, int nVertices);
 
-    // Delete structs
-    virtual ~HalfEdgeMesh() {
-      for(int f=0; f<faces.size(); f++) delete faces[f];
-      for(int h=0; h<halfEdges.size(); h++) delete halfEdges[h];
-      for(int v=0; v<vertices.size(); v++) delete vertices[v];
-    }
+    int getNumberOfHalfEdges() const { return vertex.size(); }
+    int getNumberOfFaces() const { return vertex.size()/3; }
+    int getNumberOfVertices() const { return valence.size(); }
+
+    //! HalfEdge Counter-Clockwise around Face on left
+    static int next(int h) { return h%3 == 2 ? h - 2 : h + 1; }
+    //! HalfEdge Clockwise around Face on left
+    static int prev(int h) { return h%3 == 0 ? h + 2 : h - 1; }
+    //! Face on left
+    static int face(int h) { return h/3; }
+    //! HalfEdge i of face f
+    static int faceHalfEdge(int f, int i) { return 3*f + i; }
+    //! Vertex at the start of the HalfEdge
+    int origin(int h) const { return vertex[prev(h)]; }
 
   };
 
-  
+
 }
 #endif // __HEMesh_h__
@@ -31,22 +31,41 @@ int main(){
   HalfEdgeMesh mesh(connect,nverts);
 
   std::cout << "vertices:"<< std::endl;
-  for(int a=0; a<mesh.vertices.size(); a++) {
-    std::cout << mesh.vertices[a]->id << std::endl;
+  for(int a=0; a<mesh.getNumberOfVertices(); a++) {
+    std::cout << a << " valence " << mesh.valence[a]
+	      << (mesh.boundary[a] ? " boundary" : "") << std::endl;
   }
 
   std::cout << "HalfEdges:"<< std::endl;
-  for(int h=0; h<mesh.halfEdges.size(); h++) {
-    std::cout << "h: "<< mesh.halfEdges[h]->id << std::endl
-  	      << "v: "<< (mesh.halfEdges[h]->vertex)->id << std::endl
-  	      << "n: "<< (mesh.halfEdges[h]->next)->id << std::endl;
-    if(mesh.halfEdges[h]->opposite) 
-      std::cout << "o: "<< (mesh.halfEdges[h]->opposite)->id << std::endl;
-    else
-      std::cout << "o: "<< -1 << std::endl;
-    std::cout << "f: "<< (mesh.halfEdges[h]->face)->id << std::endl
+  for(int h=0; h<mesh.getNumberOfHalfEdges(); h++) {
+    std::cout << "h: "<< h << std::endl
+  	      << "v: "<< mesh.vertex[h] << std::endl
+  	      << "n: "<< HalfEdgeMesh::next(h) << std::endl
+	      << "o: "<< mesh.opposite[h] << std::endl
+	      << "f: "<< HalfEdgeMesh::face(h) << std::endl
   	      << std::endl;
-      
   }
 
+  // Opposites are reciprocal and reversed, all vertices are on the
+  // boundary, and walking CW from the stored HalfEdge of each vertex
+  // visits all its incident faces
+  bool pass = true;
+  for(int h=0; h<mesh.getNumberOfHalfEdges(); h++) {
+    const int o = mesh.opposite[h];
+    if( o >= 0 )
+      pass = pass && mesh.opposite[o] == h && mesh.vertex[o] == mesh.origin(h);
+  }
+  for(int a=0; a<mesh.getNumberOfVertices(); a++) {
+    int count = 0, h = mesh.vertexHalfEdge[a];
+    do {
+      pass = pass && mesh.vertex[h] == a;
+      count++;
+      h = mesh.opposite[HalfEdgeMesh::next(h)];
+    } while( h >= 0 && h != mesh.vertexHalfEdge[a] && count <= mesh.valence[a] );
+    pass = pass && count == mesh.valence[a];
+  }
+  const int boundaryVertices = std::count(mesh.boundary.begin(), mesh.boundary.end(), true);
+  pass = pass && boundaryVertices == nverts;
+  std::cout << "HalfEdgeMesh connectivity - " << (pass ? "PASSED" : "FAILED") << std::endl;
+
 }
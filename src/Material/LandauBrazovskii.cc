@@ -4,10 +4,10 @@
 namespace voom 
 {
   void LandauBrazovskii::compute(Scalarresults & R, Real psi, 
-				 Vector2d psiPartials, Matrix2d psi2Partials, ShellGeometry & geom)
+				 Vector2d psiPartials, Matrix2d psi2Partials, const ShellMetric & geom)
   {
-    Matrix2d gab = geom.metricTensorInverse();
-    Real LapPsi = (gab*psi2Partials).trace() - psiPartials.dot(geom.gklGammaI_kl());
+    const Matrix2d & gab = geom.metricTensorInverse;
+    Real LapPsi = (gab*psi2Partials).trace() - psiPartials.dot(geom.gklGammaI_kl);
     Real lambda = 0;
     Real c = _c;
     
@@ -31,7 +31,7 @@ namespace voom
   LandauBrazovskii(int MatID): _matID(MatID) {;}
   LandauBrazovskii(Real c, Real k0, Real r, Real alpha, Real beta): _c(c), _k0(k0), _r(r), _alpha(alpha), _beta(beta) {;}
   void compute(Scalarresults & R, Real psi, 
-	       Vector2d psiPartials, Matrix2d psi2Partials, ShellGeometry& geom);
+	       Vector2d psiPartials, Matrix2d psi2Partials, const ShellMetric & geom);
 
   void setR(Real r) {_r = r;}
   void setC(Real c) {_c = c;}
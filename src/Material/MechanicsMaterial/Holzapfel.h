@@ -74,6 +74,9 @@ namespace voom {
     //! Tells if material has history variables and needs to be duplicated at each quadrature point
     // It is used in the Model derived classes
     bool HasHistoryVariables() { return false; };
+
+    //! Fiber direction first
+    vector<Vector3d> getDirectionVectors() { return _fibers; }
     
   private:
     //! Data
@@ -81,6 +81,9 @@ namespace voom {
     // It is used in the Model derived classes
     bool HasHistoryVariables() { return false; };
 
+    //! Fiber direction first
+    vector<Vector3d> getDirectionVectors() { return _fibers; }
+
   private:
     //! Data
     Real _C0;
@@ -63,6 +63,11 @@ namespace voom
     // It is used in the Model derived classes
     virtual bool HasHistoryVariables() = 0;
 
+    //! History variables, saved in checkpoints so that a run can be
+    //! restarted. None for materials without history.
+    virtual vector<Real > getHistoryVariables() { return vector<Real >(); }
+    virtual void setHistoryVariables(const vector<Real > &) {;}
+
     // TODO: DELETE THESE THREE FUNCTIONS
     virtual void setTimestep(double deltaT){;}
     virtual void setActivationMultiplier(double activation){;}
@@ -90,6 +90,23 @@ namespace voom
 
     Matrix3d getElasticStressOnly() {return _elasticStress;}
 
+    //! Fa, Fn (column by column) and Q at the previous timestep
+    vector<Real > getHistoryVariables()
+    {
+      vector<Real > H(_Fa.data(), _Fa.data() + 9);
+      H.insert(H.end(), _Fn.data(), _Fn.data() + 9);
+      H.insert(H.end(), _Q.data(), _Q.data() + 3);
+      return H;
+    }
+    void setHistoryVariables(const vector<Real > & H)
+    {
+      assert(H.size() == 21);
+      _Fa = Map<const Matrix3d >(&H[0]);
+      _Fn = Map<const Matrix3d >(&H[9]);
+      _Q  = Map<const Vector3d >(&H[18]);
+      _Fanp1 = _Fa; _Fnp1 = _Fn; _Qnp1 = _Q;
+    }
+
     // FUNCTIONS THAT MUST BE OVERRIDDEN
     //! Clone
     virtual MechanicsMaterial* clone() const {return NULL;}
@@ -1,5 +1,6 @@
 #include <iostream>
 #include "SCElastic.h"
+#include "HyperDual.h"
 
 namespace voom 
 {
@@ -92,4 +93,22 @@ namespace voom
 
     return;
   }
+
+
+
+  void SCElastic::computeTangent(const Real A[15], Matrix<Real, 15, 15> & H) const
+  {
+    HyperDual X[15];
+    for(int k = 0; k < 15; k++)
+      X[k] = HyperDual(A[k]);
+    for(int i = 0; i < 15; i++) {
+      X[i].f1 = 1.0;
+      for(int j = 0; j <= i; j++) {
+	X[j].f2 = 1.0;
+	H(i,j) = H(j,i) = this->parametricEnergy(X).f12;
+	X[j].f2 = 0.0;
+      }
+      X[i].f1 = 0.0;
+    }
+  }
 }
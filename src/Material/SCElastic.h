@@ -30,6 +30,17 @@ namespace voom
     
     void compute(Shellresults & R, const ShellGeometry & defGeom);
 
+    //! Energy per unit parametric area, W*sqrt(det a_ab), as a function of
+    //! A = (a_1, a_2, a_11, a_22, a_12), 3 components each, for any scalar
+    //! type (Real, HyperDual)
+    template<class T>
+    T parametricEnergy(const T A[15]) const;
+
+    //! Second derivatives of parametricEnergy with respect to A, exact
+    //! (hyper-dual numbers); the shell stiffness is B^T H B with B the
+    //! linear map from nodal positions to A
+    void computeTangent(const Real A[15], Matrix<Real, 15, 15> & H) const;
+
     double meanCurvature() const {return _H;}
     double gaussianCurvature() const {return _K;}
 
@@ -44,6 +55,33 @@ namespace voom
     vector<Real > getInternalParameters() {;}
 
   };
+
+
+
+  template<class T>
+  T SCElastic::parametricEnergy(const T A[15]) const
+  {
+    const T *a1 = A, *a2 = A + 3, *a11 = A + 6, *a22 = A + 9, *a12 = A + 12;
+    // a_1 x a_2 = sqrt(det a_ab) d
+    const T n[3] = {a1[1]*a2[2] - a1[2]*a2[1],
+		    a1[2]*a2[0] - a1[0]*a2[2],
+		    a1[0]*a2[1] - a1[1]*a2[0]};
+    const T g11 = a1[0]*a1[0] + a1[1]*a1[1] + a1[2]*a1[2];
+    const T g22 = a2[0]*a2[0] + a2[1]*a2[1] + a2[2]*a2[2];
+    const T g12 = a1[0]*a2[0] + a1[1]*a2[1] + a1[2]*a2[2];
+    const T detg = g11*g22 - g12*g12;
+    const T j = sqrt(detg);
+
+    // Curvature tensor b_ab = d.a_ab, 2H = a^ab b_ab, K = det(b)/det(a)
+    const T b11 = (n[0]*a11[0] + n[1]*a11[1] + n[2]*a11[2])/j;
+    const T b22 = (n[0]*a22[0] + n[1]*a22[1] + n[2]*a22[2])/j;
+    const T b12 = (n[0]*a12[0] + n[1]*a12[1] + n[2]*a12[2])/j;
+    const T twoH = (g22*b11 - 2.0*g12*b12 + g11*b22)/detg;
+    const T K = (b11*b22 - b12*b12)/detg;
+
+    const T twoHminusC0 = twoH - _C0;
+    return (0.5*_kC*twoHminusC0*twoHminusC0 + _kG*K)*j;
+  }
   
 } //namespace voom
 
@@ -4,7 +4,20 @@ namespace voom {
 
   // Constructor from input file
   FEMesh::FEMesh(const string Nodes, const string ConnTable): Mesh(Nodes, ConnTable) {
+    this->readConnectivity(ConnTable);
+  } // End constructor from input files
+
+  // Constructor from the nodes of another mesh and a connectivity file
+  FEMesh::FEMesh(Mesh & Parent, const string ConnTable): Mesh(Parent) {
+    this->readConnectivity(ConnTable);
+  }
+
+  void FEMesh::readConnectivity(const string ConnTable) {
     ifstream inp(ConnTable.c_str());
+    if (!inp) {
+      cout << "Cannot open input file: " << ConnTable << endl;
+      exit(0);
+    }
 
     uint NumEl = 0, temp = 0;
     string ElType;
@@ -24,9 +37,9 @@ namespace voom {
         Xel.push_back(_X[ConnEl[n]]);
       }
 
-      _elements[e] = new FEgeomElement(e, ConnEl, Xel, _shapes, _quadrature);
+      _elements[e] = this->createElement(e, ConnEl, Xel);
     } // End of FEgeom
-  } // End constructor from input files
+  }
 
   // Constructor from nodes and connectivities
   FEMesh::FEMesh(const vector<VectorXd > &  Positions,
@@ -34,6 +47,20 @@ namespace voom {
     string ElementType):
     Mesh(Positions)
   {
+    this->createElements(Connectivity, ElementType);
+  } // Constructor from nodes and connectivities
+
+  // Constructor from the nodes of another mesh and connectivities
+  FEMesh::FEMesh(Mesh & Parent,
+    const vector<vector<int > > & Connectivity,
+    string ElementType):
+    Mesh(Parent)
+  {
+    this->createElements(Connectivity, ElementType);
+  }
+
+  void FEMesh::createElements(const vector<vector<int > > & Connectivity,
+			      string ElementType) {
     this->createElementShapeAndQuadrature(ElementType);
 
     // Resize element container
@@ -47,14 +74,123 @@ namespace voom {
       for(uint m = 0; m < Connectivity[i].size(); m++)
         Xel[m] = _X[Connectivity[i][m]];
 
-      FEgeomElement *myElement = new FEgeomElement(i, Connectivity[i],
-        Xel, _shapes, _quadrature);
-        _elements[i] = myElement;
+      _elements[i] = this->createElement(i, Connectivity[i], Xel);
     } // Loop over element list
-  } // Constructor from nodes and connectivities
+  }
+
+  // Constructor from binary mesh file
+  FEMesh::FEMesh(const MeshFile & File, const string ElementSet)
+  {
+    this->setPositions(File.getNodes(), File.getNumberOfNodes(), File.getDimension());
+    this->readElementSet(File, ElementSet);
+  } // Constructor from binary mesh file
+
+  // Constructor from the nodes of another mesh and an element set of a binary mesh file
+  FEMesh::FEMesh(Mesh & Parent, const MeshFile & File, const string ElementSet):
+    Mesh(Parent)
+  {
+    if (File.getNumberOfNodes() != int(_X.size())) {
+      cout << "** FEMesh: mesh file has " << File.getNumberOfNodes()
+	   << " nodes, parent mesh has " << _X.size() << endl;
+      exit(1);
+    }
+    this->readElementSet(File, ElementSet);
+  }
+
+  void FEMesh::readElementSet(const MeshFile & File, const string ElementSet)
+  {
+    int set = -1;
+    if (ElementSet.empty()) {
+      for (int s = 0; s < File.getNumberOfSets() && set < 0; s++)
+	if (File.getSetKind(s) == MeshFile::ELEMENTSET) set = s;
+    }
+    else
+      set = File.findElementSet(ElementSet);
+    if (set < 0) {
+      cout << "** FEMesh: element set " << ElementSet << " not found in mesh file" << endl;
+      exit(1);
+    }
+
+    this->createElements(File.getSetName(set), File.getElementType(set),
+			 File.getNodesPerElement(set), File.getConnectivity(set),
+			 File.getNumberOfElements(set));
+  }
+
+  // Constructor from an Abaqus input file
+  FEMesh::FEMesh(const InpFile & File, const string ElementSet)
+  {
+    this->setPositions(File.getNodes(), File.getNumberOfNodes(), File.getDimension());
+    this->readElementSet(File, ElementSet);
+  } // Constructor from an Abaqus input file
+
+  // Constructor from the nodes of another mesh and an element set of an Abaqus input file
+  FEMesh::FEMesh(Mesh & Parent, const InpFile & File, const string ElementSet):
+    Mesh(Parent)
+  {
+    if (File.getNumberOfNodes() != int(_X.size())) {
+      cout << "** FEMesh: input file has " << File.getNumberOfNodes()
+	   << " nodes, parent mesh has " << _X.size() << endl;
+      exit(1);
+    }
+    this->readElementSet(File, ElementSet);
+  }
+
+  void FEMesh::readElementSet(const InpFile & File, const string ElementSet)
+  {
+    const int set = ElementSet.empty() ? (File.getNumberOfElementSets() > 0 ? 0 : -1) :
+      File.findElementSet(ElementSet);
+    if (set < 0) {
+      cout << "** FEMesh: element set " << ElementSet << " not found in input file" << endl;
+      exit(1);
+    }
+
+    this->createElements(File.getElementSetName(set),
+			 InpFile::voomElementType(File.getElementType(set)),
+			 File.getNodesPerElement(set), File.getConnectivity(set),
+			 File.getNumberOfElements(set));
+  }
+
+  void FEMesh::setPositions(const Real * Nodes, uint NumNodes, uint Dim)
+  {
+    _X.resize(NumNodes, VectorXd::Zero(Dim));
+    for (uint i = 0; i < NumNodes; i++)
+      _X[i] = Map<const VectorXd >(Nodes + i*Dim, Dim);
+  }
+
+  void FEMesh::createElements(const string SetName, const string ElementType,
+			      int NodesPerElement, const int * Connectivity, uint NumEl)
+  {
+    const uint NumNodesEl = this->createElementShapeAndQuadrature(ElementType);
+    if (int(NumNodesEl) != NodesPerElement) {
+      cout << "** FEMesh: element set " << SetName << " has "
+	   << NodesPerElement << " nodes per element, "
+	   << ElementType << " needs " << NumNodesEl << endl;
+      exit(1);
+    }
+
+    // Compute the geometric elements
+    _elements.resize(NumEl);
+    for (uint e = 0; e < NumEl; e++) {
+      vector<int > ConnEl(Connectivity + e*NumNodesEl, Connectivity + (e + 1)*NumNodesEl);
+      vector<VectorXd > Xel(NumNodesEl);
+      for (uint n = 0; n < NumNodesEl; n++)
+	Xel[n] = _X[ConnEl[n]];
+
+      _elements[e] = this->createElement(e, ConnEl, Xel);
+    }
+  }
+
+  GeomElement * FEMesh::createElement(const int e, const vector<int > & ConnEl,
+				      const vector<VectorXd > & Xel) {
+    // Linear simplices: one gradient per node instead of one per quadrature point
+    if (_elementType == "C3D4" || _elementType == "TD3")
+      return new AffineFEgeomElement(e, ConnEl, Xel, _shapes, _quadrature);
+    return new FEgeomElement(e, ConnEl, Xel, _shapes, _quadrature);
+  }
 
   int FEMesh::createElementShapeAndQuadrature(const string ElType) {
     uint NumNodesEl = 0;
+    _elementType = ElType;
     if (ElType == "C3D8") {
       // Full integration hexahedral element
       _quadrature = new HexQuadrature(2);
@@ -139,4 +275,180 @@ namespace voom {
     }
     return NumNodesEl;
   } // End createElementShapeAndQuadrature
+
+
+
+  // Boundary extraction
+  namespace {
+    // A face of an element; key holds the sorted corner nodes (-1 padded)
+    struct FaceKey {
+      int key[4];
+      int element, face;
+      bool operator<(const FaceKey & F) const {
+	for (int i = 0; i < 4; i++)
+	  if (key[i] != F.key[i]) return key[i] < F.key[i];
+	return element < F.element;
+      }
+      bool sameFace(const FaceKey & F) const {
+	return key[0] == F.key[0] && key[1] == F.key[1] &&
+	  key[2] == F.key[2] && key[3] == F.key[3];
+      }
+    };
+
+    // An edge of a boundary face
+    struct EdgeKey {
+      int a, b, face;
+      bool operator<(const EdgeKey & E) const {
+	if (a != E.a) return a < E.a;
+	if (b != E.b) return b < E.b;
+	return face < E.face;
+      }
+    };
+
+    int findRoot(vector<int > & Parent, int i) {
+      while (Parent[i] != i) {
+	Parent[i] = Parent[Parent[i]];
+	i = Parent[i];
+      }
+      return i;
+    }
+
+    // Corners of the faces of the volume elements (local node numbers)
+    const int TetFaces[4][4] = { {0,1,2,-1}, {0,1,3,-1}, {1,2,3,-1}, {0,2,3,-1} };
+    const int HexFaces[6][4] = { {0,1,2,3}, {4,5,6,7}, {0,3,7,4},
+				 {1,2,6,5}, {0,1,5,4}, {3,2,6,7} };
+    // Mid-side node of the edges of C3D10, QuadTetShape ordering
+    int tetMidSide(int a, int b) {
+      if (a > b) swap(a, b);
+      if (a == 0) return b == 1 ? 4 : (b == 2 ? 6 : 7);
+      if (a == 1) return b == 2 ? 5 : 8;
+      return 9;
+    }
+  }
+
+
+
+  int FEMesh::findBoundaryFaces(vector<vector<int > > & Faces, string & FaceType,
+				vector<int > & Labels, Real FeatureAngle)
+  {
+    int numFaces = 0, numCorners = 0;
+    const int (*faceTable)[4] = NULL;
+    if (_elementType == "C3D4" || _elementType == "C3D10") {
+      numFaces = 4; numCorners = 3; faceTable = TetFaces;
+      FaceType = _elementType == "C3D4" ? "TD3" : "TD6";
+    }
+    else if (_elementType == "C3D8" || _elementType == "C3D8R") {
+      numFaces = 6; numCorners = 4; faceTable = HexFaces;
+      FaceType = "Q4";
+    }
+    else {
+      cout << "** FEMesh::findBoundaryFaces: no faces for element type " << _elementType << endl;
+      exit(1);
+    }
+
+    // Sort all element faces by their corner nodes, a boundary face is
+    // found exactly once
+    const int NumEl = _elements.size();
+    vector<FaceKey > keys(NumEl*numFaces);
+    for (int e = 0; e < NumEl; e++) {
+      const vector<int > & NodesID = _elements[e]->getNodesID();
+      for (int f = 0; f < numFaces; f++) {
+	FaceKey & k = keys[e*numFaces + f];
+	for (int c = 0; c < 4; c++)
+	  k.key[c] = c < numCorners ? NodesID[faceTable[f][c]] : -1;
+	sort(k.key, k.key + numCorners);
+	k.element = e; k.face = f;
+      }
+    }
+    sort(keys.begin(), keys.end());
+
+    Faces.clear();
+    vector<Vector3d > normals;
+    for (uint i = 0; i < keys.size(); ) {
+      uint j = i + 1;
+      while (j < keys.size() && keys[j].sameFace(keys[i])) j++;
+      if (j == i + 1) {
+	const vector<int > & NodesID = _elements[keys[i].element]->getNodesID();
+	const int *local = faceTable[keys[i].face];
+
+	// Orient the face outward: away from the corners centroid
+	Vector3d center = Vector3d::Zero(), faceCenter = Vector3d::Zero();
+	const int elCorners = numCorners == 3 ? 4 : 8;
+	for (int a = 0; a < elCorners; a++)
+	  center += _X[NodesID[a]].head<3>()/Real(elCorners);
+	vector<int > corners(local, local + numCorners);
+	for (int c = 0; c < numCorners; c++)
+	  faceCenter += _X[NodesID[corners[c]]].head<3>()/Real(numCorners);
+	Vector3d x0 = _X[NodesID[corners[0]]].head<3>();
+	Vector3d x1 = _X[NodesID[corners[1]]].head<3>();
+	Vector3d x2 = _X[NodesID[corners[2]]].head<3>();
+	Vector3d n = numCorners == 3 ? Vector3d((x1 - x0).cross(x2 - x0)) :
+	  Vector3d((x2 - x0).cross(_X[NodesID[corners[3]]].head<3>() - x1));
+	if (n.dot(faceCenter - center) < 0.0) {
+	  reverse(corners.begin() + 1, corners.end());
+	  n = -n;
+	}
+	normals.push_back(n.normalized());
+
+	vector<int > face;
+	for (int c = 0; c < numCorners; c++)
+	  face.push_back(NodesID[corners[c]]);
+	if (_elementType == "C3D10")
+	  for (int c = 0; c < 3; c++)
+	    face.push_back(NodesID[tetMidSide(corners[c], corners[(c + 1)%3])]);
+	Faces.push_back(face);
+      }
+      i = j;
+    }
+
+    // Connected components: faces sharing an edge are joined unless their
+    // normals differ by more than FeatureAngle (degrees)
+    const int NumFaces = Faces.size();
+    const Real cosFeature = cos(FeatureAngle*M_PI/180.0);
+    vector<EdgeKey > edges(NumFaces*numCorners);
+    for (int f = 0; f < NumFaces; f++)
+      for (int c = 0; c < numCorners; c++) {
+	EdgeKey & k = edges[f*numCorners + c];
+	k.a = min(Faces[f][c], Faces[f][(c + 1)%numCorners]);
+	k.b = max(Faces[f][c], Faces[f][(c + 1)%numCorners]);
+	k.face = f;
+      }
+    sort(edges.begin(), edges.end());
+
+    vector<int > parent(NumFaces);
+    for (int f = 0; f < NumFaces; f++) parent[f] = f;
+    for (uint i = 0; i + 1 < edges.size(); i++) {
+      const EdgeKey & A = edges[i], & B = edges[i + 1];
+      if (A.a != B.a || A.b != B.b) continue;
+      if (FeatureAngle < 180.0 && normals[A.face].dot(normals[B.face]) < cosFeature)
+	continue;
+      parent[findRoot(parent, A.face)] = findRoot(parent, B.face);
+    }
+
+    // Number the components in order of their first face
+    Labels.assign(NumFaces, -1);
+    vector<int > rootLabel(NumFaces, -1);
+    int NumComponents = 0;
+    for (int f = 0; f < NumFaces; f++) {
+      int r = findRoot(parent, f);
+      if (rootLabel[r] < 0) rootLabel[r] = NumComponents++;
+      Labels[f] = rootLabel[r];
+    }
+    return NumComponents;
+  } // findBoundaryFaces
+
+
+
+  FEMesh * FEMesh::createBoundaryMesh(int Component, Real FeatureAngle)
+  {
+    vector<vector<int > > Faces, Selected;
+    vector<int > Labels;
+    string FaceType;
+    this->findBoundaryFaces(Faces, FaceType, Labels, FeatureAngle);
+    for (uint f = 0; f < Faces.size(); f++)
+      if (Component < 0 || Labels[f] == Component)
+	Selected.push_back(Faces[f]);
+    return new FEMesh(*this, Selected, FaceType);
+  }
+
 } // namespace voom
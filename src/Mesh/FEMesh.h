@@ -4,6 +4,9 @@
 #define __FEMesh_h__
 
 #include "Mesh.h"
+#include "MeshFile.h"
+#include "InpFile.h"
+#include "AffineFEgeomElement.h"
 #include "HexQuadrature.h"
 #include "TetQuadrature.h"
 #include "LineQuadrature.h"
@@ -32,8 +35,43 @@ namespace voom{
     	   const vector<vector<int > > & Connectivity,
     	   string ElementType);
 
-    // Build a mesh using the same nodes that are already used by another mesh
-    // FEMesh(FEMesh*, const string ConnTable);
+    //! Constructor from an element set of a binary mesh file (first set if
+    //! ElementSet is empty)
+    FEMesh(const MeshFile & File, const string ElementSet = "");
+
+    //! Constructor from an element set of an Abaqus input file (first set
+    //! if ElementSet is empty), e.g. FEMesh(InpFile("LV.inp"), "Myocardium")
+    FEMesh(const InpFile & File, const string ElementSet = "");
+
+    //! Constructors building a mesh on the nodes of another mesh (e.g. a
+    //! surface of a volume mesh). The nodal positions are shared, not copied,
+    //! so node IDs agree by construction; Parent must outlive this mesh.
+    FEMesh(Mesh & Parent, const string ConnTable);
+    FEMesh(Mesh & Parent,
+	   const vector<vector<int > > & Connectivity,
+	   string ElementType);
+    FEMesh(Mesh & Parent, const MeshFile & File, const string ElementSet);
+    FEMesh(Mesh & Parent, const InpFile & File, const string ElementSet);
+
+    //! Element type of the mesh (e.g. C3D10)
+    const string & getElementType() const { return _elementType; }
+
+    //! Boundary of a volume mesh (C3D4, C3D10, C3D8, C3D8R)
+    /*!
+      Faces used by a single element, found by sorting the faces of all the
+      elements on their corner nodes. Faces are TD3, TD6 or Q4 with nodes
+      ordered as in the element shape and oriented outward. Labels gets the
+      connected component of each face; faces sharing an edge are in the
+      same component unless their normals differ by more than FeatureAngle
+      degrees (the default keeps every connected surface whole; 45 splits a
+      box into its six sides). Returns the number of components.
+    */
+    int findBoundaryFaces(vector<vector<int > > & Faces, string & FaceType,
+			  vector<int > & Labels, Real FeatureAngle = 180.0);
+
+    //! Surface mesh (sharing the nodes of this mesh) of the boundary or of
+    //! one of its components. Caller owns the mesh.
+    FEMesh * createBoundaryMesh(int Component = -1, Real FeatureAngle = 180.0);
 
     //! Destructor
     // Destructor made virtual due to inheritance
@@ -52,9 +90,28 @@ namespace voom{
     //! One Quadrature rule per each element type
     Quadrature*    _quadrature;
 
+    //! Element type
+    string         _elementType;
+
     //! Helper function to determine type of element and fills in
     //! \param _shapes and \param _quadrature and returns \return NumNodesEl
     int createElementShapeAndQuadrature(const string ElType);
+
+    //! New element (AffineFEgeomElement for C3D4 and TD3)
+    GeomElement * createElement(const int e, const vector<int > & ConnEl,
+				const vector<VectorXd > & Xel);
+
+    //! Create the elements from a .ele file, a connectivity table or an
+    //! element set of a binary mesh file or an Abaqus input file on the
+    //! nodes in _X
+    void readConnectivity(const string ConnTable);
+    void createElements(const vector<vector<int > > & Connectivity,
+			string ElementType);
+    void createElements(const string SetName, const string ElementType,
+			int NodesPerElement, const int * Connectivity, uint NumEl);
+    void readElementSet(const MeshFile & File, const string ElementSet);
+    void readElementSet(const InpFile & File, const string ElementSet);
+    void setPositions(const Real * Nodes, uint NumNodes, uint Dim);
   };
 }
 
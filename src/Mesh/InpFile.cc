@@ -0,0 +1,482 @@
+#include "InpFile.h"
+#include <sstream>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace voom
+{
+  namespace
+  {
+    // A keyword line and its data lines [begin, end)
+    struct Card {
+      string keyword;
+      map<string, string > params;
+      const char *begin, *end;
+    };
+
+    string upper(string S)
+    {
+      for (uint i = 0; i < S.size(); i++) S[i] = toupper(S[i]);
+      return S;
+    }
+
+    inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+    inline bool isSeparator(char c) { return isSpace(c) || c == ',' || c == '\n'; }
+
+    string trim(const char * Begin, const char * End)
+    {
+      while (Begin < End && isSpace(*Begin)) Begin++;
+      while (End > Begin && isSpace(End[-1])) End--;
+      return string(Begin, End);
+    }
+
+    // End of the line starting at p; every line of the buffer ends with '\n'
+    inline const char * lineEnd(const char * p, const char * End)
+    {
+      return (const char *)memchr(p, '\n', End - p);
+    }
+
+    // Blank or comment line
+    inline bool skipLine(const char * Line, const char * Eol)
+    {
+      while (Line < Eol && isSpace(*Line)) Line++;
+      return Line == Eol || *Line == '*';
+    }
+
+    // Does the record of the line ending at Eol go on at the next line
+    inline bool continues(const char * Begin, const char * Eol)
+    {
+      while (Eol > Begin && isSpace(Eol[-1])) Eol--;
+      return Eol > Begin && Eol[-1] == ',';
+    }
+
+    // Numbers must end at a separator, "1.5" is not an id
+    inline bool readNumber(const char *& p, int & V)
+    {
+      char * e;
+      V = int(strtol(p, &e, 10));
+      const bool ok = e != p && isSeparator(*e);
+      p = e;
+      return ok;
+    }
+
+    inline bool readNumber(const char *& p, Real & V)
+    {
+      char * e;
+      V = strtod(p, &e);
+      const bool ok = e != p && isSeparator(*e);
+      p = e;
+      return ok;
+    }
+
+    // Move p to the next field of the record, over separators and onto
+    // the next line after a trailing comma. False at the end of the record.
+    inline bool nextField(const char *& p, const char *& Line, const char *& Eol,
+			  const char * End)
+    {
+      for (;;) {
+	while (p < Eol && (isSpace(*p) || *p == ',')) p++;
+	if (p < Eol) return true;
+	if (!continues(Line, Eol) || Eol + 1 >= End) return false;
+	Line = p = Eol + 1;
+	Eol = lineEnd(p, End);
+      }
+    }
+
+    // Number of fields after the id in the first record of [Begin, End),
+    // -1 if there is no record
+    int recordWidth(const char * Begin, const char * End)
+    {
+      for (const char * p = Begin; p < End; ) {
+	const char * line = p, * eol = lineEnd(p, End);
+	if (skipLine(line, eol)) { p = eol + 1; continue; }
+	int n = -1;
+	while (nextField(p, line, eol, End)) {
+	  while (p < eol && !isSpace(*p) && *p != ',') p++;
+	  n++;
+	}
+	return n;
+      }
+      return -1;
+    }
+
+    // Parse the records of [Begin, End): an id and Width values each,
+    // fewer values are zero filled if Pad. Returns the first bad line,
+    // NULL if there is none.
+    template<class T>
+    const char * parseRecords(const char * Begin, const char * End, int Width, bool Pad,
+			      vector<int > & Ids, vector<T > & Values)
+    {
+      for (const char * p = Begin; p < End; ) {
+	const char * line = p, * eol = lineEnd(p, End);
+	if (skipLine(line, eol)) { p = eol + 1; continue; }
+	int id = 0;
+	nextField(p, line, eol, End);
+	if (!readNumber(p, id)) return line;
+	Ids.push_back(id);
+	int n = 0;
+	T value;
+	while (nextField(p, line, eol, End)) {
+	  if (n == Width || !readNumber(p, value)) return line;
+	  Values.push_back(value);
+	  n++;
+	}
+	if (n < Width) {
+	  if (!Pad) return line;
+	  Values.resize(Values.size() + Width - n, T(0));
+	}
+	p = eol + 1;
+      }
+      return NULL;
+    }
+
+    // Cut [Begin, End) into at most N pieces, each starting at the first
+    // line of a record
+    vector<const char * > pieces(const char * Begin, const char * End, int N)
+    {
+      vector<const char * > cuts(1, Begin);
+      for (int k = 1; k < N; k++) {
+	const char * p = Begin + (End - Begin)/N*k;
+	if (p[-1] != '\n') p = lineEnd(p, End) + 1;
+	while (p < End && continues(Begin, p - 1)) p = lineEnd(p, End) + 1;
+	if (p < End && p > cuts.back()) cuts.push_back(p);
+      }
+      cuts.push_back(End);
+      return cuts;
+    }
+
+    // Parse the records of [Begin, End) piece by piece, in parallel, and
+    // append them to Ids and Values in file order. Returns the first bad
+    // line, NULL if there is none.
+    template<class T>
+    const char * parseBlock(const char * Begin, const char * End, int Width, bool Pad,
+			    vector<int > & Ids, vector<T > & Values)
+    {
+      // Pieces of at least 64 kB, a few per thread to balance the load
+      int N = 1;
+#ifdef _OPENMP
+      N = 4*omp_get_max_threads();
+#endif
+      N = int(max(ptrdiff_t(1), min(ptrdiff_t(N), (End - Begin)/65536)));
+      const vector<const char * > cuts = pieces(Begin, End, N);
+      const int NumPieces = cuts.size() - 1;
+
+      vector<vector<int > > ids(NumPieces);
+      vector<vector<T > > values(NumPieces);
+      vector<const char * > bad(NumPieces, (const char *)NULL);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+      for (int k = 0; k < NumPieces; k++)
+	bad[k] = parseRecords(cuts[k], cuts[k + 1], Width, Pad, ids[k], values[k]);
+
+      for (int k = 0; k < NumPieces; k++) {
+	if (bad[k]) return bad[k];
+	Ids.insert(Ids.end(), ids[k].begin(), ids[k].end());
+	Values.insert(Values.end(), values[k].begin(), values[k].end());
+      }
+      return NULL;
+    }
+
+    // Keyword and parameters of the line [Line, Eol), after the '*'
+    Card parseKeyword(const char * Line, const char * Eol)
+    {
+      Card card;
+      const char * p = Line;
+      while (p < Eol && *p != ',') p++;
+      card.keyword = upper(trim(Line, p));
+      while (p < Eol) {
+	const char * q = ++p;
+	while (p < Eol && *p != ',') p++;
+	const char * eq = q;
+	while (eq < p && *eq != '=') eq++;
+	const string key = upper(trim(q, eq));
+	if (!key.empty())
+	  card.params[key] = eq < p ? trim(eq + 1, p) : string();
+      }
+      return card;
+    }
+  }
+
+
+
+  InpFile::InpFile(const string FileName): _fileName(FileName), _dim(0)
+  {
+    ifstream inp(FileName.c_str(), ios::in | ios::binary);
+    if (!inp) {
+      cout << "** InpFile: cannot open " << FileName << endl;
+      exit(1);
+    }
+    inp.seekg(0, ios::end);
+    const size_t size = inp.tellg();
+    inp.seekg(0, ios::beg);
+    // A last '\n' ends the last line
+    _buffer.resize(size + 1, '\n');
+    if (size > 0 && !inp.read(&_buffer[0], size)) {
+      cout << "** InpFile: cannot read " << FileName << endl;
+      exit(1);
+    }
+    inp.close();
+
+    // Keyword lines start with a single '*', the data of a card runs up
+    // to the next one
+    vector<Card > cards;
+    const char * begin = &_buffer[0], * end = begin + _buffer.size();
+    for (const char * p = begin; p < end; ) {
+      const char * eol = lineEnd(p, end), * q = p;
+      while (q < eol && isSpace(*q)) q++;
+      if (q + 1 < eol && q[0] == '*' && q[1] != '*') {
+	if (!cards.empty()) cards.back().end = p;
+	cards.push_back(parseKeyword(q + 1, eol));
+	cards.back().begin = eol + 1;
+      }
+      p = eol + 1;
+    }
+    if (!cards.empty()) cards.back().end = end;
+
+    for (uint c = 0; c < cards.size(); c++) {
+      Card & card = cards[c];
+      if (card.keyword == "NODE") {
+	const int first = _nodeIds.size();
+	this->readNodes(card.begin, card.end);
+	// Nodes of the card also go to node set NSET
+	if (card.params.count("NSET")) {
+	  vector<int > & nodes = _nodeSets[this->addNodeSet(card.params["NSET"])].nodes;
+	  nodes.insert(nodes.end(), _nodeIds.begin() + first, _nodeIds.end());
+	}
+      }
+      else if (card.keyword == "ELEMENT") {
+	const string type = upper(card.params["TYPE"]);
+	if (type.empty())
+	  this->error(card.begin - 1, "*ELEMENT without TYPE");
+	const string name = card.params.count("ELSET") ? card.params["ELSET"] : type;
+	int set = this->findElementSet(name, type);
+	if (set < 0) {
+	  set = _elementSets.size();
+	  _elementSets.push_back(ElementSet());
+	  _elementSets[set].name = name;
+	  _elementSets[set].type = type;
+	  _elementSets[set].nodesPerElement = 0;
+	}
+	this->readElements(card.begin, card.end, _elementSets[set]);
+      }
+      else if (card.keyword == "NSET") {
+	if (card.params["NSET"].empty())
+	  this->error(card.begin - 1, "*NSET without NSET");
+	const int set = this->addNodeSet(card.params["NSET"]);
+	this->readNodeSet(card.begin, card.end, card.params.count("GENERATE") > 0,
+			  _nodeSets[set].nodes);
+      }
+    }
+
+    this->numberNodes();
+    vector<char >().swap(_buffer);
+  }
+
+
+
+  void InpFile::readNodes(const char * Begin, const char * End)
+  {
+    const int width = recordWidth(Begin, End);
+    if (width < 0) return;
+    if (_dim == 0) {
+      if (width < 1 || width > 3)
+	this->error(Begin, "nodes need 1 to 3 coordinates");
+      _dim = width;
+    }
+    // Omitted coordinates are zero
+    const char * bad = parseBlock(Begin, End, _dim, true, _nodeIds, _nodes);
+    if (bad) this->error(bad, "bad *NODE record");
+  }
+
+
+
+  void InpFile::readElements(const char * Begin, const char * End, ElementSet & Set)
+  {
+    const int width = recordWidth(Begin, End);
+    if (width < 0) return;
+    if (Set.nodesPerElement == 0) {
+      if (width < 1) this->error(Begin, "element without nodes");
+      Set.nodesPerElement = width;
+    }
+    const char * bad = parseBlock(Begin, End, Set.nodesPerElement, false,
+				  Set.ids, Set.connectivity);
+    if (bad) {
+      stringstream message;
+      message << "bad *ELEMENT record, " << Set.type << " elements of set "
+	      << Set.name << " have " << Set.nodesPerElement << " nodes";
+      this->error(bad, message.str());
+    }
+  }
+
+
+
+  void InpFile::readNodeSet(const char * Begin, const char * End, bool Generate,
+			    vector<int > & Nodes)
+  {
+    for (const char * p = Begin; p < End; ) {
+      const char * line = p, * eol = lineEnd(p, End);
+      p = eol + 1;
+      if (skipLine(line, eol)) continue;
+
+      // Node numbers, or names of node sets defined before
+      vector<int > fields;
+      for (const char * q = line; q < eol; ) {
+	while (q < eol && (isSpace(*q) || *q == ',')) q++;
+	if (q == eol) break;
+	const char * token = q;
+	int id = 0;
+	if (readNumber(q, id)) {
+	  fields.push_back(id);
+	  continue;
+	}
+	q = token;
+	while (q < eol && !isSpace(*q) && *q != ',') q++;
+	const int set = Generate ? -1 : this->findNodeSet(string(token, q));
+	if (set < 0)
+	  this->error(line, "bad *NSET entry " + string(token, q));
+	fields.insert(fields.end(), _nodeSets[set].nodes.begin(), _nodeSets[set].nodes.end());
+      }
+
+      if (!Generate)
+	Nodes.insert(Nodes.end(), fields.begin(), fields.end());
+      else {
+	// First, last, increment
+	if (fields.size() < 2 || fields.size() > 3 || (fields.size() == 3 && fields[2] <= 0))
+	  this->error(line, "bad *NSET, GENERATE record");
+	const int step = fields.size() == 3 ? fields[2] : 1;
+	for (int id = fields[0]; id <= fields[1]; id += step)
+	  Nodes.push_back(id);
+      }
+    }
+  }
+
+
+
+  void InpFile::numberNodes()
+  {
+    const int NumNodes = _nodeIds.size();
+    bool inOrder = true;
+    for (int i = 0; i < NumNodes && inOrder; i++)
+      inOrder = _nodeIds[i] == i + 1;
+    _nodeIndex.clear();
+    if (!inOrder) {
+      _nodeIndex.resize(NumNodes);
+      for (int i = 0; i < NumNodes; i++)
+	_nodeIndex[i] = make_pair(_nodeIds[i], i);
+      sort(_nodeIndex.begin(), _nodeIndex.end());
+      for (int i = 1; i < NumNodes; i++)
+	if (_nodeIndex[i].first == _nodeIndex[i - 1].first) {
+	  stringstream message;
+	  message << "node " << _nodeIndex[i].first << " is defined twice";
+	  this->error(NULL, message.str());
+	}
+    }
+
+    // Nodes not found are marked -1 - Id, and reported after the loop
+    for (uint s = 0; s < _elementSets.size(); s++) {
+      vector<int > & conn = _elementSets[s].connectivity;
+      const int n = conn.size();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+      for (int i = 0; i < n; i++) {
+	const int index = this->findNode(conn[i]);
+	conn[i] = index < 0 ? -1 - conn[i] : index;
+      }
+      for (int i = 0; i < n; i++)
+	if (conn[i] < 0) {
+	  stringstream message;
+	  message << "element " << _elementSets[s].ids[i/_elementSets[s].nodesPerElement]
+		  << " of set " << _elementSets[s].name << " has undefined node " << -1 - conn[i];
+	  this->error(NULL, message.str());
+	}
+    }
+
+    for (uint s = 0; s < _nodeSets.size(); s++) {
+      vector<int > & nodes = _nodeSets[s].nodes;
+      for (uint i = 0; i < nodes.size(); i++) {
+	const int index = this->findNode(nodes[i]);
+	if (index < 0) {
+	  stringstream message;
+	  message << "node set " << _nodeSets[s].name << " has undefined node " << nodes[i];
+	  this->error(NULL, message.str());
+	}
+	nodes[i] = index;
+      }
+    }
+  }
+
+
+
+  int InpFile::findNode(int Id) const
+  {
+    if (_nodeIndex.empty())
+      return Id >= 1 && Id <= int(_nodeIds.size()) ? Id - 1 : -1;
+    vector<pair<int, int > >::const_iterator it =
+      lower_bound(_nodeIndex.begin(), _nodeIndex.end(), make_pair(Id, -1));
+    return it != _nodeIndex.end() && it->first == Id ? it->second : -1;
+  }
+
+
+
+  int InpFile::findElementSet(const string Name, const string Type) const
+  {
+    for (uint s = 0; s < _elementSets.size(); s++)
+      if (_elementSets[s].name == Name && (Type.empty() || _elementSets[s].type == Type))
+	return s;
+    return -1;
+  }
+
+
+
+  int InpFile::findNodeSet(const string Name) const
+  {
+    for (uint s = 0; s < _nodeSets.size(); s++)
+      if (_nodeSets[s].name == Name) return s;
+    return -1;
+  }
+
+  int InpFile::addNodeSet(const string Name)
+  {
+    int set = this->findNodeSet(Name);
+    if (set < 0) {
+      set = _nodeSets.size();
+      _nodeSets.push_back(NodeSet());
+      _nodeSets[set].name = Name;
+    }
+    return set;
+  }
+
+
+
+  string InpFile::voomElementType(const string AbaqusType)
+  {
+    static const char * Triangles[] = { "S3", "S3R", "STRI3", "M3D3", "R3D3", "SFM3D3",
+					"CPS3", "CPE3", "DS3", NULL };
+    static const char * QuadTriangles[] = { "STRI65", "S6", "M3D6", "CPS6", "CPE6", "DS6", NULL };
+    static const char * Quads[] = { "S4", "S4R", "M3D4", "M3D4R", "R3D4", "SFM3D4",
+				    "CPS4", "CPS4R", "CPE4", "CPE4R", "DS4", NULL };
+    for (int i = 0; Triangles[i]; i++)
+      if (AbaqusType == Triangles[i]) return "TD3";
+    for (int i = 0; QuadTriangles[i]; i++)
+      if (AbaqusType == QuadTriangles[i]) return "TD6";
+    for (int i = 0; Quads[i]; i++)
+      if (AbaqusType == Quads[i]) return "Q4";
+    return AbaqusType;
+  }
+
+
+
+  void InpFile::error(const char * Where, const string Message) const
+  {
+    cout << "** InpFile: " << _fileName;
+    if (Where && !_buffer.empty())
+      cout << ", line " << count(&_buffer[0], Where, '\n') + 1;
+    cout << ": " << Message << endl;
+    exit(1);
+  }
+
+} // namespace voom
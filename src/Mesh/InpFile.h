@@ -0,0 +1,116 @@
+// -*- C++ -*-
+/*!
+  \file InpFile.h
+  \brief Abaqus input file (.inp) reader. Nodes (*NODE), elements
+  (*ELEMENT, TYPE=..., ELSET=...) and node sets (*NSET) are read into
+  memory, numbered from 0 in the order they appear, so that a FEMesh is
+  built from the .inp directly, without a text deck in between.
+
+  The file is read in one block and scanned in place. A first pass finds
+  the keyword lines; the data of the *NODE and *ELEMENT cards, almost
+  all of the file, is then cut into pieces at record boundaries and the
+  pieces are parsed in parallel (OpenMP) with strtol/strtod. A record
+  continues on the next line when its line ends with a comma (e.g. C3D8
+  and C3D10 elements written by HyperMesh).
+
+  Element sets are the *ELEMENT cards, merged by set name and type: a
+  set name used for two element types (e.g. S4 and S3 in the same
+  component) gives two sets. Elements without ELSET are in a set named
+  after their type. Other cards (*MATERIAL, *STEP, ...) are skipped.
+*/
+
+#if !defined(__InpFile_h__)
+#define __InpFile_h__
+
+#include "voom.h"
+
+namespace voom
+{
+  class InpFile
+  {
+  public:
+    //! Read an Abaqus input file
+    InpFile(const string FileName);
+
+    //! Nodes
+    uint getDimension() const { return _dim; }
+    int getNumberOfNodes() const { return int(_nodeIds.size()); }
+    //! Nodal positions, NumNodes x Dimension
+    const Real * getNodes() const { return _nodes.empty() ? NULL : &_nodes[0]; }
+    //! Abaqus number of node i
+    int getNodeId(int i) const { return _nodeIds[i]; }
+    //! Index of the node numbered Id in the file, -1 if there is none
+    int findNode(int Id) const;
+
+    //! Element sets
+    int getNumberOfElementSets() const { return int(_elementSets.size()); }
+    //! First set named Name (of type Type if given), -1 if not found
+    int findElementSet(const string Name, const string Type = "") const;
+    string getElementSetName(int Set) const { return _elementSets[Set].name; }
+    //! Abaqus element type, e.g. C3D10 or S3
+    string getElementType(int Set) const { return _elementSets[Set].type; }
+    int getNumberOfElements(int Set) const { return int(_elementSets[Set].ids.size()); }
+    int getNodesPerElement(int Set) const { return _elementSets[Set].nodesPerElement; }
+    //! Connectivity (node indices), NumElements x NodesPerElement
+    const int * getConnectivity(int Set) const { return ptr(_elementSets[Set].connectivity); }
+    //! Abaqus numbers of the elements
+    const int * getElementIds(int Set) const { return ptr(_elementSets[Set].ids); }
+
+    //! Node sets (node indices)
+    int getNumberOfNodeSets() const { return int(_nodeSets.size()); }
+    int findNodeSet(const string Name) const;
+    string getNodeSetName(int Set) const { return _nodeSets[Set].name; }
+    int getNodeSetSize(int Set) const { return int(_nodeSets[Set].nodes.size()); }
+    const int * getNodeSet(int Set) const { return ptr(_nodeSets[Set].nodes); }
+
+    //! FEMesh name of an Abaqus element type (S3 -> TD3, S4R -> Q4, ...),
+    //! AbaqusType itself if FEMesh uses the Abaqus name or does not know it
+    static string voomElementType(const string AbaqusType);
+
+  private:
+    struct ElementSet {
+      string name, type;
+      int nodesPerElement;
+      vector<int > ids;
+      vector<int > connectivity;
+    };
+    struct NodeSet {
+      string name;
+      vector<int > nodes;
+    };
+
+    //! Parse the records of the data lines [Begin, End) of a *NODE card
+    void readNodes(const char * Begin, const char * End);
+    //! ... of an *ELEMENT card into Set
+    void readElements(const char * Begin, const char * End, ElementSet & Set);
+    //! ... of an *NSET card, appended to Nodes (Abaqus numbers)
+    void readNodeSet(const char * Begin, const char * End, bool Generate, vector<int > & Nodes);
+    //! Node set Name, new and empty if there is none; cards with the same
+    //! NSET add to the same set
+    int addNodeSet(const string Name);
+    //! Abaqus node numbers to indices, in connectivities and node sets
+    void numberNodes();
+
+    //! Abort with the file name and the line number of Where
+    void error(const char * Where, const string Message) const;
+
+    static const int * ptr(const vector<int > & V) { return V.empty() ? NULL : &V[0]; }
+
+    string           _fileName;
+    //! File contents while reading
+    vector<char >    _buffer;
+
+    uint             _dim;
+    vector<Real >    _nodes;
+    vector<int >     _nodeIds;
+    //! Abaqus number of every node and its index, sorted by number;
+    //! empty if the nodes are numbered 1 to NumNodes in order
+    vector<pair<int, int > > _nodeIndex;
+
+    vector<ElementSet > _elementSets;
+    vector<NodeSet >    _nodeSets;
+  };
+
+} // namespace voom
+
+#endif // __InpFile_h__
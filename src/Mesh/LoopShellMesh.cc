@@ -53,27 +53,26 @@ namespace voom {
     // from one edge
 
     // find a boundary edge to start
-    HalfEdge * Hstart=0;
-    for(int h=0; h<mesh->halfEdges.size(); h++) {
-      HalfEdge * H = mesh->halfEdges[h];
-      if( H->opposite == 0 ) {
-	Hstart = H; 
+    int Hstart=-1;
+    for(int h=0; h<mesh->getNumberOfHalfEdges(); h++) {
+      if( mesh->opposite[h] < 0 ) {
+	Hstart = h;
 	break;
       }
     }
 
     // found one, now walk around boundary, storing boundary edges in
     // order
-    std::vector< HalfEdge * > boundaryEdges;
-    if( Hstart !=0 ) {
-      HalfEdge * H = Hstart; 
+    std::vector< int > boundaryEdges;
+    if( Hstart >= 0 ) {
+      int H = Hstart;
       do {
 	boundaryEdges.push_back( H );
 	// find next boundary edge (CCW around the boundary) by
 	// walking around H's vertex CW
-	H = H->next;
-	while ( H->opposite != 0 ) {
-	  H = H->opposite->next;
+	H = HalfEdgeMesh::next(H);
+	while ( mesh->opposite[H] >= 0 ) {
+	  H = HalfEdgeMesh::next(mesh->opposite[H]);
 	}
       } while ( H != Hstart );
     }
@@ -81,11 +80,12 @@ namespace voom {
     std::cout << "Identified " << boundaryEdges.size() << " boundary edges." 
 	      << std::endl;
     
-    if( boundaryEdges.size() > 0 ) {
+    const int NumBoundaryEdges = boundaryEdges.size();
+    if( NumBoundaryEdges > 0 ) {
       // step 2: add a ghost node and face for each boundary edge,
       // also create ghostBC for each boundary edge
-      for(int h=0; h<boundaryEdges.size(); h++) {
-	HalfEdge * H = boundaryEdges[h];
+      for(int h=0; h<NumBoundaryEdges; h++) {
+	int H = boundaryEdges[h];
 	
 	// add new ghost node
 	int V = _X.size();
@@ -104,9 +104,9 @@ namespace voom {
 	// H->next \ /  H->prev
 	//          V1
 	//
-	int V0 = H->vertex->id;
-	int V1 = H->next->vertex->id;
-	int V2 = H->prev->vertex->id;
+	int V0 = mesh->vertex[H];
+	int V1 = mesh->vertex[HalfEdgeMesh::next(H)];
+	int V2 = mesh->vertex[HalfEdgeMesh::prev(H)];
 
 	//FeNode_t * N0 = _X[ V0 ];
 	//FeNode_t * N1 = _X[ V1 ];
@@ -123,7 +123,7 @@ namespace voom {
 
       // step 3: add ghost faces
       // connecting neighboring ghost vertices
-      for(int h=0; h<boundaryEdges.size(); h++) {
+      for(int h=0; h<NumBoundaryEdges; h++) {
 	//            
 	//      VHH-------VH
 	//       / \ Add / \  
@@ -131,12 +131,11 @@ namespace voom {
 	//    *-------V-------*
 	//        HH      H
 	//
-	HalfEdge * H = boundaryEdges[h];
-	HalfEdge * HH = boundaryEdges[(h+1) % boundaryEdges.size()];
+	int H = boundaryEdges[h];
 
-	int V = H->vertex->id;
-	int VH = mesh->vertices.size() + h;
-	int VHH = mesh->vertices.size() + (h+1) % boundaryEdges.size();
+	int V = mesh->vertex[H];
+	int VH = mesh->getNumberOfVertices() + h;
+	int VHH = mesh->getNumberOfVertices() + (h+1) % NumBoundaryEdges;
 
 	TriangleConnectivity c;
 	c << V, VH, VHH;
@@ -148,69 +147,51 @@ namespace voom {
       mesh = new HalfEdgeMesh(connectivities, _X.size());
     }
        
-    for(int f=0; f<mesh->faces.size(); f++) {
-      Face * F = mesh->faces[f];
+    for(int f=0; f<mesh->getNumberOfFaces(); f++) {
       // get valences of corners and find one-ring of
       // next-nearest-neighbor vertices
       vector<VectorXd> nds;
       vector<int> ndIDs;
 
       CornerValences v(3,0);
+      int F[3];
+      for(int a=0; a<3; a++) F[a] = HalfEdgeMesh::faceHalfEdge(f, a);
       //don't create element for this face if any of the vertices is on the boundary
-      if( F->halfEdges[0]->vertex->boundary ) continue;
-      if( F->halfEdges[1]->vertex->boundary ) continue;
-      if( F->halfEdges[2]->vertex->boundary ) continue;
+      if( mesh->boundary[ mesh->vertex[F[0]] ] ) continue;
+      if( mesh->boundary[ mesh->vertex[F[1]] ] ) continue;
+      if( mesh->boundary[ mesh->vertex[F[2]] ] ) continue;
 
       for(int a=0; a<3; a++) {
     	// add corner vertices
-    	HalfEdge * H = F->halfEdges[a];
-	int Id = H->vertex->id;
+	int Id = mesh->vertex[F[a]];
 	ndIDs.push_back( Id );
     	nds.push_back( _X[Id] );
     	// valence is the number of incident halfedges
-    	v[a] = H->vertex->halfEdges.size();
+    	v[a] = mesh->valence[Id];
       }
       // walk around the one-ring adding vertices
       //
       // Start by walking CCW through the vertices incident to the
       // second corner vertex.  Stop at first vertex incident to the
-      // third corner vertex.
-      int v1=3;
-      for(HalfEdge * H = F->halfEdges[1]->opposite->next; 
-    	  H->vertex->id != F->halfEdges[2]->opposite->next->vertex->id; 
-    	  H = H->next->opposite->next  ) {
-	int Id = H->vertex->id;
-	ndIDs.push_back( Id );
-    	nds.push_back( _X[Id] );
-    	v1++;
-      }
-      // Now continue CCW through the vertices incident to the third
-      // corner vertex. Stop at first vertex incident to the first
-      // corner vertex.
-      int v2=3;
-      for(HalfEdge * H = F->halfEdges[2]->opposite->next; 
-    	  H->vertex->id != F->halfEdges[0]->opposite->next->vertex->id; 
-    	  H = H->next->opposite->next  ) {
-	int Id = H->vertex->id;
-	ndIDs.push_back( Id );
-    	nds.push_back( _X[Id] );
-    	v2++;
-      }
-      // Now continue CCW through the vertices incident to the first
-      // corner vertex. Stop at first vertex incident to the second
-      // corner vertex.
-      int v0=3;
-      for(HalfEdge * H = F->halfEdges[0]->opposite->next; 
-    	  H->vertex->id != F->halfEdges[1]->opposite->next->vertex->id; 
-    	  H = H->next->opposite->next  ) {
-	int Id = H->vertex->id;
-	ndIDs.push_back( Id );
-    	nds.push_back( _X[Id] );
-    	v0++;
+      // third corner vertex. Then continue with the third and the
+      // first corner vertices.
+      int count[3] = {3, 3, 3};
+      const int corner[3] = {1, 2, 0};
+      for(int c=0; c<3; c++) {
+	const int a = corner[c], b = corner[(c+1)%3];
+	const int stop = mesh->vertex[ HalfEdgeMesh::next(mesh->opposite[F[b]]) ];
+	for(int H = HalfEdgeMesh::next(mesh->opposite[F[a]]);
+	    mesh->vertex[H] != stop;
+	    H = HalfEdgeMesh::next(mesh->opposite[HalfEdgeMesh::next(H)]) ) {
+	  int Id = mesh->vertex[H];
+	  ndIDs.push_back( Id );
+	  nds.push_back( _X[Id] );
+	  count[a]++;
+	}
       }
-      assert(v0==v[0]);
-      assert(v1==v[1]);
-      assert(v2==v[2]);
+      assert(count[0]==v[0]);
+      assert(count[1]==v[1]);
+      assert(count[2]==v[2]);
 
       //const unsigned npn = v(0) + v(1) + v(2) - 6;
       
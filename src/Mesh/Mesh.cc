@@ -4,7 +4,7 @@
 namespace voom
 {
   // Constructor. Creates position table only.
-  Mesh::Mesh(const string Nodes, const string ConnTable) {
+  Mesh::Mesh(const string Nodes, const string ConnTable): _X(_ownX) {
     ifstream inp;
     inp.open(Nodes.c_str(), ios::in);
     if (!inp) {
@@ -36,6 +36,124 @@ namespace voom
     inp.close();
   }
   
+  void Mesh::buildNodeElements() {
+    const int NumNodes = _X.size(), NumEl = _elements.size();
+    _nodeElementOffsets.assign(NumNodes + 1, 0);
+    for (int e = 0; e < NumEl; e++) {
+      const vector<int > & NodesID = _elements[e]->getNodesID();
+      for (uint a = 0; a < NodesID.size(); a++)
+	_nodeElementOffsets[NodesID[a] + 1]++;
+    }
+    for (int n = 0; n < NumNodes; n++)
+      _nodeElementOffsets[n + 1] += _nodeElementOffsets[n];
+
+    // Fill in element order so each row is sorted
+    _nodeElements.resize(_nodeElementOffsets[NumNodes]);
+    vector<int > next(_nodeElementOffsets.begin(), _nodeElementOffsets.end() - 1);
+    for (int e = 0; e < NumEl; e++) {
+      const vector<int > & NodesID = _elements[e]->getNodesID();
+      for (uint a = 0; a < NodesID.size(); a++)
+	_nodeElements[next[NodesID[a]]++] = e;
+    }
+  }
+
+  void Mesh::buildElementNeighbors() {
+    const vector<int > & offsets = this->getNodeElementOffsets();
+    const vector<int > & nodeElements = this->getNodeElements();
+    const int NumEl = _elements.size();
+
+    // Two passes over the elements of the nodes of each element; mark[f] == e
+    // once f has been counted as a neighbor of e
+    vector<int > mark(NumEl, -1);
+    _elementNeighborOffsets.assign(NumEl + 1, 0);
+    for (int pass = 0; pass < 2; pass++) {
+      fill(mark.begin(), mark.end(), -1);
+      for (int e = 0; e < NumEl; e++) {
+	const vector<int > & NodesID = _elements[e]->getNodesID();
+	int count = 0;
+	mark[e] = e;
+	for (uint a = 0; a < NodesID.size(); a++)
+	  for (int i = offsets[NodesID[a]]; i < offsets[NodesID[a] + 1]; i++) {
+	    const int f = nodeElements[i];
+	    if (mark[f] == e) continue;
+	    mark[f] = e;
+	    if (pass == 1)
+	      _elementNeighbors[_elementNeighborOffsets[e] + count] = f;
+	    count++;
+	  }
+	if (pass == 0)
+	  _elementNeighborOffsets[e + 1] = _elementNeighborOffsets[e] + count;
+	else
+	  sort(_elementNeighbors.begin() + _elementNeighborOffsets[e],
+	       _elementNeighbors.begin() + _elementNeighborOffsets[e + 1]);
+      }
+      if (pass == 0)
+	_elementNeighbors.resize(_elementNeighborOffsets[NumEl]);
+    }
+  }
+
+  void Mesh::buildColors() {
+    const vector<int > & offsets = this->getElementNeighborOffsets();
+    const vector<int > & neighbors = this->getElementNeighbors();
+    const int NumEl = _elements.size();
+
+    // Greedy first fit: smallest color not used by a colored neighbor
+    _elementColors.assign(NumEl, -1);
+    vector<int > forbidden, count;
+    for (int e = 0; e < NumEl; e++) {
+      for (int i = offsets[e]; i < offsets[e + 1]; i++)
+	if (_elementColors[neighbors[i]] >= 0)
+	  forbidden[_elementColors[neighbors[i]]] = e;
+      int c = 0;
+      while (c < int(count.size()) && forbidden[c] == e) c++;
+      if (c == int(count.size())) {
+	count.push_back(0);
+	forbidden.push_back(-1);
+      }
+      _elementColors[e] = c;
+      count[c]++;
+    }
+
+    // Balance: move elements from colors above the average size to the
+    // smallest color their neighbors allow, keeping the number of colors
+    const int NumColors = count.size();
+    const int average = NumColors > 0 ? (NumEl + NumColors - 1)/NumColors : 0;
+    fill(forbidden.begin(), forbidden.end(), -1);
+    for (int e = 0; e < NumEl; e++) {
+      const int c = _elementColors[e];
+      if (count[c] <= average) continue;
+      for (int i = offsets[e]; i < offsets[e + 1]; i++)
+	forbidden[_elementColors[neighbors[i]]] = e;
+      int best = c;
+      for (int k = 0; k < NumColors; k++)
+	if (forbidden[k] != e && count[k] < average && count[k] < count[best])
+	  best = k;
+      count[c]--; count[best]++;
+      _elementColors[e] = best;
+    }
+
+    // Group the elements by color
+    _colorOffsets.assign(NumColors + 1, 0);
+    for (int c = 0; c < NumColors; c++)
+      _colorOffsets[c + 1] = _colorOffsets[c] + count[c];
+    _colorElements.resize(NumEl);
+    vector<int > next(_colorOffsets.begin(), _colorOffsets.end() - 1);
+    for (int e = 0; e < NumEl; e++)
+      _colorElements[next[_elementColors[e]]++] = e;
+  }
+
+  void Mesh::printColoring() {
+    const vector<int > & offsets = this->getColorOffsets();
+    const int NumColors = offsets.size() - 1;
+    int smallest = _elements.size(), largest = 0;
+    for (int c = 0; c < NumColors; c++) {
+      smallest = min(smallest, offsets[c + 1] - offsets[c]);
+      largest = max(largest, offsets[c + 1] - offsets[c]);
+    }
+    cout << "Element colors    : " << NumColors << " (" << smallest << " to "
+	 << largest << " elements per color)" << endl;
+  }
+  
   // // Static function
   // Mesh* Mesh::New(const string inputFile) {
   //   Mesh* myMesh;
@@ -42,7 +42,7 @@ namespace voom
     Mesh(const string Nodes, const string ConnTable);
 
     //! Position only based constructor
-    Mesh(const vector<VectorXd > &  X): _X(X) {};
+    Mesh(const vector<VectorXd > &  X): _ownX(X), _X(_ownX) {};
 
     //! Destructor
     // Destructor made virtual due to inheritance
@@ -76,9 +76,15 @@ namespace voom
       return getX(nodeId)(dof);
     }
 
+    //! Nodal positions (e.g. to build a NodeGrid over them)
+    const vector<VectorXd > & getPositions() { return _X; }
+
     //! Get number of Nodes
     int getNumberOfNodes() { return _X.size(); }
 
+    //! True if the nodal positions are those of another mesh
+    bool sharesNodes() const { return &_X != &_ownX; }
+
     //! Get number of elements
     int getNumberOfElements() { return _elements.size(); }
 
@@ -87,6 +93,54 @@ namespace voom
       return _elements;
     }
 
+    //! Elements connected to each node in compressed row form, built on
+    //! first use: the elements of node n are getNodeElements()[i] for
+    //! getNodeElementOffsets()[n] <= i < getNodeElementOffsets()[n+1], in
+    //! increasing order
+    const vector<int > & getNodeElementOffsets() {
+      if (_nodeElementOffsets.empty()) this->buildNodeElements();
+      return _nodeElementOffsets;
+    }
+    const vector<int > & getNodeElements() {
+      if (_nodeElementOffsets.empty()) this->buildNodeElements();
+      return _nodeElements;
+    }
+
+    //! Element coloring, built on first use: elements of the same color
+    //! share no node, so they can be assembled concurrently without atomics.
+    //! Elements of color c are getColorElements()[i] for
+    //! getColorOffsets()[c] <= i < getColorOffsets()[c+1], in increasing order
+    int getNumberOfColors() {
+      if (_colorOffsets.empty()) this->buildColors();
+      return _colorOffsets.size() - 1;
+    }
+    const vector<int > & getColorOffsets() {
+      if (_colorOffsets.empty()) this->buildColors();
+      return _colorOffsets;
+    }
+    const vector<int > & getColorElements() {
+      if (_colorOffsets.empty()) this->buildColors();
+      return _colorElements;
+    }
+    //! Color of each element
+    const vector<int > & getElementColors() {
+      if (_colorOffsets.empty()) this->buildColors();
+      return _elementColors;
+    }
+    //! Print number of colors and their sizes (balance)
+    void printColoring();
+
+    //! Elements sharing at least one node with each element (itself
+    //! excluded), same compressed row form, built on first use
+    const vector<int > & getElementNeighborOffsets() {
+      if (_elementNeighborOffsets.empty()) this->buildElementNeighbors();
+      return _elementNeighborOffsets;
+    }
+    const vector<int > & getElementNeighbors() {
+      if (_elementNeighborOffsets.empty()) this->buildElementNeighbors();
+      return _elementNeighbors;
+    }
+
     // //! Return mapping between local and global DoF and ghost DoF
     // const vector<int > & getLocalDoF() { return _localDoF; };
     // const vector<int > & getGhostDoF() { return _ghostDoF; };
@@ -96,23 +150,43 @@ namespace voom
 
   protected:
     //! Default constructor is protected because it should be called only by derived classes, not from outside
-    Mesh() {};
+    Mesh(): _X(_ownX) {};
+
+    //! View constructor: the mesh uses the nodal positions of Parent (no
+    //! copy), which must outlive it. Node IDs are the same in both meshes.
+    Mesh(Mesh & Parent): _X(Parent._X) {};
     // //! Protected because elements are not initialized here and should be used only from a derived class
     // Mesh(const vector<VectorXd > &  Positions,
     // 	 const vector<int > & LocalDoF,
     // 	 const vector<int > & GhostDoF):
     //   _positions(Positions), _localDoF(LocalDoF), _ghostDoF(GhostDoF) {};
 
-    //! Nodal positions
-    vector<VectorXd >     _X;
+    //! Nodal positions owned by this mesh (empty for a view)
+    vector<VectorXd >     _ownX;
+    //! Nodal positions, _ownX or those of the parent mesh
+    vector<VectorXd >   & _X;
 
     //! List of Elements
     vector<GeomElement* > _elements;
 
+    //! Cached adjacency, empty until first requested. Not built under a
+    //! lock: request it once before using it from several threads.
+    void buildNodeElements();
+    void buildElementNeighbors();
+    void buildColors();
+    vector<int >          _nodeElementOffsets, _nodeElements;
+    vector<int >          _elementNeighborOffsets, _elementNeighbors;
+    vector<int >          _colorOffsets, _colorElements, _elementColors;
+
     // //! Map of Degrees of freedom local ID to global ID
     // vector<int >          _localDoF;
     // vector<int >          _ghostDoF;
 
+  private:
+    //! Not copyable (owns the elements, may share the nodes)
+    Mesh(const Mesh &);
+    Mesh & operator=(const Mesh &);
+
   }; // Class Mesh
 
 } //namespace voom
@@ -0,0 +1,199 @@
+#include "MeshFile.h"
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace voom
+{
+  static const char MeshFileMagic[8] = {'V','O','O','M','M','E','S','H'};
+  static const int  MeshFileVersion = 1;
+  static const int  MeshFileByteOrder = 0x01020304;
+
+  // Bytes taken by the array of an entry
+  static size_t entryBytes(int Kind, long long Count, int Width)
+  {
+    if (Kind == MeshFile::NODESET) return size_t(Count)*sizeof(int);
+    if (Kind == MeshFile::ELEMENTSET) return size_t(Count)*size_t(Width)*sizeof(int);
+    return size_t(Count)*size_t(Width)*sizeof(Real);
+  }
+
+  static size_t align8(size_t Offset) { return (Offset + 7) & ~size_t(7); }
+
+
+
+  MeshFile::MeshFile(const string FileName): _data(NULL), _size(0)
+  {
+    int fd = open(FileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+      cout << "** MeshFile: cannot open " << FileName << endl;
+      exit(1);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(Header)) {
+      cout << "** MeshFile: " << FileName << " is not a mesh file" << endl;
+      exit(1);
+    }
+    _size = st.st_size;
+    void *map = mmap(NULL, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+      cout << "** MeshFile: cannot map " << FileName << endl;
+      exit(1);
+    }
+    _data = (const char *)map;
+    _header = (const Header *)_data;
+
+    if (memcmp(_header->magic, MeshFileMagic, 8) != 0 ||
+	_header->version != MeshFileVersion) {
+      cout << "** MeshFile: " << FileName << " is not a version "
+	   << MeshFileVersion << " mesh file" << endl;
+      exit(1);
+    }
+    if (_header->byteOrder != MeshFileByteOrder) {
+      cout << "** MeshFile: " << FileName << " was written with a different byte order" << endl;
+      exit(1);
+    }
+    const size_t tocEnd = size_t(_header->tocOffset) + size_t(_header->numSets)*sizeof(Entry);
+    const size_t nodesEnd = sizeof(Header) + size_t(_header->numNodes)*_header->dim*sizeof(Real);
+    if (tocEnd > _size || nodesEnd > _size) {
+      cout << "** MeshFile: " << FileName << " is truncated" << endl;
+      exit(1);
+    }
+    _toc = (const Entry *)(_data + _header->tocOffset);
+    for (int s = 0; s < _header->numSets; s++)
+      if (size_t(_toc[s].offset) + entryBytes(_toc[s].kind, _toc[s].count, _toc[s].width) > _size) {
+	cout << "** MeshFile: " << FileName << " is truncated (set " << _toc[s].name << ")" << endl;
+	exit(1);
+      }
+  }
+
+
+
+  MeshFile::~MeshFile()
+  {
+    if (_data) munmap((void *)_data, _size);
+  }
+
+
+
+  int MeshFile::find(SetKind Kind, const string Name) const
+  {
+    for (int s = 0; s < _header->numSets; s++)
+      if (_toc[s].kind == Kind && Name == _toc[s].name)
+	return s;
+    return -1;
+  }
+
+
+
+  MeshFile::Writer::Writer(const vector<Real > & Nodes, uint Dim):
+    _nodes(Nodes), _dim(Dim)
+  {
+    if (Dim == 0 || Nodes.size() % Dim != 0) {
+      cout << "** MeshFile::Writer: " << Nodes.size() << " coordinates for dimension " << Dim << endl;
+      exit(1);
+    }
+  }
+
+  void MeshFile::Writer::addElementSet(const string Name, const string ElementType,
+				       int NodesPerElement, const vector<int > & Connectivity)
+  {
+    if (NodesPerElement <= 0 || Connectivity.size() % NodesPerElement != 0 ||
+	ElementType.size() >= 16) {
+      cout << "** MeshFile::Writer: invalid element set " << Name << endl;
+      exit(1);
+    }
+    Set s;
+    s.kind = ELEMENTSET; s.width = NodesPerElement;
+    s.name = Name; s.type = ElementType; s.ints = Connectivity;
+    _sets.push_back(s);
+  }
+
+  void MeshFile::Writer::addNodeSet(const string Name, const vector<int > & Nodes)
+  {
+    Set s;
+    s.kind = NODESET; s.width = 1;
+    s.name = Name; s.ints = Nodes;
+    _sets.push_back(s);
+  }
+
+  void MeshFile::Writer::addField(const string Name, int Components, const vector<Real > & Values)
+  {
+    if (Components <= 0 || Values.size() % Components != 0) {
+      cout << "** MeshFile::Writer: invalid field " << Name << endl;
+      exit(1);
+    }
+    Set s;
+    s.kind = FIELD; s.width = Components;
+    s.name = Name; s.reals = Values;
+    _sets.push_back(s);
+  }
+
+
+
+  void MeshFile::Writer::write(const string FileName) const
+  {
+    Header h;
+    memset(&h, 0, sizeof(Header));
+    memcpy(h.magic, MeshFileMagic, 8);
+    h.version = MeshFileVersion;
+    h.byteOrder = MeshFileByteOrder;
+    h.dim = _dim;
+    h.numSets = _sets.size();
+    h.numNodes = _nodes.size()/_dim;
+
+    // Place the arrays
+    vector<Entry > toc(_sets.size());
+    size_t offset = align8(sizeof(Header) + _nodes.size()*sizeof(Real));
+    for (uint s = 0; s < _sets.size(); s++) {
+      memset(&toc[s], 0, sizeof(Entry));
+      if (_sets[s].name.size() >= 64) {
+	cout << "** MeshFile::Writer: set name too long " << _sets[s].name << endl;
+	exit(1);
+      }
+      strcpy(toc[s].name, _sets[s].name.c_str());
+      strcpy(toc[s].type, _sets[s].type.c_str());
+      toc[s].kind = _sets[s].kind;
+      toc[s].width = _sets[s].width;
+      toc[s].count = (_sets[s].kind == FIELD ? _sets[s].reals.size() : _sets[s].ints.size())/_sets[s].width;
+      toc[s].offset = offset;
+      offset = align8(offset + entryBytes(toc[s].kind, toc[s].count, toc[s].width));
+    }
+    h.tocOffset = offset;
+
+    ofstream out(FileName.c_str(), ios::out | ios::binary);
+    if (!out) {
+      cout << "** MeshFile::Writer: cannot open " << FileName << endl;
+      exit(1);
+    }
+    const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    size_t pos = 0;
+    out.write((const char *)&h, sizeof(Header));
+    pos += sizeof(Header);
+    if (!_nodes.empty())
+      out.write((const char *)&_nodes[0], _nodes.size()*sizeof(Real));
+    pos += _nodes.size()*sizeof(Real);
+    for (uint s = 0; s < _sets.size(); s++) {
+      out.write(zeros, toc[s].offset - pos);
+      pos = toc[s].offset;
+      size_t bytes = entryBytes(toc[s].kind, toc[s].count, toc[s].width);
+      if (bytes > 0) {
+	if (toc[s].kind == FIELD)
+	  out.write((const char *)&_sets[s].reals[0], bytes);
+	else
+	  out.write((const char *)&_sets[s].ints[0], bytes);
+      }
+      pos += bytes;
+    }
+    out.write(zeros, h.tocOffset - pos);
+    if (!toc.empty())
+      out.write((const char *)&toc[0], toc.size()*sizeof(Entry));
+    if (!out) {
+      cout << "** MeshFile::Writer: error writing " << FileName << endl;
+      exit(1);
+    }
+  }
+
+} // namespace voom
@@ -0,0 +1,139 @@
+// -*- C++ -*-
+/*!
+  \file MeshFile.h
+  \brief Binary mesh container. One file holds the nodal positions, any
+  number of named element sets (connectivity of one element type each,
+  e.g. the volume mesh and its Epicardium/Endocardium surfaces), named node
+  sets (BC nodes) and named real fields (e.g. fiber, sheet and normal
+  vectors at every quadrature point).
+
+  The file is opened with mmap and all arrays are used in place, nothing
+  is parsed. Layout (native byte order, every array 8-byte aligned):
+  - header: magic "VOOMMESH", version, byte order mark, dimension, number
+  of nodes, number of sets and offset of the table of contents
+  - nodal positions, NumNodes x Dimension doubles
+  - the arrays of the sets (int32 connectivity and node ids, doubles)
+  - table of contents, one fixed size entry per set (kind, name, element
+  type, width, count, offset)
+
+  MeshFile::Writer assembles and writes a file; the meshConverter utility
+  converts the text .node/.ele/nodeset/fiber files.
+*/
+
+#if !defined(__MeshFile_h__)
+#define __MeshFile_h__
+
+#include "voom.h"
+
+namespace voom
+{
+  class MeshFile
+  {
+  public:
+    //! Kind of set stored in the file
+    enum SetKind { ELEMENTSET = 0, NODESET = 1, FIELD = 2 };
+
+    //! Open (memory map) a binary mesh file
+    MeshFile(const string FileName);
+
+    //! Destructor, unmaps the file
+    ~MeshFile();
+
+    //! Nodes
+    uint getDimension() const { return _header->dim; }
+    int getNumberOfNodes() const { return int(_header->numNodes); }
+    //! Nodal positions, NumNodes x Dimension
+    const Real * getNodes() const { return (const Real *)(_data + sizeof(Header)); }
+
+    //! Element sets
+    int findElementSet(const string Name) const { return this->find(ELEMENTSET, Name); }
+    string getElementType(int Set) const { return string(_toc[Set].type); }
+    int getNumberOfElements(int Set) const { return int(_toc[Set].count); }
+    int getNodesPerElement(int Set) const { return _toc[Set].width; }
+    //! Connectivity, NumElements x NodesPerElement
+    const int * getConnectivity(int Set) const { return (const int *)(_data + _toc[Set].offset); }
+
+    //! Node sets
+    int findNodeSet(const string Name) const { return this->find(NODESET, Name); }
+    int getNodeSetSize(int Set) const { return int(_toc[Set].count); }
+    const int * getNodeSet(int Set) const { return (const int *)(_data + _toc[Set].offset); }
+
+    //! Real fields
+    int findField(const string Name) const { return this->find(FIELD, Name); }
+    int getFieldSize(int Set) const { return int(_toc[Set].count); }
+    int getFieldComponents(int Set) const { return _toc[Set].width; }
+    //! Values, FieldSize x FieldComponents
+    const Real * getField(int Set) const { return (const Real *)(_data + _toc[Set].offset); }
+
+    //! All sets
+    int getNumberOfSets() const { return _header->numSets; }
+    SetKind getSetKind(int Set) const { return SetKind(_toc[Set].kind); }
+    string getSetName(int Set) const { return string(_toc[Set].name); }
+
+    //! Build and write a mesh file
+    class Writer
+    {
+    public:
+      //! Nodal positions, NumNodes x Dim
+      Writer(const vector<Real > & Nodes, uint Dim);
+
+      void addElementSet(const string Name, const string ElementType,
+			 int NodesPerElement, const vector<int > & Connectivity);
+      void addNodeSet(const string Name, const vector<int > & Nodes);
+      void addField(const string Name, int Components, const vector<Real > & Values);
+
+      void write(const string FileName) const;
+
+    private:
+      struct Set {
+	int kind, width;
+	string name, type;
+	vector<int > ints;
+	vector<Real > reals;
+      };
+      vector<Real > _nodes;
+      uint          _dim;
+      vector<Set >  _sets;
+    };
+
+  private:
+    //! File header
+    struct Header {
+      char    magic[8];
+      int     version;
+      int     byteOrder;
+      int     dim;
+      int     numSets;
+      long long numNodes;
+      long long tocOffset;
+      long long reserved[3];
+    };
+
+    //! Table of contents entry
+    struct Entry {
+      int     kind;
+      int     width;
+      char    name[64];
+      char    type[16];
+      long long count;
+      long long offset;
+    };
+
+    //! Index of the set of kind Kind named Name, -1 if not found
+    int find(SetKind Kind, const string Name) const;
+
+    const char   *_data;
+    size_t        _size;
+    const Header *_header;
+    const Entry  *_toc;
+
+    //! Not copyable (owns the mapping)
+    MeshFile(const MeshFile &);
+    MeshFile & operator=(const MeshFile &);
+
+    friend class Writer;
+  };
+
+} // namespace voom
+
+#endif // __MeshFile_h__
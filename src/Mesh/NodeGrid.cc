@@ -0,0 +1,188 @@
+#include "NodeGrid.h"
+
+namespace voom
+{
+  NodeGrid::NodeGrid(const vector<VectorXd > & X, Real CellSize):
+    _X(X), _dim(0), _requestedh(CellSize), _h(CellSize)
+  {
+    if (X.empty() || X[0].size() < 1 || X[0].size() > 3 || !(CellSize > 0.0)) {
+      cout << "** NodeGrid: needs nodes in 1, 2 or 3 dimensions and a positive cell size" << endl;
+      exit(1);
+    }
+    _dim = X[0].size();
+    this->update();
+  }
+
+
+
+  void NodeGrid::update()
+  {
+    const int NumNodes = _X.size();
+    Real lo[3] = {0.0, 0.0, 0.0}, hi[3] = {0.0, 0.0, 0.0};
+    for (uint k = 0; k < _dim; k++)
+      lo[k] = hi[k] = _X[0](k);
+    for (int n = 1; n < NumNodes; n++)
+      for (uint k = 0; k < _dim; k++) {
+	lo[k] = min(lo[k], _X[n](k));
+	hi[k] = max(hi[k], _X[n](k));
+      }
+
+    // Not more than about 4 cells per node, whatever the requested size
+    _h = _requestedh;
+    const Real MaxCells = 4.0*NumNodes + 64.0;
+    while (true) {
+      Real numCells = 1.0;
+      for (uint k = 0; k < _dim; k++)
+	numCells *= floor((hi[k] - lo[k])/_h) + 1.0;
+      if (numCells <= MaxCells) break;
+      _h *= pow(numCells/MaxCells, 1.0/_dim)*1.01;
+    }
+    int numCells = 1;
+    for (uint k = 0; k < 3; k++) {
+      _origin[k] = lo[k];
+      _cells[k] = k < _dim ? int(floor((hi[k] - lo[k])/_h)) + 1 : 1;
+      numCells *= _cells[k];
+    }
+
+    // Counting sort of the nodes by cell
+    vector<int > nodeCell(NumNodes);
+    _cellOffsets.assign(numCells + 1, 0);
+    for (int n = 0; n < NumNodes; n++) {
+      int c = 0;
+      for (int k = _dim - 1; k >= 0; k--)
+	c = c*_cells[k] + this->cellIndex(_X[n](k), k);
+      nodeCell[n] = c;
+      _cellOffsets[c + 1]++;
+    }
+    for (int c = 0; c < numCells; c++)
+      _cellOffsets[c + 1] += _cellOffsets[c];
+    _cellNodes.resize(NumNodes);
+    vector<int > fill(_cellOffsets.begin(), _cellOffsets.end() - 1);
+    for (int n = 0; n < NumNodes; n++)
+      _cellNodes[fill[nodeCell[n]]++] = n;
+  }
+
+
+
+  int NodeGrid::cellIndex(Real Coordinate, int k) const
+  {
+    const Real x = floor((Coordinate - _origin[k])/_h);
+    if (x < 0.0) return 0;
+    if (x >= Real(_cells[k])) return _cells[k] - 1;
+    return int(x);
+  }
+
+
+
+  void NodeGrid::collect(const VectorXd & Point, const int Lo[3], const int Hi[3],
+			 const int Center[3], int Ring,
+			 vector<pair<Real, int > > & Candidates) const
+  {
+    for (int i2 = Lo[2]; i2 <= Hi[2]; i2++)
+      for (int i1 = Lo[1]; i1 <= Hi[1]; i1++)
+	for (int i0 = Lo[0]; i0 <= Hi[0]; i0++) {
+	  if (abs(i0 - Center[0]) < Ring && abs(i1 - Center[1]) < Ring &&
+	      abs(i2 - Center[2]) < Ring)
+	    continue;
+	  const int c = (i2*_cells[1] + i1)*_cells[0] + i0;
+	  for (int i = _cellOffsets[c]; i < _cellOffsets[c + 1]; i++) {
+	    const int n = _cellNodes[i];
+	    Candidates.push_back(make_pair((_X[n] - Point).squaredNorm(), n));
+	  }
+	}
+  }
+
+
+
+  void NodeGrid::findNodesInRadius(const VectorXd & Point, Real Radius,
+				   vector<int > & Nodes) const
+  {
+    Nodes.clear();
+    int lo[3] = {0, 0, 0}, hi[3] = {0, 0, 0};
+    for (uint k = 0; k < _dim; k++) {
+      // Ball entirely outside the grid
+      if (Point(k) + Radius < _origin[k] ||
+	  Point(k) - Radius > _origin[k] + _cells[k]*_h)
+	return;
+      lo[k] = this->cellIndex(Point(k) - Radius, k);
+      hi[k] = this->cellIndex(Point(k) + Radius, k);
+    }
+    const Real R2 = Radius*Radius;
+    for (int i2 = lo[2]; i2 <= hi[2]; i2++)
+      for (int i1 = lo[1]; i1 <= hi[1]; i1++) {
+	const int row = (i2*_cells[1] + i1)*_cells[0];
+	for (int i = _cellOffsets[row + lo[0]]; i < _cellOffsets[row + hi[0] + 1]; i++) {
+	  const int n = _cellNodes[i];
+	  if ((_X[n] - Point).squaredNorm() <= R2)
+	    Nodes.push_back(n);
+	}
+      }
+    sort(Nodes.begin(), Nodes.end());
+  }
+
+
+
+  void NodeGrid::findNearestNodes(const VectorXd & Point, int K,
+				  vector<int > & Nodes) const
+  {
+    Nodes.clear();
+    K = min(K, int(_X.size()));
+    if (K <= 0) return;
+
+    int center[3] = {0, 0, 0}, maxRing = 0;
+    for (uint k = 0; k < _dim; k++) {
+      center[k] = this->cellIndex(Point(k), k);
+      maxRing = max(maxRing, max(center[k], _cells[k] - 1 - center[k]));
+    }
+
+    // Visit rings of cells around the cell of Point. After ring r every
+    // node closer than r*_h has been seen.
+    vector<pair<Real, int > > candidates;
+    for (int r = 0; ; r++) {
+      int lo[3] = {0, 0, 0}, hi[3] = {0, 0, 0};
+      for (uint k = 0; k < _dim; k++) {
+	lo[k] = max(center[k] - r, 0);
+	hi[k] = min(center[k] + r, _cells[k] - 1);
+      }
+      this->collect(Point, lo, hi, center, r, candidates);
+      if (int(candidates.size()) >= K) {
+	nth_element(candidates.begin(), candidates.begin() + K - 1, candidates.end());
+	candidates.resize(K);
+	const Real reach = r*_h;
+	if (r >= maxRing || candidates[K - 1].first <= reach*reach)
+	  break;
+      }
+      if (r >= maxRing) break;
+    }
+    sort(candidates.begin(), candidates.end());
+    for (int i = 0; i < K; i++)
+      Nodes.push_back(candidates[i].second);
+  }
+
+
+
+  void NodeGrid::findNodesInRadius(const vector<VectorXd > & Points, Real Radius,
+				   vector<vector<int > > & Nodes) const
+  {
+    const int NumPoints = Points.size();
+    Nodes.resize(NumPoints);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+    for (int p = 0; p < NumPoints; p++)
+      this->findNodesInRadius(Points[p], Radius, Nodes[p]);
+  }
+
+  void NodeGrid::findNearestNodes(const vector<VectorXd > & Points, int K,
+				  vector<vector<int > > & Nodes) const
+  {
+    const int NumPoints = Points.size();
+    Nodes.resize(NumPoints);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+    for (int p = 0; p < NumPoints; p++)
+      this->findNearestNodes(Points[p], K, Nodes[p]);
+  }
+
+} // namespace voom
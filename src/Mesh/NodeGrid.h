@@ -0,0 +1,79 @@
+// -*- C++ -*-
+/*!
+  \file NodeGrid.h
+  \brief Uniform grid over nodal positions for radius and k-nearest
+  neighbor queries, e.g. to build the meshfree connectivity of LME and
+  MRKPM material points: the nodes of a material point are those within
+  LMEShape::getSupportRadius(beta, TolZero) for LME, within
+  max(support, supportHat) for MRKPM.
+
+  Nodes are binned in cells of side CellSize (a counting sort, O(N)), so
+  a query only visits the cells overlapping the search ball. The
+  positions are kept by reference: after the nodes move call update(),
+  which bins them again without reallocating.
+*/
+
+#if !defined(__NodeGrid_h__)
+#define __NodeGrid_h__
+
+#include "voom.h"
+
+namespace voom
+{
+  class NodeGrid
+  {
+  public:
+    //! Grid over positions X (1, 2 or 3 components each), which must
+    //! outlive it. CellSize is best close to the query radius.
+    NodeGrid(const vector<VectorXd > & X, Real CellSize);
+
+    //! Bin the nodes again, after their positions changed
+    void update();
+
+    //! Nodes within distance Radius of Point (included), in increasing order
+    void findNodesInRadius(const VectorXd & Point, Real Radius,
+			   vector<int > & Nodes) const;
+
+    //! K nearest nodes to Point (fewer if there are less than K nodes),
+    //! by increasing distance, ties by node id
+    void findNearestNodes(const VectorXd & Point, int K,
+			  vector<int > & Nodes) const;
+
+    //! Neighbor lists of many points, computed in parallel
+    void findNodesInRadius(const vector<VectorXd > & Points, Real Radius,
+			   vector<vector<int > > & Nodes) const;
+    void findNearestNodes(const vector<VectorXd > & Points, int K,
+			  vector<vector<int > > & Nodes) const;
+
+    //! Cell size actually used (larger than requested if the requested
+    //! one would make too many cells)
+    Real getCellSize() const { return _h; }
+    int getNumberOfCells() const { return _cellOffsets.size() - 1; }
+
+  private:
+    //! Cell index of Coordinate along direction k, clamped to the grid
+    int cellIndex(Real Coordinate, int k) const;
+
+    //! Add the nodes of cells with indices in [Lo, Hi] to Candidates
+    //! (squared distance, id), skipping the cells closer than Ring cells
+    //! to cell Center (already visited)
+    void collect(const VectorXd & Point, const int Lo[3], const int Hi[3],
+		 const int Center[3], int Ring,
+		 vector<pair<Real, int > > & Candidates) const;
+
+    const vector<VectorXd > & _X;
+    uint          _dim;
+    Real          _requestedh, _h;
+    Real          _origin[3];
+    int           _cells[3];
+
+    //! Nodes of cell c are _cellNodes[i], _cellOffsets[c] <= i < _cellOffsets[c+1]
+    vector<int >  _cellOffsets, _cellNodes;
+
+    NodeGrid(const NodeGrid &);
+    NodeGrid & operator=(const NodeGrid &);
+  };
+
+} // namespace voom
+
+#endif // __NodeGrid_h__
@@ -0,0 +1,130 @@
+#include "FEMesh.h"
+#include "InpFile.h"
+
+using namespace voom;
+
+// Same connectivity in both meshes, and the nodes of A in B
+bool sameMesh(FEMesh & A, FEMesh & B)
+{
+  if (A.getNumberOfNodes() > B.getNumberOfNodes() ||
+      A.getNumberOfElements() != B.getNumberOfElements())
+    return false;
+  for (int i = 0; i < A.getNumberOfNodes(); i++)
+    if (A.getX(i) != B.getX(i)) return false;
+  const vector<GeomElement* > & elA = A.getElements();
+  const vector<GeomElement* > & elB = B.getElements();
+  for (int e = 0; e < A.getNumberOfElements(); e++)
+    if (elA[e]->getNodesID() != elB[e]->getNodesID()) return false;
+  return true;
+}
+
+// Abaqus number of node i: from 1001 down, not in order
+int nodeId(int i) { return 1001 - 3*i; }
+
+int main()
+{
+  cout << endl << "Testing Abaqus input file ... " << endl;
+
+  FEMesh volume("Cube.node", "Cube.ele");
+  FEMesh surface("Cube.node", "SurfCube.ele");
+  const int NumNodes = volume.getNumberOfNodes(), NumEl = volume.getNumberOfElements();
+  // Unused nodes and copies of the elements, enough for the *NODE and
+  // *ELEMENT data to be parsed in several pieces
+  const int NumExtra = 10000, NumCopies = 400;
+
+  // Write Cube.inp: the volume elements in two cards, the second one with
+  // records continued on the next line, the surface as S3, node sets
+  {
+    ofstream out("Cube.inp");
+    out << "** Cube\n*Heading\nCube\n*NODE, NSET=All\n";
+    out << setprecision(17);
+    for (int i = 0; i < NumNodes; i++) {
+      out << setw(10) << nodeId(i);
+      for (uint j = 0; j < 3; j++) out << ", " << volume.getX(i, j);
+      out << "\r\n";
+    }
+    out << "**HWCOLOR COMP 1 11\n*Element, type=C3D4, ELSET=Cube\n";
+    const vector<GeomElement* > & elements = volume.getElements();
+    for (int e = 0; e < NumEl; e++) {
+      const vector<int > & NodesID = elements[e]->getNodesID();
+      out << e + 1;
+      for (uint n = 0; n < 4; n++) {
+	out << ", " << nodeId(NodesID[n]);
+	if (e >= NumEl/2 && n == 1) out << ",\n";
+      }
+      out << "\n";
+      if (e == NumEl/2 - 1) out << "**\n*ELEMENT,TYPE=C3D4,ELSET=Cube\n";
+    }
+    out << "*ELEMENT, TYPE=S3, ELSET=Surface\n";
+    const vector<GeomElement* > & faces = surface.getElements();
+    for (uint f = 0; f < faces.size(); f++) {
+      const vector<int > & NodesID = faces[f]->getNodesID();
+      out << 1000 + f << ", " << nodeId(NodesID[0]) << ", " << nodeId(NodesID[1])
+	  << ", " << nodeId(NodesID[2]) << "\n";
+    }
+    out << "*NODE\n";
+    for (int i = 0; i < NumExtra; i++)
+      out << 2000 + i << ",  " << Real(i) << ",  " << -Real(i) << "\n";
+    out << "*ELEMENT, TYPE=C3D4, ELSET=Copies\n";
+    for (int c = 0; c < NumCopies; c++)
+      for (int e = 0; e < NumEl; e++) {
+	const vector<int > & NodesID = elements[e]->getNodesID();
+	out << 5000 + c*NumEl + e << ", " << nodeId(NodesID[0]) << ", " << nodeId(NodesID[1])
+	    << ", " << nodeId(NodesID[2]) << ", " << nodeId(NodesID[3]) << "\n";
+      }
+    out << "*NSET, NSET=Base\n";
+    for (int i = 0; i < NumNodes; i++)
+      if (volume.getX(i, 2) == 0.0) out << nodeId(i) << ",\n";
+    out << "*NSET, NSET=Extra, GENERATE\n2000, 2998, 2\n";
+    out << "*NSET, NSET=Both\nBase, Extra\n";
+    out << "*MATERIAL, NAME=Steel\n*ELASTIC\n200.e3, 0.3\n*STEP\n*STATIC\n*END STEP\n";
+  }
+
+  InpFile file("Cube.inp");
+
+  bool pass = file.getDimension() == 3 && file.getNumberOfNodes() == NumNodes + NumExtra &&
+    file.getNumberOfElementSets() == 3 && file.getNumberOfNodeSets() == 4;
+  for (int i = 0; pass && i < NumNodes + NumExtra; i++)
+    pass = file.findNode(file.getNodeId(i)) == i;
+  pass = pass && file.findNode(nodeId(5)) == 5 && file.findNode(1002) == -1 &&
+    file.getNodes()[3*(NumNodes + 7)] == 7.0 && file.getNodes()[3*(NumNodes + 7) + 2] == 0.0;
+  cout << "Nodes - " << (pass ? "PASSED" : "FAILED") << endl;
+
+  FEMesh volumeInp(file);
+  cout << "Volume mesh from input file - "
+       << (sameMesh(volume, volumeInp) ? "PASSED" : "FAILED") << endl;
+
+  FEMesh surfaceInp(volumeInp, file, "Surface");
+  pass = surfaceInp.getElementType() == "TD3" &&
+    surfaceInp.getNumberOfElements() == surface.getNumberOfElements();
+  for (int f = 0; pass && f < surface.getNumberOfElements(); f++)
+    pass = surfaceInp.getElements()[f]->getNodesID() == surface.getElements()[f]->getNodesID();
+  cout << "Surface mesh from input file - " << (pass ? "PASSED" : "FAILED") << endl;
+
+  const int copies = file.findElementSet("Copies", "C3D4");
+  pass = copies >= 0 && file.getNumberOfElements(copies) == NumCopies*NumEl;
+  for (int c = 0; pass && c < NumCopies; c++)
+    for (int e = 0; pass && e < NumEl; e++) {
+      const int * conn = file.getConnectivity(copies) + (c*NumEl + e)*4;
+      pass = file.getElementIds(copies)[c*NumEl + e] == 5000 + c*NumEl + e &&
+	vector<int >(conn, conn + 4) == volume.getElements()[e]->getNodesID();
+    }
+  cout << "Element set read in pieces - " << (pass ? "PASSED" : "FAILED") << endl;
+
+  const int all = file.findNodeSet("All"), base = file.findNodeSet("Base");
+  const int extra = file.findNodeSet("Extra"), both = file.findNodeSet("Both");
+  pass = all >= 0 && file.getNodeSetSize(all) == NumNodes &&
+    base >= 0 && file.getNodeSetSize(base) == 9 &&
+    extra >= 0 && file.getNodeSetSize(extra) == 500 &&
+    file.getNodeSet(extra)[1] == NumNodes + 2 &&
+    both >= 0 && file.getNodeSetSize(both) == 509;
+  for (int i = 0; pass && i < file.getNodeSetSize(base); i++)
+    pass = volume.getX(file.getNodeSet(base)[i], 2) == 0.0;
+  cout << "Node sets - " << (pass ? "PASSED" : "FAILED") << endl;
+
+  pass = file.findElementSet("Cube", "S3") < 0 && file.findElementSet("Base") < 0 &&
+    file.findNodeSet("Cube") < 0;
+  cout << "Missing sets - " << (pass ? "PASSED" : "FAILED") << endl;
+
+  return 0;
+}
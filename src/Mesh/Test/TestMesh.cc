@@ -176,6 +176,188 @@ int main(int argc, char** argv)
   }
 
 
+  // Test FEmesh built on the nodes of another mesh
+  {
+    cout << endl << "Test FEmesh constructor sharing the nodes of a parent mesh " << endl;
+
+    FEMesh Volume("CubeQuad.node", "CubeQuad.ele");
+    FEMesh SurfCopy("CubeQuad.node", "SurfCubeQuad.ele");
+    FEMesh Surf(Volume, "SurfCubeQuad.ele");
+
+    bool pass = Surf.sharesNodes() && !Volume.sharesNodes() &&
+      Surf.getNumberOfNodes() == Volume.getNumberOfNodes() &&
+      Surf.getNumberOfElements() == SurfCopy.getNumberOfElements();
+    for(int i = 0; pass && i < Volume.getNumberOfNodes(); i++)
+      pass = &Surf.getX(i) == &Volume.getX(i);
+    const vector<GeomElement* > & Els = Surf.getElements();
+    const vector<GeomElement* > & ElsCopy = SurfCopy.getElements();
+    for(int e = 0; pass && e < Surf.getNumberOfElements(); e++) {
+      pass = Els[e]->getNodesID() == ElsCopy[e]->getNodesID();
+      for(uint q = 0; pass && q < Els[e]->getNumberOfQuadPoints(); q++)
+	pass = Els[e]->getQPweights(q) == ElsCopy[e]->getQPweights(q);
+    }
+    cout << "Shared nodes - " << (pass ? "PASSED" : "FAILED") << endl;
+
+    // Same through connectivities
+    vector<vector<int > > Conn;
+    for(int e = 0; e < Surf.getNumberOfElements(); e++)
+      Conn.push_back(Els[e]->getNodesID());
+    FEMesh SurfConn(Volume, Conn, "TD6");
+    pass = SurfConn.sharesNodes() && &SurfConn.getX(0) == &Volume.getX(0) &&
+      SurfConn.getNumberOfElements() == Surf.getNumberOfElements();
+    cout << "Shared nodes from connectivities - " << (pass ? "PASSED" : "FAILED") << endl;
+  }
+
+
+  // Test boundary extraction
+  {
+    cout << endl << "Test boundary extraction " << endl;
+
+    const char* Nodes[3]   = {"Cube.node", "CubeQuad.node", "CoarseLV.node"};
+    const char* Volumes[3] = {"Cube.ele", "CubeQuad.ele", "CoarseLV.ele"};
+    const char* Surfs[3]   = {"SurfCube.ele", "SurfCubeQuad.ele", "CoarseLV.surf"};
+    for (int m = 0; m < 3; m++) {
+      FEMesh Volume(Nodes[m], Volumes[m]);
+      vector<vector<int > > Faces;
+      vector<int > Labels;
+      string FaceType;
+      int NumComp = Volume.findBoundaryFaces(Faces, FaceType, Labels);
+
+      // Enclosed volume from the outward faces (divergence theorem)
+      Real enclosed = 0.0, volume = 0.0;
+      for (uint f = 0; f < Faces.size(); f++) {
+	Vector3d x0 = Volume.getX(Faces[f][0]), x1 = Volume.getX(Faces[f][1]), x2 = Volume.getX(Faces[f][2]);
+	enclosed += x0.dot((x1 - x0).cross(x2 - x0))/6.0;
+      }
+      const vector<GeomElement* > & Els = Volume.getElements();
+      for (uint e = 0; e < Els.size(); e++)
+	for (uint q = 0; q < Els[e]->getNumberOfQuadPoints(); q++)
+	  volume += Els[e]->getQPweights(q);
+
+      // Every face of the hand made surface is found with the same orientation
+      FEMesh Surf(Volume, Surfs[m]);
+      const vector<GeomElement* > & SurfEls = Surf.getElements();
+      int found = 0;
+      for (uint s = 0; s < SurfEls.size(); s++) {
+	const vector<int > & S = SurfEls[s]->getNodesID();
+	for (uint f = 0; f < Faces.size(); f++) {
+	  bool same = false;
+	  for (int r = 0; r < 3 && !same; r++) {
+	    same = true;
+	    for (uint c = 0; c < 3; c++) {
+	      same = same && Faces[f][(c + r)%3] == S[c];
+	      if (S.size() == 6) same = same && Faces[f][3 + (c + r)%3] == S[3 + c];
+	    }
+	  }
+	  if (same) { found++; break; }
+	}
+      }
+
+      bool pass = FaceType == (m == 0 ? "TD3" : "TD6") && NumComp == 1 &&
+	found == int(SurfEls.size()) && fabs(enclosed - volume) < 1.0e-3*volume;
+      if (m == 0)
+	pass = pass && Faces.size() == 48 && Volume.findBoundaryFaces(Faces, FaceType, Labels, 45.0) == 6;
+      cout << Volumes[m] << ": " << Faces.size() << " boundary faces, " << NumComp
+	   << " component(s) - " << (pass ? "PASSED" : "FAILED") << endl;
+    }
+
+    // Two hexahedra side by side
+    vector<VectorXd > X;
+    for (int k = 0; k < 2; k++)
+      for (int j = 0; j < 2; j++)
+	for (int i = 0; i < 3; i++) {
+	  VectorXd x(3); x << Real(i), Real(j), Real(k);
+	  X.push_back(x);
+	}
+    vector<vector<int > > Conn(2);
+    for (int i = 0; i < 2; i++) {
+      // HexShape ordering: 0-3 at z = +1 and y = -1 ... see HexShape.cc
+      int c[8] = {6+i, 7+i, 1+i, 0+i, 9+i, 10+i, 4+i, 3+i};
+      Conn[i].assign(c, c + 8);
+    }
+    FEMesh Hex(X, Conn, "C3D8");
+    FEMesh *Boundary = Hex.createBoundaryMesh();
+    vector<vector<int > > Faces;
+    vector<int > Labels;
+    string FaceType;
+    int NumComp = Hex.findBoundaryFaces(Faces, FaceType, Labels, 45.0);
+    Real enclosed = 0.0;
+    for (uint f = 0; f < Faces.size(); f++) {
+      Vector3d x0 = Hex.getX(Faces[f][0]), x1 = Hex.getX(Faces[f][1]);
+      Vector3d x2 = Hex.getX(Faces[f][2]), x3 = Hex.getX(Faces[f][3]);
+      enclosed += 0.25*(x0 + x1 + x2 + x3).dot(0.5*(x2 - x0).cross(x3 - x1))/3.0;
+    }
+    bool pass = FaceType == "Q4" && Faces.size() == 10 && NumComp == 6 &&
+      Boundary->getNumberOfElements() == 10 && Boundary->sharesNodes() &&
+      fabs(enclosed - 2.0) < 1.0e-12;
+    cout << "C3D8: " << Faces.size() << " boundary faces, " << NumComp
+	 << " planar components - " << (pass ? "PASSED" : "FAILED") << endl;
+    delete Boundary;
+
+    // Node to element and element to element adjacency
+    FEMesh Volume("CubeQuad.node", "CubeQuad.ele");
+    const vector<int > & Offsets = Volume.getNodeElementOffsets();
+    const vector<int > & Elements = Volume.getNodeElements();
+    pass = int(Offsets.size()) == Volume.getNumberOfNodes() + 1 &&
+      &Offsets == &Volume.getNodeElementOffsets();
+    const vector<GeomElement* > & Els = Volume.getElements();
+    for (int n = 0; pass && n < Volume.getNumberOfNodes(); n++) {
+      int count = 0;
+      for (uint e = 0; e < Els.size(); e++) {
+	const vector<int > & NodesID = Els[e]->getNodesID();
+	if (find(NodesID.begin(), NodesID.end(), n) != NodesID.end()) {
+	  pass = pass && Offsets[n] + count < Offsets[n + 1] && Elements[Offsets[n] + count] == int(e);
+	  count++;
+	}
+      }
+      pass = pass && Offsets[n] + count == Offsets[n + 1];
+    }
+    const vector<int > & NeighborOffsets = Volume.getElementNeighborOffsets();
+    const vector<int > & Neighbors = Volume.getElementNeighbors();
+    for (uint e = 0; pass && e < Els.size(); e++) {
+      vector<int > expected;
+      for (uint f = 0; f < Els.size(); f++) {
+	const vector<int > & A = Els[e]->getNodesID(), & B = Els[f]->getNodesID();
+	bool shared = false;
+	for (uint a = 0; a < A.size() && !shared; a++)
+	  shared = find(B.begin(), B.end(), A[a]) != B.end();
+	if (shared && f != e) expected.push_back(f);
+      }
+      pass = vector<int >(Neighbors.begin() + NeighborOffsets[e],
+			  Neighbors.begin() + NeighborOffsets[e + 1]) == expected;
+    }
+    cout << "Node to element and element neighbors adjacency - " << (pass ? "PASSED" : "FAILED") << endl;
+  }
+
+
+  // Test element coloring
+  {
+    cout << endl << "Test element coloring " << endl;
+
+    FEMesh LV("CoarseLV.node", "CoarseLV.ele");
+    const vector<int > & Offsets = LV.getColorOffsets();
+    const vector<int > & Colored = LV.getColorElements();
+    const vector<int > & Colors = LV.getElementColors();
+    const vector<GeomElement* > & Els = LV.getElements();
+    LV.printColoring();
+
+    // Every element once, in its color, and no node twice in a color
+    bool pass = int(Colored.size()) == LV.getNumberOfElements();
+    vector<int > seen(LV.getNumberOfElements(), 0), lastColor(LV.getNumberOfNodes(), -1);
+    for (int c = 0; pass && c < LV.getNumberOfColors(); c++)
+      for (int i = Offsets[c]; pass && i < Offsets[c + 1]; i++) {
+	const int e = Colored[i];
+	pass = Colors[e] == c && seen[e]++ == 0;
+	const vector<int > & NodesID = Els[e]->getNodesID();
+	for (uint a = 0; pass && a < NodesID.size(); a++) {
+	  pass = lastColor[NodesID[a]] != c;
+	  lastColor[NodesID[a]] = c;
+	}
+      }
+    cout << "Coloring - " << (pass ? "PASSED" : "FAILED") << endl;
+  }
+
+
   LoopShellMesh icosa("T7nodes.dat","T7connectivity.dat");
   
   // cout << endl << "........................ " << endl;
@@ -0,0 +1,100 @@
+#include "FEMesh.h"
+#include "MeshFile.h"
+
+using namespace voom;
+
+// Read a text .ele file into a flat connectivity
+void readConnectivity(const string FileName, int NodesPerEl, string & Type,
+		      vector<int > & Conn)
+{
+  ifstream inp(FileName.c_str());
+  uint NumEl = 0;
+  inp >> NumEl >> Type;
+  Conn.resize(NumEl*NodesPerEl);
+  for (uint i = 0; i < Conn.size(); i++)
+    inp >> Conn[i];
+}
+
+// Same nodes and connectivity in both meshes
+bool sameMesh(FEMesh & A, FEMesh & B)
+{
+  if (A.getNumberOfNodes() != B.getNumberOfNodes() ||
+      A.getNumberOfElements() != B.getNumberOfElements())
+    return false;
+  for (int i = 0; i < A.getNumberOfNodes(); i++)
+    if (A.getX(i) != B.getX(i)) return false;
+  const vector<GeomElement* > & elA = A.getElements();
+  const vector<GeomElement* > & elB = B.getElements();
+  for (int e = 0; e < A.getNumberOfElements(); e++) {
+    if (elA[e]->getNodesID() != elB[e]->getNodesID()) return false;
+    for (uint q = 0; q < elA[e]->getNumberOfQuadPoints(); q++)
+      if (elA[e]->getQPweights(q) != elB[e]->getQPweights(q)) return false;
+  }
+  return true;
+}
+
+int main()
+{
+  cout << endl << "Testing binary mesh file ... " << endl;
+
+  // Write Cube.node, Cube.ele, SurfCube.ele, a node set and a field
+  FEMesh volume("Cube.node", "Cube.ele");
+  FEMesh surface("Cube.node", "SurfCube.ele");
+  {
+    vector<Real > nodes;
+    for (int i = 0; i < volume.getNumberOfNodes(); i++)
+      for (uint j = 0; j < volume.getDimension(); j++)
+	nodes.push_back(volume.getX(i, j));
+    MeshFile::Writer writer(nodes, volume.getDimension());
+
+    string type;
+    vector<int > conn;
+    readConnectivity("Cube.ele", 4, type, conn);
+    writer.addElementSet("Elements", type, 4, conn);
+    readConnectivity("SurfCube.ele", 3, type, conn);
+    writer.addElementSet("Surface", type, 3, conn);
+
+    vector<int > base;
+    for (int i = 0; i < volume.getNumberOfNodes(); i++)
+      if (volume.getX(i, 2) == 0.0) base.push_back(i);
+    writer.addNodeSet("Base", base);
+
+    vector<Real > fibers;
+    for (int e = 0; e < volume.getNumberOfElements(); e++)
+      for (int c = 0; c < 9; c++)
+	fibers.push_back(Real(e) + 0.1*c);
+    writer.addField("Fibers", 9, fibers);
+
+    writer.write("Cube.vmesh");
+  }
+
+  // Read back
+  MeshFile file("Cube.vmesh");
+
+  FEMesh volumeBin(file);
+  FEMesh surfaceBin(file, "Surface");
+  cout << "Volume mesh from binary file - "
+       << (sameMesh(volume, volumeBin) ? "PASSED" : "FAILED") << endl;
+  cout << "Surface mesh from binary file - "
+       << (sameMesh(surface, surfaceBin) ? "PASSED" : "FAILED") << endl;
+
+  int base = file.findNodeSet("Base");
+  bool pass = base >= 0 && file.getNodeSetSize(base) == 9;
+  for (int i = 0; pass && i < file.getNodeSetSize(base); i++)
+    pass = volume.getX(file.getNodeSet(base)[i], 2) == 0.0;
+  cout << "Node set - " << (pass ? "PASSED" : "FAILED") << endl;
+
+  int fib = file.findField("Fibers");
+  pass = fib >= 0 && file.getFieldSize(fib) == volume.getNumberOfElements() &&
+    file.getFieldComponents(fib) == 9;
+  for (int e = 0; pass && e < file.getFieldSize(fib); e++)
+    for (int c = 0; c < 9; c++)
+      pass = pass && file.getField(fib)[e*9 + c] == Real(e) + 0.1*c;
+  cout << "Field - " << (pass ? "PASSED" : "FAILED") << endl;
+
+  pass = file.findElementSet("Base") < 0 && file.findNodeSet("Surface") < 0 &&
+    file.findField("Missing") < 0;
+  cout << "Missing sets - " << (pass ? "PASSED" : "FAILED") << endl;
+
+  return 0;
+}
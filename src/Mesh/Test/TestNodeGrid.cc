@@ -0,0 +1,143 @@
+#include "FEMesh.h"
+#include "NodeGrid.h"
+#include "LMEShape.h"
+#include <sys/time.h>
+
+using namespace voom;
+
+Real getRand() { return Real(rand())/RAND_MAX; }
+
+// Brute force neighbors, same order as NodeGrid
+void bruteRadius(const vector<VectorXd > & X, const VectorXd & P, Real R,
+		 vector<int > & Nodes)
+{
+  Nodes.clear();
+  for (uint n = 0; n < X.size(); n++)
+    if ((X[n] - P).squaredNorm() <= R*R) Nodes.push_back(n);
+}
+
+void bruteNearest(const vector<VectorXd > & X, const VectorXd & P, int K,
+		  vector<int > & Nodes)
+{
+  vector<pair<Real, int > > d(X.size());
+  for (uint n = 0; n < X.size(); n++)
+    d[n] = make_pair((X[n] - P).squaredNorm(), int(n));
+  sort(d.begin(), d.end());
+  Nodes.clear();
+  for (int i = 0; i < K && i < int(d.size()); i++)
+    Nodes.push_back(d[i].second);
+}
+
+// Compare grid and brute force queries at random points around the nodes
+bool checkQueries(const vector<VectorXd > & X, NodeGrid & grid, Real R, int K)
+{
+  const uint dim = X[0].size();
+  bool pass = true;
+  vector<int > a, b;
+  for (int p = 0; p < 200 && pass; p++) {
+    VectorXd P(dim);
+    for (uint k = 0; k < dim; k++)
+      P(k) = 1.4*getRand() - 0.2;   // also outside the cloud
+    grid.findNodesInRadius(P, R, a);
+    bruteRadius(X, P, R, b);
+    pass = a == b;
+    grid.findNearestNodes(P, K, a);
+    bruteNearest(X, P, K, b);
+    pass = pass && a == b;
+  }
+  return pass;
+}
+
+int main()
+{
+  cout << endl << "Testing node grid ... " << endl;
+  srand(0);
+
+  {
+    // Random cloud in the unit cube
+    vector<VectorXd > X(3000, Vector3d::Zero());
+    for (uint n = 0; n < X.size(); n++)
+      X[n] << getRand(), getRand(), getRand();
+    NodeGrid grid(X, 0.1);
+    cout << "3D radius and nearest queries - "
+	 << (checkQueries(X, grid, 0.12, 15) ? "PASSED" : "FAILED") << endl;
+
+    // Move the nodes and bin them again
+    for (uint n = 0; n < X.size(); n++)
+      X[n] = 0.5*X[n] + Vector3d(0.3, 0.1*X[n](0), 0.2);
+    grid.update();
+    cout << "3D queries after update - "
+	 << (checkQueries(X, grid, 0.05, 8) ? "PASSED" : "FAILED") << endl;
+
+    // Cell size far too small: the number of cells is bounded
+    NodeGrid fine(X, 1.0e-6);
+    cout << "Bounded number of cells - "
+	 << (fine.getNumberOfCells() <= 4*3000 + 64 && checkQueries(X, fine, 0.05, 4) ?
+	     "PASSED" : "FAILED") << endl;
+
+    // Neighbor lists of several material points at once
+    vector<VectorXd > points(50, Vector3d::Zero());
+    for (uint p = 0; p < points.size(); p++)
+      points[p] << getRand(), getRand(), getRand();
+    vector<vector<int > > lists;
+    grid.findNodesInRadius(points, 0.08, lists);
+    bool pass = lists.size() == points.size();
+    vector<int > b;
+    for (uint p = 0; p < points.size() && pass; p++) {
+      bruteRadius(X, points[p], 0.08, b);
+      pass = lists[p] == b;
+    }
+    grid.findNearestNodes(points, 6, lists);
+    for (uint p = 0; p < points.size() && pass; p++) {
+      bruteNearest(X, points[p], 6, b);
+      pass = lists[p] == b;
+    }
+    cout << "Lists of neighbors - " << (pass ? "PASSED" : "FAILED") << endl;
+  }
+
+  {
+    // Planar cloud
+    vector<VectorXd > X(1000, Vector2d::Zero());
+    for (uint n = 0; n < X.size(); n++)
+      X[n] << getRand(), getRand();
+    NodeGrid grid(X, 0.05);
+    cout << "2D radius and nearest queries - "
+	 << (checkQueries(X, grid, 0.07, 10) ? "PASSED" : "FAILED") << endl;
+  }
+
+  {
+    // LME neighborhoods of the CoarseLV nodes, grid against brute force
+    FEMesh mesh("CoarseLV.node", "CoarseLV.ele");
+    const vector<VectorXd > & X = mesh.getPositions();
+    // Mean edge length
+    Real h = 0.0;
+    const vector<GeomElement* > & elements = mesh.getElements();
+    for (int e = 0; e < mesh.getNumberOfElements(); e++) {
+      const vector<int > & ids = elements[e]->getNodesID();
+      h += (X[ids[0]] - X[ids[1]]).norm();
+    }
+    h /= mesh.getNumberOfElements();
+    const Real beta = 4.0/(h*h);
+    const Real radius = LMEShape::getSupportRadius(beta, 1.0e-6);
+
+    timeval t0, t1, t2;
+    gettimeofday(&t0, NULL);
+    NodeGrid grid(X, radius);
+    vector<vector<int > > lists;
+    grid.findNodesInRadius(X, radius, lists);
+    gettimeofday(&t1, NULL);
+    bool pass = true;
+    vector<int > b;
+    for (uint n = 0; n < X.size(); n += 97) {
+      bruteRadius(X, X[n], radius, b);
+      pass = pass && lists[n] == b;
+    }
+    gettimeofday(&t2, NULL);
+    cout << "LME neighbors of " << X.size() << " nodes in "
+	 << (t1.tv_sec - t0.tv_sec)*1.0e3 + (t1.tv_usec - t0.tv_usec)*1.0e-3 << " ms ("
+	 << ((t2.tv_sec - t1.tv_sec)*1.0e3 + (t2.tv_usec - t1.tv_usec)*1.0e-3)*97
+	 << " ms by brute force) - " << (pass ? "PASSED" : "FAILED") << endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,173 @@
+#include "AsyncVTKWriter.h"
+#include "XDMFTimeSeries.h"
+
+#include <vtkSmartPointer.h>
+#include <vtkPoints.h>
+#include <vtkPointData.h>
+#include <vtkCellData.h>
+#include <vtkDoubleArray.h>
+#include <vtkUnstructuredGrid.h>
+#include <vtkPolyData.h>
+#include <vtkXMLUnstructuredGridWriter.h>
+#include <vtkXMLPolyDataWriter.h>
+
+namespace voom
+{
+  VTKArray & VTKSnapshot::addArray(deque<VTKArray > & Arrays, const string & Name,
+				   int Components, int Tuples,
+				   const char * const * ComponentNames)
+  {
+    Arrays.push_back(VTKArray());
+    VTKArray & A = Arrays.back();
+    A.name = Name;
+    A.components = Components;
+    if (ComponentNames)
+      A.componentNames.assign(ComponentNames, ComponentNames + Components);
+    A.values.assign(Components*Tuples, 0.0);
+    return A;
+  }
+
+
+
+  namespace
+  {
+    vtkSmartPointer<vtkDoubleArray> toVTK(const VTKArray & A)
+    {
+      vtkSmartPointer<vtkDoubleArray> array = vtkSmartPointer<vtkDoubleArray>::New();
+      array->SetName(A.name.c_str());
+      array->SetNumberOfComponents(A.components);
+      for (uint i = 0; i < A.componentNames.size(); i++)
+	array->SetComponentName(i, A.componentNames[i].c_str());
+      array->SetNumberOfTuples(A.values.size()/A.components);
+      for (uint i = 0; i < A.values.size(); i++)
+	array->SetValue(i, A.values[i]);
+      return array;
+    }
+  }
+
+
+
+  void AsyncVTKWriter::write(const VTKSnapshot & S)
+  {
+    if (S.series) {
+      S.series->append(S);
+      return;
+    }
+
+    const int NumPoints = S.points.size()/3;
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    points->SetNumberOfPoints(NumPoints);
+    for (int i = 0; i < NumPoints; i++)
+      points->SetPoint(i, S.points[3*i], S.points[3*i + 1], S.points[3*i + 2]);
+
+    if (S.pointCloud) {
+      vtkSmartPointer<vtkPolyData> grid = vtkSmartPointer<vtkPolyData>::New();
+      grid->SetPoints(points);
+      for (uint i = 0; i < S.pointData.size(); i++)
+	grid->GetPointData()->AddArray(toVTK(S.pointData[i]));
+
+      vtkSmartPointer<vtkXMLPolyDataWriter> writer = vtkSmartPointer<vtkXMLPolyDataWriter>::New();
+      writer->SetFileName(S.fileName.c_str());
+      writer->SetInput(grid);
+      writer->Write();
+      return;
+    }
+
+    vtkSmartPointer<vtkUnstructuredGrid> grid = vtkSmartPointer<vtkUnstructuredGrid>::New();
+    grid->SetPoints(points);
+    const int NumCells = S.nodesPerCell > 0 ? S.connectivity.size()/S.nodesPerCell : 0;
+    grid->Allocate(NumCells);
+    vector<vtkIdType > ids(S.nodesPerCell);
+    for (int e = 0; e < NumCells; e++) {
+      for (int n = 0; n < S.nodesPerCell; n++)
+	ids[n] = S.connectivity[e*S.nodesPerCell + n];
+      grid->InsertNextCell(S.cellType, S.nodesPerCell, &ids[0]);
+    }
+    for (uint i = 0; i < S.pointData.size(); i++)
+      grid->GetPointData()->AddArray(toVTK(S.pointData[i]));
+    for (uint i = 0; i < S.cellData.size(); i++)
+      grid->GetCellData()->AddArray(toVTK(S.cellData[i]));
+
+    vtkSmartPointer<vtkXMLUnstructuredGridWriter> writer = vtkSmartPointer<vtkXMLUnstructuredGridWriter>::New();
+    writer->SetFileName(S.fileName.c_str());
+    writer->SetInput(grid);
+    writer->Write();
+  }
+
+
+
+  AsyncVTKWriter::AsyncVTKWriter(int MaxQueued):
+    _maxQueued(max(MaxQueued, 1)), _busy(false), _stop(false)
+  {
+    pthread_mutex_init(&_mutex, NULL);
+    pthread_cond_init(&_changed, NULL);
+    if (pthread_create(&_thread, NULL, AsyncVTKWriter::run, this) != 0) {
+      cout << "** AsyncVTKWriter: cannot start the writer thread" << endl;
+      exit(1);
+    }
+  }
+
+
+
+  AsyncVTKWriter::~AsyncVTKWriter()
+  {
+    pthread_mutex_lock(&_mutex);
+    _stop = true;
+    pthread_cond_broadcast(&_changed);
+    pthread_mutex_unlock(&_mutex);
+    pthread_join(_thread, NULL);
+    pthread_cond_destroy(&_changed);
+    pthread_mutex_destroy(&_mutex);
+  }
+
+
+
+  void AsyncVTKWriter::push(VTKSnapshot * Snapshot)
+  {
+    pthread_mutex_lock(&_mutex);
+    while (int(_queue.size()) >= _maxQueued)
+      pthread_cond_wait(&_changed, &_mutex);
+    _queue.push_back(Snapshot);
+    pthread_cond_broadcast(&_changed);
+    pthread_mutex_unlock(&_mutex);
+  }
+
+
+
+  void AsyncVTKWriter::flush()
+  {
+    pthread_mutex_lock(&_mutex);
+    while (!_queue.empty() || _busy)
+      pthread_cond_wait(&_changed, &_mutex);
+    pthread_mutex_unlock(&_mutex);
+  }
+
+
+
+  void * AsyncVTKWriter::run(void * Writer)
+  {
+    AsyncVTKWriter & W = *static_cast<AsyncVTKWriter * >(Writer);
+    pthread_mutex_lock(&W._mutex);
+    while (true) {
+      while (W._queue.empty() && !W._stop)
+	pthread_cond_wait(&W._changed, &W._mutex);
+      // Stop only once the queue is empty
+      if (W._queue.empty()) break;
+      VTKSnapshot * S = W._queue.front();
+      W._queue.pop_front();
+      W._busy = true;
+      pthread_cond_broadcast(&W._changed);
+      pthread_mutex_unlock(&W._mutex);
+
+      write(*S);
+      delete S;
+
+      pthread_mutex_lock(&W._mutex);
+      W._busy = false;
+      pthread_cond_broadcast(&W._changed);
+    }
+    pthread_mutex_unlock(&W._mutex);
+    return NULL;
+  }
+
+} // namespace voom
@@ -0,0 +1,115 @@
+//-*-C++-*-
+/*!
+  \file AsyncVTKWriter.h
+  \brief Output snapshots and a background writer for them. A model
+  copies what it wants to output (positions, connectivity, point and
+  cell arrays) into a VTKSnapshot, plain data detached from the model;
+  building the VTK data set and writing the XML file can then happen on
+  a writer thread while the solver moves on to the next step. At most
+  MaxQueued snapshots wait to be written, further pushes block, which
+  bounds the memory used by output.
+*/
+
+#ifndef __AsyncVTKWriter_h__
+#define __AsyncVTKWriter_h__
+
+#include "voom.h"
+#include <deque>
+#include <pthread.h>
+
+namespace voom
+{
+  class XDMFTimeSeries;
+
+  //! Named array of tuples with Components values each, stored tuple by tuple
+  struct VTKArray
+  {
+    string          name;
+    int             components;
+    vector<string > componentNames;
+    vector<Real >   values;
+
+    Real & operator()(int Tuple, int Component) { return values[Tuple*components + Component]; }
+  };
+
+  struct VTKSnapshot
+  {
+    //! Written as a point cloud (.vtp) if true, as an unstructured grid
+    //! (.vtu) of cells of type CellType otherwise
+    string fileName;
+    bool   pointCloud;
+    int    cellType;
+    int    nodesPerCell;
+
+    //! x, y, z of each point
+    vector<Real > points;
+    //! nodesPerCell point ids per cell
+    vector<int >  connectivity;
+
+    //! Arrays keep their address as more are added
+    deque<VTKArray > pointData, cellData;
+
+    //! If set, the snapshot is appended to this series as step, instead
+    //! of being written to fileName
+    XDMFTimeSeries * series;
+    int              step;
+
+    VTKSnapshot(): pointCloud(false), cellType(0), nodesPerCell(0), series(NULL), step(0) {};
+
+    //! New zero array, with components named ComponentNames[i] if given
+    VTKArray & addPointArray(const string & Name, int Components, int Tuples,
+			     const char * const * ComponentNames = NULL) {
+      return addArray(pointData, Name, Components, Tuples, ComponentNames);
+    }
+    VTKArray & addCellArray(const string & Name, int Components, int Tuples,
+			    const char * const * ComponentNames = NULL) {
+      return addArray(cellData, Name, Components, Tuples, ComponentNames);
+    }
+
+  private:
+    static VTKArray & addArray(deque<VTKArray > & Arrays, const string & Name,
+			       int Components, int Tuples, const char * const * ComponentNames);
+  };
+
+
+
+  class AsyncVTKWriter
+  {
+  public:
+    //! Start the writer thread
+    AsyncVTKWriter(int MaxQueued = 2);
+
+    //! Write the snapshots still queued, then stop the writer thread
+    ~AsyncVTKWriter();
+
+    //! Queue a snapshot, deleted once written. Blocks while MaxQueued
+    //! snapshots are waiting.
+    void push(VTKSnapshot * Snapshot);
+
+    //! Wait until all queued snapshots are written
+    void flush();
+
+    //! Build the VTK data set of a snapshot and write it, or append it to
+    //! its series, in the calling thread
+    static void write(const VTKSnapshot & Snapshot);
+
+  private:
+    static void * run(void * Writer);
+
+    int                    _maxQueued;
+    deque<VTKSnapshot * >  _queue;
+    //! A snapshot is being written
+    bool                   _busy;
+    bool                   _stop;
+
+    pthread_t              _thread;
+    pthread_mutex_t        _mutex;
+    pthread_cond_t         _changed;
+
+    AsyncVTKWriter(const AsyncVTKWriter &);
+    AsyncVTKWriter & operator=(const AsyncVTKWriter &);
+  };
+
+} // namespace voom
+
+#endif // __AsyncVTKWriter_h__
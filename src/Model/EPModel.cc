@@ -1,27 +1,366 @@
 #include "EPModel.h"
 
 namespace voom {
-  EPModel::EPModel(Mesh* myMesh, const string inputFile, const uint NodeDof)
-    : Model(myMesh, inputFile, NodeDof) {
+
+  EPModel::EPModel(Mesh* myMesh, vector<IonicMaterial * > IonicMaterials,
+		   const vector<Matrix3d > & Diffusion,
+		   const Real Xi, const Real Cm)
+    : Model(myMesh, 1), _diffusion(Diffusion),
+      _ionicMaterials(IonicMaterials), _ionicArray(NULL), _xi(Xi), _Cm(Cm)
+  {
+    if (int(_ionicMaterials.size()) != _myMesh->getNumberOfNodes()) {
+      cout << "** EPModel: number of ionic materials (" << _ionicMaterials.size()
+	   << ") different from number of nodes (" << _myMesh->getNumberOfNodes()
+	   << ")" << endl;
+      exit(1);
+    }
+    if (int(_diffusion.size()) != _myMesh->getNumberOfElements()) {
+      cout << "** EPModel: number of diffusion tensors different from number of elements"
+	   << endl;
+      exit(1);
+    }
+
+    _distinctMaterials = this->getNumMat() == _ionicMaterials.size();
+
+    // Initialize field
+    _field.resize( _myMesh->getNumberOfNodes() );
+    this->initializeField();
+
+    this->setPrevField();
+  }
+
+
+
+  EPModel::EPModel(Mesh* myMesh, vector<IonicMaterial * > IonicMaterials,
+		   const string inputFile,
+		   const Real Xi, const Real Cm)
+    : Model(myMesh, 1), _ionicMaterials(IonicMaterials), _ionicArray(NULL),
+      _xi(Xi), _Cm(Cm)
+  {
+    if (int(_ionicMaterials.size()) != _myMesh->getNumberOfNodes()) {
+      cout << "** EPModel: number of ionic materials (" << _ionicMaterials.size()
+	   << ") different from number of nodes (" << _myMesh->getNumberOfNodes()
+	   << ")" << endl;
+      exit(1);
+    }
+    this->readDiffusion(inputFile);
+
+    _distinctMaterials = this->getNumMat() == _ionicMaterials.size();
+
+    // Initialize field
+    _field.resize( _myMesh->getNumberOfNodes() );
+    this->initializeField();
+
+    this->setPrevField();
+  }
+
+
+
+  EPModel::EPModel(Mesh* myMesh, IonicArray * Ionic,
+		   const vector<Matrix3d > & Diffusion,
+		   const Real Xi, const Real Cm)
+    : Model(myMesh, 1), _diffusion(Diffusion), _ionicArray(Ionic),
+      _distinctMaterials(true), _xi(Xi), _Cm(Cm)
+  {
+    if (int(_ionicArray->getNumCells()) != _myMesh->getNumberOfNodes()) {
+      cout << "** EPModel: number of ionic cells (" << _ionicArray->getNumCells()
+	   << ") different from number of nodes (" << _myMesh->getNumberOfNodes()
+	   << ")" << endl;
+      exit(1);
+    }
+    if (int(_diffusion.size()) != _myMesh->getNumberOfElements()) {
+      cout << "** EPModel: number of diffusion tensors different from number of elements"
+	   << endl;
+      exit(1);
+    }
+
+    // Initialize field
+    _field.resize( _myMesh->getNumberOfNodes() );
+    this->initializeField();
+
+    this->setPrevField();
+  }
+
+
+
+  void EPModel::readDiffusion(const string inputFile)
+  {
     // Read diffusion tensor data
-    ifstream inp(inputFile.c_str() );
+    ifstream inp(inputFile.c_str());
+    if (!inp.is_open()) {
+      cout << "** EPModel: cannot open " << inputFile << endl;
+      exit(1);
+    }
     string line;
-    _diffusion.resize( _myMesh->getNumberOfElements() );
+    _diffusion.resize( _myMesh->getNumberOfElements(), Matrix3d::Zero() );
     while( getline(inp, line) ) {
-      // Read diffusion tensor data
-      if (line.find("*DIFFUSION") == 0) 
+      if (line.find("*DIFFUSION") == 0)
 	for(uint i = 0; i < _diffusion.size(); i++) {
 	  getline(inp, line);
 	  vector<string> strs = splitString(line, " \t");
 	  for(uint m = 0; m < 3; m++)
-	    for(uint n = 0; n < 3; n++) 
+	    for(uint n = 0; n < 3; n++)
 	      _diffusion[i](m,n) = atof( strs[3*m + n].c_str() );
 	} // Loop over number of diffusion values
-
-      // Reading in of load steps
-      
     } // While getline loop
     inp.close();
-  } // Constructor
+  }
+
+
+
+  void EPModel::addStimulus(const vector<int > & Nodes, const Real Amplitude,
+			    const Real Start, const Real Duration,
+			    const Real Period)
+  {
+    Stimulus stim;
+    stim.nodes     = Nodes;
+    stim.amplitude = Amplitude;
+    stim.start     = Start;
+    stim.duration  = Duration;
+    stim.period    = Period;
+    _stimuli.push_back(stim);
+  }
+
+
+
+  void EPModel::computeStimulus(vector<Real > & istim, const Real time)
+  {
+    istim.assign(_field.size(), 0.0);
+    for (uint s = 0; s < _stimuli.size(); s++) {
+      const Stimulus & stim = _stimuli[s];
+      Real t = time - stim.start;
+      if (t < 0.0) continue;
+      if (stim.period > 0.0)
+	t = fmod(t, stim.period);
+      if (t >= stim.duration) continue;
+      for (uint i = 0; i < stim.nodes.size(); i++)
+	istim[stim.nodes[i]] += stim.amplitude;
+    }
+  }
+
+
+
+  // Compute Function - Compute Energy, Force, Stiffness of diffusion operator
+  void EPModel::compute(Result * R)
+  {
+    const vector<GeomElement* > elements = _myMesh->getElements();
+    const int AvgNodePerEl = ((elements[0])->getNodesID()).size();
+    const int NumEl = elements.size();
+    const int dim = _myMesh->getDimension();
+    const Real scale = 1.0/(_xi*_Cm);
+    vector<Triplet<Real > > KtripletList;
+
+    // Reset values in result struct
+    if ( R->getRequest() & ENERGY ) {
+      R->setEnergy(0.0);
+    }
+    if ( R->getRequest() & FORCE )  {
+      R->resetResidualToZero();
+    }
+    if ( R->getRequest() & STIFFNESS ) {
+      R->resetStiffnessToZero();
+      KtripletList.reserve(NumEl*AvgNodePerEl*AvgNodePerEl);
+    }
+
+    for(int e = 0; e < NumEl; e++)
+    {
+      GeomElement* geomEl = elements[e];
+      const vector<int  >& NodesID = geomEl->getNodesID();
+      const int numQP    = geomEl->getNumberOfQuadPoints();
+      const int numNodes = NodesID.size();
+      const Matrix3d & D = _diffusion[e];
+      MatrixXd Kele = MatrixXd::Zero(numNodes, numNodes);
+
+      for(int q = 0; q < numQP; q++) {
+	Real Vol = geomEl->getQPweights(q)*scale;
+	for(int a = 0; a < numNodes; a++) {
+	  for(int b = 0; b < numNodes; b++) {
+	    Real tempK = 0.0;
+	    for (int I = 0; I < dim; I++)
+	      for (int J = 0; J < dim; J++)
+		tempK += D(I,J)*geomEl->getDN(q, a, I)*geomEl->getDN(q, b, J);
+	    Kele(a,b) += tempK*Vol;
+	  } // b loop
+	} // a loop
+      } // q loop
+
+      if (R->getRequest() & (ENERGY | FORCE)) {
+	VectorXd Vele(numNodes);
+	for(int a = 0; a < numNodes; a++)
+	  Vele(a) = _field[NodesID[a]];
+	VectorXd KV = Kele*Vele;
+
+	if (R->getRequest() & ENERGY)
+	  R->addEnergy(0.5*Vele.dot(KV));
+
+	if (R->getRequest() & FORCE)
+	  for(int a = 0; a < numNodes; a++)
+	    R->addResidual(NodesID[a], KV(a));
+      }
+
+      if (R->getRequest() & STIFFNESS)
+	for(int a = 0; a < numNodes; a++)
+	  for(int b = 0; b < numNodes; b++)
+	    KtripletList.push_back( Triplet<Real >( NodesID[a], NodesID[b], Kele(a,b) ) );
+
+    } // element loop
+
+    // Sum up all stiffness entries with the same indices
+    if ( R->getRequest() & STIFFNESS ) {
+      R->setStiffnessFromTriplets(KtripletList);
+      R->FinalizeGlobalStiffnessAssembly();
+    }
+
+  } // EP Model compute
+
+
+
+  void EPModel::computeMassMatrix(SparseMatrix<Real > & M, const bool lumped)
+  {
+    const vector<GeomElement* > elements = _myMesh->getElements();
+    const int NumEl = elements.size();
+    const int NumNodes = _myMesh->getNumberOfNodes();
+    vector<Triplet<Real > > MtripletList;
+    MtripletList.reserve(lumped ? NumEl*10 : NumEl*100);
+
+    for(int e = 0; e < NumEl; e++)
+    {
+      GeomElement* geomEl = elements[e];
+      const vector<int  >& NodesID = geomEl->getNodesID();
+      const int numQP    = geomEl->getNumberOfQuadPoints();
+      const int numNodes = NodesID.size();
+      MatrixXd Mele = MatrixXd::Zero(numNodes, numNodes);
+
+      Real Volume = 0.0;
+      for(int q = 0; q < numQP; q++)
+	Volume += geomEl->getQPweights(q);
+
+      if (geomEl->isAffine()) {
+	// Linear simplex (tet or triangle): closed form V/(n(n+1)) (1 + delta_ab),
+	// n = numNodes, independent of the quadrature rule
+	const Real Factor = Volume/Real(numNodes*(numNodes + 1));
+	for(int a = 0; a < numNodes; a++)
+	  for(int b = 0; b < numNodes; b++)
+	    Mele(a,b) = (a == b ? 2.0 : 1.0)*Factor;
+      }
+      else {
+	for(int q = 0; q < numQP; q++) {
+	  Real Vol = geomEl->getQPweights(q);
+	  for(int a = 0; a < numNodes; a++)
+	    for(int b = 0; b < numNodes; b++)
+	      Mele(a,b) += geomEl->getN(q, a)*geomEl->getN(q, b)*Vol;
+	}
+      }
+
+      for(int a = 0; a < numNodes; a++) {
+	if (lumped)
+	  MtripletList.push_back( Triplet<Real >( NodesID[a], NodesID[a], Mele.row(a).sum() ) );
+	else
+	  for(int b = 0; b < numNodes; b++)
+	    MtripletList.push_back( Triplet<Real >( NodesID[a], NodesID[b], Mele(a,b) ) );
+      }
+    } // element loop
+
+    M.resize(NumNodes, NumNodes);
+    M.setFromTriplets(MtripletList.begin(), MtripletList.end());
+    M.makeCompressed();
+  } // computeMassMatrix
+
+
+
+  void EPModel::computeReaction(const Real dt, const Real time)
+  {
+    vector<Real > istim;
+    this->computeStimulus(istim, time);
+
+    const int NumNodes = _field.size();
+    if (_ionicArray) {
+      vector<Real > dVdt(NumNodes, 0.0);
+      _ionicArray->compute(_xi, _Cm, dt, &_field[0], &istim[0], &dVdt[0]);
+      for (int i = 0; i < NumNodes; i++)
+	_field[i] += dt*dVdt[i];
+      return;
+    }
+
+    // A material shared by several nodes keeps its state in one place: serial
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if(_distinctMaterials)
+#endif
+    for (int i = 0; i < NumNodes; i++) {
+      _field[i] += dt*_ionicMaterials[i]->compute(_xi, _Cm, dt, _field[i], istim[i]);
+    }
+  } // computeReaction
+
+
+
+  // Writing output
+  void EPModel::writeOutputVTK(const string OutputFile, int step)
+  {
+    // Create outputFile name
+    stringstream FileNameStream;
+    FileNameStream << OutputFile << step << ".vtk";
+    ofstream out;
+    out.open( (FileNameStream.str()).c_str() );
+    int NumNodes = _myMesh->getNumberOfNodes();
+
+    // Header
+    char spchar = '#';
+    out << spchar << " vtk DataFile Version 3.1" << endl;
+    out << "vtk output" << endl;
+    out << "ASCII" << endl;
+    out << "DATASET UNSTRUCTURED_GRID" << endl;
+    out << "POINTS " << NumNodes << " FLOAT" << endl;
+
+    // For now we assumed dim == 3 !
+    for (int i = 0; i < NumNodes; i++ ) {
+      out << _myMesh->getX(i,0) << " " << _myMesh->getX(i,1) << " " << _myMesh->getX(i,2) << endl;
+    }
+
+    vector<GeomElement* > elements = _myMesh->getElements();
+    int NumEl = elements.size();
+    int NodePerEl = (elements[0])->getNodesPerElement();
+    int CellType = 0;
+    switch (NodePerEl) {
+    case 4:
+      CellType = 10;
+      break;
+    case 8:
+      CellType = 12;
+      break;
+    case 10:
+      CellType = 24;
+      break;
+    default:
+      cout << "Error cell type not implemented in EPModel writeOutput. " << endl;
+    }
+
+    out << endl << "CELLS " << NumEl << " " << NumEl*(NodePerEl+1) << endl;
+
+    for (int e = 0; e < NumEl; e++) {
+      out << NodePerEl << " ";
+      const vector<int > & NodesID = (elements[e])->getNodesID();
+      for (int n = 0; n < NodePerEl; n++) {
+	out << NodesID[n] << " ";
+      }
+      out << endl;
+    }
+
+    out << endl << "CELL_TYPES " << NumEl << endl;
+    for (int e = 0; e < NumEl; e++) {
+      out << CellType << " " << endl;
+    }  // end of printing conntable
+
+    // Point data section
+    out << endl << "POINT_DATA " << NumNodes << endl
+	<< "SCALARS voltage double" << endl
+	<< "LOOKUP_TABLE default" << endl;
+
+    for (int i = 0; i < NumNodes; i++ ) {
+      out << _field[i] << endl;
+    }
+
+    // Close file
+    out.close();
+  } // writeOutputVTK
 
-}
+} // namespace voom
@@ -2,31 +2,207 @@
 /*!
   \file EPModel.h
 
-  \brief Implementation of Cardiac Electrophysiology. This is the parent
-  class for cardiac EP. Monodomain and Bidomain classes will derive from 
-  this class
+  \brief Implementation of Cardiac Electrophysiology (monodomain). The
+  transmembrane voltage is stored at the nodes of the mesh and every node
+  carries its own ionic cell model. The model provides the two operators
+  needed by an operator splitting solver:
+  - the reaction step, i.e. the ionic ODE integration at every node
+  - the diffusion operator, i.e. mass and conductivity matrices assembled
+  from the per-element diffusion tensors.
+
+  The monodomain equation
+  \f[
+  \chi C_m \frac{\partial V}{\partial t} = \nabla \cdot (\sigma \nabla V) -
+  \chi I_{ion} + I_{stim}
+  \f]
+  is scaled by \f$ \chi C_m \f$ so that the ionic models return dV/dt
+  directly (mV/ms).
 */
 
 #ifndef __EPModel_h__
 #define __EPModel_h__
 #include "Model.h"
-#include "EPResult.h"
+#include "EigenResult.h"
+#include "IonicMaterial.h"
+#include "IonicArray.h"
 
 namespace voom{
   class EPModel : public Model {
+  public:
+    //! Stimulus protocol applied to a set of nodes
+    struct Stimulus {
+      vector<int > nodes;
+      Real amplitude;  // uA/cm^3
+      Real start;      // ms
+      Real duration;   // ms
+      Real period;     // ms (0 = single stimulus)
+    };
+
+    //! Constructor from per-element diffusion (conductivity) tensors
+    /*!
+      \param IonicMaterials one ionic material per node
+      \param Diffusion one conductivity tensor per element
+      \param Xi surface area to volume ratio (1/cm)
+      \param Cm membrane capacitance (uF/cm^2)
+    */
+    EPModel(Mesh* myMesh, vector<IonicMaterial * > IonicMaterials,
+	    const vector<Matrix3d > & Diffusion,
+	    const Real Xi = 1000., const Real Cm = 1.0);
+
+    //! Constructor reading the diffusion tensors from the *DIFFUSION card
+    EPModel(Mesh* myMesh, vector<IonicMaterial * > IonicMaterials,
+	    const string inputFile,
+	    const Real Xi = 1000., const Real Cm = 1.0);
+
+    //! Constructor with all cells integrated by one IonicArray
+    EPModel(Mesh* myMesh, IonicArray * Ionic,
+	    const vector<Matrix3d > & Diffusion,
+	    const Real Xi = 1000., const Real Cm = 1.0);
+
+    //! Destructor
+    virtual ~EPModel() {
+      if (_ionicArray) delete _ionicArray;
+
+      set<IonicMaterial *> UNIQUEmaterials;
+      for (uint i = 0; i < _ionicMaterials.size(); i++)
+	UNIQUEmaterials.insert(_ionicMaterials[i]);
+
+      for (set<IonicMaterial *>::iterator it = UNIQUEmaterials.begin();
+	   it != UNIQUEmaterials.end(); it++)
+	delete (*it);
+    }
+
+    //! Initialize field
+    // From constant value
+    void initializeField(const Real value = 0.0) {
+      _field.assign(_field.size(), value);
+    };
+
+    //! From array
+    void initializeField(const Real* value) {
+      _field.assign(value, value+_field.size());
+    };
+
+    //! Linearized update
+    // From solution array
+    void linearizedUpdate(const Real* localValues, Real fact=1.0) {
+      for(uint i = 0; i < _field.size(); i++)
+	_field[i] += localValues[i]*fact;
+    };
+
+    // One value at the time (Node ID, dof index, value)
+    void linearizedUpdate(const int id, const int, const Real value) {
+      _field[id] += value;
+    };
+
+    void linearizedUpdate(const int dof, const Real value) {
+      _field[dof] += value;
+    };
+
+    void setField(uint dof, Real value) {
+      _field[dof] = value;
+    };
+
+    void setField(const Real* value) {
+      _field.assign(value, value+_field.size());
+    };
+
+    void setPrevField() {
+      _prevField = _field;
+    };
+
+    void getField(vector<double> & x) {
+      assert(x.size() == _field.size());
+      x = _field;
+    }
+
+    //! Direct access to the voltage field (used by the EP solver)
+    vector<Real > & getVoltage() { return _field; }
+
+    void printField() {
+      for (uint i = 0; i < _field.size(); i++)
+	cout << _field[i] << endl;
+    };
+
+    uint getNumMat() {
+      if (_ionicArray) return 1;
+      set<IonicMaterial *> UNIQUEmaterials;
+      for (uint i = 0; i < _ionicMaterials.size(); i++)
+	UNIQUEmaterials.insert(_ionicMaterials[i]);
+
+      return UNIQUEmaterials.size();
+    }
+
+    //! Get ionic materials (one per node)
+    const vector<IonicMaterial * > & getIonicMaterials() {
+      return _ionicMaterials;
+    }
+
+    //! Get ionic array (NULL if per node ionic materials are used)
+    IonicArray * getIonicArray() { return _ionicArray; }
+
+    //! Get element diffusion tensors
+    const vector<Matrix3d > & getDiffusion() { return _diffusion; }
+
+    //! Get surface area to volume ratio and capacitance
+    Real getXi() { return _xi; }
+    Real getCm() { return _Cm; }
+
+    //! Add a stimulus protocol
+    void addStimulus(const vector<int > & Nodes, const Real Amplitude,
+		     const Real Start, const Real Duration,
+		     const Real Period = 0.0);
+
+    //! Remove all stimuli
+    void clearStimuli() { _stimuli.clear(); }
+
+    //! Stimulus current at every node at time t
+    void computeStimulus(vector<Real > & istim, const Real time);
+
+    /*!
+      Diffusion operator (scaled by 1/(Xi Cm)). ENERGY = 0.5 V^T K V,
+      FORCE = K V, STIFFNESS = K
+    */
+    void compute(Result * R);
+
+    //! Assemble mass matrix (lumped = row sum)
+    void computeMassMatrix(SparseMatrix<Real > & M, const bool lumped = true);
+
+    /*!
+      Reaction step. Integrates the ionic models at every node over dt
+      starting at time and updates the voltage with dV/dt returned by the
+      ionic model. Nodes are independent and processed in parallel.
+    */
+    void computeReaction(const Real dt, const Real time);
+
+    //! Write output
+    void writeOutputVTK(const string OutputFile, int step);
+
   protected:
+    //! Read *DIFFUSION card from input file
+    void readDiffusion(const string inputFile);
+
     //! Diffusion tensor data for each element
-    vector<Matrix3d>   _diffusion;
+    vector<Matrix3d >        _diffusion;
 
-  public:
-    //! Constructor
-    EPModel(Mesh* myMesh, const string inputFile, const uint NodeDof);
+    //! Ionic material at each node
+    vector<IonicMaterial * > _ionicMaterials;
 
-    //! Destructor
-    virtual ~EPModel() {;}
+    //! Ionic model for all nodes stored as structure of arrays
+    IonicArray *             _ionicArray;
+
+    //! No ionic material shared by two nodes: nodes can be integrated in parallel
+    bool                     _distinctMaterials;
+
+    //! Stimulus protocols
+    vector<Stimulus >        _stimuli;
+
+    //! Surface area to volume ratio and membrane capacitance
+    Real _xi, _Cm;
 
-    //! Pure virtual compute function call
-    void compute(EPResult& R) {;}
+    //! Voltage at all nodes
+    vector<Real > _field;
+    vector<Real > _prevField;
   };
 }
 
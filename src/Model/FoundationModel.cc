@@ -112,12 +112,14 @@ namespace voom {
     } // loop over elements
 
     // loop over _spNodes
+    const vector<int > & offsets = _myMesh->getNodeElementOffsets();
+    const vector<int > & nodeElements = _myMesh->getNodeElements();
     for (int n = 0; n < _spNodes.size(); n++) {
       // Reset normal to zero
       _spNormals[n] = Vector3d::Zero();
       // Loop over all elements sharing that node
-      for (int m = 0; m < _spNodesToEle[n].size(); m++) {
-        _spNormals[n] += ElNormals[_spNodesToEle[n][m]];
+      for (int m = offsets[_spNodes[n]]; m < offsets[_spNodes[n] + 1]; m++) {
+        _spNormals[n] += ElNormals[nodeElements[m]];
       }
       Real normFactor = 1.0/_spNormals[n].norm();
       _spNormals[n] *= normFactor;
@@ -134,23 +136,6 @@ namespace voom {
     while (inp >> nodeNum)
     _spNodes.push_back(nodeNum);
 
-    // Collect elements that share a node in _spNodes
-    const vector<GeomElement* > elements = _myMesh->getElements();
-
-    for (int n = 0; n < _spNodes.size(); n++) {
-      vector<int > connected;
-      for(int e = 0; e < elements.size(); e++) {
-        const vector<int >& NodesID = elements[e]->getNodesID();
-        for (int m = 0; m < NodesID.size(); m++) {
-          if (NodesID[m] == _spNodes[n]) {
-            connected.push_back(e);
-            break;
-          } //  check if node belong to element
-        } // loop over nodes of the element
-      } // loop over elements
-      _spNodesToEle.push_back(connected);
-    } // loop over _spNodes
-
     _spNormals.resize(_spNodes.size(), Vector3d::Zero());
     // Compute initial node normals
     this->computeNormals();
@@ -143,7 +143,6 @@ namespace voom{
     // Spring BC
     vector<int > _spNodes;
     Real _springK;
-    vector<vector<int > > _spNodesToEle;
     vector<Vector3d > _spNormals;
   };
 
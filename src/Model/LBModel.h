@@ -141,6 +141,12 @@ namespace voom{
 
     //! Solve the system
     void compute(Result & R);
+    //! Model interface, used by the solvers
+    void compute(Result * R) { this->compute(*R); }
+
+    //! Recompute the stored surface metric at all quadrature points
+    //! (done at construction; call again if the mesh nodes move)
+    void computeReferenceGeometry();
     
     void setImplicitDynamicsFlag(bool flag){
       
@@ -166,6 +172,10 @@ namespace voom{
     vector<Real > _field;
     vector<Real > _prevField;
 
+    //! Surface metric at QP q of element e is _refGeometry[_QPoffsets[e] + q]
+    vector<ShellMetric, aligned_allocator<ShellMetric > > _refGeometry;
+    vector<int > _QPoffsets;
+
     bool _implicitDynamics;
   };
 
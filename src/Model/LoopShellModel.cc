@@ -19,7 +19,6 @@ namespace voom {
   void LoopShellModel::compute(Result & R)
   {
     const vector<GeomElement* > elements = _myMesh->getElements();
-    const int AvgNodePerEl = ((elements[0])->getNodesID()).size();
     const int NumEl = elements.size();
     const int dim = _myMesh->getDimension();
     vector<Triplet<Real > > KtripletList, HgtripletList;
@@ -41,20 +40,43 @@ namespace voom {
     }
     if ( R.getRequest() & STIFFNESS ) { 
       R.resetStiffnessToZero();
-      KtripletList.reserve(dim*dim*NumEl*AvgNodePerEl*AvgNodePerEl);
     }
    
-    // Loop through elements, also through material points array, which is unrolled
-    // uint index = 0;
-    SCElastic::Shellresults ShRes;
-    ShRes.request = R.getRequest();
-    for(int e = 0; e < NumEl; e++)
+    // Loop through elements, also through material points array, which is unrolled.
+    // Elements of one color share no node and are assembled in parallel;
+    // SCElastic keeps its curvatures, so a material shared by several
+    // elements forces the serial loop
+    const vector<int > & colorOffsets = _myMesh->getColorOffsets();
+    const vector<int > & colorElements = _myMesh->getColorElements();
+    const int NumColors = int(colorOffsets.size()) - 1;
+    const bool distinctMaterials = this->getNumMat() == _materials.size();
+    vector<Real > ElEnergy(NumEl, 0.0);
+
+    // Stiffness triplets of element e are stored from KtripletOffset[e]
+    vector<int > KtripletOffset(NumEl + 1, 0);
+    if ( R.getRequest() & STIFFNESS ) {
+      for(int e = 0; e < NumEl; e++) {
+	const int numDoF = elements[e]->getNodesID().size()*dim;
+	KtripletOffset[e + 1] = KtripletOffset[e] + numDoF*numDoF;
+      }
+      KtripletList.resize(KtripletOffset[NumEl]);
+    }
+    for (int c = 0; c < NumColors; c++) {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if(distinctMaterials)
+#endif
+    for(int ce = colorOffsets[c]; ce < colorOffsets[c + 1]; ce++)
       {
+	const int e = colorElements[ce];
+	SCElastic::Shellresults ShRes;
+	ShRes.request = R.getRequest();
 	LoopShellElement* element = dynamic_cast<LoopShellElement*>(elements[e]);
 	const vector<int  >& NodesID = element->getNodesID();
 	const int numQP    = element->getNumberOfQuadPoints();
 	const int numNodes = NodesID.size();
-	//MatrixXd Kele = MatrixXd::Zero(numNodes*dim, numNodes*dim);
+	MatrixXd Kele;
+	if ( R.getRequest() & STIFFNESS )
+	  Kele = MatrixXd::Zero(numNodes*dim, numNodes*dim);
       
 	// Loop over quadrature points
 	for(int q = 0; q < numQP; q++) {
@@ -107,7 +129,7 @@ namespace voom {
 	
 	  // Compute energy
 	  if (R.getRequest() & ENERGY) {
-	    R.addEnergy(ShRes.W*Vol);
+	    ElEnergy[e] += ShRes.W*Vol;
 	  }
 	  
 	  Real MC = - 0.5 * ( geometry.aDual()[0].dot( geometry.dPartials()[0] ) + \
@@ -144,10 +166,58 @@ namespace voom {
 	      } //i loop
 	    } // n loop
 	  } // Internal force loop
+
+	  // Compute stiffness: the energy at the QP is w*f(A), with
+	  // A = (a_1, a_2, a_11, a_22, a_12) = B x linear in the nodal
+	  // positions, so K = w B^T (d^2 f/dA^2) B
+	  if ( R.getRequest() & STIFFNESS ) {
+	    Real A[15];
+	    for(uint i = 0; i < 3; i++) {
+	      A[i] = a[0](i); A[3 + i] = a[1](i);
+	      A[6 + i] = aPartials[0](i); A[9 + i] = aPartials[1](i); A[12 + i] = aPartials[2](i);
+	    }
+	    Matrix<Real, 15, 15> H;
+	    _materials[e]->computeTangent(A, H);
+
+	    MatrixXd B = MatrixXd::Zero(15, numNodes*dim);
+	    for(int n = 0; n < numNodes; n++) {
+	      const Real coeff[5] = {element->getDN(q,n,0), element->getDN(q,n,1),
+				     element->getDDN(q,n,0,0), element->getDDN(q,n,1,1),
+				     element->getDDN(q,n,0,1)};
+	      for(uint b = 0; b < 5; b++)
+		for(uint i = 0; i < 3; i++)
+		  B(3*b + i, n*dim + i) = coeff[b];
+	    }
+	    Kele.noalias() += element->getQPweights(q) * (B.transpose() * (H * B));
+	  } // Compute stiffness matrix
+	} // QP loop
+
+	if ( R.getRequest() & STIFFNESS ) {
+	  int t = KtripletOffset[e];
+	  for(int n = 0; n < numNodes; n++)
+	    for(int i = 0; i < dim; i++)
+	      for(int m = 0; m < numNodes; m++)
+		for(int j = 0; j < dim; j++)
+		  KtripletList[t++] = Triplet<Real >(NodesID[n]*dim + i, NodesID[m]*dim + j,
+						     Kele(n*dim + i, m*dim + j));
 	}
   
 
       }// Element loop
+    } // Color loop
+
+    if (R.getRequest() & ENERGY) {
+      Real energy = 0.0;
+      for(int e = 0; e < NumEl; e++)
+	energy += ElEnergy[e];
+      R.addEnergy(energy);
+    }
+
+    // Sum up all stiffness entries with the same indices
+    if ( R.getRequest() & STIFFNESS ) {
+      R.setStiffnessFromTriplets(KtripletList);
+      R.FinalizeGlobalStiffnessAssembly();
+    }
  
   } // Compute Mechanics Model
 
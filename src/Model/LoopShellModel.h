@@ -156,6 +156,8 @@ namespace voom{
 
     //! Solve the system
     void compute(Result & R);
+    //! Model interface, used by the solvers
+    void compute(Result * R) { this->compute(*R); }
 
 
   protected:
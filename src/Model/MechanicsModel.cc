@@ -1,4 +1,8 @@
 #include "MechanicsModel.h"
+#include "AffineFEgeomElement.h"
+
+#include <boost/lexical_cast.hpp>
+#include <vtkCellType.h>
 
 namespace voom {
 
@@ -11,7 +15,10 @@ namespace voom {
     int SpringBCflag):
     Model(aMesh, NodeDoF), _materials(Materials),
     _pressureFlag(PressureFlag), _pressure(0.0), _surfaceMesh(SurfaceMesh),
-    _nodalForcesFlag(NodalForcesFlag), _forcesID(NULL), _forces(NULL), _resetFlag(ResetFlag), _springBCflag(SpringBCflag)
+    _nodalForcesFlag(NodalForcesFlag), _forcesID(NULL), _forces(NULL), _resetFlag(ResetFlag), _springBCflag(SpringBCflag),
+    _timeSeries(false), _singlePrecision(false), _writer(NULL),
+    _keepOutputState(false), _lastResidualPressure(0.0),
+    _stressCellAverages(true), _stressQuadraturePoints(false)
     {
       // THERE IS ONE MATERIAL PER ELEMENT - CAN BE CHANGED - DIFFERENT THAN BEFORE
       // Resize and initialize (default function) _field vector
@@ -67,10 +74,90 @@ namespace voom {
 
 
   // Compute Function - Compute Energy, Force, Stiffness
+  void MechanicsModel::computeAffineElement(Result * R, const int e, MechanicsMaterial::FKresults & FKres,
+					    Real & Energy, Triplet<Real > * Ktriplets,
+					    vector<VectorXd > & dRdalpha, const int NumPropPerMat)
+  {
+    AffineFEgeomElement* geomEl = static_cast<AffineFEgeomElement* >(_myMesh->getElements()[e]);
+    const vector<int  >& NodesID = geomEl->getNodesID();
+    const int numQP = geomEl->getNumberOfQuadPoints();
+    const int request = R->getRequest();
+    const Real* G = geomEl->getGradients(); // G[a*3 + J]
+
+    // F = sum_a x_a G_a, the same at all quadrature points
+    Matrix3d F = Matrix3d::Zero();
+    for(int a = 0; a < 4; a++)
+      for(int i = 0; i < 3; i++)
+	for(int J = 0; J < 3; J++)
+	  F(i,J) += _field[NodesID[a]*3 + i]*G[a*3 + J];
+
+    // Volume weighted sums of P and K over the quadrature points
+    Matrix3d P = Matrix3d::Zero();
+    Real K[81];
+    for(int n = 0; n < 81; n++) K[n] = 0.0;
+    const bool capture = captureStress(request);
+    for(int q = 0; q < numQP; q++) {
+      MechanicsMaterial* material = _materials[e*numQP + q];
+      material->compute(FKres, F);
+      const Real Vol = geomEl->getQPweights(q);
+      if (capture)
+	_qpStress[e*numQP + q] = FKres.P;
+
+      if (request & ENERGY)
+	Energy += FKres.W*Vol;
+      if ( (request & FORCE) || (request & DMATPROP) )
+	P += FKres.P*Vol;
+      if (request & STIFFNESS)
+	for(int i = 0; i < 3; i++)
+	  for(int M = 0; M < 3; M++)
+	    for(int j = 0; j < 3; j++)
+	      for(int N = 0; N < 3; N++)
+		K[((i*3 + M)*3 + j)*3 + N] += FKres.K.get(i, M, j, N)*Vol;
+
+      if (request & DMATPROP) {
+	for(int alpha = 0; alpha < NumPropPerMat; alpha++) {
+	  VectorXd & dR = dRdalpha[material->getMatID()*NumPropPerMat + alpha];
+	  for(int a = 0; a < 4; a++)
+	    for(int i = 0; i < 3; i++) {
+	      Real tempdRdalpha = 0.0;
+	      for(int J = 0; J < 3; J++)
+		tempdRdalpha += FKres.Dmat.get(alpha,i,J)*G[a*3 + J];
+	      dR(NodesID[a]*3 + i) += tempdRdalpha*Vol;
+	    }
+	}
+      }
+    } // QP loop
+
+    if ( (request & FORCE) || (request & DMATPROP) )
+      for(int a = 0; a < 4; a++)
+	for(int i = 0; i < 3; i++)
+	  R->addResidual(NodesID[a]*3 + i,
+			 P(i,0)*G[a*3] + P(i,1)*G[a*3 + 1] + P(i,2)*G[a*3 + 2]);
+
+    if (request & STIFFNESS) {
+      // KG(i,M,j,b) = sum_N K(i,M,j,N) G(b,N), then K_ab,ij = sum_M G(a,M) KG(i,M,j,b)
+      Real KG[108];
+      for(int iMj = 0; iMj < 27; iMj++)
+	for(int b = 0; b < 4; b++)
+	  KG[iMj*4 + b] = K[iMj*3]*G[b*3] + K[iMj*3 + 1]*G[b*3 + 1] + K[iMj*3 + 2]*G[b*3 + 2];
+      int t = 0;
+      for(int a = 0; a < 4; a++)
+	for(int i = 0; i < 3; i++)
+	  for(int b = 0; b < 4; b++)
+	    for(int j = 0; j < 3; j++) {
+	      Real tempStiffness = 0.0;
+	      for(int M = 0; M < 3; M++)
+		tempStiffness += G[a*3 + M]*KG[((i*3 + M)*3 + j)*4 + b];
+	      Ktriplets[t++] = Triplet<Real >(NodesID[a]*3 + i, NodesID[b]*3 + j, tempStiffness);
+	    }
+    }
+  }
+
+
+
   void MechanicsModel::compute(Result * R)
   {
     const vector<GeomElement* > elements = _myMesh->getElements();
-    const int AvgNodePerEl = ((elements[0])->getNodesID()).size();
     const int NumEl = elements.size();
     const int dim = _myMesh->getDimension();
     vector<Triplet<Real > > KtripletList, HgtripletList;
@@ -90,7 +177,6 @@ namespace voom {
     }
     if ( R->getRequest() & STIFFNESS ) {
       R->resetStiffnessToZero();
-      KtripletList.reserve(dim*dim*NumEl*AvgNodePerEl*AvgNodePerEl);
     }
 
     if ( R->getRequest() & DMATPROP ) {
@@ -104,17 +190,55 @@ namespace voom {
 
 
 
-    // Loop through elements, also through material points array, which is unrolled
-    // uint index = 0;
-    MechanicsMaterial::FKresults FKres;
-    FKres.request = R->getRequest();
-    for(int e = 0; e < NumEl; e++)
+    // P at each quadrature point is kept for stress output
+    const bool capture = captureStress(R->getRequest());
+    if (capture)
+      _qpStress.resize(_materials.size());
+
+    // Stiffness triplets of element e are stored from KtripletOffset[e],
+    // energy in ElEnergy[e], so that threads never write the same entry
+    vector<int > KtripletOffset(NumEl + 1, 0);
+    vector<Real > ElEnergy(NumEl, 0.0);
+    if ( R->getRequest() & STIFFNESS ) {
+      for(int e = 0; e < NumEl; e++) {
+	const int numDoF = elements[e]->getNodesID().size()*dim;
+	KtripletOffset[e + 1] = KtripletOffset[e] + numDoF*numDoF;
+      }
+      KtripletList.resize(KtripletOffset[NumEl]);
+    }
+
+    // Loop through elements, also through material points array, which is unrolled.
+    // Elements of one color share no node: each color is assembled in parallel.
+    // Materials keep the results of compute (e.g. PlasticMaterial), so a
+    // material shared by several quadrature points forces the serial loop
+    const vector<int > & colorOffsets = _myMesh->getColorOffsets();
+    const vector<int > & colorElements = _myMesh->getColorElements();
+    const int NumColors = int(colorOffsets.size()) - 1;
+    const bool distinctMaterials = this->getNumMat() == _materials.size();
+    for (int c = 0; c < NumColors; c++) {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if(distinctMaterials)
+#endif
+    for(int ce = colorOffsets[c]; ce < colorOffsets[c + 1]; ce++)
     {
+      const int e = colorElements[ce];
+      MechanicsMaterial::FKresults FKres;
+      FKres.request = R->getRequest();
       GeomElement* geomEl = elements[e];
       const vector<int  >& NodesID = geomEl->getNodesID();
       const int numQP    = geomEl->getNumberOfQuadPoints();
       const int numNodes = NodesID.size();
+
+      if (geomEl->isAffine() && numNodes == 4 && dim == 3) {
+        this->computeAffineElement(R, e, FKres, ElEnergy[e],
+          (R->getRequest() & STIFFNESS) ? &KtripletList[KtripletOffset[e]] : NULL,
+          dRdalpha, NumPropPerMat);
+        continue;
+      }
+
       MatrixXd Kele = MatrixXd::Zero(numNodes*dim, numNodes*dim);
+      // Shape function derivatives at the current quadrature point, DN[a*dim + J]
+      vector<Real > DN(numNodes*dim);
 
       // F at each quadrature point are computed at the same time in one element
       vector<Matrix3d > Flist(numQP, Matrix3d::Zero());
@@ -124,13 +248,18 @@ namespace voom {
       // Loop over quadrature points
       for(int q = 0; q < numQP; q++) {
         _materials[e*numQP + q]->compute(FKres, Flist[q]);
+        if (capture)
+          _qpStress[e*numQP + q] = FKres.P;
 
         // Volume associated with QP q
         Real Vol = geomEl->getQPweights(q);
+        for(int a = 0; a < numNodes; a++)
+          for(int J = 0; J < dim; J++)
+            DN[a*dim + J] = geomEl->getDN(q, a, J);
 
         // Compute energy
         if (R->getRequest() & ENERGY) {
-          R->addEnergy(FKres.W*Vol);
+          ElEnergy[e] += FKres.W*Vol;
         }
 
         // Compute Residual
@@ -139,7 +268,7 @@ namespace voom {
             for(uint i = 0; i < dim; i++) {
               Real tempResidual = 0.0;
               for (uint J = 0; J < dim; J++) {
-                tempResidual += FKres.P(i,J) * geomEl->getDN(q, a, J);
+                tempResidual += FKres.P(i,J) * DN[a*dim + J];
               } // J loop
               tempResidual *= Vol;
               R->addResidual(NodesID[a]*dim+i, tempResidual);
@@ -156,8 +285,7 @@ namespace voom {
                   Real tempStiffness = 0.0;
                   for(uint M = 0; M < dim; M++) {
                     for(uint N = 0; N < dim; N++) {
-                      tempStiffness += FKres.K.get(i, M, j, N)*elements[e]->getDN(q, a, M)*
-                      elements[e]->getDN(q, b, N);
+                      tempStiffness += FKres.K.get(i, M, j, N)*DN[a*dim + M]*DN[b*dim + N];
                     } // N loop
                   } // M loop
                   tempStiffness *= Vol;
@@ -176,7 +304,7 @@ namespace voom {
               for(uint i = 0; i < dim; i++) {
                 Real tempdRdalpha = 0.0;
                 for (uint J = 0; J < dim; J++) {
-                  tempdRdalpha += FKres.Dmat.get(alpha,i,J) * geomEl->getDN(q, a, J);
+                  tempdRdalpha += FKres.Dmat.get(alpha,i,J) * DN[a*dim + J];
                 } // J loop
                 tempdRdalpha *= Vol;
                 (dRdalpha[ (_materials[e*numQP + q]->getMatID())*NumPropPerMat + alpha])( NodesID[a]*dim + i) += tempdRdalpha;
@@ -190,11 +318,12 @@ namespace voom {
 
       if ( R->getRequest() & STIFFNESS ) {
         // Transform in triplets Kele
+        int t = KtripletOffset[e];
         for(uint a = 0; a < numNodes; a++) {
           for(uint i = 0; i < dim; i++) {
             for(uint b = 0; b < numNodes; b++) {
               for(uint j = 0; j < dim; j++) {
-                KtripletList.push_back( Triplet<Real >( NodesID[a]*dim + i, NodesID[b]*dim + j, Kele(a*dim + i, b*dim + j) ) );
+                KtripletList[t++] = Triplet<Real >( NodesID[a]*dim + i, NodesID[b]*dim + j, Kele(a*dim + i, b*dim + j) );
               }
             }
           }
@@ -202,6 +331,14 @@ namespace voom {
       }
 
     } // Element loop
+    } // Color loop
+
+    if (R->getRequest() & ENERGY) {
+      Real energy = 0.0;
+      for(int e = 0; e < NumEl; e++)
+        energy += ElEnergy[e];
+      R->addEnergy(energy);
+    }
 
     // Insert BC terms from spring
     if (_springBCflag == 1) {
@@ -233,6 +370,18 @@ namespace voom {
       }
     }
 
+    // Keep the residual for output
+    if ( (R->getRequest() & FORCE) && PbDoF == int(_field.size()) ) {
+      _lastResidual.resize(PbDoF);
+      for (int i = 0; i < PbDoF; i++)
+        _lastResidual[i] = R->getResidual(i);
+      if (_keepOutputState) {
+	_lastResidualField = _field;
+	_lastResidualPrevField = _prevField;
+	_lastResidualPressure = _pressure;
+      }
+    }
+
     // Compute Gradg and Hg
     if ( R->getRequest() & DMATPROP ) {
 
@@ -311,13 +460,152 @@ namespace voom {
 
 
 
+  // Checkpoint records: number of values, then the values
+  static void writeValues(ofstream & out, const vector<Real > & Values)
+  {
+    const int Size = Values.size();
+    out.write(reinterpret_cast<const char * >(&Size), sizeof(int));
+    if (Size > 0)
+      out.write(reinterpret_cast<const char * >(&Values[0]), Size*sizeof(Real));
+  }
+
+  static vector<Real > readValues(ifstream & in, const string & FileName)
+  {
+    int Size = -1;
+    in.read(reinterpret_cast<char * >(&Size), sizeof(int));
+    if (!in || Size < 0) {
+      cout << "** MechanicsModel: checkpoint " << FileName << " is truncated" << endl;
+      exit(1);
+    }
+    vector<Real > Values(Size);
+    if (Size > 0)
+      in.read(reinterpret_cast<char * >(&Values[0]), Size*sizeof(Real));
+    return Values;
+  }
+
+  static vector<Real > flatten(const vector<Vector3d > & V)
+  {
+    vector<Real > Values(3*V.size());
+    for (uint i = 0; i < V.size(); i++)
+      for (int d = 0; d < 3; d++)
+	Values[3*i + d] = V[i](d);
+    return Values;
+  }
+
+  static const char CheckpointTag[8] = {'V', 'O', 'O', 'M', 'C', 'K', 'P', '1'};
+
+
+
+  void MechanicsModel::writeCheckpoint(const string & FileName, int Step, Real Time)
+  {
+    // Written next to FileName, then renamed over it: a job stopped while
+    // writing leaves the previous checkpoint intact
+    const string TmpName = FileName + ".tmp";
+    ofstream out(TmpName.c_str(), ios::out | ios::binary | ios::trunc);
+    if (!out) {
+      cout << "** MechanicsModel: cannot open checkpoint " << TmpName << endl;
+      exit(1);
+    }
+
+    out.write(CheckpointTag, 8);
+    out.write(reinterpret_cast<const char * >(&Step), sizeof(int));
+    out.write(reinterpret_cast<const char * >(&Time), sizeof(Real));
+    out.write(reinterpret_cast<const char * >(&_pressure), sizeof(Real));
+    writeValues(out, _field);
+    writeValues(out, _prevField);
+    writeValues(out, flatten(_spNormals));
+    writeValues(out, flatten(_spTangents));
+    writeValues(out, vector<Real >(_centroidLocation.data(), _centroidLocation.data() + 3));
+
+    const int NumMat = _materials.size();
+    out.write(reinterpret_cast<const char * >(&NumMat), sizeof(int));
+    for (int k = 0; k < NumMat; k++)
+      writeValues(out, _materials[k]->getHistoryVariables());
+
+    out.close();
+    if (!out || rename(TmpName.c_str(), FileName.c_str()) != 0) {
+      cout << "** MechanicsModel: cannot write checkpoint " << FileName << endl;
+      exit(1);
+    }
+  }
+
+
+
+  void MechanicsModel::readCheckpoint(const string & FileName, int & Step, Real & Time)
+  {
+    ifstream in(FileName.c_str(), ios::in | ios::binary);
+    char Tag[8];
+    in.read(Tag, 8);
+    if (!in || !equal(Tag, Tag + 8, CheckpointTag)) {
+      cout << "** MechanicsModel: " << FileName << " is not a checkpoint" << endl;
+      exit(1);
+    }
+    in.read(reinterpret_cast<char * >(&Step), sizeof(int));
+    in.read(reinterpret_cast<char * >(&Time), sizeof(Real));
+    in.read(reinterpret_cast<char * >(&_pressure), sizeof(Real));
+
+    vector<Real > Field = readValues(in, FileName);
+    vector<Real > PrevField = readValues(in, FileName);
+    vector<Real > Normals = readValues(in, FileName);
+    vector<Real > Tangents = readValues(in, FileName);
+    vector<Real > Centroid = readValues(in, FileName);
+    if (Field.size() != _field.size() || PrevField.size() != _prevField.size() ||
+	Normals.size() != 3*_spNormals.size() || Tangents.size() != 3*_spTangents.size() ||
+	Centroid.size() != 3) {
+      cout << "** MechanicsModel: checkpoint " << FileName
+	   << " was written for a different mesh or boundary conditions" << endl;
+      exit(1);
+    }
+    _field = Field;
+    _prevField = PrevField;
+    for (uint i = 0; i < _spNormals.size(); i++)
+      _spNormals[i] = Vector3d(Normals[3*i], Normals[3*i + 1], Normals[3*i + 2]);
+    for (uint i = 0; i < _spTangents.size(); i++)
+      _spTangents[i] = Vector3d(Tangents[3*i], Tangents[3*i + 1], Tangents[3*i + 2]);
+    _centroidLocation = Vector3d(Centroid[0], Centroid[1], Centroid[2]);
+
+    int NumMat = -1;
+    in.read(reinterpret_cast<char * >(&NumMat), sizeof(int));
+    if (NumMat != int(_materials.size())) {
+      cout << "** MechanicsModel: checkpoint " << FileName << " has " << NumMat
+	   << " materials, the model " << _materials.size() << endl;
+      exit(1);
+    }
+    for (int k = 0; k < NumMat; k++) {
+      vector<Real > History = readValues(in, FileName);
+      if (History.size() != _materials[k]->getHistoryVariables().size()) {
+	cout << "** MechanicsModel: material " << k << " in checkpoint " << FileName
+	     << " has a different number of history variables" << endl;
+	exit(1);
+      }
+      if (!History.empty())
+	_materials[k]->setHistoryVariables(History);
+    }
+
+    // The residual and stress kept for output belong to the old state
+    this->invalidateOutputState();
+  }
+
+
+
   void MechanicsModel::applyPressure(Result * R) {
 
     const vector<GeomElement* > elements = _surfaceMesh->getElements();
-
-    // Loop through elements
-    for(int e = 0; e < elements.size(); e++)
+    vector<Real > ElEnergy(elements.size(), 0.0);
+
+    // Loop through elements, color by color (elements of one color share no
+    // node). No material is evaluated, so the loop is parallel also when
+    // materials are shared
+    const vector<int > & colorOffsets = _surfaceMesh->getColorOffsets();
+    const vector<int > & colorElements = _surfaceMesh->getColorElements();
+    const int NumColors = int(colorOffsets.size()) - 1;
+    for (int c = 0; c < NumColors; c++) {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for(int ce = colorOffsets[c]; ce < colorOffsets[c + 1]; ce++)
     {
+      const int e = colorElements[ce];
       GeomElement* geomEl = elements[e];
       const vector<int  >& NodesID = geomEl->getNodesID();
       const int numQP    = geomEl->getNumberOfQuadPoints();
@@ -348,7 +636,7 @@ namespace voom {
 
         // Compute energy
         if (R->getRequest() & ENERGY) {
-          R->addEnergy( _pressure*Area*a3.dot(u) );
+          ElEnergy[e] += _pressure*Area*a3.dot(u);
         }
 
         // Compute Residual
@@ -363,6 +651,14 @@ namespace voom {
 
       } // loop over QP
     } // loop over elements
+    } // loop over colors
+
+    if (R->getRequest() & ENERGY) {
+      Real energy = 0.0;
+      for(uint e = 0; e < elements.size(); e++)
+        energy += ElEnergy[e];
+      R->addEnergy(energy);
+    }
 
   } // apply pressure
 
@@ -450,12 +746,14 @@ namespace voom {
     } // loop over elements
 
     // loop over _spNodes
+    const vector<int > & offsets = _spMesh->getNodeElementOffsets();
+    const vector<int > & nodeElements = _spMesh->getNodeElements();
     for (int n = 0; n < _spNodes.size(); n++) {
       // Reset normal to zero
       _spNormals[n] = Vector3d::Zero();
       // Loop over all elements sharing that node
-      for (int m = 0; m < _spNodesToEle[n].size(); m++) {
-        _spNormals[n] += ElNormals[_spNodesToEle[n][m]];
+      for (int m = offsets[_spNodes[n]]; m < offsets[_spNodes[n] + 1]; m++) {
+        _spNormals[n] += ElNormals[nodeElements[m]];
       }
       Real normFactor = 1.0/_spNormals[n].norm();
       _spNormals[n] *= normFactor;
@@ -498,29 +796,8 @@ namespace voom {
     cout << "** Applying the Spring BC to " << numSpringNodes << " nodes." << endl;
 
     // Collect elements that share a node in _spNodes
-    const vector<GeomElement* > elements = _spMesh->getElements();
-
-    for (int n = 0; n < _spNodes.size(); n++) {
-      vector<int > connected;
-      for(int e = 0; e < elements.size(); e++) {
-        const vector<int >& NodesID = elements[e]->getNodesID();
-        for (int m = 0; m < NodesID.size(); m++) {
-          if (NodesID[m] == _spNodes[n]) {
-            connected.push_back(e);
-            break;
-          } //  check if node belong to element
-        } // loop over nodes of the element
-      } // loop over elements
-      _spNodesToEle.push_back(connected);
-
-      // For testing only - to be commented out
-      // cout << _spNodes[n] << " ";
-      // for (int i = 0; i < connected.size(); i++) {
-      // 	cout << connected[i] << " ";
-      // }
-      // cout << endl;
-
-    } // loop over _spNodes
+    // (node to element adjacency, built once and cached by _spMesh)
+    _spMesh->getNodeElements();
 
     _spNormals.resize(_spNodes.size(), Vector3d::Zero());
     // Compute initial node normals
@@ -842,49 +1119,119 @@ namespace voom {
 
 
   // Writing output
-  void MechanicsModel::writeOutputVTK(const string OutputFile, int step)
+  void MechanicsModel::setAsynchronousOutput(int MaxQueued)
+  {
+    delete _writer;
+    _writer = MaxQueued > 0 ? new AsyncVTKWriter(MaxQueued) : NULL;
+  }
+
+  void MechanicsModel::flushOutput()
+  {
+    if (_writer) _writer->flush();
+  }
+
+  void MechanicsModel::setTimeSeriesOutput(bool TimeSeries, bool SinglePrecision)
+  {
+    if (!TimeSeries)
+      this->closeTimeSeries();
+    _timeSeries = TimeSeries;
+    _singlePrecision = SinglePrecision;
+  }
+
+  void MechanicsModel::closeTimeSeries()
+  {
+    // Queued snapshots may still append to the series
+    this->flushOutput();
+    for (map<string, XDMFTimeSeries * >::iterator it = _series.begin(); it != _series.end(); it++)
+      delete it->second;
+    _series.clear();
+  }
+
+  VTKSnapshot * MechanicsModel::newSnapshot(const string & Name, int step, const string & Extension)
+  {
+    VTKSnapshot * S = new VTKSnapshot;
+    S->fileName = Name + boost::lexical_cast<string>(step) + Extension;
+    S->pointCloud = (Extension == ".vtp");
+    if (_timeSeries) {
+      XDMFTimeSeries * & series = _series[Name];
+      if (!series)
+	series = new XDMFTimeSeries(Name, _singlePrecision);
+      S->series = series;
+      S->step = step;
+    }
+    return S;
+  }
+
+  void MechanicsModel::output(VTKSnapshot * Snapshot)
+  {
+    if (_writer)
+      _writer->push(Snapshot);
+    else {
+      AsyncVTKWriter::write(*Snapshot);
+      delete Snapshot;
+    }
+  }
+
+
+
+  void MechanicsModel::updateOutputState()
+  {
+    if ( lastResidualIsCurrent() &&
+	 (!captureStress(FORCE) || _qpStress.size() == _materials.size()) )
+      return;
+
+    uint PbDoF = ( _myMesh->getNumberOfNodes())*this->getDoFperNode();
+    EigenResult myResults(PbDoF, 0);
+    myResults.setRequest(FORCE);
+    this->compute(&myResults);
+  }
+
+
+
+  // Cauchy stress, Green-Lagrange strain and Cauchy stress along the
+  // current fiber direction, from F, P and the reference fiber f0
+  static void stressMeasures(const Matrix3d & F, const Matrix3d & P, const Vector3d & f0,
+			     Matrix3d & Sigma, Matrix3d & E, Real & Sff)
   {
-    /////
-    // Todo: NEED TO BE REWRITTEN TAKING INTO ACCOUNT MULTIPLE QUADRATURE POINTS PER ELEMENT !!!
-    /////
+    Sigma = P*F.transpose()/F.determinant();
+    E = 0.5*(F.transpose()*F - Matrix3d::Identity());
+    const Vector3d f = F*f0;
+    Sff = f.dot(Sigma*f)/f.squaredNorm();
+  }
 
-    // Rewrite it with VTK Libraries
-    // Create outputFile name
-    string outputFileName = OutputFile + boost::lexical_cast<string>(step) + ".vtu";
-    vtkSmartPointer<vtkUnstructuredGrid> newUnstructuredGrid = vtkSmartPointer<vtkUnstructuredGrid>::New();
+
+
+  void MechanicsModel::writeOutputVTK(const string OutputFile, int step)
+  {
+    // Everything written is copied into S, which is written to file
+    // in the background if asynchronous output is on
+    VTKSnapshot * S = newSnapshot(OutputFile, step, ".vtu");
+    const char * XYZ[3] = {"X", "Y", "Z"};
 
     // Insert Points:
     int NumNodes = _myMesh->getNumberOfNodes();
-    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
-    // points->SetNumberOfPoints(NumNodes);
-    for (int i = 0; i < NumNodes; i++) {
-      float x_point = 0.0; float y_point = 0.0; float z_point = 0.0;
-      x_point = _myMesh->getX(i)(0);
-      if (_myMesh->getDimension() > 1) y_point = _myMesh->getX(i)(1);
-      if (_myMesh->getDimension() > 2) z_point = _myMesh->getX(i)(2);
-      points->InsertNextPoint(x_point, y_point, z_point);
-      // points->InsertPoint(i, x_point, y_point, z_point);
-    }
-    newUnstructuredGrid->SetPoints(points);
-    
+    int dim = _myMesh->getDimension();
+    S->points.assign(3*NumNodes, 0.0);
+    for (int i = 0; i < NumNodes; i++)
+      for (int j = 0; j < dim; j++)
+	S->points[3*i + j] = _myMesh->getX(i, j);
+
     // Element Connectivity:
     // To-do: Figure out how to handle mixed meshes
     // To-do: It would be better to select based on Abaqus element names
-    vector <GeomElement*> elements = _myMesh->getElements();
+    const vector <GeomElement*> & elements = _myMesh->getElements();
     int NumEl = elements.size();
     int NodePerEl = (elements[0])->getNodesPerElement();
-    int dim = _myMesh->getDimension();
 
-    VTKCellType cellType;
     // Set Cell Type: http://www.vtk.org/doc/nightly/html/vtkCellType_8h.html
     switch (dim) {
       case 3: // 3D
 	switch (NodePerEl) {
 	  case 4: // Linear Tetrahedron
-	    cellType = VTK_TETRA;
+	    S->cellType = VTK_TETRA;
 	    break;
 	  case 10: // Quadratic Tetrahedron
-	    cellType = VTK_QUADRATIC_TETRA;
+	    S->cellType = VTK_QUADRATIC_TETRA;
 	    break;
 	  default:
 	    cout << "3D Element type not implemented in MechanicsModel writeOutput." << endl;
@@ -896,197 +1243,126 @@ namespace voom {
 	exit(EXIT_FAILURE);
     }
 
+    S->nodesPerCell = NodePerEl;
+    S->connectivity.reserve(NumEl*NodePerEl);
     for (int el_iter = 0; el_iter < NumEl; el_iter++) {
-      vtkSmartPointer<vtkIdList> elConnectivity = vtkSmartPointer<vtkIdList>::New();
-
       const vector<int > & NodesID = (elements[el_iter])->getNodesID();
-      for (int n = 0; n < NodePerEl; n++) {
-        elConnectivity->InsertNextId(NodesID[n]);
-      }
-      newUnstructuredGrid->InsertNextCell(cellType, elConnectivity);
+      S->connectivity.insert(S->connectivity.end(), NodesID.begin(), NodesID.begin() + NodePerEl);
     }
 
     // ** BEGIN: POINT DATA ** //
     // ~~ BEGIN: DISPLACEMENTS ~~ //
-    vtkSmartPointer<vtkDoubleArray> displacements = vtkSmartPointer<vtkDoubleArray>::New();
-    displacements->SetNumberOfComponents(dim);
-    displacements->SetName("displacement");
-    displacements->SetComponentName(0, "X");
-    displacements->SetComponentName(1, "Y");
-    if (dim > 2) displacements->SetComponentName(2, "Z");
-
-    for (int i = 0; i < NumNodes; i++ ) {
-      double x[dim];
-      VectorXd X = _myMesh->getX(i);
-      for (int j = 0; j < dim; j++) {
-        x[j] = _field[i*dim + j] - X(j);
-      }
-      displacements->InsertNextTuple(x);
-    }
-    newUnstructuredGrid->GetPointData()->AddArray(displacements);
+    VTKArray & displacements = S->addPointArray("displacement", dim, NumNodes, XYZ);
+    for (int i = 0; i < NumNodes; i++ )
+      for (int j = 0; j < dim; j++)
+        displacements(i, j) = _field[i*dim + j] - _myMesh->getX(i, j);
     // ~~ END: DISPLACEMENTS ~~ //
     
     // ~~ BEGIN: RESIDUALS ~~ //
-    vtkSmartPointer<vtkDoubleArray> residuals = vtkSmartPointer<vtkDoubleArray>::New();
-    residuals->SetNumberOfComponents(dim);
-    residuals->SetName("residual");
-    residuals->SetComponentName(0, "X"); residuals->SetComponentName(1, "Y");
-    if (dim > 2) residuals->SetComponentName(2, "Z");
-
-    // Compute Residual
-    uint PbDoF = ( _myMesh->getNumberOfNodes())*this->getDoFperNode();
-    EigenResult myResults(PbDoF, 2);
-    int myRequest = 2;
-    myResults.setRequest(myRequest);
-    this->compute(&myResults);
-    VectorXd R = *(myResults._residual);
-
-    for (int i = 0; i < NumNodes; i++ ) {
-      double res[dim];
-      for (int j = 0; j < dim; j++) {
-        res[j] = R(i*dim + j);
-      }
-      residuals->InsertNextTuple(res);
-    }
-    newUnstructuredGrid->GetPointData()->AddArray(residuals);
+    // Residual of the last solver iteration if kept (setKeepOutputState)
+    // and the field did not change since, otherwise assembled again
+    this->updateOutputState();
+
+    VTKArray & residuals = S->addPointArray("residual", dim, NumNodes, XYZ);
+    for (int i = 0; i < NumNodes; i++ )
+      for (int j = 0; j < dim; j++)
+        residuals(i, j) = _lastResidual[i*dim + j];
     // ~~ END: RESIDUALS ~~ //
     // ** END: POINT DATA ** //
     
     // ** BEGIN: CELL DATA ** //
     // ~~ BEGIN: \alpha MATERIAL PROPERTY (MAT_PARAM_ID) ~~ //
-    vtkSmartPointer<vtkDoubleArray> alpha = vtkSmartPointer<vtkDoubleArray>::New();
-    alpha->SetNumberOfComponents(2);
-    alpha->SetName("alpha");
-    alpha->SetComponentName(0, "Alpha_1"); alpha->SetComponentName(1, "Alpha_2");
+    const char * AlphaNames[2] = {"Alpha_1", "Alpha_2"};
+    VTKArray & alpha = S->addCellArray("alpha", 2, NumEl, AlphaNames);
     for (int e = 0; e < NumEl; e++) {
-      GeomElement* geomEl = elements[e];
-      const int numQP = geomEl->getNumberOfQuadPoints();
-      double alpha_arr[2];
-      Real AvgMatProp_alpha1 = 0.0;
-      Real AvgMatProp_alpha2 = 0.0;
+      const int numQP = elements[e]->getNumberOfQuadPoints();
       for (int q = 0; q < numQP; q++) {
         vector <Real> MatProp = _materials[e*numQP + q]->getMaterialParameters();
-	if (!MatProp.empty()) {
-	  if (MatProp.size() > 0) AvgMatProp_alpha1 += MatProp[0];
-	  if (MatProp.size() > 1) AvgMatProp_alpha2 += MatProp[1];
-        }
+	if (MatProp.size() > 0) alpha(e, 0) += MatProp[0];
+	if (MatProp.size() > 1) alpha(e, 1) += MatProp[1];
       }
-      AvgMatProp_alpha1 /= double(numQP); AvgMatProp_alpha2 /= double(numQP);
-      alpha_arr[0] = AvgMatProp_alpha1; alpha_arr[1] = AvgMatProp_alpha2;
-      alpha->InsertNextTuple(alpha_arr);
+      alpha(e, 0) /= double(numQP); alpha(e, 1) /= double(numQP);
     }
-    newUnstructuredGrid->GetCellData()->AddArray(alpha);
     // ~~ END: \alpha MATERIAL PROPERTY (MAT_PARAM_ID) ~~ //
     
     // ~~ BEGIN: INTERNAL VARIABLES ~~ //
     // TODO: This method assumes the same material throughout the entire body
     int numInternalVariables = (_materials[0]->getInternalParameters()).size();
     if (numInternalVariables > 0) {
-      vtkSmartPointer <vtkDoubleArray> internalVariables = vtkSmartPointer<vtkDoubleArray>::New();
-      internalVariables->SetName("Material_Internal_Variables");
-      internalVariables->SetNumberOfComponents(numInternalVariables);
-      for (int i = 0; i < numInternalVariables; i++) {
-        string tempName = "Internal_Variable_" +  boost::lexical_cast<string>(i);
-        internalVariables->SetComponentName(i, tempName.c_str());
-      }
+      VTKArray & internalVariables = S->addCellArray("Material_Internal_Variables", numInternalVariables, NumEl);
+      for (int i = 0; i < numInternalVariables; i++)
+        internalVariables.componentNames.push_back("Internal_Variable_" + boost::lexical_cast<string>(i));
       for (int e = 0; e < NumEl; e++) {
-        GeomElement* geomEl = elements[e];
-        const int numQP = geomEl->getNumberOfQuadPoints();
-        vector<Real> IntProp = _materials[e*numQP]->getInternalParameters();
-        if (!IntProp.size() == numInternalVariables) {
+        const int numQP = elements[e]->getNumberOfQuadPoints();
+        if (int(_materials[e*numQP]->getInternalParameters().size()) != numInternalVariables) {
 	  cout << "Internal Variables output for multi-materials not supported yet." << endl;
-          // double* tempIntProp = new double[numInternalVariables]();
-          double tempIntProp[numInternalVariables];
-          for (int p = 0; p < numInternalVariables; p++) tempIntProp[p] = -123.4; // Some error value. NaN is better.
-	  internalVariables->InsertNextTuple(tempIntProp);
-	  // delete tempIntProp;
+          for (int p = 0; p < numInternalVariables; p++)
+	    internalVariables(e, p) = -123.4; // Some error value. NaN is better.
 	  continue;
         }
 
-        fill(IntProp.begin(), IntProp.end(), 0.0);
-
-        // Get Internal Properties from each quad point.
+        // Average over quad points for cell data.
         for (int q = 0; q < numQP; q++) {
           vector <Real> IntPropQuad = _materials[e*numQP + q]->getInternalParameters();
-          for (int p = 0; p < numInternalVariables; p++) IntProp[p] = IntProp[p] + IntPropQuad[p];
+          for (int p = 0; p < numInternalVariables; p++)
+	    internalVariables(e, p) += IntPropQuad[p]/numQP;
         }
-        // Average over quad points for cell data.
-        // double* intPropArr = new double(numInternalVariables);
-        double intPropArr[numInternalVariables];
-        for (int i = 0; i < numInternalVariables; i++) 
-  	  intPropArr[i] = IntProp[i]/numQP;
-        internalVariables->InsertNextTuple(intPropArr);
-	// delete [] intPropArr;
       }
-      newUnstructuredGrid->GetCellData()->AddArray(internalVariables);
     }
     // ~~ END: INTERNAL VARIABLES ~~ //
   
-    // ~~ BEGIN: 1ST PIOLA-KIRCHHOFF STRESS ~~ //
-    // Loop through elements, also through material points array, which is unrolled
-    // uint index = 0;
-    
-    vtkSmartPointer <vtkDoubleArray> FirstPKStress = vtkSmartPointer<vtkDoubleArray>::New();
-    FirstPKStress->SetName("First_PK_Stress");
-    FirstPKStress->SetNumberOfComponents(dim*dim);
-    for (int i = 0; i < dim; i++) { // row
-      for (int j = 0; j < dim; j++) {
-        string tempCompName = "P" + boost::lexical_cast<string>(i+1) + boost::lexical_cast<string>(j+1);
-        FirstPKStress->SetComponentName(i*3 + j, tempCompName.c_str());
-      }
-    }
-
-    MechanicsMaterial::FKresults FKres;
-    FKres.request = 2;
-    for(int e = 0; e < NumEl; e++)
-    {
-      // The dynamic allocation results in a memory leak + Seg fault. Not great.
-      // double* eleFirstPKStress = new (nothrow) double(dim*dim);
-      double eleFirstPKStress[dim * dim];
-      for (int i = 0; i < dim; i++)
-        for (int j = 0; j < dim; j++)
-          eleFirstPKStress[i*dim + j] = 0.0;
-
-      // double eleFirstPKStress[9] = {0.0};;
-      GeomElement* geomEl = elements[e];
-      const int numQP = geomEl->getNumberOfQuadPoints();
-      
-      // F at each quadrature point are computed at the same time in one element
-      vector<Matrix3d > Flist(numQP, Matrix3d::Zero());
-      // Compute deformation gradients for current element
-      this->computeDeformationGradient(Flist, geomEl);
+    // ~~ BEGIN: STRESS AND STRAIN ~~ //
+    // Volume averages over each element of the quadrature point values
+    // kept from the last compute, no material is evaluated here
+    if (_stressCellAverages) {
+      const char * TensorNames[9] = {"11", "12", "13", "21", "22", "23", "31", "32", "33"};
+      VTKArray & FirstPKStress = S->addCellArray("First_PK_Stress", 9, NumEl, TensorNames);
+      VTKArray & CauchyStress  = S->addCellArray("Cauchy_Stress", 9, NumEl, TensorNames);
+      VTKArray & GLStrain      = S->addCellArray("Green_Lagrange_Strain", 9, NumEl, TensorNames);
+      VTKArray & FiberStress   = S->addCellArray("Fiber_Stress", 1, NumEl);
+
+      for(int e = 0; e < NumEl; e++)
+      {
+	GeomElement* geomEl = elements[e];
+	const int numQP = geomEl->getNumberOfQuadPoints();
+	vector<Matrix3d > Flist(numQP, Matrix3d::Zero());
+	this->computeDeformationGradient(Flist, geomEl);
+
+	Real Volume = 0.0;
+	for (int q = 0; q < numQP; q++) {
+	  Matrix3d Sigma, E;
+	  Real Sff = 0.0;
+	  const Matrix3d & P = _qpStress[e*numQP + q];
+	  stressMeasures(Flist[q], P, _materials[e*numQP + q]->getDirectionVectors()[0], Sigma, E, Sff);
+
+	  const Real Vol = geomEl->getQPweights(q);
+	  Volume += Vol;
+	  for (int i = 0; i < 3; i++)
+	    for (int j = 0; j < 3; j++) {
+	      FirstPKStress(e, i*3 + j) += P(i,j)*Vol;
+	      CauchyStress(e, i*3 + j)  += Sigma(i,j)*Vol;
+	      GLStrain(e, i*3 + j)      += E(i,j)*Vol;
+	    }
+	  FiberStress(e, 0) += Sff*Vol;
+	}
 
-      // Loop over quadrature Points
-      // for (int q = 0; q < numQP; q++) {
-      //   _materials[e]->compute(FKres, Flist[q], &Fiber);
-      /*
-      WARNING
-      THIS ONLY WORKS WITH 1QP PER ELEMENT - BAD - NEEDS TO BE CHANGED!!
-      */
-      // }
-      // Read through this on how to visualize data at integration points:
-      // http://www.vtk.org/Wiki/VTK/VTK_integration_point_support
-
-      _materials[e*numQP + 0]->compute(FKres, Flist[0]);
-      
-      for (int i = 0; i < dim; i++)
-	for (int j = 0; j < dim; j++) 
-	  eleFirstPKStress[i*3 + j] = FKres.P(i,j);
-      
-      FirstPKStress->InsertNextTuple(eleFirstPKStress);
-      // delete eleFirstPKStress;
+	for (int k = 0; k < 9; k++) {
+	  FirstPKStress(e, k) /= Volume;
+	  CauchyStress(e, k)  /= Volume;
+	  GLStrain(e, k)      /= Volume;
+	}
+	FiberStress(e, 0) /= Volume;
+      }
     }
-    newUnstructuredGrid->GetCellData()->AddArray(FirstPKStress);
-    // ~~ END: 1ST PIOLA-KIRCHHOFF STRESS ~~ //
+    // ~~ END: STRESS AND STRAIN ~~ //
     // ** END: CELL DATA ** //
 
-    // Write file
-    vtkSmartPointer<vtkXMLUnstructuredGridWriter> writer = vtkSmartPointer<vtkXMLUnstructuredGridWriter>::New();
-    writer->SetFileName(outputFileName.c_str());
-    writer->SetInput(newUnstructuredGrid);
-    writer->Write();
+    this->output(S);
     
     // ** BEGIN: SUPPORT FOR INTEGRATION POINTS ** //
+    if (_stressQuadraturePoints)
+      writeQuadraturePointStress(OutputFile, step);
+
     // ~~ BEGIN: PLOT PRESSURE NORMALS ~~ //
     if (_pressureFlag) 
       writePressurePolyData(OutputFile, step);
@@ -1098,188 +1374,153 @@ namespace voom {
       writeTorsionalSpringPolyData(OutputFile, step);
   } // writeOutput
 
+  void MechanicsModel::writeQuadraturePointStress(string OutputFile, int step) {
+
+    int dim = _myMesh->getDimension();
+    this->updateOutputState();
+
+    VTKSnapshot * S = newSnapshot(OutputFile + "_QPStress", step, ".vtp");
+
+    const vector <GeomElement*> & elements = _myMesh->getElements();
+    int NumPoints = 0;
+    for (uint e = 0; e < elements.size(); e++)
+      NumPoints += elements[e]->getNumberOfQuadPoints();
+    S->points.assign(3*NumPoints, 0.0);
+    const char * TensorNames[9] = {"11", "12", "13", "21", "22", "23", "31", "32", "33"};
+    VTKArray & Displacements = S->addPointArray("Displacements", 3, NumPoints);
+    VTKArray & FirstPKStress = S->addPointArray("First_PK_Stress", 9, NumPoints, TensorNames);
+    VTKArray & CauchyStress  = S->addPointArray("Cauchy_Stress", 9, NumPoints, TensorNames);
+    VTKArray & GLStrain      = S->addPointArray("Green_Lagrange_Strain", 9, NumPoints, TensorNames);
+    VTKArray & FiberStress   = S->addPointArray("Fiber_Stress", 1, NumPoints);
+
+    int p = 0;
+    for (uint e = 0; e < elements.size(); e++) {
+      GeomElement* geomEl = elements[e];
+      const int numQP = geomEl->getNumberOfQuadPoints();
+      const vector<int>& NodesID = geomEl->getNodesID();
+      vector<Matrix3d > Flist(numQP, Matrix3d::Zero());
+      this->computeDeformationGradient(Flist, geomEl);
+
+      for (int q = 0; q < numQP; q++, p++) {
+	for (int d = 0; d < dim; d++)
+	  for (uint n = 0; n < NodesID.size(); n++) {
+	    S->points[3*p + d] += _myMesh->getX(NodesID[n], d) * geomEl->getN(q, n);
+	    Displacements(p, d) += (_field[NodesID[n]*dim + d] - _myMesh->getX(NodesID[n], d)) * geomEl->getN(q, n);
+	  }
+
+	Matrix3d Sigma, E;
+	const Matrix3d & P = _qpStress[e*numQP + q];
+	stressMeasures(Flist[q], P, _materials[e*numQP + q]->getDirectionVectors()[0], Sigma, E, FiberStress(p, 0));
+	for (int i = 0; i < 3; i++)
+	  for (int j = 0; j < 3; j++) {
+	    FirstPKStress(p, i*3 + j) = P(i,j);
+	    CauchyStress(p, i*3 + j)  = Sigma(i,j);
+	    GLStrain(p, i*3 + j)      = E(i,j);
+	  }
+      }
+    }
+
+    this->output(S);
+  }
+
   void MechanicsModel::writePressurePolyData(string OutputFile, int step) {
 
     int dim = _myMesh->getDimension();
 
-    string outputIntegrationPointDataFileName = OutputFile + "_IntPointData" + boost::lexical_cast<string>(step) + ".vtp";
-    vtkSmartPointer<vtkPolyData> IntegrationPointGrid = vtkSmartPointer<vtkPolyData>::New();
-    vtkSmartPointer<vtkPoints> IntegrationPoints = vtkSmartPointer<vtkPoints>::New();
-    vtkSmartPointer<vtkDoubleArray> IntegrationPointsDisplacements = vtkSmartPointer<vtkDoubleArray>::New();
-    IntegrationPointsDisplacements->SetNumberOfComponents(3);
-    IntegrationPointsDisplacements->SetName("Displacements");
+    VTKSnapshot * S = newSnapshot(OutputFile + "_IntPointData", step, ".vtp");
 
-    vector <GeomElement*> elements2D = _surfaceMesh->getElements();
+    const vector <GeomElement*> & elements2D = _surfaceMesh->getElements();
+    int NumPoints = 0;
+    for (uint e = 0; e < elements2D.size(); e++)
+      NumPoints += elements2D[e]->getNumberOfQuadPoints();
+    S->points.assign(3*NumPoints, 0.0);
+    VTKArray & IntegrationPointsDisplacements = S->addPointArray("Displacements", 3, NumPoints);
+    // Compute Normals:
+    VTKArray & pressureNormal = S->addPointArray("Pressure_Normals", 3, NumPoints);
+
+    int p = 0;
     for (int e = 0; e < elements2D.size(); e++) {
       GeomElement* geomEl = elements2D[e];
       const int numQP = geomEl->getNumberOfQuadPoints();
       const vector<int>& NodesID = geomEl->getNodesID();
       const uint numNodesOfEl = NodesID.size();
 
-      for (int q = 0; q < numQP; q++) {
-	float tempDisplacement[3] = {0.0}; float tempPoint[3] = {0.0};
+      for (int q = 0; q < numQP; q++, p++) {
 	for (int d = 0; d < dim; d++) {
 	  for (int n = 0; n < numNodesOfEl; n++) {
-	    tempPoint[d] += _surfaceMesh->getX(n)(d) * geomEl->getN(q,n);
-	    tempDisplacement[d] += (_field[NodesID[n]*dim + d] - _surfaceMesh->getX(n)(d)) * geomEl->getN(q, n);
+	    S->points[3*p + d] += _surfaceMesh->getX(NodesID[n])(d) * geomEl->getN(q,n);
+	    IntegrationPointsDisplacements(p, d) += (_field[NodesID[n]*dim + d] - _surfaceMesh->getX(NodesID[n])(d)) * geomEl->getN(q, n);
 	  }
 	}
-	IntegrationPoints->InsertNextPoint(tempPoint);
-	IntegrationPointsDisplacements->InsertNextTuple(tempDisplacement);
-      }
-    }
-    IntegrationPointGrid->SetPoints(IntegrationPoints);
-    IntegrationPointGrid->GetPointData()->AddArray(IntegrationPointsDisplacements);
-
 
-    // Compute Normals:
-    vtkSmartPointer<vtkDoubleArray> pressureNormal = vtkSmartPointer<vtkDoubleArray>::New();
-    pressureNormal->SetNumberOfComponents(3);
-    pressureNormal->SetName("Pressure_Normals");
-    for(int e = 0; e < elements2D.size(); e++) {
-      GeomElement* geomEl = elements2D[e];
-      const vector<int  >& NodesID = geomEl->getNodesID();
-      const int numQP    = geomEl->getNumberOfQuadPoints();
-      const int numNodes = NodesID.size();
-	
-      // Loop over quadrature points
-      for(int q = 0; q < numQP; q++) {
 	// Compute normal based on _prevField and displacement
 	Vector3d a1 = Vector3d::Zero(), a2 = Vector3d::Zero(), a3 = Vector3d::Zero();
 	for (int a = 0; a < NodesID.size(); a++) {
 	  int nodeID = NodesID[a];
-	  Vector3d xa_prev, xa_curr;
+	  Vector3d xa_prev;
 	  xa_prev << _prevField[nodeID*3], _prevField[nodeID*3+1], _prevField[nodeID*3+2];
-	  xa_curr << _field[nodeID*3], _field[nodeID*3+1], _field[nodeID*3+2];
 	  a1 += xa_prev*geomEl->getDN(q, a, 0);
 	  a2 += xa_prev*geomEl->getDN(q, a, 1);
 	}
 	a3 = a1.cross(a2);
-	  
-	// Surface associated with QP q
-	Real Area = a3.norm();
-	a3 /= Area;
-	double tempNormal[3] = {a3[0], a3[1], a3[2]};
-	pressureNormal->InsertNextTuple(tempNormal);
+	a3.normalize();
+	for (int d = 0; d < 3; d++)
+	  pressureNormal(p, d) = a3(d);
       }
     }
-    IntegrationPointGrid->GetPointData()->AddArray(pressureNormal);
-
-    // Write File
-    vtkSmartPointer<vtkXMLPolyDataWriter> IntegrationPointWriter = vtkSmartPointer<vtkXMLPolyDataWriter>::New();
-    IntegrationPointWriter->SetFileName(outputIntegrationPointDataFileName.c_str());
-    IntegrationPointWriter->SetInput(IntegrationPointGrid);
-    IntegrationPointWriter->Write();
-    // ** END: SUPPORT FOR INTEGRATION POINTS ** //
+
+    this->output(S);
   }
 
   void MechanicsModel::writeLinearSpringPolyData(string OutputFile, int step) {
     int dim = _myMesh->getDimension();
 
-    string outputIntegrationPointDataFileName = OutputFile + "_LinearSpring" + boost::lexical_cast<string>(step) + ".vtp";
-    vtkSmartPointer<vtkPolyData> IntegrationPointGrid = vtkSmartPointer<vtkPolyData>::New();
-    vtkSmartPointer<vtkPoints> IntegrationPoints = vtkSmartPointer<vtkPoints>::New();
-    vtkSmartPointer<vtkDoubleArray> IntegrationPointsDisplacements = vtkSmartPointer<vtkDoubleArray>::New();
-    IntegrationPointsDisplacements->SetNumberOfComponents(3);
-    IntegrationPointsDisplacements->SetName("Displacements");
-
-    vtkSmartPointer<vtkDoubleArray> LinearSpringForces = vtkSmartPointer<vtkDoubleArray>::New();
-    LinearSpringForces->SetNumberOfComponents(3);
-    LinearSpringForces->SetName("LinearSpring_Force");
+    VTKSnapshot * S = newSnapshot(OutputFile + "_LinearSpring", step, ".vtp");
 
-    uint PbDoF = ( _myMesh->getNumberOfNodes())*this->getDoFperNode();
-    EigenResult myResults(PbDoF, 0);
-    myResults.resetResidualToZero();
-    ComputeRequest myRequest = FORCE;
-
-    myResults.setRequest(myRequest);
-    this->applySpringBC(myResults);
-    VectorXd R = *(myResults._residual);
-
-    vector <GeomElement*> elements2D = _spMesh->getElements();
-    for (int n = 0; n < _spNodes.size(); n++) {
-      float tempDisplacement[3] = {0.0}; float tempPoint[3] = {0.0};
+    const int NumPoints = _spNodes.size();
+    S->points.assign(3*NumPoints, 0.0);
+    VTKArray & IntegrationPointsDisplacements = S->addPointArray("Displacements", 3, NumPoints);
+    VTKArray & LinearSpringForces = S->addPointArray("LinearSpring_Force", 3, NumPoints);
+    VTKArray & spNormal = S->addPointArray("LinearSpring_Normals", 3, NumPoints);
 
+    for (int n = 0; n < NumPoints; n++) {
       // Compute Spring Force also
-      float tempSpringForce[3] = {0.0};
       Vector3d xa_prev, xa_curr;
       xa_prev << _prevField[_spNodes[n]*3], _prevField[_spNodes[n]*3+1], _prevField[_spNodes[n]*3+2];
       xa_curr << _field[_spNodes[n]*3], _field[_spNodes[n]*3+1], _field[_spNodes[n]*3+2];
 
       for (int d = 0; d < dim; d++) {
-        tempPoint[d] = _spMesh->getX(n)(d);
-	tempDisplacement[d] = (_field[_spNodes[n]*dim + d] - _spMesh->getX(n)(d));
-        tempSpringForce[d] =  _springK*_spNormals[n](d)*(xa_curr - xa_prev).dot(_spNormals[n]); 
+        S->points[3*n + d] = _spMesh->getX(_spNodes[n])(d);
+	IntegrationPointsDisplacements(n, d) = (_field[_spNodes[n]*dim + d] - _spMesh->getX(_spNodes[n])(d));
+        LinearSpringForces(n, d) =  _springK*_spNormals[n](d)*(xa_curr - xa_prev).dot(_spNormals[n]); 
       }
-      // cout << "Spring Force:\t" << tempSpringForce[0] << "\t" << tempSpringForce[1] << "\t" << tempSpringForce[2] << endl;
-      IntegrationPoints->InsertNextPoint(tempPoint);
-      IntegrationPointsDisplacements->InsertNextTuple(tempDisplacement);
-      LinearSpringForces->InsertNextTuple(tempSpringForce);
-    }
-    
-    IntegrationPointGrid->SetPoints(IntegrationPoints);
-    IntegrationPointGrid->GetPointData()->AddArray(IntegrationPointsDisplacements);
-    IntegrationPointGrid->GetPointData()->AddArray(LinearSpringForces);
-
-    // Compute Normals:
-    vtkSmartPointer<vtkDoubleArray> spNormal = vtkSmartPointer<vtkDoubleArray>::New();
-    spNormal->SetNumberOfComponents(3);
-    spNormal->SetName("LinearSpring_Normals");
-
-    for (int n = 0; n < _spNormals.size(); n++) {
-      double tempSpNormal[3] = {_spNormals[n](0), _spNormals[n](1), _spNormals[n](2)};
-      spNormal->InsertNextTuple(tempSpNormal);
+      for (int d = 0; d < 3; d++)
+	spNormal(n, d) = _spNormals[n](d);
     }
 
-    IntegrationPointGrid->GetPointData()->AddArray(spNormal);
-
-    // Write File
-    vtkSmartPointer<vtkXMLPolyDataWriter> IntegrationPointWriter = vtkSmartPointer<vtkXMLPolyDataWriter>::New();
-    IntegrationPointWriter->SetFileName(outputIntegrationPointDataFileName.c_str());
-    IntegrationPointWriter->SetInput(IntegrationPointGrid);
-    IntegrationPointWriter->Write();
+    this->output(S);
   }
 
   void MechanicsModel::writeTorsionalSpringPolyData(string OutputFile, int step) {
     int dim = _myMesh->getDimension();
 
-    string outputIntegrationPointDataFileName = OutputFile + "_TorsionalSpring" + boost::lexical_cast<string>(step) + ".vtp";
-    vtkSmartPointer<vtkPolyData> IntegrationPointGrid = vtkSmartPointer<vtkPolyData>::New();
-    vtkSmartPointer<vtkPoints> IntegrationPoints = vtkSmartPointer<vtkPoints>::New();
-    vtkSmartPointer<vtkDoubleArray> IntegrationPointsDisplacements = vtkSmartPointer<vtkDoubleArray>::New();
-    IntegrationPointsDisplacements->SetNumberOfComponents(3);
-    IntegrationPointsDisplacements->SetName("Displacements");
+    VTKSnapshot * S = newSnapshot(OutputFile + "_TorsionalSpring", step, ".vtp");
+
+    const int NumPoints = _torsionalSpringNodes.size();
+    S->points.assign(3*NumPoints, 0.0);
+    VTKArray & IntegrationPointsDisplacements = S->addPointArray("Displacements", 3, NumPoints);
+    VTKArray & spNormal = S->addPointArray("TorsionalSpring_Normals", 3, NumPoints);
 
-    for (int n = 0; n < _torsionalSpringNodes.size(); n++) {
-      float tempDisplacement[3] = {0.0}; float tempPoint[3] = {0.0};
+    for (int n = 0; n < NumPoints; n++) {
       for (int d = 0; d < dim; d++) {
-        tempPoint[d] = _myMesh->getX(_torsionalSpringNodes[n])(d);
-        tempDisplacement[d] = (_field[_torsionalSpringNodes[n]*dim + d] - _myMesh->getX(_torsionalSpringNodes[n])(d));
+        S->points[3*n + d] = _myMesh->getX(_torsionalSpringNodes[n])(d);
+        IntegrationPointsDisplacements(n, d) = (_field[_torsionalSpringNodes[n]*dim + d] - _myMesh->getX(_torsionalSpringNodes[n])(d));
       }
-      IntegrationPoints->InsertNextPoint(tempPoint);
-      IntegrationPointsDisplacements->InsertNextTuple(tempDisplacement);
+      for (int d = 0; d < 3; d++)
+	spNormal(n, d) = _spTangents[n](d);
     }
 
-    IntegrationPointGrid->SetPoints(IntegrationPoints);
-    IntegrationPointGrid->GetPointData()->AddArray(IntegrationPointsDisplacements);
-
-    // Compute Normals:
-    vtkSmartPointer<vtkDoubleArray> spNormal = vtkSmartPointer<vtkDoubleArray>::New();
-    spNormal->SetNumberOfComponents(3);
-    spNormal->SetName("TorsionalSpring_Normals");
-
-    for (int n = 0; n < _spTangents.size(); n++) {
-      double tempSpNormal[3] = {_spTangents[n](0), _spTangents[n](1), _spTangents[n](2)};
-      spNormal->InsertNextTuple(tempSpNormal);
-    }
-
-    IntegrationPointGrid->GetPointData()->AddArray(spNormal);
-
-    // Write File
-    vtkSmartPointer<vtkXMLPolyDataWriter> IntegrationPointWriter = vtkSmartPointer<vtkXMLPolyDataWriter>::New();
-    IntegrationPointWriter->SetFileName(outputIntegrationPointDataFileName.c_str());
-    IntegrationPointWriter->SetInput(IntegrationPointGrid);
-    IntegrationPointWriter->Write();
+    this->output(S);
   }
 
 } // namespace voom
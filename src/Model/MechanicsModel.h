@@ -5,25 +5,9 @@
 #include "Model.h"
 #include "MechanicsMaterial.h"
 #include "EigenResult.h"
-
-// Include files for Writing Output:
-#include <boost/lexical_cast.hpp>
-#include <vtkVersion.h>
-#include <vtkIdList.h>
-#include <vtkPoints.h>
-#include <vtkPointData.h>
-#include <vtkCellData.h>
-#include <vtkTensor.h>
-#include <vtkSmartPointer.h>
-#include <vtkUnstructuredGrid.h>
-#include <vtkPolyData.h>
-#include <vtkPolyDataWriter.h>
-#include <vtkUnstructuredGridWriter.h>
-#include <vtkXMLPolyDataWriter.h>
-#include <vtkXMLUnstructuredGridWriter.h>
-#include <vtkCellType.h>
-#include <vtkCellArray.h>
-#include <vtkDoubleArray.h>
+#include "AsyncVTKWriter.h"
+#include "XDMFTimeSeries.h"
+#include <sstream>
 
 namespace voom{
 
@@ -50,6 +34,11 @@ namespace voom{
 
     //! Destructor
     ~MechanicsModel() {
+      // Files still queued are written first
+      delete _writer;
+      _writer = NULL;
+      this->closeTimeSeries();
+
       set<MechanicsMaterial *> UNIQUEmaterials;
       for (uint i = 0; i < _materials.size(); i++)
 	  UNIQUEmaterials.insert(_materials[i]);
@@ -141,6 +130,16 @@ namespace voom{
       out.close();
     }
 
+    //! Write the state needed to restart a run in binary: field,
+    //! previous field, pressure, spring normals, tangents and centroid,
+    //! history variables of every material, and Step and Time of the
+    //! time loop. FileName is replaced only once the checkpoint is complete.
+    void writeCheckpoint(const string & FileName, int Step, Real Time);
+
+    //! Restore a checkpoint written for the same mesh, materials and
+    //! boundary conditions, and return its Step and Time
+    void readCheckpoint(const string & FileName, int & Step, Real & Time);
+
     uint getNumMat() {
       set<MechanicsMaterial *> UNIQUEmaterials;
       for (uint i = 0; i < _materials.size(); i++)
@@ -177,6 +176,51 @@ namespace voom{
     //! Write output
     void writeOutputVTK(const string OutputFile, int step);
 
+    //! Output the residual and stress of the last compute with FORCE
+    //! instead of assembling them again in writeOutputVTK (off by
+    //! default). They are only checked against the field, previous field
+    //! and pressure: call invalidateOutputState after changing the
+    //! materials (updateStateVariables, setActivationMultiplier,
+    //! setTimestep, setMaterialParameters) without a new solve.
+    void setKeepOutputState(bool KeepOutputState) {
+      _keepOutputState = KeepOutputState;
+    }
+
+    //! Assemble the residual and stress again at the next output
+    void invalidateOutputState() {
+      _lastResidualField.clear();
+    }
+
+    //! Write VTK files on a background thread: writeOutputVTK only copies
+    //! the data and returns, at most MaxQueued outputs wait to be written.
+    //! MaxQueued = 0 goes back to writing in the calling thread.
+    void setAsynchronousOutput(int MaxQueued = 2);
+
+    //! Wait until all VTK files are written
+    void flushOutput();
+
+    //! Write each output (mesh, quadrature point stress, pressure,
+    //! springs) as one XDMF time series, OutputFile.xmf, instead of a
+    //! VTK file per step: points and cells are written once, the arrays
+    //! of each step appended to one binary file, as floats with
+    //! SinglePrecision. Switching it off closes the series.
+    void setTimeSeriesOutput(bool TimeSeries, bool SinglePrecision = false);
+
+    //! Stress and strain output of writeOutputVTK: volume averages over
+    //! each element as cell data and/or values at each quadrature point,
+    //! written by writeQuadraturePointStress. Both use the stress kept
+    //! from the last compute with FORCE; none is kept if both are off.
+    void setStressOutput(bool CellAverages, bool QuadraturePoints = false) {
+      _stressCellAverages = CellAverages;
+      _stressQuadraturePoints = QuadraturePoints;
+      if (!CellAverages && !QuadraturePoints)
+	vector<Matrix3d >().swap(_qpStress);
+    }
+
+    //! Write P, Cauchy stress, Green-Lagrange strain and fiber stress at
+    //! the quadrature points as a point cloud
+    void writeQuadraturePointStress(string OutputFile, int step);
+
     //! Write VTK output for normals of pressure
     void writePressurePolyData(string OutputFile, int step);
 
@@ -231,6 +275,13 @@ namespace voom{
     //! Compute Green Lagrangian Strain Tensor
     void computeGreenLagrangianStrainTensor(vector<Matrix3d> & Elist, GeomElement* geomEl);
 
+    //! Energy, residual, stiffness triplets (from Ktriplets) and dRdalpha
+    //! of a linear tetrahedron: F, the gradients and the contractions with
+    //! the quadrature point sums of P and K are computed once per element
+    void computeAffineElement(Result * R, const int e, MechanicsMaterial::FKresults & FKres,
+			      Real & Energy, Triplet<Real > * Ktriplets,
+			      vector<VectorXd > & dRdalpha, const int NumPropPerMat);
+
     //! List of Material data at each QP in the model
     vector<MechanicsMaterial * > _materials;
 
@@ -256,7 +307,6 @@ namespace voom{
     vector<int > _spNodes;
     Mesh* _spMesh;
     Real _springK;
-    vector<vector<int > > _spNodesToEle;
     vector<Vector3d > _spNormals;
 
     // Torsional Spring BC
@@ -265,6 +315,48 @@ namespace voom{
     Vector3d _centroidLocation;
     Real _torsionalSpringK;
     vector<Vector3d> _spTangents;
+
+    //! Snapshot to be written to Name + step + Extension, or to the step
+    //! of the time series Name
+    VTKSnapshot * newSnapshot(const string & Name, int step, const string & Extension);
+
+    //! Write Snapshot, now or through _writer, and delete it
+    void output(VTKSnapshot * Snapshot);
+
+    void closeTimeSeries();
+
+    bool _timeSeries, _singlePrecision;
+    map<string, XDMFTimeSeries * > _series;
+
+    //! Background writer, NULL to write in the calling thread
+    AsyncVTKWriter * _writer;
+
+    //! Residual of the last compute with FORCE. With _keepOutputState,
+    //! also the field, previous field and pressure it was computed at:
+    //! writeOutputVTK outputs it instead of assembling the residual again
+    //! while they are unchanged.
+    bool _keepOutputState;
+    vector<Real > _lastResidual, _lastResidualField, _lastResidualPrevField;
+    Real _lastResidualPressure;
+
+    //! First Piola-Kirchhoff stress at each quadrature point (indexed as
+    //! _materials) from the same compute as _lastResidual
+    bool _stressCellAverages, _stressQuadraturePoints;
+    vector<Matrix3d > _qpStress;
+
+    bool captureStress(int Request) const {
+      return (Request & FORCE) && (_stressCellAverages || _stressQuadraturePoints);
+    }
+
+    //! Assemble the residual again, and the stress if output, unless
+    //! the ones kept are current
+    void updateOutputState();
+
+    //! Is _lastResidual kept and computed at the current state?
+    bool lastResidualIsCurrent() const {
+      return _keepOutputState && !_lastResidualField.empty() && _lastResidualField == _field &&
+	_lastResidualPrevField == _prevField && _lastResidualPressure == _pressure;
+    }
   };
 
 } // namespace voom
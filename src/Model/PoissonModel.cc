@@ -22,7 +22,6 @@ namespace voom {
   void PoissonModel::compute(Result & R) 
   {
     const vector<GeomElement* > elements = _myMesh->getElements();
-    const int AvgNodePerEl = ((elements[0])->getNodesID()).size();
     const int NumEl = elements.size();
     const int dim = _myMesh->getDimension();
     vector<Triplet<Real > > KtripletList;
@@ -38,16 +37,36 @@ namespace voom {
     }
     if ( R.getRequest() & STIFFNESS ) { 
       R.resetStiffnessToZero();
-      KtripletList.reserve(NumEl*AvgNodePerEl*AvgNodePerEl);
     }
     
     
 
-    // Loop through elements, also through material points array, which is unrolled
-    DiffusionMaterial::DiffusionResults DiffRes;
-    for(int e = 0; e < NumEl; e++)
+    // Stiffness triplets of element e are stored from KtripletOffset[e]
+    vector<int > KtripletOffset(NumEl + 1, 0);
+    if ( R.getRequest() & STIFFNESS ) {
+      for(int e = 0; e < NumEl; e++) {
+	const int numNodes = elements[e]->getNodesID().size();
+	KtripletOffset[e + 1] = KtripletOffset[e] +
+	  elements[e]->getNumberOfQuadPoints()*numNodes*numNodes;
+      }
+      KtripletList.resize(KtripletOffset[NumEl]);
+    }
+
+    // Loop through elements, also through material points array, which is unrolled.
+    // Elements of one color share no node and are assembled in parallel
+    const vector<int > & colorOffsets = _myMesh->getColorOffsets();
+    const vector<int > & colorElements = _myMesh->getColorElements();
+    const int NumColors = int(colorOffsets.size()) - 1;
+    for (int c = 0; c < NumColors; c++) {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for(int ce = colorOffsets[c]; ce < colorOffsets[c + 1]; ce++)
     {
+      const int e = colorElements[ce];
+      DiffusionMaterial::DiffusionResults DiffRes;
       GeomElement* geomEl = elements[e];
+      int t = KtripletOffset[e];
       const vector<int  >& NodesID = geomEl->getNodesID();
       const int numQP    = geomEl->getNumberOfQuadPoints();
       const int numNodes = NodesID.size();
@@ -88,13 +107,14 @@ namespace voom {
     		} // J loop
     	      } // I loop
     	      tempStiffness *= Vol;
-	      KtripletList.push_back( Triplet<Real >( NodesID[a], NodesID[b], tempStiffness ) );
+	      KtripletList[t++] = Triplet<Real >( NodesID[a], NodesID[b], tempStiffness );
     	    } // b loop
     	  } //a loop
 	} // Compute hessian matrix
       } // q loop
   
     } // element loop
+    } // color loop
     
     // Sum up all stiffness entries with the same indices
     if ( R.getRequest() & STIFFNESS ) {
@@ -0,0 +1,71 @@
+//-*-C++-*-
+/*!
+  \file ModelTestFixtures.h
+  \brief Meshes, boundary conditions and file readers shared by the
+  Model tests.
+*/
+
+#ifndef __ModelTestFixtures_h__
+#define __ModelTestFixtures_h__
+
+#include "AsyncVTKWriter.h"
+#include "Mesh.h"
+#include <sstream>
+#include <vtkCellType.h>
+
+namespace voom
+{
+  //! Strip of NumTets linear tetrahedra along x, NumTets + 3 points
+  inline void tetStrip(VTKSnapshot & S, int NumTets)
+  {
+    S.cellType = VTK_TETRA;
+    S.nodesPerCell = 4;
+    for (int i = 0; i < NumTets + 3; i++) {
+      S.points.push_back(Real(i));
+      S.points.push_back(Real(i % 2));
+      S.points.push_back(Real((i/2) % 2));
+    }
+    for (int e = 0; e < NumTets; e++)
+      for (int n = 0; n < 4; n++)
+	S.connectivity.push_back(e + n);
+  }
+
+  //! Symmetry planes x = y = z = 0 of the [0,2]^3 cube, the x = 2 face
+  //! moved to x = FaceX
+  inline void cubeStretchBC(Mesh & Cube, Real FaceX, vector<int > & BCid,
+			    vector<Real > & BCvalues)
+  {
+    BCid.clear();
+    BCvalues.clear();
+    for (int i = 0; i < Cube.getNumberOfNodes(); i++) {
+      for (uint d = 0; d < 3; d++)
+	if (Cube.getX(i)(d) < 1.0e-8) {
+	  BCid.push_back(3*i + d);
+	  BCvalues.push_back(0.0);
+	}
+      if (Cube.getX(i)(0) > 2.0 - 1.0e-8) {
+	BCid.push_back(3*i);
+	BCvalues.push_back(FaceX);
+      }
+    }
+  }
+
+  //! Contents of a file, empty if it cannot be read
+  inline string readFile(const string & FileName)
+  {
+    ifstream in(FileName.c_str(), ios::in | ios::binary);
+    stringstream contents;
+    if (in) contents << in.rdbuf();
+    return contents.str();
+  }
+
+  //! Seek offset of the first DataItem at or after position At of the
+  //! XDMF text Xml, -1 if there is none
+  inline long seekAfter(const string & Xml, size_t At)
+  {
+    const size_t seek = Xml.find("Seek=\"", At);
+    return seek == string::npos ? -1 : atol(Xml.c_str() + seek + 6);
+  }
+}
+
+#endif
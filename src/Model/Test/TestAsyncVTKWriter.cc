@@ -0,0 +1,98 @@
+#include "ModelTestFixtures.h"
+#include <cstdio>
+
+using namespace voom;
+
+// Strip of NumTets tetrahedra along x, with a point and a cell array
+VTKSnapshot * valueStrip(const string & FileName, int NumTets, Real Value)
+{
+  // No file left from a previous run
+  remove(FileName.c_str());
+  VTKSnapshot * S = new VTKSnapshot;
+  S->fileName = FileName;
+  tetStrip(*S, NumTets);
+  const int NumPoints = NumTets + 3;
+
+  VTKArray & value = S->addPointArray("Value", 1, NumPoints);
+  for (int i = 0; i < NumPoints; i++) value(i, 0) = Value*Real(i);
+  const char * names[] = {"x", "y", "z"};
+  VTKArray & centroid = S->addCellArray("Centroid", 3, NumTets, names);
+  for (int e = 0; e < NumTets; e++)
+    for (int n = 0; n < 4; n++)
+      for (int j = 0; j < 3; j++)
+	centroid(e, j) += 0.25*S->points[3*(e + n) + j];
+  return S;
+}
+
+// Does the VTK XML file FileName have a piece of NumPoints points (and
+// NumCells cells, unless negative)?
+bool hasPiece(const string & FileName, int NumPoints, int NumCells = -1)
+{
+  const string contents = readFile(FileName);
+  stringstream points, cells;
+  points << "NumberOfPoints=\"" << NumPoints << "\"";
+  cells << "NumberOfCells=\"" << NumCells << "\"";
+  return contents.find(points.str()) != string::npos &&
+    (NumCells < 0 || contents.find(cells.str()) != string::npos);
+}
+
+string fileName(const string & Name, int i, const string & Extension)
+{
+  stringstream name;
+  name << Name << i << Extension;
+  return name.str();
+}
+
+int main()
+{
+  cout << endl << "Testing asynchronous VTK writer ... " << endl;
+
+  const int NumFiles = 10;
+
+  // Queue longer than MaxQueued: every file is complete after flush
+  {
+    AsyncVTKWriter writer(2);
+    for (int i = 0; i < NumFiles; i++)
+      writer.push(valueStrip(fileName("Async", i, ".vtu"), 100*(i + 1), Real(i)));
+    writer.flush();
+    bool pass = true;
+    for (int i = 0; i < NumFiles; i++)
+      pass = pass && hasPiece(fileName("Async", i, ".vtu"), 100*(i + 1) + 3, 100*(i + 1));
+    cout << "Files written by flush - " << (pass ? "PASSED" : "FAILED") << endl;
+  }
+
+  // Same files as written in the calling thread
+  {
+    bool pass = true;
+    for (int i = 0; i < NumFiles; i++) {
+      VTKSnapshot * S = valueStrip(fileName("Sync", i, ".vtu"), 100*(i + 1), Real(i));
+      AsyncVTKWriter::write(*S);
+      delete S;
+      const string sync = readFile(fileName("Sync", i, ".vtu"));
+      pass = pass && !sync.empty() && readFile(fileName("Async", i, ".vtu")) == sync;
+    }
+    cout << "Same files as synchronous output - " << (pass ? "PASSED" : "FAILED") << endl;
+  }
+
+  // The destructor writes the snapshots still queued
+  {
+    AsyncVTKWriter * writer = new AsyncVTKWriter(1);
+    for (int i = 0; i < NumFiles; i++)
+      writer->push(valueStrip(fileName("Drain", i, ".vtu"), 1000, Real(i)));
+    remove("Cloud.vtp");
+    VTKSnapshot * cloud = new VTKSnapshot;
+    cloud->fileName = "Cloud.vtp";
+    cloud->pointCloud = true;
+    cloud->points.assign(3*50, 1.0);
+    cloud->addPointArray("Value", 1, 50);
+    writer->push(cloud);
+    delete writer;
+
+    bool pass = hasPiece("Cloud.vtp", 50);
+    for (int i = 0; i < NumFiles; i++)
+      pass = pass && hasPiece(fileName("Drain", i, ".vtu"), 1003, 1000);
+    cout << "Queue written by the destructor - " << (pass ? "PASSED" : "FAILED") << endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,150 @@
+#include "FEMesh.h"
+#include "MechanicsModel.h"
+#include "CompNeoHookean.h"
+#include "PlasticMaterial.h"
+#include "APForceVelPotential.h"
+#include "BlankViscousPotential.h"
+#include "EigenNRsolver.h"
+#include "ModelTestFixtures.h"
+#include <unistd.h>
+#include <sys/wait.h>
+
+using namespace voom;
+
+const Real DeltaT = 0.01;
+
+// One plastic material per element, fibers along x
+vector<MechanicsMaterial * > plasticMaterials(int NumEl, MechanicsMaterial * Active,
+					      MechanicsMaterial * Passive, Potential * Kinetic,
+					      ViscousPotential * Viscous)
+{
+  vector<Vector3d > dirVec(3, Vector3d::Zero());
+  for (int i = 0; i < 3; i++) dirVec[i](i) = 1.0;
+  vector<MechanicsMaterial * > materials(NumEl, (MechanicsMaterial *)(NULL));
+  for (int e = 0; e < NumEl; e++) {
+    PlasticMaterial * PlMat = new PlasticMaterial(e, Active, Passive, Kinetic, Viscous);
+    PlMat->setDirectionVectors(dirVec);
+    PlMat->setHardeningParameters(Vector3d::Zero());
+    PlMat->setActiveDeformationGradient(Matrix3d::Identity());
+    PlMat->setTotalDeformationGradient(Matrix3d::Identity());
+    PlMat->setTimestep(DeltaT);
+    materials[e] = PlMat;
+  }
+  return materials;
+}
+
+// Step s of the run: the x = 2 face of the cube pulled a little further,
+// the activation raised, then the state moved on as in the applications
+void step(MechanicsModel & Model, FEMesh & Cube, vector<MechanicsMaterial * > & Materials, int s)
+{
+  vector<int > BCid;
+  vector<Real > BCvalues;
+  cubeStretchBC(Cube, 2.0 + 0.01*Real(s + 1), BCid, BCvalues);
+  for (uint k = 0; k < Materials.size(); k++)
+    Materials[k]->setActivationMultiplier(0.2*Real(s + 1));
+
+  EigenNRsolver mySolver(&Model, BCid, BCvalues, CHOL, 1.0e-12, 20);
+  mySolver.solve(DISP);
+  for (uint k = 0; k < Materials.size(); k++)
+    Materials[k]->updateStateVariables();
+  Model.invalidateOutputState();
+}
+
+// Does reading FileName into Model stop the program with an error? Read in
+// a child process, since the errors exit
+bool readFails(MechanicsModel & Model, const string & FileName)
+{
+  cout.flush();
+  const pid_t pid = fork();
+  if (pid == 0) {
+    int Step = 0;
+    Real Time = 0.0;
+    Model.readCheckpoint(FileName, Step, Time);
+    _exit(0);
+  }
+  int status = 0;
+  return pid > 0 && waitpid(pid, &status, 0) == pid &&
+    WIFEXITED(status) && WEXITSTATUS(status) == 1;
+}
+
+int main()
+{
+  cout << endl << "Testing checkpoint round trip ... " << endl;
+
+  FEMesh Cube("../../Mesh/Test/Cube.node", "../../Mesh/Test/Cube.ele");
+  const int NumNodes = Cube.getNumberOfNodes(), NumEl = Cube.getNumberOfElements();
+  CompNeoHookean PassiveMat(0, 4.0, 0.4), ActiveMat(0, 4.0, 0.4);
+  APForceVelPotential Kinetic(1.0, 500.0);
+  BlankViscousPotential Viscous;
+  const int NumSteps = 4, CheckpointStep = 2;
+
+  // Run interrupted by a checkpoint ...
+  vector<MechanicsMaterial * > materials = plasticMaterials(NumEl, &ActiveMat, &PassiveMat, &Kinetic, &Viscous);
+  MechanicsModel myModel(&Cube, materials, 3);
+  for (int s = 0; s < CheckpointStep; s++)
+    step(myModel, Cube, materials, s);
+  myModel.writeCheckpoint("Cube.ckp", CheckpointStep, DeltaT*Real(CheckpointStep));
+  for (int s = CheckpointStep; s < NumSteps; s++)
+    step(myModel, Cube, materials, s);
+
+  // ... and restarted from it in a fresh model
+  vector<MechanicsMaterial * > restarted = plasticMaterials(NumEl, &ActiveMat, &PassiveMat, &Kinetic, &Viscous);
+  MechanicsModel restartModel(&Cube, restarted, 3);
+  int Step = -1;
+  Real Time = -1.0;
+  restartModel.readCheckpoint("Cube.ckp", Step, Time);
+  bool pass = Step == CheckpointStep && Time == DeltaT*Real(CheckpointStep);
+  for (int s = Step; s < NumSteps; s++)
+    step(restartModel, Cube, restarted, s);
+
+  vector<Real > x(3*NumNodes, 0.0), restartX(3*NumNodes, 0.0);
+  myModel.getField(x);
+  restartModel.getField(restartX);
+  Real fieldDiff = 0.0, historyDiff = 0.0, plasticFlow = 0.0;
+  for (int i = 0; i < 3*NumNodes; i++)
+    fieldDiff = max(fieldDiff, fabs(x[i] - restartX[i]));
+  for (int e = 0; e < NumEl; e++) {
+    const vector<Real > H = materials[e]->getHistoryVariables();
+    const vector<Real > restartH = restarted[e]->getHistoryVariables();
+    pass = pass && H.size() == 21 && restartH.size() == 21;
+    for (uint k = 0; pass && k < H.size(); k++)
+      historyDiff = max(historyDiff, fabs(H[k] - restartH[k]));
+    // Hardening parameters moved from zero
+    plasticFlow = max(plasticFlow, Vector3d(H[18], H[19], H[20]).norm());
+  }
+  cout << "Field difference = " << fieldDiff << ", history difference = " << historyDiff
+       << ", largest hardening parameter = " << plasticFlow << endl;
+  cout << "Restart reproduces the run - "
+       << (pass && fieldDiff == 0.0 && historyDiff == 0.0 && plasticFlow > 1.0e-6 ?
+	   "PASSED" : "FAILED") << endl;
+
+  // Checkpoints written for another model are refused
+  cout << "Expect four checkpoint errors:" << endl;
+
+  // Different mesh: one more node
+  vector<VectorXd > Positions(NumNodes, VectorXd::Zero(3));
+  for (int i = 0; i < NumNodes; i++) Positions[i] = Cube.getX(i);
+  vector<vector<int > > Connectivity;
+  for (int e = 0; e < NumEl; e++) Connectivity.push_back(Cube.getElements()[e]->getNodesID());
+  Positions.push_back(VectorXd::Constant(3, 3.0));
+  FEMesh LargerCube(Positions, Connectivity, "C3D4");
+  MechanicsModel largerModel(&LargerCube, plasticMaterials(NumEl, &ActiveMat, &PassiveMat, &Kinetic, &Viscous), 3);
+
+  // Same nodes, half the elements: fewer materials
+  Positions.pop_back();
+  Connectivity.resize(NumEl/2);
+  FEMesh HalfCube(Positions, Connectivity, "C3D4");
+  MechanicsModel halfModel(&HalfCube, plasticMaterials(NumEl/2, &ActiveMat, &PassiveMat, &Kinetic, &Viscous), 3);
+
+  // Same mesh, materials without history
+  vector<MechanicsMaterial * > elastic(NumEl, (MechanicsMaterial *)(NULL));
+  for (int e = 0; e < NumEl; e++)
+    elastic[e] = new CompNeoHookean(e, 4.0, 0.4);
+  MechanicsModel elasticModel(&Cube, elastic, 3);
+
+  pass = readFails(largerModel, "Cube.ckp") && readFails(halfModel, "Cube.ckp") &&
+    readFails(elasticModel, "Cube.ckp") && readFails(restartModel, "../../Mesh/Test/Cube.node");
+  cout << "Mismatched checkpoints refused - " << (pass ? "PASSED" : "FAILED") << endl;
+
+  return 0;
+}
@@ -0,0 +1,87 @@
+#include "FEMesh.h"
+#include "MechanicsModel.h"
+#include "CompNeoHookean.h"
+#include "EigenNRsolver.h"
+#include "ModelTestFixtures.h"
+
+using namespace voom;
+
+// MechanicsModel with the residual kept for output exposed
+class OutputModel: public MechanicsModel
+{
+public:
+  OutputModel(Mesh * aMesh, vector<MechanicsMaterial * > Materials):
+    MechanicsModel(aMesh, Materials, 3) {};
+
+  const vector<Real > & getKeptResidual() const { return _lastResidual; }
+  bool keptResidualIsCurrent() const { return lastResidualIsCurrent(); }
+  void update() { updateOutputState(); }
+};
+
+// Largest difference between Residual and a new FORCE assembly
+Real assemblyDifference(OutputModel & Model, const vector<Real > & Residual)
+{
+  const int PbDoF = Residual.size();
+  EigenResult R(PbDoF, 0);
+  R.setRequest(FORCE);
+  Model.compute(&R);
+  Real diff = 0.0;
+  for (int i = 0; i < PbDoF; i++)
+    diff = max(diff, fabs(R.getResidual(i) - Residual[i]));
+  return diff;
+}
+
+int main()
+{
+  cout << endl << "Testing residual kept for output ... " << endl;
+
+  FEMesh Cube("../../Mesh/Test/Cube.node", "../../Mesh/Test/Cube.ele");
+  const int NumNodes = Cube.getNumberOfNodes(), NumEl = Cube.getNumberOfElements();
+  vector<MechanicsMaterial * > materials(NumEl, (MechanicsMaterial *)(NULL));
+  for (int e = 0; e < NumEl; e++)
+    materials[e] = new CompNeoHookean(e, 10.0, 1.0);
+  OutputModel myModel(&Cube, materials);
+
+  // Symmetry planes x = y = z = 0, x = 2 face stretched by 10%
+  vector<int > BCid;
+  vector<Real > BCvalues;
+  cubeStretchBC(Cube, 2.2, BCid, BCvalues);
+  EigenNRsolver mySolver(&myModel, BCid, BCvalues, CHOL, 1.0e-12, 20);
+  mySolver.solve(DISP);
+
+  // By default the residual is assembled again for output
+  const bool notKept = !myModel.keptResidualIsCurrent();
+  cout << "Residual not kept by default - " << (notKept ? "PASSED" : "FAILED") << endl;
+  myModel.setKeepOutputState(true);
+  mySolver.solve(DISP);
+
+  // Right after the solve, the residual kept is the one at the solution
+  vector<Real > kept = myModel.getKeptResidual();
+  Real reaction = 0.0;
+  for (uint i = 0; i < kept.size(); i++)
+    reaction = max(reaction, fabs(kept[i]));
+  Real diff = assemblyDifference(myModel, kept);
+  cout << "Kept residual - new assembly after solve = " << diff << " - "
+       << (int(kept.size()) == 3*NumNodes && reaction > 1.0e-3 && diff < 1.0e-12*reaction ?
+	   "PASSED" : "FAILED") << endl;
+
+  // Changing the materials is only seen once the output state is invalidated
+  vector<Real > stiffer(2, 10.0);
+  stiffer[1] = 2.0;
+  for (int e = 0; e < NumEl; e++)
+    materials[e]->setMaterialParameters(stiffer);
+  const bool stale = myModel.keptResidualIsCurrent();
+  myModel.invalidateOutputState();
+  const bool invalidated = !myModel.keptResidualIsCurrent();
+  myModel.update();
+  Real change = 0.0;
+  for (uint i = 0; i < kept.size(); i++)
+    change = max(change, fabs(myModel.getKeptResidual()[i] - kept[i]));
+  kept = myModel.getKeptResidual();
+  diff = assemblyDifference(myModel, kept);
+  cout << "Kept residual - new assembly after a material change = " << diff << " - "
+       << (stale && invalidated && change > 1.0e-3 && diff < 1.0e-12*reaction ?
+	   "PASSED" : "FAILED") << endl;
+
+  return 0;
+}
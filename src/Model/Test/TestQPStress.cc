@@ -0,0 +1,107 @@
+#include "FEMesh.h"
+#include "MechanicsModel.h"
+#include "CompNeoHookean.h"
+#include "ModelTestFixtures.h"
+
+using namespace voom;
+
+// Values of attribute Name of the first step of the XDMF time series
+// Series, Size of them; empty if not found
+vector<Real > readAttribute(const string & Series, const string & Name, int Size)
+{
+  const string xml = readFile(Series + ".xmf");
+  vector<Real > values;
+  const size_t at = xml.find("<Attribute Name=\"" + Name + "\"");
+  if (at == string::npos) return values;
+  const long seek = seekAfter(xml, at);
+  if (seek < 0) return values;
+
+  ifstream data((Series + "_data.bin").c_str(), ios::in | ios::binary);
+  data.seekg(seek);
+  values.resize(Size);
+  data.read(reinterpret_cast<char * >(&values[0]), Size*sizeof(Real));
+  if (!data) values.clear();
+  return values;
+}
+
+// Largest difference between the tensors (or scalars) of Values and Exact
+Real maxError(const vector<Real > & Values, const Real * Exact, int Components, int Tuples)
+{
+  if (int(Values.size()) != Components*Tuples) return 1.0e10;
+  Real error = 0.0;
+  for (int t = 0; t < Tuples; t++)
+    for (int k = 0; k < Components; k++)
+      error = max(error, fabs(Values[t*Components + k] - Exact[k]));
+  return error;
+}
+
+int main()
+{
+  cout << endl << "Testing stress output on a homogeneously deformed C3D10 cube ... " << endl;
+
+  FEMesh Cube("../../Mesh/Test/CubeQuad.node", "../../Mesh/Test/CubeQuad.ele");
+  const int NumNodes = Cube.getNumberOfNodes(), NumEl = Cube.getNumberOfElements();
+  const int NumQP = Cube.getElements()[0]->getNumberOfQuadPoints();
+  vector<MechanicsMaterial * > materials(NumEl*NumQP, (MechanicsMaterial *)(NULL));
+  for (int k = 0; k < NumEl*NumQP; k++)
+    materials[k] = new CompNeoHookean(k, 10.0, 1.0);
+  MechanicsModel myModel(&Cube, materials, 3);
+  myModel.setStressOutput(true, true);
+  myModel.setTimeSeriesOutput(true);
+
+  // x = F0 X
+  Matrix3d F0;
+  F0 << 1.10, 0.05, 0.00,
+        0.00, 0.95, 0.02,
+        0.01, 0.00, 1.05;
+  vector<Real > x(3*NumNodes, 0.0);
+  for (int i = 0; i < NumNodes; i++) {
+    const Vector3d X = Cube.getX(i).head(3);
+    const Vector3d xi = F0*X;
+    for (uint d = 0; d < 3; d++) x[3*i + d] = xi(d);
+  }
+  myModel.setField(&x[0]);
+  myModel.writeOutputVTK("Homogeneous", 0);
+  myModel.setTimeSeriesOutput(false);
+
+  // Analytic values: P from the material at F0, the others from P and F0,
+  // fiber along x in the reference configuration
+  MechanicsMaterial::FKresults FKres;
+  FKres.request = FORCE;
+  CompNeoHookean material(0, 10.0, 1.0);
+  material.compute(FKres, F0);
+  const Matrix3d P = FKres.P;
+  const Matrix3d Sigma = P*F0.transpose()/F0.determinant();
+  const Matrix3d E = 0.5*(F0.transpose()*F0 - Matrix3d::Identity());
+  const Vector3d f = F0.col(0);
+  const Real Sff = f.dot(Sigma*f)/f.squaredNorm();
+
+  // Row by row, as written
+  Real exactP[9], exactSigma[9], exactE[9];
+  for (int i = 0; i < 3; i++)
+    for (int j = 0; j < 3; j++) {
+      exactP[i*3 + j] = P(i,j);
+      exactSigma[i*3 + j] = Sigma(i,j);
+      exactE[i*3 + j] = E(i,j);
+    }
+  const Real tol = 1.0e-12*P.norm();
+
+  const string names[4] = {"First_PK_Stress", "Cauchy_Stress", "Green_Lagrange_Strain", "Fiber_Stress"};
+  const Real * exact[4] = {exactP, exactSigma, exactE, &Sff};
+  const int components[4] = {9, 9, 9, 1};
+  bool passQP = true, passCell = true;
+  for (int k = 0; k < 4; k++) {
+    const Real errorQP = maxError(readAttribute("Homogeneous_QPStress", names[k], components[k]*NumEl*NumQP),
+				  exact[k], components[k], NumEl*NumQP);
+    const Real errorCell = maxError(readAttribute("Homogeneous", names[k], components[k]*NumEl),
+				    exact[k], components[k], NumEl);
+    cout << names[k] << ": max error at quadrature points = " << errorQP
+	 << ", of cell averages = " << errorCell << endl;
+    passQP = passQP && errorQP < tol;
+    passCell = passCell && errorCell < tol;
+  }
+  cout << "Quadrature point values - " << (passQP ? "PASSED" : "FAILED") << endl;
+  cout << "Cell averages - " << (passCell ? "PASSED" : "FAILED") << endl;
+
+  return 0;
+}
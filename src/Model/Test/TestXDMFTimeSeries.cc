@@ -0,0 +1,99 @@
+#include "XDMFTimeSeries.h"
+#include "ModelTestFixtures.h"
+
+using namespace voom;
+
+// Seek offsets of the DataItems of Name.xmf pointing to File, in order
+vector<long > seeks(const string & Name, const string & File)
+{
+  const string xml = readFile(Name + ".xmf");
+  vector<long > offsets;
+  for (size_t at = xml.find("<DataItem"); at != string::npos; at = xml.find("<DataItem", at + 1)) {
+    const size_t end = xml.find("</DataItem>", at);
+    if (end == string::npos) continue;
+    if (xml.compare(end - File.size(), File.size(), File) == 0)
+      offsets.push_back(seekAfter(xml, at));
+  }
+  return offsets;
+}
+
+long fileSize(const string & FileName)
+{
+  ifstream in(FileName.c_str(), ios::in | ios::binary | ios::ate);
+  return in ? long(in.tellg()) : -1;
+}
+
+// Number of times Text appears in Name.xmf
+int count(const string & Name, const string & Text)
+{
+  const string xml = readFile(Name + ".xmf");
+  int n = 0;
+  for (size_t at = xml.find(Text); at != string::npos; at = xml.find(Text, at + 1)) n++;
+  return n;
+}
+
+int main()
+{
+  cout << endl << "Testing XDMF time series ... " << endl;
+
+  // Strip of tetrahedra with a displacement (point) and a stress (cell) array
+  const int NumTets = 50, NumPoints = NumTets + 3, NumSteps = 4;
+  VTKSnapshot S;
+  tetStrip(S, NumTets);
+  S.addPointArray("Displacement", 3, NumPoints);
+  S.addCellArray("Stress", 9, NumTets);
+
+  for (int precision = 0; precision < 2; precision++) {
+    const bool single = precision == 1;
+    const string Name = single ? "SeriesSingle" : "SeriesDouble";
+    const long RealSize = single ? sizeof(float) : sizeof(Real);
+    {
+      XDMFTimeSeries series(Name, single);
+      for (int s = 0; s < NumSteps; s++) {
+	S.step = s;
+	for (uint i = 0; i < S.pointData[0].values.size(); i++)
+	  S.pointData[0].values[i] = Real(s) + 0.5*Real(i);
+	for (uint i = 0; i < S.cellData[0].values.size(); i++)
+	  S.cellData[0].values[i] = -Real(s) - 0.25*Real(i);
+	series.append(S);
+      }
+    }
+
+    // Mesh once: connectivity, then points; the arrays of every step one
+    // after the other
+    const long ConnBytes = NumTets*4*sizeof(int);
+    const long PointBytes = 3*NumPoints*RealSize, CellBytes = 9*NumTets*RealSize;
+    bool pass = fileSize(Name + "_mesh.bin") == ConnBytes + 3*NumPoints*RealSize &&
+      fileSize(Name + "_data.bin") == NumSteps*(PointBytes + CellBytes);
+
+    const vector<long > mesh = seeks(Name, "_mesh.bin"), data = seeks(Name, "_data.bin");
+    pass = pass && int(mesh.size()) == 2*NumSteps && int(data.size()) == 2*NumSteps;
+    for (int s = 0; pass && s < NumSteps; s++)
+      pass = mesh[2*s] == 0 && mesh[2*s + 1] == ConnBytes &&
+	data[2*s] == s*(PointBytes + CellBytes) && data[2*s + 1] == s*(PointBytes + CellBytes) + PointBytes;
+
+    stringstream precisionAttribute;
+    precisionAttribute << "NumberType=\"Float\" Precision=\"" << RealSize << "\"";
+    pass = pass && count(Name, "<Grid Name=\"Step ") == NumSteps &&
+      count(Name, precisionAttribute.str()) == 3*NumSteps && count(Name, "</Xdmf>") == 1;
+
+    // Last step read back
+    ifstream in((Name + "_data.bin").c_str(), ios::in | ios::binary);
+    in.seekg(data[2*NumSteps - 1]);
+    for (int i = 0; pass && i < 9*NumTets; i++) {
+      Real value = 0.0;
+      if (single) {
+	float f = 0.0;
+	in.read(reinterpret_cast<char * >(&f), sizeof(float));
+	value = f;
+      }
+      else
+	in.read(reinterpret_cast<char * >(&value), sizeof(Real));
+      pass = in && value == -Real(NumSteps - 1) - 0.25*Real(i);
+    }
+    cout << (single ? "Single" : "Double") << " precision offsets and sizes - "
+	 << (pass ? "PASSED" : "FAILED") << endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,171 @@
+#include "XDMFTimeSeries.h"
+
+#include <sstream>
+#include <vtkCellType.h>
+
+namespace voom
+{
+  namespace
+  {
+    //! Closing tags, overwritten by the next step
+    const char * XMLTail = "    </Grid>\n  </Domain>\n</Xdmf>\n";
+
+    string topologyType(const VTKSnapshot & S)
+    {
+      if (S.pointCloud) return "Polyvertex";
+      switch (S.cellType) {
+      case VTK_TRIANGLE:             return "Triangle";
+      case VTK_QUADRATIC_TRIANGLE:   return "Triangle_6";
+      case VTK_TETRA:                return "Tetrahedron";
+      case VTK_QUADRATIC_TETRA:      return "Tet_10";
+      case VTK_HEXAHEDRON:           return "Hexahedron";
+      case VTK_QUADRATIC_HEXAHEDRON: return "Hex_20";
+      default:
+	cout << "** XDMFTimeSeries: VTK cell type " << S.cellType
+	     << " has no XDMF topology." << endl;
+	exit(1);
+      }
+    }
+
+    string attributeType(int Components)
+    {
+      switch (Components) {
+      case 1:  return "Scalar";
+      case 3:  return "Vector";
+      case 6:  return "Tensor6";
+      case 9:  return "Tensor";
+      default: return "Matrix";
+      }
+    }
+
+    string baseName(const string & Path)
+    {
+      const size_t slash = Path.find_last_of('/');
+      return slash == string::npos ? Path : Path.substr(slash + 1);
+    }
+
+    void open(ofstream & File, const string & FileName)
+    {
+      File.open(FileName.c_str(), ios::out | ios::binary | ios::trunc);
+      if (!File) {
+	cout << "** XDMFTimeSeries: cannot open " << FileName << endl;
+	exit(1);
+      }
+    }
+  }
+
+
+
+  XDMFTimeSeries::XDMFTimeSeries(const string & Name, bool SinglePrecision):
+    _name(Name), _singlePrecision(SinglePrecision), _numPoints(-1), _numCells(-1)
+  {
+    open(_xml, _name + ".xmf");
+    open(_mesh, _name + "_mesh.bin");
+    open(_data, _name + "_data.bin");
+
+    _xml << "<?xml version=\"1.0\" ?>\n"
+	 << "<Xdmf Version=\"2.0\">\n"
+	 << "  <Domain>\n"
+	 << "    <Grid Name=\"" << baseName(_name)
+	 << "\" GridType=\"Collection\" CollectionType=\"Temporal\">\n";
+    _xmlEnd = _xml.tellp();
+    _xml << XMLTail << flush;
+  }
+
+
+
+  string XDMFTimeSeries::writeValues(ofstream & File, const string & FileName,
+				     const vector<Real > & Values, int Tuples, int Components)
+  {
+    const streamoff Seek = File.tellp();
+    if (_singlePrecision && !Values.empty()) {
+      vector<float > single(Values.begin(), Values.end());
+      File.write(reinterpret_cast<const char * >(&single[0]), single.size()*sizeof(float));
+    }
+    else if (!Values.empty())
+      File.write(reinterpret_cast<const char * >(&Values[0]), Values.size()*sizeof(Real));
+    File.flush();
+    if (!File) {
+      cout << "** XDMFTimeSeries: cannot write " << _name + FileName << endl;
+      exit(1);
+    }
+
+    stringstream item;
+    item << "<DataItem Dimensions=\"" << Tuples;
+    if (Components > 1) item << " " << Components;
+    item << "\" NumberType=\"Float\" Precision=\"" << (_singlePrecision ? sizeof(float) : sizeof(Real))
+	 << "\" Format=\"Binary\" Endian=\"Native\" Seek=\"" << Seek << "\">"
+	 << baseName(_name) << FileName << "</DataItem>";
+    return item.str();
+  }
+
+
+
+  string XDMFTimeSeries::writeArray(const VTKArray & A, const string & Center, int Tuples)
+  {
+    stringstream xml;
+    xml << "        <Attribute Name=\"" << A.name << "\" AttributeType=\""
+	<< attributeType(A.components) << "\" Center=\"" << Center << "\">\n"
+	<< "          " << writeValues(_data, "_data.bin", A.values, Tuples, A.components) << "\n"
+	<< "        </Attribute>\n";
+    return xml.str();
+  }
+
+
+
+  void XDMFTimeSeries::append(const VTKSnapshot & S)
+  {
+    const int NumPoints = S.points.size()/3;
+    const int NodesPerCell = S.pointCloud ? 1 : S.nodesPerCell;
+    const int NumCells = S.pointCloud ? NumPoints : S.connectivity.size()/NodesPerCell;
+
+    if (_numPoints < 0) {
+      // Mesh written once, Polyvertex cells of a point cloud are its points
+      _numPoints = NumPoints;
+      _numCells = NumCells;
+      vector<int > connectivity;
+      if (S.pointCloud)
+	for (int i = 0; i < NumPoints; i++) connectivity.push_back(i);
+      const vector<int > & cells = S.pointCloud ? connectivity : S.connectivity;
+
+      stringstream xml;
+      xml << "        <Topology TopologyType=\"" << topologyType(S)
+	  << "\" NumberOfElements=\"" << NumCells << "\" NodesPerElement=\"" << NodesPerCell << "\">\n"
+	  << "          <DataItem Dimensions=\"" << NumCells << " " << NodesPerCell
+	  << "\" NumberType=\"Int\" Precision=\"" << sizeof(int)
+	  << "\" Format=\"Binary\" Endian=\"Native\" Seek=\"0\">"
+	  << baseName(_name) << "_mesh.bin</DataItem>\n"
+	  << "        </Topology>\n";
+      if (!cells.empty())
+	_mesh.write(reinterpret_cast<const char * >(&cells[0]), cells.size()*sizeof(int));
+      xml << "        <Geometry GeometryType=\"XYZ\">\n"
+	  << "          " << writeValues(_mesh, "_mesh.bin", S.points, NumPoints, 3) << "\n"
+	  << "        </Geometry>\n";
+      _topology = xml.str();
+      _mesh.close();
+    }
+    else if (NumPoints != _numPoints || NumCells != _numCells) {
+      cout << "** XDMFTimeSeries: step " << S.step << " of " << _name << " has "
+	   << NumPoints << " points and " << NumCells << " cells, the series "
+	   << _numPoints << " and " << _numCells << endl;
+      exit(1);
+    }
+
+    stringstream xml;
+    xml << "      <Grid Name=\"Step " << S.step << "\" GridType=\"Uniform\">\n"
+	<< "        <Time Value=\"" << S.step << "\"/>\n"
+	<< _topology;
+    for (uint i = 0; i < S.pointData.size(); i++)
+      xml << writeArray(S.pointData[i], "Node", NumPoints);
+    for (uint i = 0; i < S.cellData.size(); i++)
+      xml << writeArray(S.cellData[i], "Cell", NumCells);
+    xml << "      </Grid>\n";
+
+    // The new step replaces the closing tags, written again after it
+    _xml.seekp(_xmlEnd);
+    _xml << xml.str();
+    _xmlEnd = _xml.tellp();
+    _xml << XMLTail << flush;
+  }
+
+} // namespace voom
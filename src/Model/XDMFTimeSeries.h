@@ -0,0 +1,54 @@
+//-*-C++-*-
+/*!
+  \file XDMFTimeSeries.h
+  \brief Output of many steps on the same mesh as one XDMF temporal
+  collection. Points and cells are written once to Name_mesh.bin; the
+  point and cell arrays of each step are appended to Name_data.bin, raw
+  and in native byte order, and Name.xmf gives their offsets. ParaView
+  and VisIt read Name.xmf as a time series.
+*/
+
+#ifndef __XDMFTimeSeries_h__
+#define __XDMFTimeSeries_h__
+
+#include "AsyncVTKWriter.h"
+
+namespace voom
+{
+  class XDMFTimeSeries
+  {
+  public:
+    //! Open Name.xmf, Name_mesh.bin and Name_data.bin. With
+    //! SinglePrecision, arrays and points are stored as floats.
+    XDMFTimeSeries(const string & Name, bool SinglePrecision = false);
+
+    //! Append the arrays of Snapshot as the next step, at time Snapshot.step.
+    //! Points and cells are taken from the first snapshot, later ones
+    //! must have as many of them.
+    void append(const VTKSnapshot & Snapshot);
+
+  private:
+    //! Write Values to File, as floats with _singlePrecision, and return
+    //! the XML DataItem pointing to them
+    string writeValues(ofstream & File, const string & FileName,
+		       const vector<Real > & Values, int Tuples, int Components);
+    string writeArray(const VTKArray & A, const string & Center, int Tuples);
+
+    string _name;
+    bool   _singlePrecision;
+
+    ofstream _xml, _mesh, _data;
+    //! Where the next step goes in Name.xmf, before the closing tags
+    streampos _xmlEnd;
+
+    //! Topology and Geometry elements of every step, set by the first one
+    string _topology;
+    int    _numPoints, _numCells;
+
+    XDMFTimeSeries(const XDMFTimeSeries &);
+    XDMFTimeSeries & operator=(const XDMFTimeSeries &);
+  };
+
+} // namespace voom
+
+#endif // __XDMFTimeSeries_h__
@@ -10,95 +10,109 @@ namespace voom{
     update(Point);
   }
 
-
-  void LMEShape::update(const VectorXd & Point)
+  LMEShape::LMEShape(const vector<VectorXd > & Nodes, const VectorXd & Point, 
+		     const Real beta, const Real tol, const uint MaxIter,
+		     const VectorXd & Lambda):
+    MFShape(Nodes), _beta(beta), _tol(tol), _maxIter(MaxIter), _lambda(Lambda)
   {
-    uint dim = _nodes[0].size();
-    assert(dim==Point.size());
-
-    // Compute LME shape functions and shape functions derivatives
-    VectorXd lambda = VectorXd::Zero(dim);
-    VectorXd r = VectorXd::Zero(dim), dN = VectorXd::Zero(dim);
-    MatrixXd J = MatrixXd::Zero(dim,dim), Jinv = MatrixXd::Zero(dim,dim);
-
-    // Compute error
-    r = LME_r(Point, lambda);    
-    Real res = pow(r.dot(r), 0.5);
-   
-    // Start minimization problem to determine LME functions
-    uint iter = 0;
-    while (res>_tol && iter<_maxIter)
-    {
-      J = LME_J(Point, lambda);
-      Jinv = J.inverse();
-      lambda -= Jinv*r;
-
-      r = LME_r(Point, lambda);
-      res = pow(r.dot(r), 0.5);
-      iter++;
-    }
-
-    for(uint i=0; i<_nodes.size(); i++)
-    {
-      _N[i]  = LME_pa(Point, lambda, i);
-      _DN[i] = _N[i]*Jinv*(_nodes[i]-Point);
-    }
+    update(Point);
   }
 
 
 
-  Real LMEShape::LME_pa(const VectorXd & Point,
-			const VectorXd & lambda,
-			uint j)
+  void LMEShape::update(const VectorXd & Point)
   {
-    Real Z = 0.0;
-    VectorXd temp(_nodes[0].size());
-
-    for(int i=0; i<_nodes.size(); i++)
-    { 
-      temp = Point - _nodes[i];
-      Z += exp( - _beta*temp.dot(temp) + temp.dot(lambda)  );
+    assert(_nodes[0].size() == Point.size());
+    switch (Point.size()) {
+    case 1: this->solve<1>(Point); break;
+    case 2: this->solve<2>(Point); break;
+    case 3: this->solve<3>(Point); break;
+    default: this->solve<Dynamic>(Point);
     }
-    
-    temp = Point - _nodes[j];
-    return exp( - _beta*temp.dot(temp) + temp.dot(lambda) )/Z;
   }
 
 
 
-  VectorXd LMEShape::LME_r(const VectorXd & Point, 
-			   const VectorXd & lambda)
+  // All partition function terms at lambda in one pass over the nodes:
+  // p_a = exp(f_a + lambda.dx_a)/Z, r = sum_a p_a dx_a and
+  // J = sum_a p_a dx_a dx_a^T - r r^T, with dx_a = x - x_a and the prior
+  // f_a = -beta |dx_a|^2. Returns |r|.
+  template<int DIM>
+  static Real LMEterms(const vector<Matrix<Real, DIM, 1>, aligned_allocator<Matrix<Real, DIM, 1> > > & dx,
+		       const vector<Real > & prior, const Matrix<Real, DIM, 1> & lambda,
+		       vector<Real > & p, Matrix<Real, DIM, 1> & r, Matrix<Real, DIM, DIM> & J)
   {
-    VectorXd r = VectorXd::Zero(Point.size());
-    
-    for(int i=0; i<_nodes.size(); i++){
-      r += LME_pa(Point, lambda, i) * (Point-_nodes[i]);
+    const int n = dx.size();
+    // Shift the exponents by their maximum so that exp does not overflow
+    Real shift = prior[0] + lambda.dot(dx[0]);
+    for (int a = 0; a < n; a++) {
+      p[a] = prior[a] + lambda.dot(dx[a]);
+      shift = max(shift, p[a]);
     }
-
-    return r;
+    Real Z = 0.0;
+    for (int a = 0; a < n; a++) {
+      p[a] = exp(p[a] - shift);
+      Z += p[a];
+    }
+    r.setZero(lambda.size());
+    J.setZero(lambda.size(), lambda.size());
+    for (int a = 0; a < n; a++) {
+      p[a] /= Z;
+      r += p[a]*dx[a];
+      J += p[a]*dx[a]*dx[a].transpose();
+    }
+    J -= r*r.transpose();
+    return r.norm();
   }
 
 
 
-  MatrixXd LMEShape::LME_J(const VectorXd & Point,
-			   const VectorXd & lambda)
+  template<int DIM>
+  void LMEShape::solve(const VectorXd & Point)
   {
-    uint dim = Point.size();
-    MatrixXd J = MatrixXd::Zero(dim,dim);
-    VectorXd temp = VectorXd::Zero(dim);
+    typedef Matrix<Real, DIM, 1> Vec;
+    typedef Matrix<Real, DIM, DIM> Mat;
+    const int dim = Point.size();
+    const int n = _nodes.size();
+
+    vector<Vec, aligned_allocator<Vec> > dx(n);
+    vector<Real > prior(n), p(n);
+    for (int a = 0; a < n; a++) {
+      dx[a] = Point - _nodes[a];
+      prior[a] = -_beta*dx[a].squaredNorm();
+    }
 
-    for(int i=0; i<_nodes.size(); i++){  
-      temp = Point - _nodes[i];
-      J += LME_pa(Point, lambda, i) * (temp*temp.transpose() );
+    // Start from the previous multiplier; if Newton does not converge from
+    // there, start again from zero
+    const bool warm = _lambda.size() == dim && _lambda.squaredNorm() > 0.0;
+    Vec lambda = warm ? Vec(_lambda) : Vec(Vec::Zero(dim));
+    Vec r;
+    Mat J;
+    for (int attempt = warm ? 0 : 1; attempt < 2; attempt++) {
+      if (attempt == 1 && warm) lambda.setZero(dim);
+      Real res = LMEterms<DIM>(dx, prior, lambda, p, r, J);
+      uint iter = 0;
+      while (res > _tol && iter < _maxIter) {
+	lambda -= J.inverse()*r;
+	res = LMEterms<DIM>(dx, prior, lambda, p, r, J);
+	iter++;
+      }
+      if (res <= _tol) {
+	// One more step, converging quadratically: lambda is then exact to
+	// round-off whatever the starting point (warm or cold, any thread)
+	lambda -= J.inverse()*r;
+	LMEterms<DIM>(dx, prior, lambda, p, r, J);
+	break;
+      }
     }
-    
-    temp = LME_r(Point, lambda);
+    _lambda = lambda;
 
-    J -= temp*temp.transpose();
-    return J;
+    // Derivatives from the Hessian at the converged multiplier
+    const Mat Jinv = J.inverse();
+    for (int a = 0; a < n; a++) {
+      _N[a]  = p[a];
+      _DN[a] = -p[a]*(Jinv*dx[a]);
+    }
   }
 
-
-
 } // namespace voom
-
@@ -19,39 +19,47 @@ namespace voom {
     LMEShape(const vector<VectorXd> & Nodes, const VectorXd & Point, 
 	     const Real beta, const Real tol, const uint MaxIter);
 
-    //! Update recomputes N and DN at new Point
+    //! Same, with the Newton iterations started from Lambda (e.g. the
+    //! multiplier of a neighboring material point with the same nodes)
+    LMEShape(const vector<VectorXd> & Nodes, const VectorXd & Point, 
+	     const Real beta, const Real tol, const uint MaxIter,
+	     const VectorXd & Lambda);
+
+    //! Update recomputes N and DN at new Point, starting from the
+    //! multiplier of the previous point
     void update(const VectorXd & Point);
 
     // Accessors/Mutators to specific LME class members
     Real getBeta() {return _beta; };
     Real getTol() {return _tol; };
     uint getMaxIter() {return _maxIter; };
+    //! Lagrange multiplier at the last point
+    const VectorXd & getLambda() {return _lambda; };
     
     void setBeta(Real beta) {_beta = beta; };
-    void setTol(Real tol) {_tol = _tol; };
+    void setTol(Real tol) {_tol = tol; };
     void setMaxIter(uint maxIter) {_maxIter = maxIter; };
+    //! Initial guess of the next update
+    void setLambda(const VectorXd & Lambda) {_lambda = Lambda; };
+
+    //! Distance beyond which the prior weight exp(-beta r^2) of a node is
+    //! below TolZero: radius of the node neighborhood of a material point
+    static Real getSupportRadius(Real beta, Real TolZero) {
+      return sqrt(-log(TolZero)/beta);
+    }
       
   private:
-    // private functions for LME calculation
-
-    //! Calculate shape function j value
-    Real LME_pa(const VectorXd & Point,
-		const VectorXd & lambda,
-		uint j);
-  
-    //! Calculate vector r
-    VectorXd LME_r(const VectorXd & Point, 
-		   const VectorXd & lambda);
-
-    //! Calculate Matrix J
-    MatrixXd LME_J(const VectorXd & Point, 
-		   const VectorXd & lambda);
+    //! Newton solve for lambda and N, DN at Point, in dimension DIM
+    //! (Eigen::Dynamic for dimensions other than 1, 2 and 3)
+    template<int DIM>
+    void solve(const VectorXd & Point);
 
   private:
     // extra members wrt classic FE shape functions
     Real _beta;
     Real _tol;
     uint _maxIter;
+    VectorXd _lambda;
   };
 
 } // namespace voom
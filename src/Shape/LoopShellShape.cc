@@ -2,452 +2,621 @@
 
 namespace voom{
 
-  
-  //! constructor function with parrametric coords
-  void LoopShellShape::update( const VectorXd & Point)
-  {
-    _coords = Point;
-    
-    // need subdivision
-    bool needSubdivide = true;
-    if ( _Valences[0] == 6 && _Valences[1]==6 && _Valences[2] == 6 ) needSubdivide = false;
-
-    // sub-division matrix
-    SubdivisionMatrix  S(12,_nodes);
-    S = SubdivisionMatrix::Zero(12, _nodes);
-    _computeSubdivisionMatrix(S, needSubdivide);
-    //! convert the parametric coords for sub-patch (irregular patches)
-    if( needSubdivide ) _convertParaCoords();
-		
-    // compute shape functions
-    _computeFunctions(S, needSubdivide);
-
-    // compute the 1st derivatives of shape functions
-    _computeDerivatives(S, needSubdivide);
-
-    // compute the 2nd derivatives of shape functions
-    _computeSecondDerivatives(S, needSubdivide);
-	
-  }
+  namespace {
 
+    //! Shape functions and derivatives at a point, one column per node:
+    //! rows N, N_v, N_w, N_vv, N_ww, N_vw
+    typedef Matrix<Real, 6, Dynamic> ShapeValues;
 
-  void LoopShellShape::_computeFunctions( const SubdivisionMatrix & SDMatrix, bool needSubdivide )
-  {
-    // set the parametric coords
-    const double v = _coords(0);
-    const double w = _coords(1);
-    const double u = 1 - v - w;
+    typedef vector<int > Triangle;
+
+    //! Third vertex c of the face (a, b, c) containing the directed edge (a, b)
+    typedef map<pair<int, int >, int > ThirdVertex;
+
+    //! Box spline of each node of a regular patch (nodes in LoopShellMesh order)
+    const int RegularNodeToBoxSpline[12] = {3, 6, 7, 2, 5, 9, 10, 11, 8, 4, 1, 0};
 
-    Matrix<double,1,12> boxSplines;
-    // computing ...
-    // 12 shape functions for the regular patch element
-    //
-    boxSplines(0)=(u*u*u*u + 2.0*u*u*u*v)/12.0;
+    //! Corners of the four triangles of one subdivision step, in the
+    //! parametric coordinates (v, w) of the parent: the triangle at corner
+    //! 0, 1, 2 (listed from that corner) and the middle one
+    const Real SubTriangleCorners[4][3][2] = {{{0.0, 0.0}, {0.5, 0.0}, {0.0, 0.5}},
+					      {{1.0, 0.0}, {0.5, 0.5}, {0.5, 0.0}},
+					      {{0.0, 1.0}, {0.0, 0.5}, {0.5, 0.5}},
+					      {{0.5, 0.0}, {0.5, 0.5}, {0.0, 0.5}}};
 
-    boxSplines(1)=(u*u*u*u + 2.0*u*u*u*w)/12.0;
 
-    boxSplines(2)=(u*u*u*u + 2.0*u*u*u*w + 6.0*u*u*u*v + 6.0*u*u*v*w +
+
+    //! The 12 box splines of a regular patch and their derivatives at (v, w)
+    void boxSplines(const Real v, const Real w, Matrix<Real, 6, 12> & B)
+    {
+      const Real u = 1.0 - v - w;
+
+      // Shape functions
+      B(0, 0)=(u*u*u*u + 2.0*u*u*u*v)/12.0;
+
+      B(0, 1)=(u*u*u*u + 2.0*u*u*u*w)/12.0;
+
+      B(0, 2)=(u*u*u*u + 2.0*u*u*u*w + 6.0*u*u*u*v + 6.0*u*u*v*w +
 		   12.0*u*u*v*v + 6.0*u*v*v*w + 6.0*u*v*v*v + 2.0*v*v*v*w +
 		   v*v*v*v)/12.0;
 
-    boxSplines(3)=(6.0*u*u*u*u + 24.0*u*u*u*w + 24.0*u*u*w*w + 8.0*u*w*w*w + 
+      B(0, 3)=(6.0*u*u*u*u + 24.0*u*u*u*w + 24.0*u*u*w*w + 8.0*u*w*w*w + 
 		   w*w*w*w + 24.0*u*u*u*v + 60.0*u*u*v*w + 36.0*u*v*w*w + 
 		   6.0*v*w*w*w + 24.0*u*u*v*v + 36.0*u*v*v*w + 12.0*v*v*w*w + 
 		   8.0*u*v*v*v + 6.0*v*v*v*w + v*v*v*v)/12.0;
 
-    boxSplines(4)=(u*u*u*u + 6.0*u*u*u*w + 12.0*u*u*w*w + 6.0*u*w*w*w + 
+      B(0, 4)=(u*u*u*u + 6.0*u*u*u*w + 12.0*u*u*w*w + 6.0*u*w*w*w + 
 		   w*w*w*w + 2.0*u*u*u*v + 6.0*u*u*v*w + 6.0*u*v*w*w + 
 		   2.0*v*w*w*w)/12.0;
 
-    boxSplines(5)=(2.0*u*v*v*v + v*v*v*v)/12.0;
+      B(0, 5)=(2.0*u*v*v*v + v*v*v*v)/12.0;
 
-    boxSplines(6)=(u*u*u*u + 6.0*u*u*u*w + 12.0*u*u*w*w + 
+      B(0, 6)=(u*u*u*u + 6.0*u*u*u*w + 12.0*u*u*w*w + 
 		   6.0*u*w*w*w + w*w*w*w + 8.0*u*u*u*v + 36.0*u*u*v*w + 
 		   36.0*u*v*w*w + 8.0*v*w*w*w + 24.0*u*u*v*v + 60.0*u*v*v*w + 
 		   24.0*v*v*w*w + 24.0*u*v*v*v + 24.0*v*v*v*w + 
 		   6.0*v*v*v*v)/12.0;
 
-    boxSplines(7)=(u*u*u*u + 8.0*u*u*u*w + 24.0*u*u*w*w + 24.0*u*w*w*w + 
+      B(0, 7)=(u*u*u*u + 8.0*u*u*u*w + 24.0*u*u*w*w + 24.0*u*w*w*w + 
 		   6.0*w*w*w*w + 6.0*u*u*u*v + 36.0*u*u*v*w + 60.0*u*v*w*w + 
 		   24.0*v*w*w*w + 12.0*u*u*v*v + 36.0*u*v*v*w + 
 		   24.0*v*v*w*w + 6.0*u*v*v*v + 8.0*v*v*v*w + v*v*v*v)/12.0;
 
-    boxSplines(8) =(2.0*u*w*w*w + w*w*w*w)/12.0; 
-    boxSplines(9)=(2.0*v*v*v*w + v*v*v*v)/12.0;
-
+      B(0, 8) =(2.0*u*w*w*w + w*w*w*w)/12.0; 
+      B(0, 9)=(2.0*v*v*v*w + v*v*v*v)/12.0;
 
-    boxSplines(10)=(2.0*u*w*w*w + w*w*w*w + 6.0*u*v*w*w + 6.0*v*w*w*w + 
+      B(0, 10)=(2.0*u*w*w*w + w*w*w*w + 6.0*u*v*w*w + 6.0*v*w*w*w + 
 		    6.0*u*v*v*w + 12.0*v*v*w*w + 2.0*u*v*v*v + 
 		    6.0*v*v*v*w + v*v*v*v)/12.0;
 
-    boxSplines(11)=(w*w*w*w + 2.0*v*w*w*w)/12.0;
-    
-    Matrix<double,1,Dynamic> prod(1,_nodes);
-    prod = (boxSplines * SDMatrix);
-    for (int i=0; i<_nodes; i++) _N[i] = prod[i];
-		
-  }
-
-
-
-  void LoopShellShape::_computeDerivatives( const SubdivisionMatrix & SDMatrix, bool needSubdivide )
-  {
-    // set the parametric coords
-    const double v = _coords(0);
-    const double w = _coords(1);
-    const double u = 1 - v - w;
+      B(0, 11)=(w*w*w*w + 2.0*v*w*w*w)/12.0;
 
-    MatrixXd bsDerivatives(2,12); //rows: directions v,w; cols: shape fns
+      // First derivatives, directions v and w
+      B(1, 0) = (-6.0*v*u*u - 2.0*u*u*u)/12.0;
+      B(2, 0) = (-6.0*v*u*u - 4.0*u*u*u)/12.0;
 
-    // 12 * 2 components of the 1st derivatives of the shape function for the
-    // regular element
-    bsDerivatives(0,0) = (-6.0*v*u*u - 2.0*u*u*u)/12.0;
-    bsDerivatives(1,0) = (-6.0*v*u*u - 4.0*u*u*u)/12.0;
+      B(1, 1) = (-4.0*u*u*u-6.0*u*u*w)/12.0;
+      B(2, 1) = (-2.0*u*u*u-6.0*u*u*w)/12.0;
 
-    bsDerivatives(0,1) = (-4.0*u*u*u-6.0*u*u*w)/12.0;
-    bsDerivatives(1,1) = (-2.0*u*u*u-6.0*u*u*w)/12.0;
-
-    bsDerivatives(0,2) = (-2.0*v*v*v-6.0*v*v*u
+      B(1, 2) = (-2.0*v*v*v-6.0*v*v*u
 			  + 6.0*v*u*u+2.0*u*u*u)/12.0;
-    bsDerivatives(1,2) = (-4.0*v*v*v-18.0*v*v*u
+      B(2, 2) = (-4.0*v*v*v-18.0*v*v*u
 			  - 12.0*v*u*u-2.0*u*u*u
 			  - 6.0*v*v*w-12.0*v*u*w
 			  - 6.0*u*u*w)/12.0;
 
-    bsDerivatives(0,3) = (-4.0*v*v*v-24.0*v*v*u
+      B(1, 3) = (-4.0*v*v*v-24.0*v*v*u
 			  - 24.0*v*u*u-18.0*v*v*w 
 			  - 48.0*v*u*w-12.0*u*u*w
 			  - 12.0*v*w*w - 12.0*u*w*w
 			  - 2.0*w*w*w)/12.0;
 
-    bsDerivatives(1,3) = (-2.0*v*v*v-12.0*v*v*u
+      B(2, 3) = (-2.0*v*v*v-12.0*v*v*u
 			  - 12.0*v*u*u-12.0*v*v*w
 			  - 48.0*v*u*w-24.0*u*u*w
 			  - 18.0*v*w*w-24.0*u*w*w
 			  - 4.0*w*w*w)/12.0;
 
-    bsDerivatives(0,4) = (-6.0*v*u*u-2.0*u*u*u
+      B(1, 4) = (-6.0*v*u*u-2.0*u*u*u
 			  - 12.0*v*u*w-12.0*u*u*w
 			  - 6.0*v*w*w-18.0*u*w*w
 			  - 4.0*w*w*w)/12.0;
 
-    bsDerivatives(1,4) = (2.0*u*u*u+6.0*u*u*w
+      B(2, 4) = (2.0*u*u*u+6.0*u*u*w
 			  - 6.0*u*w*w-2.0*w*w*w)/12.0;
 
-    bsDerivatives(0,5) = (2.0*v*v*v+6.0*v*v*u)/12.0;
-    bsDerivatives(1,5) = -v*v*v/6.0;
+      B(1, 5) = (2.0*v*v*v+6.0*v*v*u)/12.0;
+      B(2, 5) = -v*v*v/6.0;
 
-    bsDerivatives(0,6) = (24.0*v*v*u+24.0*v*u*u
+      B(1, 6) = (24.0*v*v*u+24.0*v*u*u
 			  + 4.0*u*u*u+12.0*v*v*w
 			  + 48.0*v*u*w+18.0*u*u*w
 			  + 12.0*v*w*w+12.0*u*w*w
 			  + 2.0*w*w*w)/12.0;
   
-    bsDerivatives(1,6) = (12.0*v*v*u+12.0*v*u*u
+      B(2, 6) = (12.0*v*v*u+12.0*v*u*u
 			  + 2.0*u*u*u-12.0*v*v*w
 			  + 6.0*u*u*w-12.0*v*w*w
 			  - 6.0*u*w*w-2.0*w*w*w)/12.0;
 
-    bsDerivatives(0,7) = (-2.0*v*v*v-6.0*v*v*u
+      B(1, 7) = (-2.0*v*v*v-6.0*v*v*u
 			  + 6.0*v*u*u+2.0*u*u*u
 			  - 12.0*v*v*w+12.0*u*u*w
 			  - 12.0*v*w*w+12.0*u*w*w)/12.0;
 
-    bsDerivatives(1,7) = (2.0*v*v*v+12.0*v*v*u
+      B(2, 7) = (2.0*v*v*v+12.0*v*v*u
 			  + 18.0*v*u*u+4.0*u*u*u
 			  + 12.0*v*v*w+48.0*v*u*w
 			  + 24.0*u*u*w+12.0*v*w*w
 			  + 24.0*u*w*w)/12.0;
 
-    bsDerivatives(0,8) = -w*w*w/6.0;
-    bsDerivatives(1,8) = (6.0*u*w*w+2.0*w*w*w)/12.0;
+      B(1, 8) = -w*w*w/6.0;
+      B(2, 8) = (6.0*u*w*w+2.0*w*w*w)/12.0;
 
-    bsDerivatives(0,9) = (4.0*v*v*v+6.0*v*v*w)/12.0;
-    bsDerivatives(1,9) = v*v*v/6.0;
+      B(1, 9) = (4.0*v*v*v+6.0*v*v*w)/12.0;
+      B(2, 9) = v*v*v/6.0;
 
-    bsDerivatives(0,10) = (2.0*v*v*v+6.0*v*v*u
+      B(1, 10) = (2.0*v*v*v+6.0*v*v*u
 			   + 12.0*v*v*w+12.0*v*u*w
 			   + 18.0*v*w*w+6.0*u*w*w
 			   + 4.0*w*w*w)/12.0;
 
-    bsDerivatives(1,10)= (4.0*v*v*v+6.0*v*v*u
+      B(2, 10)= (4.0*v*v*v+6.0*v*v*u
 			  + 18.0*v*v*w+12.0*v*u*w
 			  + 12.0*v*w*w+6.0*u*w*w
 			  + 2.0*w*w*w)/12.0;
 
-    bsDerivatives(0,11) = w*w*w/6.0;
-    bsDerivatives(1,11) = (6.0*v*w*w+4.0*w*w*w)/12.0;
-		
-    Matrix<double,2,Dynamic> prod(2,_nodes);
-    prod = bsDerivatives * SDMatrix;
-
-    double fact = (needSubdivide)? -2.0: 1.0; //need to multiply by -2 if subdivision
-
-    for (int i=0; i<_nodes; i++){
-      _DN[i](0) = fact * prod(0,i);
-      _DN[i](1) = fact * prod(1,i);
-    }   
-    return;
-		
-  }
-
-
-
-  void LoopShellShape::_computeSecondDerivatives( const  SubdivisionMatrix & SDMatrix, bool needSubdivide )
-  {
-    /* second order derivatives of the box spline shape functions */
-    /* der(0, *) derivative with respect to vv                     */
-    /* der(1, *) derivative with respect to ww                     */
-    /* der(2, *) derivative with respect to vw                     */
-    const double v = _coords(0);
-    const double w = _coords(1);
-    const double u = 1 - v - w;
-  
-    Matrix<double,3,12> bs2ndDerivatives;
+      B(1, 11) = w*w*w/6.0;
+      B(2, 11) = (6.0*v*w*w+4.0*w*w*w)/12.0;
 
-    bs2ndDerivatives(0,0) = v*u;
-    bs2ndDerivatives(1,0) = v*u+u*u;
-    bs2ndDerivatives(2,0) = (12.0*v*u+6.0*u*u)/12.0;
+      // Second derivatives vv, ww and vw
+      B(3, 0) = v*u;
+      B(4, 0) = v*u+u*u;
+      B(5, 0) = (12.0*v*u+6.0*u*u)/12.0;
 
-    bs2ndDerivatives(0,1) = u*u+u*w;
-    bs2ndDerivatives(1,1) = u*w;
-    bs2ndDerivatives(2,1) = (6.0*u*u+12.0*u*w)/12.0;
+      B(3, 1) = u*u+u*w;
+      B(4, 1) = u*w;
+      B(5, 1) = (6.0*u*u+12.0*u*w)/12.0;
              
-    bs2ndDerivatives(0,2) = -2.0*v*u;
-    bs2ndDerivatives(1,2) = v*v+v*u+v*w+u*w;
-    bs2ndDerivatives(2,2) = (6.0*v*v-12.0*v*u
+      B(3, 2) = -2.0*v*u;
+      B(4, 2) = v*v+v*u+v*w+u*w;
+      B(5, 2) = (6.0*v*v-12.0*v*u
 			       -6.0*u*u)/12.0;
              
-    bs2ndDerivatives(0,3) = v*v-2.0*u*u
-      + v*w-2.0*u*w;
-    bs2ndDerivatives(1,3) = -2.0*v*u-2.0*u*u
-      + v*w+w*w;
-    bs2ndDerivatives(2,3) = (6.0*v*v-12.0*u*u
+      B(3, 3) = v*v-2.0*u*u
+        + v*w-2.0*u*w;
+      B(4, 3) = -2.0*v*u-2.0*u*u
+        + v*w+w*w;
+      B(5, 3) = (6.0*v*v-12.0*u*u
 			       + 24.0*v*w+6.0*w*w)/12.0;
              
-    bs2ndDerivatives(0,4) = v*u+v*w+u*w+ w*w;
-    bs2ndDerivatives(1,4) = -2.0*u*w;
-    bs2ndDerivatives(2,4) = (-6.0*u*u-12.0*u*w 
+      B(3, 4) = v*u+v*w+u*w+ w*w;
+      B(4, 4) = -2.0*u*w;
+      B(5, 4) = (-6.0*u*u-12.0*u*w 
 			       + 6.0*w*w)/12.0;
              
-    bs2ndDerivatives(0,5) = v*u;
-    bs2ndDerivatives(1,5) = 0.0;
-    bs2ndDerivatives(2,5) = -v*v/2.0;
+      B(3, 5) = v*u;
+      B(4, 5) = 0.0;
+      B(5, 5) = -v*v/2.0;
              
-    bs2ndDerivatives(0,6) = (-24.0*v*v+12.0*u*u-24.0*v*w
+      B(3, 6) = (-24.0*v*v+12.0*u*u-24.0*v*w
 			       + 12.0*u*w)/12.0;
-    bs2ndDerivatives(1,6) = (-24.0*v*v-24.0*v*u-24.0*v*w
+      B(4, 6) = (-24.0*v*v-24.0*v*u-24.0*v*w
 			       - 24.0*u*w)/12.0;
-    bs2ndDerivatives(2,6) = (-12.0*v*v+6.0*u*u-24.0*v*w
+      B(5, 6) = (-12.0*v*v+6.0*u*u-24.0*v*w
 			       - 12.0*u*w-6.0*w*w)/12.0;
              
-    bs2ndDerivatives(0,7) = -2.0*v*u-2.0*v*w-2.0*u*w- 2.0*w*w;
-    bs2ndDerivatives(1,7) = v*u+u*u-2.0*v*w - 2.0*w*w;
-    bs2ndDerivatives(2,7) = (-6.0*v*v-12.0*v*u+6.0*u*u 
+      B(3, 7) = -2.0*v*u-2.0*v*w-2.0*u*w- 2.0*w*w;
+      B(4, 7) = v*u+u*u-2.0*v*w - 2.0*w*w;
+      B(5, 7) = (-6.0*v*v-12.0*v*u+6.0*u*u 
 			       - 24.0*v*w-12.0*w*w)/12.0;
              
-    bs2ndDerivatives(0,8) = 0.0;
-    bs2ndDerivatives(1,8) = u*w;
-    bs2ndDerivatives(2,8) = -w*w/2.0; 
+      B(3, 8) = 0.0;
+      B(4, 8) = u*w;
+      B(5, 8) = -w*w/2.0; 
              
-    bs2ndDerivatives(0,9) = (12.0*v*v+12.0*v*w)/12.0;
-    bs2ndDerivatives(1,9) = 0.0;
-    bs2ndDerivatives(2,9) = v*v/2.0;
+      B(3, 9) = (12.0*v*v+12.0*v*w)/12.0;
+      B(4, 9) = 0.0;
+      B(5, 9) = v*v/2.0;
              
-    bs2ndDerivatives(0,10)= (12.0*v*u+12.0*v*w+12.0*u*w
+      B(3, 10)= (12.0*v*u+12.0*v*w+12.0*u*w
 			       + 12.0*w*w)/12.0;
-    bs2ndDerivatives(1,10)= v*v+v*u+v*w+u*w;
-    bs2ndDerivatives(2,10)= (6.0*v*v+12.0*v*u+24.0*v*w 
+      B(4, 10)= v*v+v*u+v*w+u*w;
+      B(5, 10)= (6.0*v*v+12.0*v*u+24.0*v*w 
 			       + 12.0*u*w+6.0*w*w)/12.0;
              
-    bs2ndDerivatives(0,11)= 0.0;
-    bs2ndDerivatives(1,11)= v*w+w*w;
-    bs2ndDerivatives(2,11)= w*w/2.0;
-
-    Matrix<double,3,Dynamic> prod(3,_nodes);
-    prod = bs2ndDerivatives * SDMatrix;
-    double fact = (needSubdivide)? 4.0: 1.0; //need to multiply by 4 if subdivision
-
-    for(int i=0;i<_nodes;i++){
-      _DDN[i](0,0) = fact * prod(0,i);
-      _DDN[i](1,1) = fact * prod(1,i);
-      _DDN[i](0,1) = fact * prod(2,i);
-      _DDN[i](1,0) = fact * prod(2,i);
+      B(3, 11)= 0.0;
+      B(4, 11)= v*w+w*w;
+      B(5, 11)= w*w/2.0;
     }
-    	
-    return;	
-  }
 
 
-  void LoopShellShape::_computeSubdivisionMatrix(SubdivisionMatrix & S, 
-						 bool needSubdivide)
-  {
-    //
-    //  to understand this part, need the formula of Transformation Matrix 
-    //  in the document.
-    //
-    if ( needSubdivide ){
-      int N0 = _Valences[0]-2,  N1 = _Valences[1]-2,  N2 = _Valences[2]-2;
-  
-      ///////////////////////////////////////////////////////////////////////
-      //
-      //  if the vertices of elements surrounding one element are overlapped,
-      //  need new method to construct the Transformation Matrix.
-      //
-      assert( N0 != 1 || N1 != 1 || N2 != 1);
-      //
-      ///////////////////////////////////////////////////////////////////////
-
-      //double w0 = ( 0.625 - pow( ( 0.375 + 0.25*cos(2.0*M_PI/(N0+2)) ) , 2.0) )/(N0+2);
-      //double w1 = ( 0.625 - pow( ( 0.375 + 0.25*cos(2.0*M_PI/(N1+2)) ), 2.0 ) )/(N1+2);
-      //double w2 = ( 0.625 - pow( ( 0.375 + 0.25*cos(2.0*M_PI/(N2+2)) ), 2.0 ) )/(N2+2);
-      //
-      // warren way
-      double w0 = 0.375/(N0+2);
-      double w1 = 0.375/(N1+2);
-      double w2 = 0.375/(N2+2);
-
-      double oneMinusNw0 = 1.0 - ( N0 + 2) * w0;
-      double oneMinusNw1 = 1.0 - ( N1 + 2) * w1;
-      double oneMinusNw2 = 1.0 - ( N2 + 2) * w2;
-
-      if(false){
-	std::cout <<"w0 = " << w0 << std::endl
-		  <<"w1 = " << w1 << std::endl
-		  <<"w2 = " << w2 << std::endl;
-	std::cout <<"oneMinusNw0 = " << oneMinusNw0 << std::endl
-		  <<"oneMinusNw1 = " << oneMinusNw1 << std::endl
-		  <<"oneMinusNw2 = " << oneMinusNw2 << std::endl;
+
+    //! Shape functions of a regular patch
+    void regularPatch(const Real v, const Real w, ShapeValues & R)
+    {
+      Matrix<Real, 6, 12> B;
+      boxSplines(v, w, B);
+      R.resize(6, 12);
+      for (int a = 0; a < 12; a++)
+	R.col(a) = B.col(RegularNodeToBoxSpline[a]);
+    }
+
+
+
+    //! R holds functions of s = T p + s0 and their derivatives with respect
+    //! to s; convert the derivatives to derivatives with respect to p
+    void changeVariables(ShapeValues & R, const Matrix2d & T)
+    {
+      for (int a = 0; a < R.cols(); a++) {
+	Vector2d D(R(1, a), R(2, a));
+	Matrix2d DD;
+	DD << R(3, a), R(5, a), R(5, a), R(4, a);
+	D = T.transpose()*D;
+	DD = T.transpose()*DD*T;
+	R(1, a) = D(0);      R(2, a) = D(1);
+	R(3, a) = DD(0, 0);  R(4, a) = DD(1, 1);  R(5, a) = DD(0, 1);
       }
-      const int n = static_cast<int>(_nodes);
-      assert(n > 0);
- 
-      double oneEighth = 1.0/8.0;
-      double threeEighths = 3.0/8.0;  
-
-      //
-      //  first row
-      S(0, 0) = oneEighth;
-      S(0, 1) = threeEighths;
-      S(0, 3) = threeEighths;
-      S(0, 4) = oneEighth;
-      // 
-      // second row
-      S(1, 0) = threeEighths;
-      S(1, 1) = oneEighth;
-      S(1, 3) = threeEighths;
-      S(1, n-1) = oneEighth;
-      //
-      // third row
-      S(2, 0) = w1;
-      S(2, 1) = oneMinusNw1;
-      for (int col=2;col<=3+N1-1;col++)
-	S(2,col) = w1;
-      //
-      // fourth row
-      S(3, 0) = threeEighths;  
-      S(3, 1) = threeEighths;  
-      S(3, 2) = oneEighth;  
-      S(3, 3) = oneEighth;  
-      //
-      // fifth row
-      S(4, 0) = oneMinusNw0;
-      S(4, 1) = w0;
-      S(4, 2) = w0;
-      S(4, 3) = w0;
-      for (int col=n-N0+1;col<=n-1;col++)
-      S(4, col ) = w0;
-      //
-      // sixth row
-      S(5, 1) = threeEighths;
-      S(5, 2) = oneEighth;
-      S(5, 3+N1-2) = oneEighth;
-      S(5, 3+N1-1) = threeEighths;
-      //
-      // seventh row
-      S(6, 0) = oneEighth;
-      S(6, 1) = threeEighths;
-      S(6, 2) = threeEighths;
-      S(6, 3+N1-1) = oneEighth;
-      //
-      // eighth row
-      S(7, 0) = threeEighths;
-      S(7, 1) = oneEighth;
-      S(7, 2) = threeEighths;
-      S(7, 3+N1+N2-2) = oneEighth;
-      //
-      // ninth row
-      S(8, 0) = threeEighths;
-      S(8, 2) = oneEighth;
-      S(8, 3+N1+N2-2) = threeEighths;
-      if ( 3+N1+N2-1 == N1 + N2 + N0  )
-	S(8,3) = 1.0/8.0;
-      else if ( 3+N1+N2-1 < N1 + N2 + N0  )		
-	S(8, 3+N1+N2-1) = oneEighth;
-      else
-	std::cout << "never thought about this case ..." << std::endl;
-      //
-      // tenth row
-      S(9, 1) = oneEighth;
-      S(9, 2) = threeEighths;
-      S(9, 3+N1-1) = threeEighths;
-      S(9, 3+N1) = oneEighth;
-      //
-      // eleventh row
-      S(10, 0) = w2;
-      S(10, 1) = w2;
-      S(10, 2) = oneMinusNw2;
-      for (int col = 3+N1-1; col <= 3+N1+N2-2; col++)
-	S(10, col) = w2;
-      //
-      // twelfth row
-      S(11, 0) = oneEighth;
-      S(11, 2) = threeEighths;
-      S(11, 3+N1+N2-3) = oneEighth;
-      S(11, 3+N1+N2-2) = threeEighths;
-      //
     }
-    else{
-      S(3 ,0 ) = 1.0;
-      S(6 ,1 ) = 1.0;
-      S(7 ,2 ) = 1.0;
-      S(2 ,3 ) = 1.0;
-      S(5 ,4 ) = 1.0;
-      S(9 ,5 ) = 1.0;
-      S(10 ,6) = 1.0;
-      S(11 ,7) = 1.0;
-      S(8 ,8 ) = 1.0;
-      S(4 ,9 ) = 1.0;
-      S(1, 10) = 1.0;
-      S(0 ,11) = 1.0;						
+
+
+
+    //! Sub-triangle of one subdivision step containing (v, w), with the
+    //! coordinates of the point in it and the Jacobian of the map
+    int subTriangle(Real & v, Real & w, Matrix2d & T)
+    {
+      const Real u = 1.0 - v - w;
+      const int k = u >= 0.5 ? 0 : (v >= 0.5 ? 1 : (w >= 0.5 ? 2 : 3));
+      const Real (&P)[3][2] = SubTriangleCorners[k];
+      Matrix2d E;
+      E << P[1][0] - P[0][0], P[2][0] - P[0][0],
+	   P[1][1] - P[0][1], P[2][1] - P[0][1];
+      T = E.inverse();
+      const Vector2d s = T*Vector2d(v - P[0][0], w - P[0][1]);
+      v = s(0);
+      w = s(1);
+      return k;
     }
 
-    const bool Output_Flag = false;
-		
-    if( Output_Flag ) {
-//       std::cout.precision(4);
-//       std::cout.setf(std::ios_base::scientific,std::ios_base::floatfield);
-      std::cout << "***** Begin Subdivision Matrix *****"<< std::endl;
-      //	      << S << std::endl
-      for(int i=0; i<S.rows(); i++) {
-	std::cout << "    ";
-	for(int j=0; j<S.cols(); j++) {
-	  std::cout << S(i,j) << "    "; 
+
+
+    void buildThirdVertex(const vector<Triangle > & Faces, ThirdVertex & Third)
+    {
+      Third.clear();
+      for (uint f = 0; f < Faces.size(); f++)
+	for (int i = 0; i < 3; i++)
+	  Third[make_pair(Faces[f][i], Faces[f][(i + 1)%3])] = Faces[f][(i + 2)%3];
+    }
+
+    int third(const ThirdVertex & Third, int a, int b)
+    {
+      ThirdVertex::const_iterator it = Third.find(make_pair(a, b));
+      return it == Third.end() ? -1 : it->second;
+    }
+
+
+
+    //! Faces of the patch of a triangle with corner valences V, over the
+    //! patch nodes numbered as in LoopShellMesh: the corners, then the
+    //! remaining neighbors of corner 1, corner 2 and corner 0, each listed
+    //! counterclockwise
+    void patchFaces(const vector<int > & V, vector<Triangle > & Faces)
+    {
+      const int n = V[0] + V[1] + V[2] - 6;
+      const int corner[3] = {1, 2, 0};
+      set<Triangle > unique;
+      int start = 3;
+      for (int c = 0; c < 3; c++) {
+	const int k = corner[c];
+	// Ring of corner k: previous corner, own list, first node of the
+	// next list, next corner
+	vector<int > ring(1, (k + 2)%3);
+	for (int i = 0; i < V[k] - 3; i++)
+	  ring.push_back(start + i);
+	start += V[k] - 3;
+	ring.push_back(start < n ? start : 3);
+	ring.push_back((k + 1)%3);
+	for (uint i = 0; i < ring.size(); i++) {
+	  Triangle f(3);
+	  f[0] = k;  f[1] = ring[i];  f[2] = ring[(i + 1)%ring.size()];
+	  // Same face seen from different corners
+	  rotate(f.begin(), min_element(f.begin(), f.end()), f.end());
+	  unique.insert(f);
 	}
-	std::cout << "}" << std::endl;
       }
-      std::cout << "*****  End Subdivision Matrix  *****"<< std::endl;
-    }	
-  }
+      Faces.assign(unique.begin(), unique.end());
+    }
 
 
 
-  void LoopShellShape::_convertParaCoords()
+    //! Nodes of the patch of face (a, b, c) in LoopShellMesh order
+    bool patchNodes(const ThirdVertex & Third, int a, int b, int c, vector<int > & Nodes)
+    {
+      Nodes.clear();
+      Nodes.push_back(a);  Nodes.push_back(b);  Nodes.push_back(c);
+      // Walk around b from across edge ab to across edge bc, then around
+      // c and around a
+      const int walk[3][3] = {{b, a, c}, {c, b, a}, {a, c, b}};
+      for (int i = 0; i < 3; i++) {
+	const int k = walk[i][0];
+	const int stop = third(Third, walk[i][2], k);
+	int r = third(Third, k, walk[i][1]);
+	for (int count = 0; r != stop; count++) {
+	  if (r < 0 || stop < 0 || count > 64) return false;
+	  Nodes.push_back(r);
+	  r = third(Third, k, r);
+	}
+      }
+      return true;
+    }
+
+
+
+    //! Rows of one Loop subdivision step of a patch, for the patches of
+    //! the four sub-triangles of face (0, 1, 2) (order of SubTriangleCorners)
+    struct SubPatches
+    {
+      MatrixXd W[4];
+      int      valence[4];   //!< valence of the first corner
+    };
+
+    void buildSubPatches(const vector<int > & V, SubPatches & S)
+    {
+      const int n = V[0] + V[1] + V[2] - 6;
+      vector<Triangle > faces;
+      patchFaces(V, faces);
+      ThirdVertex Third;
+      buildThirdVertex(faces, Third);
+
+      // New vertices: old vertices with a complete ring (Warren's weights)
+      // and edges shared by two faces
+      vector<vector<pair<int, Real > > > rows;
+      vector<int > vertexChild(n, -1);
+      map<pair<int, int >, int > edgeChild;
+      vector<set<int > > neighbors(n);
+      for (ThirdVertex::iterator it = Third.begin(); it != Third.end(); it++)
+	neighbors[it->first.first].insert(it->first.second);
+      for (int a = 0; a < n; a++) {
+	bool complete = true;
+	for (set<int >::iterator r = neighbors[a].begin(); r != neighbors[a].end(); r++)
+	  complete = complete && third(Third, *r, a) >= 0;
+	if (!complete) continue;
+	const Real beta = 0.375/neighbors[a].size();
+	vector<pair<int, Real > > row(1, make_pair(a, 1.0 - neighbors[a].size()*beta));
+	for (set<int >::iterator r = neighbors[a].begin(); r != neighbors[a].end(); r++)
+	  row.push_back(make_pair(*r, beta));
+	vertexChild[a] = rows.size();
+	rows.push_back(row);
+      }
+      for (ThirdVertex::iterator it = Third.begin(); it != Third.end(); it++) {
+	const int a = it->first.first, b = it->first.second;
+	const int d = third(Third, b, a);
+	if (a > b || d < 0) continue;
+	vector<pair<int, Real > > row;
+	row.push_back(make_pair(a, 0.375));
+	row.push_back(make_pair(b, 0.375));
+	row.push_back(make_pair(it->second, 0.125));
+	row.push_back(make_pair(d, 0.125));
+	edgeChild[make_pair(a, b)] = rows.size();
+	edgeChild[make_pair(b, a)] = rows.size();
+	rows.push_back(row);
+      }
+
+      // Faces after subdivision, those whose vertices could be computed
+      vector<Triangle > children;
+      for (uint f = 0; f < faces.size(); f++) {
+	const int a = faces[f][0], b = faces[f][1], c = faces[f][2];
+	const int m[3] = {edgeChild.count(make_pair(a, b)) ? edgeChild[make_pair(a, b)] : -1,
+			  edgeChild.count(make_pair(b, c)) ? edgeChild[make_pair(b, c)] : -1,
+			  edgeChild.count(make_pair(c, a)) ? edgeChild[make_pair(c, a)] : -1};
+	const int sub[4][3] = {{vertexChild[a], m[0], m[2]}, {vertexChild[b], m[1], m[0]},
+			       {vertexChild[c], m[2], m[1]}, {m[0], m[1], m[2]}};
+	for (int k = 0; k < 4; k++)
+	  if (sub[k][0] >= 0 && sub[k][1] >= 0 && sub[k][2] >= 0)
+	    children.push_back(Triangle(sub[k], sub[k] + 3));
+      }
+      ThirdVertex childThird;
+      buildThirdVertex(children, childThird);
+
+      // Patches of the four sub-triangles of face (0, 1, 2)
+      const int m01 = edgeChild[make_pair(0, 1)], m12 = edgeChild[make_pair(1, 2)],
+	m20 = edgeChild[make_pair(2, 0)];
+      const int sub[4][3] = {{vertexChild[0], m01, m20}, {vertexChild[1], m12, m01},
+			     {vertexChild[2], m20, m12}, {m01, m12, m20}};
+      for (int k = 0; k < 4; k++) {
+	vector<int > nodes;
+	S.valence[k] = k < 3 ? V[k] : 6;
+	if (!patchNodes(childThird, sub[k][0], sub[k][1], sub[k][2], nodes) ||
+	    int(nodes.size()) != S.valence[k] + 6) {
+	  cout << "** LoopShellShape: cannot subdivide patch with valences "
+	       << V[0] << " " << V[1] << " " << V[2] << endl;
+	  exit(1);
+	}
+	S.W[k] = MatrixXd::Zero(nodes.size(), n);
+	for (uint i = 0; i < nodes.size(); i++)
+	  for (uint j = 0; j < rows[nodes[i]].size(); j++)
+	    S.W[k](i, rows[nodes[i]][j].first) += rows[nodes[i]][j].second;
+      }
+    }
+
+
+
+    //! Eigenbasis of the subdivision matrix A of a patch with one
+    //! extraordinary vertex of valence N at corner 0 (Stam). With the
+    //! extraordinary vertex and its ring (I) first and the 5 outer nodes
+    //! (O) last, A = [S 0; C D]. A itself is defective for some valences
+    //! (S and D share the eigenvalues 1/8 and 1/16), but S and D are not,
+    //! so A^n = [S^n 0; X_n D^n] with S = Vs Ls Vs^-1, D = Vd Ld Vd^-1 and
+    //! X_n = sum_i D^(n-1-i) C S^i = Vd G_n Vs^-1, G_n(p, q) = Ct(p, q)
+    //! (mu_p^n - lambda_q^n)/(mu_p - lambda_q), Ct = Vd^-1 C Vs.
+    //! Mi[k], Mo[k] map the eigencoefficients to the regular sub-patches 1, 2, 3.
+    struct EigenBasis
+    {
+      vector<int > inner, outer;
+      VectorXd Ls, Ld;
+      MatrixXd VsInv, VdInv, Ct;
+      MatrixXd Mi[3], Mo[3];
+    };
+
+    //! Real eigendecomposition M = V diag(L) V^-1
+    bool diagonalize(const MatrixXd & M, VectorXd & L, MatrixXd & V, MatrixXd & Vinv)
+    {
+      EigenSolver<MatrixXd > es(M);
+      V = es.eigenvectors().real();
+      L = es.eigenvalues().real();
+      Vinv = V.inverse();
+      const Real error = (M - V*L.asDiagonal()*Vinv).norm();
+      return es.eigenvalues().imag().norm() < 1.0e-12 && error < 1.0e-10;
+    }
+
+    //! Rows Rows and columns Cols of M
+    MatrixXd block(const MatrixXd & M, const vector<int > & Rows, const vector<int > & Cols)
+    {
+      MatrixXd B(Rows.size(), Cols.size());
+      for (uint i = 0; i < Rows.size(); i++)
+	for (uint j = 0; j < Cols.size(); j++)
+	  B(i, j) = M(Rows[i], Cols[j]);
+      return B;
+    }
+
+    void buildEigenBasis(const int N, EigenBasis & E)
+    {
+      vector<int > V(3, 6);
+      V[0] = N;
+      SubPatches S;
+      buildSubPatches(V, S);
+      const MatrixXd & A = S.W[0];
+      for (int i = 0; i < A.cols(); i++) {
+	// The new extraordinary vertex only depends on the old one and its ring
+	(A(0, i) != 0.0 ? E.inner : E.outer).push_back(i);
+      }
+
+      MatrixXd Vs, Vd;
+      if (!diagonalize(block(A, E.inner, E.inner), E.Ls, Vs, E.VsInv) ||
+	  !diagonalize(block(A, E.outer, E.outer), E.Ld, Vd, E.VdInv) ||
+	  block(A, E.inner, E.outer).norm() != 0.0) {
+	cout << "** LoopShellShape: no real eigenbasis of the subdivision matrix for valence "
+	     << N << endl;
+	exit(1);
+      }
+      E.Ct = E.VdInv*block(A, E.outer, E.inner)*Vs;
+      for (int k = 0; k < 3; k++) {
+	vector<int > rows;
+	for (int i = 0; i < S.W[k + 1].rows(); i++)
+	  rows.push_back(i);
+	E.Mi[k] = block(S.W[k + 1], rows, E.inner)*Vs;
+	E.Mo[k] = block(S.W[k + 1], rows, E.outer)*Vd;
+      }
+    }
+
+
+
+    //! Shape functions of a patch with one extraordinary vertex at corner 0,
+    //! at any (v, w) away from it, at a cost independent of the number of
+    //! subdivision steps needed to reach a regular sub-patch
+    void extraordinaryPatch(const EigenBasis & E, Real v, Real w, ShapeValues & R)
+    {
+      const Real s = v + w;
+      if (!(s > 0.0)) {
+	cout << "** LoopShellShape: cannot evaluate at an extraordinary vertex" << endl;
+	exit(1);
+      }
+      // Subdivide n times so that the point leaves the sub-triangle at
+      // the extraordinary vertex: 1/2 < 2^n (v + w) <= 1
+      int n = max(0, int(floor(-log(s)/log(2.0))));
+      Real scale = ldexp(1.0, n);
+      while (scale*s <= 0.5) { n++; scale *= 2.0; }
+      while (n > 0 && scale*s > 1.0) { n--; scale *= 0.5; }
+      v *= scale;
+      w *= scale;
+
+      Matrix2d T;
+      const int k = subTriangle(v, w, T);
+      ShapeValues Rsub;
+      regularPatch(v, w, Rsub);
+
+      const int ni = E.Ls.size(), no = E.Ld.size();
+      VectorXd LsN(ni), LdN(no);
+      for (int q = 0; q < ni; q++)
+	LsN(q) = pow(E.Ls(q), n);
+      for (int p = 0; p < no; p++)
+	LdN(p) = pow(E.Ld(p), n);
+      MatrixXd G(no, ni);
+      for (int p = 0; p < no; p++)
+	for (int q = 0; q < ni; q++) {
+	  const Real mu = E.Ld(p), lambda = E.Ls(q);
+	  // Repeated eigenvalue: the sum is n lambda^(n-1)
+	  const Real f = fabs(mu - lambda) > 1.0e-8 ? (LdN(p) - LsN(q))/(mu - lambda) :
+	    (n > 0 ? n*pow(lambda, n - 1) : 0.0);
+	  G(p, q) = E.Ct(p, q)*f;
+	}
+
+      const Matrix<Real, 6, Dynamic> Ri = Rsub*E.Mi[k - 1], Ro = Rsub*E.Mo[k - 1];
+      const Matrix<Real, 6, Dynamic> Yi = (Ri*LsN.asDiagonal() + Ro*G)*E.VsInv,
+	Yo = Ro*LdN.asDiagonal()*E.VdInv;
+      R.resize(6, ni + no);
+      for (int q = 0; q < ni; q++)
+	R.col(E.inner[q]) = Yi.col(q);
+      for (int p = 0; p < no; p++)
+	R.col(E.outer[p]) = Yo.col(p);
+      changeVariables(R, scale*T);
+    }
+
+
+
+    //! Cached sub-patches and eigenbases, by valences
+    const SubPatches & getSubPatches(const vector<int > & V)
+    {
+      static map<vector<int >, SubPatches > cache;
+      SubPatches * S;
+#ifdef _OPENMP
+#pragma omp critical(LoopShellShapeCache)
+#endif
+      {
+	map<vector<int >, SubPatches >::iterator it = cache.find(V);
+	if (it == cache.end()) {
+	  it = cache.insert(make_pair(V, SubPatches())).first;
+	  buildSubPatches(V, it->second);
+	}
+	S = &(it->second);
+      }
+      return *S;
+    }
+
+    const EigenBasis & getEigenBasis(const int N)
+    {
+      static map<int, EigenBasis > cache;
+      EigenBasis * E;
+#ifdef _OPENMP
+#pragma omp critical(LoopShellShapeCache)
+#endif
+      {
+	map<int, EigenBasis >::iterator it = cache.find(N);
+	if (it == cache.end()) {
+	  it = cache.insert(make_pair(N, EigenBasis())).first;
+	  buildEigenBasis(N, it->second);
+	}
+	E = &(it->second);
+      }
+      return *E;
+    }
+
+  } // unnamed namespace
+
+
+
+  void LoopShellShape::update(const VectorXd & Point)
   {
-    _coords(0) = 1.0 - 2.0 * _coords(0);
-    _coords(1) = 1.0 - 2.0 * _coords(1);	
-    //! now, the parametric coords are related to the sub-patch
-  }
+    _coords = Point;
+    ShapeValues R;
+    if (_Valences[0] == 6 && _Valences[1] == 6 && _Valences[2] == 6)
+      regularPatch(_coords(0), _coords(1), R);
+    else {
+      // One subdivision step leaves at most one extraordinary vertex per
+      // sub-triangle, evaluated exactly through its eigenbasis
+      if (_nodes != _Valences[0] + _Valences[1] + _Valences[2] - 6) {
+	cout << "** LoopShellShape: " << _nodes << " nodes do not match valences "
+	     << _Valences[0] << " " << _Valences[1] << " " << _Valences[2] << endl;
+	exit(1);
+      }
+      const SubPatches & S = getSubPatches(_Valences);
+      Real v = _coords(0), w = _coords(1);
+      Matrix2d T;
+      const int k = subTriangle(v, w, T);
+      ShapeValues Rsub;
+      if (S.valence[k] == 6)
+	regularPatch(v, w, Rsub);
+      else
+	extraordinaryPatch(getEigenBasis(S.valence[k]), v, w, Rsub);
+      changeVariables(Rsub, T);
+      R = Rsub*S.W[k];
+    }
 
+    for (int a = 0; a < _nodes; a++) {
+      _N[a] = R(0, a);
+      _DN[a] << R(1, a), R(2, a);
+      _DDN[a] << R(3, a), R(5, a), R(5, a), R(4, a);
+    }
+  }
 
 } // namespace voom
@@ -15,7 +15,6 @@ namespace voom{
   class LoopShellShape: public Shape {
 
   public:
-    typedef Eigen::Matrix<double,12,Dynamic> SubdivisionMatrix;
     typedef vector<int> CornerValences; //Valences of nodes at three corners
 
     //! LoopShellShape constructor fills in N, DN and DDN
@@ -30,7 +29,11 @@ namespace voom{
     }
 
    
-    //! Update recomputes N, DN and DDN at a Point assuming it's in a regular patch
+    //! Update recomputes N, DN and DDN at a Point. Regular patches use the
+    //! 12 box splines; irregular ones are subdivided once and each
+    //! extraordinary corner is evaluated exactly through the eigenbasis of
+    //! its subdivision matrix (precomputed once per valence), at any point
+    //! of the triangle
     void update(const VectorXd & Point);
 
     //! Get number of shape functions
@@ -126,18 +129,6 @@ namespace voom{
 
     int _nodes; //Regular patch: 12, Irregular patch: variable
 
-    void _computeFunctions( const SubdivisionMatrix & S, bool needSubdivide);
-
-    void _computeDerivatives( const SubdivisionMatrix & S, bool needSubdivide);
-
-    void _computeSecondDerivatives( const SubdivisionMatrix & S, bool needSubdivide);
-
-    //! compute subdivision Matrix
-    void _computeSubdivisionMatrix(SubdivisionMatrix & S, 
-				    bool needSubdivide );
-    
-    void _convertParaCoords();
-
     void _initialize(const int nodes, const VectorXd & paraCoords);
     
     void _initialize(const int nodes) {
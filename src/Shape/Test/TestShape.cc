@@ -207,6 +207,8 @@ int main()
     srand( time(NULL) );
     Point2D(0) = (Real(rand())/RAND_MAX );
     Point2D(1) = (Real(rand())/RAND_MAX );
+    // Inside the triangle
+    if (Point2D.sum() > 1.0) Point2D = Vector2d::Ones() - Point2D;
     vector<int> Valences(3,0);
     Valences[0]=6; Valences[1]=5; Valences[2]=6;
     cout << "Testing LoopShellShape" << endl;
@@ -216,6 +218,15 @@ int main()
     LpShlShp.checkConsistency2(Point2D, 1e-8, 1e-6);
     LpShlShp.checkPartitionUnity(Point2D);
 
+    // Close to an extraordinary vertex of valence 7, many subdivision
+    // levels away from a regular patch
+    Valences[0]=7; Valences[1]=6; Valences[2]=6;
+    Point2D *= 1.0e-2;
+    LoopShellShape LpShlShp7(13, Valences, Point2D);
+    cout << "Check consistency at Point " << Point2D.transpose() << endl;
+    LpShlShp7.checkConsistency(Point2D, 1e-9, 1e-6);
+    LpShlShp7.checkConsistency2(Point2D, 1e-9, 1e-4);
+    LpShlShp7.checkPartitionUnity(Point2D);
   }
 
 }
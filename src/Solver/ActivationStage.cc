@@ -0,0 +1,77 @@
+#include "ActivationStage.h"
+
+namespace voom{
+
+  TimeTableActivation::TimeTableActivation(const vector<Real > & ActivationTimes,
+					   const vector<Real > & Curve,
+					   Real CurveDt, Real MinActivation):
+    ActivationStage(ActivationTimes.size()), _times(ActivationTimes),
+    _curve(Curve), _curveDt(CurveDt), _minActivation(MinActivation)
+  {
+    if (_curve.size() < 2 || _curveDt <= 0.0) {
+      cout << "** TimeTableActivation: the activation curve needs at least two samples and a positive spacing." << endl;
+      exit(1);
+    }
+  }
+
+
+
+  Real TimeTableActivation::curve(Real t) const
+  {
+    const Real s = t/_curveDt;
+    const int last = _curve.size() - 1;
+    if (!(s >= 0.0) || s > Real(last)) // also not activated (HUGE_VAL, NaN)
+      return _minActivation;
+    const int i = min(int(s), last - 1);
+    const Real w = s - Real(i);
+    return max((1.0 - w)*_curve[i] + w*_curve[i + 1], _minActivation);
+  }
+
+
+
+  void TimeTableActivation::advance(Real Time)
+  {
+    const int NumNodes = _activation.size();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int n = 0; n < NumNodes; n++)
+      _activation[n] = this->curve(Time - _times[n]);
+  }
+
+
+
+  EPActivation::EPActivation(EigenEPsolver *EPsolver, EPModel *myEPModel,
+			     const vector<Real > & Curve, Real CurveDt,
+			     Real MinActivation, Real Threshold):
+    TimeTableActivation(vector<Real >(myEPModel->getVoltage().size(), HUGE_VAL),
+			Curve, CurveDt, MinActivation),
+    _EPsolver(EPsolver), _myEPModel(myEPModel), _threshold(Threshold),
+    _prevVoltage(myEPModel->getVoltage()) {};
+
+
+
+  void EPActivation::advance(Real Time)
+  {
+    const vector<Real > & V = _myEPModel->getVoltage();
+    const int NumNodes = V.size();
+    const Real dt = _EPsolver->getTimeStep();
+
+    while (_EPsolver->getTime() < Time - 0.5*dt) {
+      const Real t0 = _EPsolver->getTime();
+      _EPsolver->step();
+      // Latest upward crossing of the threshold, linear in time
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+      for (int n = 0; n < NumNodes; n++) {
+	if (_prevVoltage[n] < _threshold && V[n] >= _threshold)
+	  _times[n] = t0 + dt*(_threshold - _prevVoltage[n])/(V[n] - _prevVoltage[n]);
+	_prevVoltage[n] = V[n];
+      }
+    }
+
+    TimeTableActivation::advance(Time);
+  }
+
+} // namespace voom
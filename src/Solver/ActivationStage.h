@@ -0,0 +1,107 @@
+//-*-C++-*-
+/*!
+  \file ActivationStage.h
+  \brief Sources of the nodal activation multiplier driving the active
+  contraction in the electromechanical time loop (ElectroMechanicsSolver).
+  A stage is advanced to a given time and then provides the activation at
+  every node of the mechanics mesh; the coupled solver interpolates it to
+  the quadrature points.
+
+  - TimeTableActivation: every node starts the activation curve (e.g. the
+  calcium transient of the Contraction apps) at its own activation time,
+  e.g. computed by the EikonalSolver.
+  - EPActivation: the activation times are the upstrokes of the voltage of
+  a monodomain EP model advanced with EigenEPsolver on the same nodes.
+*/
+
+#ifndef __ActivationStage_h__
+#define __ActivationStage_h__
+
+#include "voom.h"
+#include "EigenEPsolver.h"
+
+namespace voom{
+
+  class ActivationStage
+  {
+  public:
+    //! Constructor
+    ActivationStage(uint NumNodes): _activation(NumNodes, 0.0) {};
+
+    //! Destructor
+    virtual ~ActivationStage() {};
+
+    //! Advance to Time and update the nodal activation
+    virtual void advance(Real Time) = 0;
+
+    //! Activation at every node at the last advanced time
+    const vector<Real > & getNodalActivation() const { return _activation; }
+
+  protected:
+    vector<Real > _activation;
+  };
+
+
+
+  class TimeTableActivation: public ActivationStage
+  {
+  public:
+    //! Constructor
+    /*!
+      \param ActivationTimes one activation time per node (HUGE_VAL = never)
+      \param Curve activation multiplier sampled every CurveDt from the
+      activation time, MinActivation is used outside the curve
+    */
+    TimeTableActivation(const vector<Real > & ActivationTimes,
+			const vector<Real > & Curve, Real CurveDt,
+			Real MinActivation = 0.0);
+
+    //! Destructor
+    virtual ~TimeTableActivation() {};
+
+    void advance(Real Time);
+
+    //! Change the activation times
+    void setActivationTimes(const vector<Real > & ActivationTimes) {
+      _times = ActivationTimes;
+    }
+    const vector<Real > & getActivationTimes() const { return _times; }
+
+  protected:
+    //! Activation at time t from the activation time (linear interpolation)
+    Real curve(Real t) const;
+
+    vector<Real > _times;
+    vector<Real > _curve;
+    Real          _curveDt, _minActivation;
+  };
+
+
+
+  class EPActivation: public TimeTableActivation
+  {
+  public:
+    //! Constructor
+    /*!
+      \param Threshold voltage (mV) whose upward crossing starts the curve
+    */
+    EPActivation(EigenEPsolver *EPsolver, EPModel *myEPModel,
+		 const vector<Real > & Curve, Real CurveDt,
+		 Real MinActivation = 0.0, Real Threshold = -40.0);
+
+    //! Destructor
+    virtual ~EPActivation() {};
+
+    //! Advance the EP solver up to Time, then update the activation
+    void advance(Real Time);
+
+  protected:
+    EigenEPsolver *_EPsolver;
+    EPModel       *_myEPModel;
+    Real           _threshold;
+    vector<Real >  _prevVoltage;
+  };
+
+} // namespace voom
+
+#endif
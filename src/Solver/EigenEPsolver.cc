@@ -0,0 +1,90 @@
+#include "EigenEPsolver.h"
+
+namespace voom
+{
+  void EigenEPsolver::factorize()
+  {
+    uint PbDoF = (_myModel->getMesh())->getNumberOfNodes();
+
+    // Conductivity matrix
+    EigenResult myResults(PbDoF, 0);
+    myResults.setRequest(STIFFNESS);
+    _myModel->compute(&myResults);
+    _K = *(myResults._stiffness);
+
+    // Mass matrix
+    _myModel->computeMassMatrix(_M, _lumpedMass);
+
+    // Left hand side is SPD
+    SparseMatrix<Real > A = _M + (_theta*_dt)*_K;
+    _B = _M - ((1.0 - _theta)*_dt)*_K;
+    _solver.compute(A);
+    if (_solver.info() != Success) {
+      cout << "** EigenEPsolver: factorization of diffusion system failed" << endl;
+      exit(1);
+    }
+
+    _factorized = true;
+  }
+
+
+
+  void EigenEPsolver::reaction(Real dt)
+  {
+    Real h = dt/Real(_reactionSubSteps);
+    for (uint s = 0; s < _reactionSubSteps; s++)
+      _myModel->computeReaction(h, _time + Real(s)*h);
+  }
+
+
+
+  void EigenEPsolver::diffusion()
+  {
+    vector<Real > & V = _myModel->getVoltage();
+    Map<VectorXd > Vmap(&V[0], V.size());
+    VectorXd rhs = _B*Vmap;
+    Vmap = _solver.solve(rhs);
+  }
+
+
+
+  void EigenEPsolver::step()
+  {
+    if (!_factorized)
+      this->factorize();
+
+    _myModel->setPrevField();
+    switch (_splitting)
+    {
+    case GODUNOV:
+      this->reaction(_dt);
+      this->diffusion();
+      break;
+    case STRANG:
+      this->reaction(0.5*_dt);
+      this->diffusion();
+      _time += 0.5*_dt;
+      this->reaction(0.5*_dt);
+      _time -= 0.5*_dt;
+      break;
+    }
+    _time += _dt;
+  }
+
+
+
+  void EigenEPsolver::solve(Real FinalTime, const string OutputFile, uint OutputFreq)
+  {
+    uint step = 0;
+    if (OutputFreq > 0)
+      _myModel->writeOutputVTK(OutputFile, step);
+
+    while (_time < FinalTime - 0.5*_dt) {
+      this->step();
+      step++;
+      if (OutputFreq > 0 && step % OutputFreq == 0)
+	_myModel->writeOutputVTK(OutputFile, step);
+    }
+  }
+
+} // namespace voom
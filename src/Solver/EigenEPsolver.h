@@ -0,0 +1,97 @@
+//-*-C++-*-
+/*!
+  \file EigenEPsolver.h
+  \brief Operator splitting solver for the monodomain EP model based on
+  Eigen sparse solver. Each time step is split into a reaction step (ionic
+  models integrated node by node) and a diffusion step solved with a
+  theta-scheme
+  \f[
+  (M + \theta \Delta t K) V^{n+1} = (M - (1-\theta) \Delta t K) V^n
+  \f]
+  The system matrix does not change as long as dt does not change, hence it
+  is factorized only once.
+*/
+
+#ifndef __EigenEPsolver_h__
+#define __EigenEPsolver_h__
+
+#include "voom.h"
+#include "Mesh.h"
+#include "EPModel.h"
+#include "EigenResult.h"
+
+namespace voom{
+
+  //! Operator splitting scheme
+  enum SplittingType {
+    GODUNOV = 0, // reaction (dt) - diffusion (dt)
+    STRANG  = 1  // reaction (dt/2) - diffusion (dt) - reaction (dt/2)
+  };
+
+  class EigenEPsolver
+  {
+  public:
+    //! Constructor
+    /*!
+      \param Theta 0.5 = Crank-Nicolson, 1.0 = backward Euler
+      \param ReactionSubSteps number of ionic substeps per reaction step
+    */
+    EigenEPsolver( EPModel *myModel,
+		   Real dt,
+		   SplittingType Splitting = GODUNOV,
+		   Real Theta = 0.5,
+		   bool LumpedMass = true,
+		   uint ReactionSubSteps = 1):
+      _myModel(myModel), _dt(dt), _time(0.0),
+      _splitting(Splitting), _theta(Theta),
+      _lumpedMass(LumpedMass), _reactionSubSteps(ReactionSubSteps),
+      _factorized(false) {};
+
+    //! Destructor
+    ~EigenEPsolver() {};
+
+    //! Change time step - forces refactorization
+    void setTimeStep(Real dt) {
+      if (dt != _dt) {
+	_dt = dt;
+	_factorized = false;
+      }
+    }
+    Real getTimeStep() { return _dt; }
+
+    //! Current time (ms)
+    Real getTime() { return _time; }
+    void setTime(Real time) { _time = time; }
+
+    //! Advance one time step
+    void step();
+
+    //! Advance up to final time, writing output every OutputFreq steps (0 = none)
+    void solve(Real FinalTime, const string OutputFile = "", uint OutputFreq = 0);
+
+  protected:
+    //! Assemble mass, stiffness and factorize diffusion system
+    void factorize();
+
+    //! Reaction step over dt split in _reactionSubSteps
+    void reaction(Real dt);
+
+    //! Diffusion step over _dt
+    void diffusion();
+
+    EPModel*        _myModel;
+    Real            _dt;
+    Real            _time;
+    SplittingType   _splitting;
+    Real            _theta;
+    bool            _lumpedMass;
+    uint            _reactionSubSteps;
+
+    bool            _factorized;
+    SparseMatrix<Real > _M, _K, _B;
+    SimplicialLDLT<SparseMatrix<Real > > _solver;
+  };
+
+}
+
+#endif // __EigenEPsolver_h__
@@ -13,11 +13,18 @@ namespace voom
     }
 
     // Find unique material parameters
-    vector<MechanicsMaterial *> materials = _myModel->getMaterials();
     set<MechanicsMaterial *> UNIQUEmaterials;
-    for (uint i = 0; i < materials.size(); i++) 
-      UNIQUEmaterials.insert(materials[i]);
-    uint TotNumMatProp =  UNIQUEmaterials.size()*(materials[0]->getMaterialParameters()).size();
+    uint TotNumMatProp = 0;
+    if (_mechModel) {
+      vector<MechanicsMaterial *> materials = _mechModel->getMaterials();
+      for (uint i = 0; i < materials.size(); i++) 
+	UNIQUEmaterials.insert(materials[i]);
+      TotNumMatProp = UNIQUEmaterials.size()*(materials[0]->getMaterialParameters()).size();
+    }
+    else if (UKN == MAT) {
+      cout << "** EigenNRsolver: solving for material parameters needs a MechanicsModel" << endl;
+      exit(1);
+    }
 
     // Create Eigen results
     EigenResult myResults( PbDoF, TotNumMatProp );
@@ -32,12 +32,16 @@ namespace voom{
   {
   public:
     //! Constructor
-    EigenNRsolver( MechanicsModel *myModel, 
+    /*! Any Model providing residual and stiffness can be solved for its
+      field (e.g. LoopShellModel); solving for material parameters needs
+      a MechanicsModel.
+    */
+    EigenNRsolver( Model *myModel, 
 		   vector<int > & DoFid,
 		   vector<Real > & DoFvalues,
 		   SolverType LinSolType = CHOL,
 		   Real NRtol = 1.0e-8, uint NRmaxIter = 100):
-      _myModel(myModel),
+      _myModel(myModel), _mechModel(dynamic_cast<MechanicsModel* >(myModel)),
       _DoFid(DoFid), _DoFvalues(DoFvalues),
       _linSolType(LinSolType),
       _NRtol(NRtol), _NRmaxIter(NRmaxIter) {};
@@ -52,7 +56,8 @@ namespace voom{
     void applyEBC(EigenResult & myResults);
 
   protected:
-    MechanicsModel*  _myModel;
+    Model*          _myModel;
+    MechanicsModel* _mechModel;
     vector<int > &  _DoFid;
     vector<Real > & _DoFvalues;
     SolverType      _linSolType;
@@ -0,0 +1,318 @@
+#include "EikonalSolver.h"
+#include <queue>
+#include <functional>
+
+namespace voom{
+
+  // C3D10 mid-side nodes and the vertices of their edge (QuadTetShape order)
+  static const int TetEdges[6][3] = { {4, 0, 1}, {5, 1, 2}, {6, 2, 0},
+				      {7, 0, 3}, {8, 1, 3}, {9, 2, 3} };
+
+  EikonalSolver::EikonalSolver(FEMesh *myMesh, Real Velocity):
+    _myMesh(myMesh), _fiberVelocity(Velocity), _transverseVelocity(Velocity)
+  {
+    vector<Vector3d > Fibers(myMesh->getNumberOfElements(), Vector3d::Zero());
+    this->initialize(Fibers);
+  }
+
+
+
+  EikonalSolver::EikonalSolver(FEMesh *myMesh, const vector<Vector3d > & Fibers,
+			       Real FiberVelocity, Real TransverseVelocity):
+    _myMesh(myMesh), _fiberVelocity(FiberVelocity),
+    _transverseVelocity(TransverseVelocity)
+  {
+    this->initialize(Fibers);
+  }
+
+
+
+  void EikonalSolver::initialize(const vector<Vector3d > & Fibers)
+  {
+    const int NumNodes = _myMesh->getNumberOfNodes();
+    const int NumEl = _myMesh->getNumberOfElements();
+    const vector<GeomElement* > & elements = _myMesh->getElements();
+
+    if (_myMesh->getDimension() != 3 || NumEl == 0) {
+      cout << "** EikonalSolver: a 3D tetrahedral mesh is required." << endl;
+      exit(1);
+    }
+    if (int(Fibers.size()) != NumEl) {
+      cout << "** EikonalSolver: " << Fibers.size() << " fibers given for "
+	   << NumEl << " elements." << endl;
+      exit(1);
+    }
+    if (_fiberVelocity <= 0.0 || _transverseVelocity <= 0.0) {
+      cout << "** EikonalSolver: conduction velocities must be positive." << endl;
+      exit(1);
+    }
+
+    _pos.resize(NumNodes);
+    for (int n = 0; n < NumNodes; n++)
+      _pos[n] = _myMesh->getX(n).head<3>();
+
+    _tet.resize(4*NumEl);
+    _fibers.resize(NumEl);
+    _isVertex.assign(NumNodes, false);
+    _midEdge.assign(2*NumNodes, -1);
+    for (int e = 0; e < NumEl; e++) {
+      const vector<int > & nodes = elements[e]->getNodesID();
+      if (nodes.size() != 4 && nodes.size() != 10) {
+	cout << "** EikonalSolver: element " << e << " has " << nodes.size()
+	     << " nodes, only C3D4 and C3D10 are supported." << endl;
+	exit(1);
+      }
+      for (int a = 0; a < 4; a++) {
+	_tet[4*e + a] = nodes[a];
+	_isVertex[nodes[a]] = true;
+      }
+      if (nodes.size() == 10)
+	for (int m = 0; m < 6; m++) {
+	  _midEdge[2*nodes[TetEdges[m][0]]    ] = nodes[TetEdges[m][1]];
+	  _midEdge[2*nodes[TetEdges[m][0]] + 1] = nodes[TetEdges[m][2]];
+	}
+      Real norm = Fibers[e].norm();
+      _fibers[e] = norm > 0.0 ? Vector3d(Fibers[e]/norm) : Vector3d::Zero();
+    }
+
+    // Node to element map (vertices only)
+    _nodeEleStart.assign(NumNodes + 1, 0);
+    for (int i = 0; i < 4*NumEl; i++)
+      _nodeEleStart[_tet[i] + 1]++;
+    for (int n = 0; n < NumNodes; n++)
+      _nodeEleStart[n + 1] += _nodeEleStart[n];
+    _nodeEle.resize(4*NumEl);
+    vector<int > fill(_nodeEleStart.begin(), _nodeEleStart.end() - 1);
+    for (int i = 0; i < 4*NumEl; i++)
+      _nodeEle[fill[_tet[i]]++] = i/4;
+
+    _T.assign(NumNodes, HUGE_VAL);
+  }
+
+
+
+  void EikonalSolver::addSource(int Node, Real Time)
+  {
+    if (Node < 0 || Node >= int(_T.size())) {
+      cout << "** EikonalSolver: source node " << Node << " out of range." << endl;
+      exit(1);
+    }
+    _sources.push_back(Node);
+    _sourceTimes.push_back(Time);
+  }
+
+  void EikonalSolver::addSources(const vector<int > & Nodes, Real Time)
+  {
+    for (uint i = 0; i < Nodes.size(); i++)
+      this->addSource(Nodes[i], Time);
+  }
+
+  void EikonalSolver::clearSources()
+  {
+    _sources.clear();
+    _sourceTimes.clear();
+  }
+
+
+
+  Real EikonalSolver::simplexUpdate(const Matrix3d & A, const Vector3d & X,
+				    const Vector3d *Y, const Real *T,
+				    int NumKnown) const
+  {
+    // Minimize T(l) = Tc + l.d + |u - V l|_A over the simplex, with Yc the
+    // last vertex, V = [Yi - Yc], d = [Ti - Tc] and u = X - Yc. With l0 the
+    // A-projection of u on span(V) and h its distance from the span, the
+    // stationary point is l = l0 - r G^-1 d, r = h/sqrt(1 - d.G^-1 d)
+    const int c = NumKnown - 1;
+    const Vector3d u = X - Y[c];
+    const Vector3d Au = A*u;
+    const Real uAu = u.dot(Au);
+
+    if (c == 0)
+      return T[0] + sqrt(uAu);
+
+    if (c == 1) {
+      const Vector3d v = Y[0] - Y[c];
+      const Real a = v.dot(A*v), b = v.dot(Au), d = T[0] - T[c];
+      if (a <= d*d) return HUGE_VAL;
+      const Real h2 = uAu - b*b/a;
+      if (h2 <= 0.0) return HUGE_VAL;
+      const Real r = sqrt(h2/(1.0 - d*d/a));
+      const Real l = (b - r*d)/a;
+      if (l < 0.0 || l > 1.0) return HUGE_VAL;
+      return T[c] + l*d + r;
+    }
+
+    Matrix<Real, 3, 2> V;
+    V.col(0) = Y[0] - Y[c];
+    V.col(1) = Y[1] - Y[c];
+    const Matrix<Real, 3, 2> AV = A*V;
+    const Matrix2d G = V.transpose()*AV;
+    const Real det = G.determinant();
+    if (det <= 1.0e-14*G(0,0)*G(1,1)) return HUGE_VAL;
+    const Matrix2d Ginv = G.inverse();
+    const Vector2d d(T[0] - T[c], T[1] - T[c]);
+    const Vector2d l0 = Ginv*(AV.transpose()*u);
+    const Vector2d Gd = Ginv*d;
+    const Real s = d.dot(Gd);
+    const Real h2 = uAu - l0.dot(G*l0);
+    if (s >= 1.0 || h2 <= 0.0) return HUGE_VAL;
+    const Real r = sqrt(h2/(1.0 - s));
+    const Vector2d l = l0 - r*Gd;
+    if (l(0) < 0.0 || l(1) < 0.0 || l(0) + l(1) > 1.0) return HUGE_VAL;
+    return T[c] + l.dot(d) + r;
+  }
+
+
+
+  Matrix3d EikonalSolver::metric(int e) const
+  {
+    const Vector3d & f = _fibers[e];
+    const Real it2 = 1.0/(_transverseVelocity*_transverseVelocity);
+    const Real if2 = 1.0/(_fiberVelocity*_fiberVelocity);
+    return it2*Matrix3d::Identity() + (if2 - it2)*f*f.transpose();
+  }
+
+
+
+  Real EikonalSolver::localUpdate(int e, int v) const
+  {
+    const Matrix3d A = this->metric(e);
+
+    Vector3d Y[3];
+    Real T[3];
+    int k = 0;
+    for (int a = 0; a < 4; a++) {
+      const int n = _tet[4*e + a];
+      if (n == v || _T[n] == HUGE_VAL) continue;
+      Y[k] = _pos[n];
+      T[k] = _T[n];
+      k++;
+    }
+
+    const Vector3d & X = _pos[v];
+    Real best = HUGE_VAL;
+    // Face
+    if (k == 3)
+      best = min(best, this->simplexUpdate(A, X, Y, T, 3));
+    // Edges
+    for (int i = 0; i < k; i++)
+      for (int j = i + 1; j < k; j++) {
+	Vector3d Ye[2] = {Y[i], Y[j]};
+	Real Te[2] = {T[i], T[j]};
+	best = min(best, this->simplexUpdate(A, X, Ye, Te, 2));
+      }
+    // Vertices
+    for (int i = 0; i < k; i++)
+      best = min(best, this->simplexUpdate(A, X, &Y[i], &T[i], 1));
+
+    return best;
+  }
+
+
+
+  void EikonalSolver::solve()
+  {
+    typedef pair<Real, int > HeapEntry;
+    priority_queue<HeapEntry, vector<HeapEntry >, greater<HeapEntry > > heap;
+
+    const int NumNodes = _T.size();
+    _T.assign(NumNodes, HUGE_VAL);
+    vector<bool > fixed(NumNodes, false);
+
+    if (_sources.empty()) {
+      cout << "** EikonalSolver: no source nodes given." << endl;
+      exit(1);
+    }
+
+    for (uint i = 0; i < _sources.size(); i++) {
+      const int n = _sources[i];
+      if (_isVertex[n]) {
+	_T[n] = min(_T[n], _sourceTimes[i]);
+	fixed[n] = true;
+	continue;
+      }
+      // A mid-side source activates the vertices of its edge, reached
+      // through the fastest of the elements sharing it
+      const int a = _midEdge[2*n], b = _midEdge[2*n + 1];
+      if (a < 0) continue; // node not in any element
+      const Vector3d d = 0.5*(_pos[a] - _pos[b]);
+      Real dAd = HUGE_VAL;
+      for (int k = _nodeEleStart[a]; k < _nodeEleStart[a + 1]; k++) {
+	const int e = _nodeEle[k];
+	for (int v = 0; v < 4; v++)
+	  if (_tet[4*e + v] == b)
+	    dAd = min(dAd, d.dot(this->metric(e)*d));
+      }
+      const Real ta = _sourceTimes[i] + sqrt(dAd);
+      _T[a] = min(_T[a], ta);
+      _T[b] = min(_T[b], ta);
+    }
+    for (int n = 0; n < NumNodes; n++)
+      if (_T[n] < HUGE_VAL) heap.push(HeapEntry(_T[n], n));
+
+    while (!heap.empty()) {
+      const HeapEntry top = heap.top();
+      heap.pop();
+      const int n = top.second;
+      if (top.first > _T[n]) continue; // outdated entry
+
+      for (int i = _nodeEleStart[n]; i < _nodeEleStart[n + 1]; i++) {
+	const int e = _nodeEle[i];
+	for (int a = 0; a < 4; a++) {
+	  const int w = _tet[4*e + a];
+	  if (w == n || fixed[w]) continue;
+	  const Real t = this->localUpdate(e, w);
+	  if (t < _T[w] - 1.0e-12*(1.0 + fabs(t))) {
+	    _T[w] = t;
+	    heap.push(HeapEntry(t, w));
+	  }
+	}
+      }
+    }
+
+    // Mid-side nodes are interpolated from their edge
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int n = 0; n < NumNodes; n++)
+      if (!_isVertex[n] && _midEdge[2*n] >= 0)
+	_T[n] = 0.5*(_T[_midEdge[2*n]] + _T[_midEdge[2*n + 1]]);
+    for (uint i = 0; i < _sources.size(); i++)
+      _T[_sources[i]] = min(_T[_sources[i]], _sourceTimes[i]);
+  }
+
+
+
+  void EikonalSolver::getQuadPointTimes(vector<Real > & Times)
+  {
+    const vector<GeomElement* > & elements = _myMesh->getElements();
+    const int NumEl = elements.size();
+    const int NumQP = elements[0]->getNumberOfQuadPoints();
+    Times.assign(NumEl*NumQP, 0.0);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int e = 0; e < NumEl; e++) {
+      const vector<int > & nodes = elements[e]->getNodesID();
+      for (int q = 0; q < NumQP; q++) {
+	Real t = 0.0;
+	for (uint a = 0; a < nodes.size(); a++)
+	  t += elements[e]->getN(q, a)*_T[nodes[a]];
+	Times[e*NumQP + q] = t;
+      }
+    }
+  }
+
+
+
+  int EikonalSolver::getNumberOfUnreachedNodes() const
+  {
+    int count = 0;
+    for (uint n = 0; n < _T.size(); n++)
+      if (_isVertex[n] && _T[n] == HUGE_VAL) count++;
+    return count;
+  }
+
+} // namespace voom
@@ -0,0 +1,109 @@
+//-*-C++-*-
+/*!
+  \file EikonalSolver.h
+  \brief Fast marching solver for the anisotropic eikonal equation on a
+  tetrahedral FEMesh, used to compute the activation times of the tissue
+  \f[
+  \sqrt{\nabla T \cdot D \nabla T} = 1, \qquad
+  D = c_t^2 I + (c_f^2 - c_t^2) f \otimes f
+  \f]
+  with f the (per element) fiber direction, c_f and c_t the conduction
+  velocities along and across the fibers. Nodes are taken in order of
+  increasing time from a binary heap; each node taken updates the nodes of
+  its elements with the minimum of the local problem over the opposite
+  face, its edges and its vertices (time linear on the face, metric D^{-1}
+  of the element). The scheme is first order: the error decreases linearly
+  with the mesh size.
+
+  With anisotropy the causality of the classical fast marching does not
+  hold, so a node whose time decreases again is put back in the heap and
+  updates its neighbours once more. This removes the ordering error but
+  bounds neither the number of re-insertions nor the cost: with a single
+  pass per node the cost is O(N log N) in the number of nodes, strongly
+  anisotropic or distorted meshes take more passes.
+
+  Units follow the inputs: with positions in cm and velocities in cm/ms
+  the times are in ms. C3D4 and C3D10 meshes are supported; for C3D10 the
+  equation is solved on the vertices and the mid-side nodes are linearly
+  interpolated, so that per quadrature point times are consistent.
+*/
+
+#ifndef __EikonalSolver_h__
+#define __EikonalSolver_h__
+
+#include "voom.h"
+#include "FEMesh.h"
+
+namespace voom{
+
+  class EikonalSolver
+  {
+  public:
+    //! Isotropic conduction with velocity Velocity
+    EikonalSolver(FEMesh *myMesh, Real Velocity);
+
+    //! Anisotropic conduction, one fiber direction per element
+    EikonalSolver(FEMesh *myMesh, const vector<Vector3d > & Fibers,
+		  Real FiberVelocity, Real TransverseVelocity);
+
+    //! Destructor
+    ~EikonalSolver() {};
+
+    //! Activate Node at time Time
+    void addSource(int Node, Real Time = 0.0);
+    void addSources(const vector<int > & Nodes, Real Time = 0.0);
+    void clearSources();
+
+    //! Compute the activation time of all nodes
+    void solve();
+
+    //! Activation time of each node (after solve)
+    const vector<Real > & getNodalTimes() const { return _T; }
+    Real getNodalTime(int Node) const { return _T[Node]; }
+
+    //! Activation time at each quadrature point, element by element
+    void getQuadPointTimes(vector<Real > & Times);
+
+    //! Number of nodes not reached from the sources (time left to HUGE_VAL)
+    int getNumberOfUnreachedNodes() const;
+
+  private:
+    //! Build vertex connectivity and node to element map
+    void initialize(const vector<Vector3d > & Fibers);
+
+    //! Inverse conductivity tensor of element e, d^T A d the squared
+    //! travel time along d
+    Matrix3d metric(int e) const;
+
+    //! Smallest time at vertex v of element e from its other vertices
+    Real localUpdate(int e, int v) const;
+
+    //! Minimum over the simplex spanned by the first NumKnown entries of
+    //! Y (times T) seen from X, HUGE_VAL if the minimum is on its boundary
+    Real simplexUpdate(const Matrix3d & A, const Vector3d & X,
+		       const Vector3d *Y, const Real *T, int NumKnown) const;
+
+    FEMesh *_myMesh;
+    Real _fiberVelocity, _transverseVelocity;
+
+    //! Nodal positions
+    vector<Vector3d > _pos;
+    //! Tetrahedra vertices, 4 per element
+    vector<int >      _tet;
+    //! Fiber direction per element (zero for isotropic conduction)
+    vector<Vector3d > _fibers;
+    //! Node to element map in compressed row format
+    vector<int >      _nodeEleStart, _nodeEle;
+    //! Vertex flag (false for C3D10 mid-side nodes)
+    vector<bool >     _isVertex;
+    //! End vertices of the edge of each mid-side node, 2 per node
+    vector<int >      _midEdge;
+
+    vector<int >  _sources;
+    vector<Real > _sourceTimes;
+    vector<Real > _T;
+  };
+
+} // namespace voom
+
+#endif
@@ -0,0 +1,162 @@
+#include "ElectroMechanicsSolver.h"
+#include <set>
+#include <ctime>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace voom{
+
+  // Wall clock time in seconds
+  static Real wallTime()
+  {
+#ifdef _OPENMP
+    return omp_get_wtime();
+#else
+    return Real(clock())/Real(CLOCKS_PER_SEC);
+#endif
+  }
+
+
+
+  ElectroMechanicsSolver::ElectroMechanicsSolver(ActivationStage *Activation,
+						 EigenNRsolver *MechanicsSolver,
+						 MechanicsModel *myModel, Mesh *myMesh,
+						 const vector<MechanicsMaterial * > & Materials,
+						 Real dt, Real StartTime, bool Pipelined):
+    _activation(Activation), _mechanicsSolver(MechanicsSolver),
+    _myModel(myModel), _materials(Materials), _dt(dt), _time(StartTime),
+    _pipelined(Pipelined), _initialized(false), _activationThreads(0),
+    _activationWallTime(0.0), _mechanicsWallTime(0.0), _stepWallTime(0.0)
+  {
+    const vector<GeomElement* > & elements = myMesh->getElements();
+    const int NumEl = elements.size();
+    const int NumQP = elements[0]->getNumberOfQuadPoints();
+    const int NumNodes = myMesh->getNumberOfNodes();
+
+    if (int(_materials.size()) != NumEl*NumQP) {
+      cout << "** ElectroMechanicsSolver: " << _materials.size()
+	   << " materials given for " << NumEl*NumQP << " quadrature points." << endl;
+      exit(1);
+    }
+    if (int(_activation->getNodalActivation().size()) != NumNodes) {
+      cout << "** ElectroMechanicsSolver: the activation stage has "
+	   << _activation->getNodalActivation().size() << " nodes, the mesh "
+	   << NumNodes << "." << endl;
+      exit(1);
+    }
+
+    // Shape function values at all quadrature points
+    vector<Triplet<Real > > triplets;
+    triplets.reserve(NumEl*NumQP*elements[0]->getNodesPerElement());
+    for (int e = 0; e < NumEl; e++) {
+      const vector<int > & nodes = elements[e]->getNodesID();
+      for (int q = 0; q < NumQP; q++)
+	for (uint a = 0; a < nodes.size(); a++)
+	  triplets.push_back(Triplet<Real >(e*NumQP + q, nodes[a],
+					    elements[e]->getN(q, a)));
+    }
+    _interpolation.resize(NumEl*NumQP, NumNodes);
+    _interpolation.setFromTriplets(triplets.begin(), triplets.end());
+
+    // The same material may be shared by several quadrature points, its
+    // state variables are updated once
+    set<MechanicsMaterial * > unique;
+    for (uint i = 0; i < _materials.size(); i++)
+      if (unique.insert(_materials[i]).second)
+	_uniqueMaterials.push_back(_materials[i]);
+
+    _actQP = VectorXd::Zero(NumEl*NumQP);
+    _actNext = _actQP;
+
+    // Output the residual of the last mechanics solve, it is invalidated
+    // when the state variables are updated
+    _myModel->setKeepOutputState(true);
+  }
+
+
+
+  void ElectroMechanicsSolver::activationStage(Real Time, VectorXd & QPactivation)
+  {
+    Real t0 = wallTime();
+    _activation->advance(Time);
+    const vector<Real > & nodal = _activation->getNodalActivation();
+    QPactivation = _interpolation*Map<const VectorXd >(&nodal[0], nodal.size());
+    _activationWallTime += wallTime() - t0;
+  }
+
+
+
+  void ElectroMechanicsSolver::mechanicsStage()
+  {
+    Real t0 = wallTime();
+    _mechanicsSolver->solve(DISP);
+    _myModel->finalizeCompute();
+
+    const int NumMat = _uniqueMaterials.size();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int k = 0; k < NumMat; k++)
+      _uniqueMaterials[k]->updateStateVariables();
+    _myModel->invalidateOutputState();
+    _mechanicsWallTime += wallTime() - t0;
+  }
+
+
+
+  void ElectroMechanicsSolver::step()
+  {
+    Real t0 = wallTime();
+    if (!_initialized) {
+      this->activationStage(_time, _actQP);
+      _initialized = true;
+    }
+
+    // A material shared by several quadrature points is set in order, the
+    // last of its quadrature points wins
+    const int NumQP = _materials.size();
+    const bool shared = _uniqueMaterials.size() < _materials.size();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if(!shared)
+#endif
+    for (int k = 0; k < NumQP; k++)
+      _materials[k]->setActivationMultiplier(_actQP(k));
+
+#ifdef _OPENMP
+    if (_pipelined && omp_get_max_threads() > 1) {
+      // Activation (step n+1) and mechanics (step n) run concurrently, the
+      // parallel loops inside each stage use their share of the threads
+      const int NumThreads = omp_get_max_threads();
+      const int actThreads = _activationThreads > 0 ?
+	min(_activationThreads, NumThreads - 1) : max(NumThreads/2, 1);
+      const int nested = omp_get_nested();
+      omp_set_nested(1);
+#pragma omp parallel sections num_threads(2)
+      {
+#pragma omp section
+	{
+	  omp_set_num_threads(NumThreads - actThreads);
+	  this->mechanicsStage();
+	}
+#pragma omp section
+	{
+	  omp_set_num_threads(actThreads);
+	  this->activationStage(_time + _dt, _actNext);
+	}
+      }
+      omp_set_nested(nested);
+    }
+    else
+#endif
+    {
+      this->mechanicsStage();
+      this->activationStage(_time + _dt, _actNext);
+    }
+
+    _actQP.swap(_actNext);
+    _time += _dt;
+    _stepWallTime += wallTime() - t0;
+  }
+
+} // namespace voom
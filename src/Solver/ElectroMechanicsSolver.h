@@ -0,0 +1,98 @@
+//-*-C++-*-
+/*!
+  \file ElectroMechanicsSolver.h
+  \brief Electromechanically coupled time loop. Every step sets the
+  activation multiplier of the mechanics materials (one per quadrature
+  point) and solves the mechanics with EigenNRsolver. The activation stage
+  only depends on its own state, so it is advanced to the next step while
+  the Newton solve of the current step runs: the two stages are run as two
+  OpenMP sections, each with its own share of the threads, and the
+  activation computed for step n+1 is swapped in at the end of step n.
+
+  The quadrature point activation is obtained from the nodal one with a
+  single sparse matrix-vector product with the shape function values
+  N_a(x_q) of all the elements, assembled once in the constructor.
+*/
+
+#ifndef __ElectroMechanicsSolver_h__
+#define __ElectroMechanicsSolver_h__
+
+#include "voom.h"
+#include "Mesh.h"
+#include "EigenNRsolver.h"
+#include "ActivationStage.h"
+
+namespace voom{
+
+  class ElectroMechanicsSolver
+  {
+  public:
+    //! Constructor
+    /*!
+      \param Materials mechanics materials, element by element and
+      quadrature point by quadrature point (as in MechanicsModel). A
+      material shared by several quadrature points gets the activation of
+      the last one.
+      \param dt time step of the coupled loop (same units as Activation)
+    */
+    ElectroMechanicsSolver(ActivationStage *Activation,
+			   EigenNRsolver *MechanicsSolver,
+			   MechanicsModel *myModel, Mesh *myMesh,
+			   const vector<MechanicsMaterial * > & Materials,
+			   Real dt, Real StartTime = 0.0,
+			   bool Pipelined = true);
+
+    //! Destructor
+    ~ElectroMechanicsSolver() {};
+
+    /*!
+      Solve the mechanics at the current time, update the material state
+      variables and advance the activation to the next time step
+    */
+    void step();
+
+    //! Time of the next mechanics solve
+    Real getTime() const { return _time; }
+
+    //! Activation at every quadrature point for the next mechanics solve
+    const VectorXd & getQuadPointActivation() const { return _actQP; }
+
+    //! Overlap activation and mechanics (needs OpenMP)
+    void setPipelined(bool Pipelined) { _pipelined = Pipelined; }
+
+    //! Threads given to the activation stage when pipelined (0 = half)
+    void setActivationThreads(int NumThreads) { _activationThreads = NumThreads; }
+
+    //! Accumulated wall time of the stages and of the steps (s)
+    Real getActivationWallTime() const { return _activationWallTime; }
+    Real getMechanicsWallTime() const { return _mechanicsWallTime; }
+    Real getStepWallTime() const { return _stepWallTime; }
+
+  protected:
+    //! Advance the activation to Time and interpolate it into QPactivation
+    void activationStage(Real Time, VectorXd & QPactivation);
+
+    //! Newton solve and state variables update
+    void mechanicsStage();
+
+    ActivationStage              *_activation;
+    EigenNRsolver                *_mechanicsSolver;
+    MechanicsModel               *_myModel;
+    vector<MechanicsMaterial * >  _materials;
+    vector<MechanicsMaterial * >  _uniqueMaterials;
+
+    Real _dt, _time;
+    bool _pipelined, _initialized;
+    int  _activationThreads;
+
+    //! Quadrature point interpolation of nodal values
+    SparseMatrix<Real, RowMajor > _interpolation;
+    //! Activation at the quadrature points for the current and next step
+    VectorXd _actQP, _actNext;
+
+    Real _activationWallTime, _mechanicsWallTime, _stepWallTime;
+  };
+
+} // namespace voom
+
+#endif
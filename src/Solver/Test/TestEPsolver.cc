@@ -0,0 +1,118 @@
+#include "FEMesh.h"
+#include "EPModel.h"
+#include "EigenEPsolver.h"
+#include "LR.h"
+
+using namespace voom;
+
+// Build a structured cable of C3D4 elements (each hexahedron split into 6 tets)
+void buildCable(vector<VectorXd > & X, vector<vector<int > > & Conn,
+		int nx, int ny, int nz, Real Lx, Real Ly, Real Lz);
+
+int main()
+{
+  cout << endl << "Testing monodomain EP solver on C3D4 cable ... " << endl;
+
+  int nx = 40, ny = 2, nz = 2;
+  Real Lx = 1.0, Ly = 0.05, Lz = 0.05; // cm
+  vector<VectorXd > X;
+  vector<vector<int > > Conn;
+  buildCable(X, Conn, nx, ny, nz, Lx, Ly, Lz);
+  FEMesh myMesh(X, Conn, "C3D4");
+  uint NumNodes = myMesh.getNumberOfNodes();
+  uint NumEl    = myMesh.getNumberOfElements();
+  cout << "Number of nodes = " << NumNodes << " - Number of elements = " << NumEl << endl;
+
+  // One LuoRudy cell per node, conductivity 1 mS/cm along the cable
+  vector<IonicMaterial * > ionicMaterials(NumNodes, (IonicMaterial *)(NULL));
+  for (uint i = 0; i < NumNodes; i++) {
+    ionicMaterials[i] = new LuoRudy(false, NULL);
+    // Bring gates to their resting steady state
+    for (uint n = 0; n < 2000; n++)
+      ionicMaterials[i]->compute(2000.0, 1.0, 0.5, -84.0, 0.0);
+  }
+  vector<Matrix3d > diffusion(NumEl, Matrix3d::Identity());
+
+  Real Xi = 2000.0, Cm = 1.0;
+  EPModel myModel(&myMesh, ionicMaterials, diffusion, Xi, Cm);
+  myModel.initializeField(-84.0);
+
+  // Stimulate left end
+  vector<int > stimNodes;
+  for (uint i = 0; i < NumNodes; i++)
+    if (myMesh.getX(i)(0) < 0.1*Lx + 1.0e-8) stimNodes.push_back(i);
+  myModel.addStimulus(stimNodes, 1.0e5, 0.0, 2.0);
+
+  // Check diffusion operator: constant field is in the kernel
+  {
+    EigenResult myResults(NumNodes, 0);
+    myModel.initializeField(-84.0);
+    myResults.setRequest(FORCE);
+    myModel.compute(&myResults);
+    Real maxRes = (myResults._residual)->cwiseAbs().maxCoeff();
+    cout << "Residual for uniform field = " << maxRes << " - "
+	 << (maxRes < 1.0e-10 ? "PASSED" : "FAILED") << endl;
+
+    SparseMatrix<Real > M;
+    myModel.computeMassMatrix(M, false);
+    Real Vol = VectorXd::Ones(NumNodes).dot(M*VectorXd::Ones(NumNodes));
+    cout << "Mass matrix volume = " << Vol << " (expected " << Lx*Ly*Lz << ") - "
+	 << (fabs(Vol - Lx*Ly*Lz) < 1.0e-10 ? "PASSED" : "FAILED") << endl;
+  }
+
+  // Propagate and record activation time at both ends of the cable
+  EigenEPsolver mySolver(&myModel, 0.02, STRANG, 0.5, true, 1);
+  Real tLeft = -1.0, tRight = -1.0;
+  while (mySolver.getTime() < 40.0) {
+    mySolver.step();
+    const vector<Real > & V = myModel.getVoltage();
+    for (uint i = 0; i < NumNodes; i++) {
+      if (myMesh.getX(i)(0) < 1.0e-8 && tLeft < 0.0 && V[i] > 0.0)
+	tLeft = mySolver.getTime();
+      if (myMesh.getX(i)(0) > Lx - 1.0e-8 && tRight < 0.0 && V[i] > 0.0)
+	tRight = mySolver.getTime();
+    }
+  }
+  cout << "Activation time left = " << tLeft << " ms - right = " << tRight << " ms" << endl;
+  if (tLeft >= 0.0 && tRight > tLeft)
+    cout << "Conduction velocity = " << Lx/(tRight - tLeft) << " cm/ms - PASSED" << endl;
+  else
+    cout << "No propagation - FAILED" << endl;
+
+  return 0;
+}
+
+
+
+void buildCable(vector<VectorXd > & X, vector<vector<int > > & Conn,
+		int nx, int ny, int nz, Real Lx, Real Ly, Real Lz)
+{
+  for (int k = 0; k <= nz; k++)
+    for (int j = 0; j <= ny; j++)
+      for (int i = 0; i <= nx; i++) {
+	VectorXd x(3);
+	x << Lx*Real(i)/Real(nx), Ly*Real(j)/Real(ny), Lz*Real(k)/Real(nz);
+	X.push_back(x);
+      }
+
+  // Kuhn triangulation of each hexahedron
+  const int tets[6][4] = { {0,1,3,7}, {0,1,7,5}, {0,4,5,7},
+			   {0,2,7,3}, {0,4,7,6}, {0,2,6,7} };
+  for (int k = 0; k < nz; k++)
+    for (int j = 0; j < ny; j++)
+      for (int i = 0; i < nx; i++) {
+	int v[8];
+	for (int c = 0; c < 8; c++)
+	  v[c] = (i + (c & 1)) + (nx+1)*((j + ((c >> 1) & 1)) + (ny+1)*(k + ((c >> 2) & 1)));
+	for (int t = 0; t < 6; t++) {
+	  vector<int > tet(4);
+	  for (int a = 0; a < 4; a++) tet[a] = v[tets[t][a]];
+	  // Keep positive orientation
+	  Vector3d e1 = X[tet[1]].head(3) - X[tet[0]].head(3);
+	  Vector3d e2 = X[tet[2]].head(3) - X[tet[0]].head(3);
+	  Vector3d e3 = X[tet[3]].head(3) - X[tet[0]].head(3);
+	  if (e1.cross(e2).dot(e3) < 0.0) swap(tet[1], tet[2]);
+	  Conn.push_back(tet);
+	}
+      }
+}
@@ -0,0 +1,249 @@
+#include "EikonalSolver.h"
+#include <ctime>
+#include <map>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace voom;
+
+// Wall clock time in seconds
+Real wallTime() {
+#ifdef _OPENMP
+  return omp_get_wtime();
+#else
+  return Real(clock())/Real(CLOCKS_PER_SEC);
+#endif
+}
+
+// Cube [0,L]^3 with N^3 cells, each split into 6 tetrahedra (C3D4 or C3D10)
+FEMesh * cubeMesh(int N, Real L, bool Quadratic = false)
+{
+  vector<VectorXd > X;
+  vector<vector<int > > conn;
+  for (int k = 0; k <= N; k++)
+    for (int j = 0; j <= N; j++)
+      for (int i = 0; i <= N; i++) {
+	VectorXd x(3);
+	x << i*L/N, j*L/N, k*L/N;
+	X.push_back(x);
+      }
+
+  const int perm[6][3] = { {0,1,2}, {0,2,1}, {1,0,2}, {1,2,0}, {2,0,1}, {2,1,0} };
+  const int stride[3] = {1, N + 1, (N + 1)*(N + 1)};
+  for (int k = 0; k < N; k++)
+    for (int j = 0; j < N; j++)
+      for (int i = 0; i < N; i++)
+	for (int p = 0; p < 6; p++) {
+	  vector<int > tet(4);
+	  tet[0] = i + j*stride[1] + k*stride[2];
+	  for (int a = 0; a < 3; a++)
+	    tet[a + 1] = tet[a] + stride[perm[p][a]];
+	  conn.push_back(tet);
+	}
+  if (!Quadratic)
+    return new FEMesh(X, conn, "C3D4");
+
+  // Mid-side nodes in QuadTetShape order
+  const int edges[6][2] = { {0,1}, {1,2}, {2,0}, {0,3}, {1,3}, {2,3} };
+  map<pair<int, int >, int > midNode;
+  for (uint e = 0; e < conn.size(); e++)
+    for (int m = 0; m < 6; m++) {
+      int a = conn[e][edges[m][0]], b = conn[e][edges[m][1]];
+      pair<int, int > key(min(a, b), max(a, b));
+      if (midNode.find(key) == midNode.end()) {
+	midNode[key] = X.size();
+	X.push_back(0.5*(X[a] + X[b]));
+      }
+      conn[e].push_back(midNode[key]);
+    }
+  return new FEMesh(X, conn, "C3D10");
+}
+
+// Nodes on the face Coord = 0
+vector<int > faceNodes(FEMesh * Mesh, int Coord)
+{
+  vector<int > nodes;
+  for (int n = 0; n < Mesh->getNumberOfNodes(); n++)
+    if (Mesh->getX(n, Coord) < 1.0e-12)
+      nodes.push_back(n);
+  return nodes;
+}
+
+// Largest relative difference between the nodal times and sqrt(x.Metric x)
+// over the nodes at distance larger than MinDistance from the origin
+Real maxError(FEMesh * Mesh, EikonalSolver & Solver, const Matrix3d & Metric,
+	      Real MinDistance = 0.0)
+{
+  Real err = 0.0;
+  for (int n = 0; n < Mesh->getNumberOfNodes(); n++) {
+    Vector3d x = Mesh->getX(n).head<3>();
+    Real exact = sqrt(x.dot(Metric*x));
+    if (exact > 0.0 && x.norm() >= MinDistance)
+      err = max(err, fabs(Solver.getNodalTime(n) - exact)/exact);
+  }
+  return err;
+}
+
+
+
+int main()
+{
+  const Real L = 1.0, cf = 0.06, ct = 0.02;
+  FEMesh * mesh = cubeMesh(10, L);
+  const int NumEl = mesh->getNumberOfElements();
+  Matrix3d Metric;
+
+  // Isotropic plane wave from x = 0
+  {
+    EikonalSolver solver(mesh, cf);
+    solver.addSources(faceNodes(mesh, 0));
+    solver.solve();
+    Metric.setZero(); Metric(0,0) = 1.0/(cf*cf);
+    Real err = maxError(mesh, solver, Metric);
+    cout << "Isotropic plane wave: max relative error = " << err << " - "
+	 << (err < 1.0e-8 ? "PASSED" : "FAILED") << endl;
+
+    // One quadrature point at the centroid of each C3D4
+    vector<Real > tQP;
+    solver.getQuadPointTimes(tQP);
+    Real errQP = 0.0;
+    const vector<GeomElement* > & elements = mesh->getElements();
+    for (int e = 0; e < NumEl; e++) {
+      Real xc = 0.0;
+      for (int a = 0; a < 4; a++)
+	xc += 0.25*mesh->getX(elements[e]->getNodesID()[a], 0);
+      errQP = max(errQP, fabs(tQP[e] - xc/cf));
+    }
+    cout << "Quadrature point times: max error = " << errQP << " ms - "
+	 << (int(tQP.size()) == NumEl && errQP < 1.0e-8 ? "PASSED" : "FAILED") << endl;
+  }
+
+  // Anisotropic plane waves, fibers along x
+  {
+    vector<Vector3d > fibers(NumEl, Vector3d(1.0, 0.0, 0.0));
+    EikonalSolver solver(mesh, fibers, cf, ct);
+    solver.addSources(faceNodes(mesh, 0));
+    solver.solve();
+    Metric.setZero(); Metric(0,0) = 1.0/(cf*cf);
+    Real errF = maxError(mesh, solver, Metric);
+    solver.clearSources();
+    solver.addSources(faceNodes(mesh, 1));
+    solver.solve();
+    Metric.setZero(); Metric(1,1) = 1.0/(ct*ct);
+    Real errT = maxError(mesh, solver, Metric);
+    cout << "Plane wave along fibers: max relative error = " << errF
+	 << ", across fibers: max relative error = " << errT << " - "
+	 << (errF < 1.0e-8 && errT < 1.0e-8 ? "PASSED" : "FAILED") << endl;
+  }
+
+  delete mesh;
+
+  // Quadratic tetrahedra: mid-side nodes and quadrature points
+  {
+    mesh = cubeMesh(5, L, true);
+    vector<Vector3d > fibers(mesh->getNumberOfElements(), Vector3d(1.0, 0.0, 0.0));
+    EikonalSolver solver(mesh, fibers, cf, ct);
+    solver.addSources(faceNodes(mesh, 0));
+    solver.solve();
+    Metric.setZero(); Metric(0,0) = 1.0/(cf*cf);
+    Real err = maxError(mesh, solver, Metric);
+
+    vector<Real > tQP;
+    solver.getQuadPointTimes(tQP);
+    const vector<GeomElement* > & elements = mesh->getElements();
+    const int NumQP = elements[0]->getNumberOfQuadPoints();
+    for (uint e = 0; e < elements.size(); e++)
+      for (int q = 0; q < NumQP; q++) {
+	Real xq = 0.0;
+	for (int a = 0; a < 10; a++)
+	  xq += elements[e]->getN(q, a)*mesh->getX(elements[e]->getNodesID()[a], 0);
+	err = max(err, fabs(tQP[e*NumQP + q] - xq/cf)/max(xq/cf, 1.0));
+      }
+    cout << "C3D10 plane wave: max relative error = " << err << " - "
+	 << (err < 1.0e-8 ? "PASSED" : "FAILED") << endl;
+    delete mesh;
+  }
+
+  // Mid-side source on an edge along y: its vertices are reached in half
+  // the edge over the fastest velocity along y of the elements sharing it
+  {
+    mesh = cubeMesh(2, L, true);
+    const vector<GeomElement* > & elements = mesh->getElements();
+    const int edges[6][3] = { {4,0,1}, {5,1,2}, {6,2,0}, {7,0,3}, {8,1,3}, {9,2,3} };
+    int source = -1, a = -1, b = -1;
+    for (uint e = 0; source < 0 && e < elements.size(); e++)
+      for (int m = 0; source < 0 && m < 6; m++) {
+	const vector<int > & nodes = elements[e]->getNodesID();
+	a = nodes[edges[m][1]];
+	b = nodes[edges[m][2]];
+	if (mesh->getX(a, 0) == mesh->getX(b, 0) && mesh->getX(a, 2) == mesh->getX(b, 2))
+	  source = nodes[edges[m][0]];
+      }
+    const Real halfEdge = 0.5*fabs(mesh->getX(a, 1) - mesh->getX(b, 1));
+
+    bool pass = source >= 0;
+    for (int t = 0; pass && t < 2; t++) {
+      // Fibers along x, then along y in one of the elements sharing the edge
+      vector<Vector3d > fibers(elements.size(), Vector3d(1.0, 0.0, 0.0));
+      bool shared = false;
+      for (uint e = 0; t == 1 && !shared && e < elements.size(); e++) {
+	const vector<int > & nodes = elements[e]->getNodesID();
+	shared = find(nodes.begin(), nodes.begin() + 4, a) != nodes.begin() + 4 &&
+	  find(nodes.begin(), nodes.begin() + 4, b) != nodes.begin() + 4;
+	if (shared) fibers[e] = Vector3d(0.0, 1.0, 0.0);
+      }
+      EikonalSolver solver(mesh, fibers, cf, ct);
+      solver.addSource(source);
+      solver.solve();
+      const Real exact = halfEdge/(t == 0 ? ct : cf);
+      pass = solver.getNodalTime(source) == 0.0 &&
+	fabs(solver.getNodalTime(a) - exact) < 1.0e-12*exact &&
+	fabs(solver.getNodalTime(b) - exact) < 1.0e-12*exact;
+    }
+    cout << "Mid-side source across and along fibers - " << (pass ? "PASSED" : "FAILED") << endl;
+    delete mesh;
+  }
+
+  // Anisotropic point source, fibers at 45 degrees in the xy plane. The
+  // scheme is first order and the front is curved near the source, check
+  // the error away from it and its decrease under refinement
+  {
+    Vector3d f(1.0, 1.0, 0.0);
+    f.normalize();
+    Metric = Matrix3d::Identity()/(ct*ct) + (1.0/(cf*cf) - 1.0/(ct*ct))*f*f.transpose();
+    Real err[2];
+    for (int r = 0; r < 2; r++) {
+      mesh = cubeMesh(10*(r + 1), L);
+      vector<Vector3d > fibers(mesh->getNumberOfElements(), f);
+      EikonalSolver solver(mesh, fibers, cf, ct);
+      solver.addSource(0);
+      solver.solve();
+      err[r] = maxError(mesh, solver, Metric, 0.5*L);
+      if (solver.getNumberOfUnreachedNodes() > 0) err[r] = HUGE_VAL;
+      delete mesh;
+    }
+    cout << "Anisotropic point source: max relative error = " << err[0]
+	 << " (h = " << L/10 << "), " << err[1] << " (h = " << L/20 << ") - "
+	 << (err[1] < err[0] && err[1] < 0.1 ? "PASSED" : "FAILED") << endl;
+  }
+
+  // Timing on a larger mesh
+  {
+    const int N = 40;
+    mesh = cubeMesh(N, L);
+    vector<Vector3d > fibers(mesh->getNumberOfElements(), Vector3d(1.0, 0.0, 0.0));
+    Real t0 = wallTime();
+    EikonalSolver solver(mesh, fibers, cf, ct);
+    Real tInit = wallTime() - t0;
+    solver.addSource(0);
+    t0 = wallTime();
+    solver.solve();
+    Real tSolve = wallTime() - t0;
+    cout << mesh->getNumberOfElements() << " tetrahedra: setup " << tInit
+	 << " s, solve " << tSolve << " s" << endl;
+    delete mesh;
+  }
+
+  return 0;
+}
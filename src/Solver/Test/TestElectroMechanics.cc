@@ -0,0 +1,206 @@
+#include "FEMesh.h"
+#include "EPModel.h"
+#include "EigenEPsolver.h"
+#include "MechanicsModel.h"
+#include "CompNeoHookean.h"
+#include "ElectroMechanicsSolver.h"
+#include "LR.h"
+
+using namespace voom;
+
+// Neo-Hookean with an active fiber tension T = activation*Tmax along x
+class ActiveNeoHookean: public CompNeoHookean
+{
+public:
+  ActiveNeoHookean(int ID, Real Lambda, Real Mu, Real Tmax):
+    CompNeoHookean(ID, Lambda, Mu), _Tmax(Tmax), _activation(0.0) {};
+
+  void setActivationMultiplier(double activation) { _activation = activation; }
+
+  void compute(FKresults & R, const Matrix3d & F) {
+    CompNeoHookean::compute(R, F);
+    const Real T = _activation*_Tmax;
+    if (R.request & ENERGY)
+      R.W += 0.5*T*F.col(0).squaredNorm();
+    if (R.request & FORCE)
+      R.P.col(0) += T*F.col(0);
+    if (R.request & STIFFNESS)
+      for (uint i = 0; i < 3; i++)
+	R.K.set(i, 0, i, 0, R.K.get(i, 0, i, 0) + T);
+  }
+
+private:
+  Real _Tmax, _activation;
+};
+
+// Build a structured cable of C3D4 elements (each hexahedron split into 6 tets)
+void buildCable(vector<VectorXd > & X, vector<vector<int > > & Conn,
+		int nx, int ny, int nz, Real Lx, Real Ly, Real Lz);
+
+// EP model, mechanics model and coupled solver on one cable
+struct CoupledProblem
+{
+  CoupledProblem(FEMesh *myMesh, const vector<Real > & Curve, bool Pipelined);
+  ~CoupledProblem() {
+    delete coupled; delete activation; delete mechSolver; delete mechModel;
+    delete EPsolver; delete EPmodel;
+  }
+
+  EPModel                *EPmodel;
+  EigenEPsolver          *EPsolver;
+  MechanicsModel         *mechModel;
+  EigenNRsolver          *mechSolver;
+  EPActivation           *activation;
+  ElectroMechanicsSolver *coupled;
+  vector<int >            BCid;
+  vector<Real >           BCvalues;
+};
+
+
+
+int main()
+{
+  cout << endl << "Testing electromechanically coupled solver on C3D4 cable ... " << endl;
+
+  int nx = 40, ny = 2, nz = 2;
+  Real Lx = 1.0, Ly = 0.05, Lz = 0.05; // cm
+  vector<VectorXd > X;
+  vector<vector<int > > Conn;
+  buildCable(X, Conn, nx, ny, nz, Lx, Ly, Lz);
+  FEMesh myMesh(X, Conn, "C3D4");
+  const int NumNodes = myMesh.getNumberOfNodes();
+
+  // Activation curve sampled every 1 ms
+  vector<Real > curve(201);
+  for (uint i = 0; i < curve.size(); i++)
+    curve[i] = pow(sin(M_PI*Real(i)/200.0), 2);
+
+  CoupledProblem pipelined(&myMesh, curve, true);
+  CoupledProblem serial(&myMesh, curve, false);
+
+  const int NumSteps = 30;
+  Real maxDiff = 0.0;
+  vector<Real > xP(3*NumNodes), xS(3*NumNodes);
+  for (int s = 0; s < NumSteps; s++) {
+    pipelined.coupled->step();
+    serial.coupled->step();
+    pipelined.mechModel->getField(xP);
+    serial.mechModel->getField(xS);
+    for (int i = 0; i < 3*NumNodes; i++)
+      maxDiff = max(maxDiff, fabs(xP[i] - xS[i]));
+  }
+  cout << "Max difference pipelined - serial = " << maxDiff << " - "
+       << (maxDiff < 1.0e-12 ? "PASSED" : "FAILED") << endl;
+
+  // Quadrature point activation is the interpolation of the nodal one
+  {
+    const vector<Real > & nodal = pipelined.activation->getNodalActivation();
+    const VectorXd & qp = pipelined.coupled->getQuadPointActivation();
+    const vector<GeomElement* > & elements = myMesh.getElements();
+    Real err = 0.0, maxAct = 0.0;
+    for (uint e = 0; e < elements.size(); e++) {
+      Real a = 0.0;
+      for (uint n = 0; n < 4; n++)
+	a += elements[e]->getN(0, n)*nodal[elements[e]->getNodesID()[n]];
+      err = max(err, fabs(a - qp(e)));
+      maxAct = max(maxAct, qp(e));
+    }
+    cout << "Quadrature point activation: max error = " << err << ", max activation = "
+	 << maxAct << " - " << (err < 1.0e-14 && maxAct > 0.0 ? "PASSED" : "FAILED") << endl;
+  }
+
+  // The cable shortens under the active tension
+  {
+    Real length = 0.0;
+    for (int n = 0; n < NumNodes; n++)
+      length = max(length, xP[3*n]);
+    cout << "Cable length = " << length << " cm - "
+	 << (length < Lx - 1.0e-4 ? "PASSED" : "FAILED") << endl;
+  }
+
+  cout << "Serial: step " << serial.coupled->getStepWallTime() << " s (activation "
+       << serial.coupled->getActivationWallTime() << " s, mechanics "
+       << serial.coupled->getMechanicsWallTime() << " s)" << endl;
+  cout << "Pipelined: step " << pipelined.coupled->getStepWallTime() << " s (activation "
+       << pipelined.coupled->getActivationWallTime() << " s, mechanics "
+       << pipelined.coupled->getMechanicsWallTime() << " s)" << endl;
+
+  return 0;
+}
+
+
+
+CoupledProblem::CoupledProblem(FEMesh *myMesh, const vector<Real > & Curve,
+			       bool Pipelined)
+{
+  const int NumNodes = myMesh->getNumberOfNodes();
+  const int NumEl = myMesh->getNumberOfElements();
+
+  // EP: one LuoRudy cell per node, stimulus at the left end
+  vector<IonicMaterial * > ionicMaterials(NumNodes, (IonicMaterial *)(NULL));
+  for (int i = 0; i < NumNodes; i++) {
+    ionicMaterials[i] = new LuoRudy(false, NULL);
+    for (uint n = 0; n < 2000; n++)
+      ionicMaterials[i]->compute(2000.0, 1.0, 0.5, -84.0, 0.0);
+  }
+  vector<Matrix3d > diffusion(NumEl, Matrix3d::Identity());
+  EPmodel = new EPModel(myMesh, ionicMaterials, diffusion, 2000.0, 1.0);
+  EPmodel->initializeField(-84.0);
+  vector<int > stimNodes;
+  for (int i = 0; i < NumNodes; i++)
+    if (myMesh->getX(i)(0) < 0.1 + 1.0e-8) stimNodes.push_back(i);
+  EPmodel->addStimulus(stimNodes, 1.0e5, 0.0, 2.0);
+  EPsolver = new EigenEPsolver(EPmodel, 0.02, STRANG, 0.5, true, 1);
+  activation = new EPActivation(EPsolver, EPmodel, Curve, 1.0);
+
+  // Mechanics: one material per element, symmetry planes x = y = z = 0
+  vector<MechanicsMaterial * > materials(NumEl, (MechanicsMaterial *)(NULL));
+  for (int e = 0; e < NumEl; e++)
+    materials[e] = new ActiveNeoHookean(e, 10.0, 1.0, 0.3);
+  mechModel = new MechanicsModel(myMesh, materials, 3);
+  for (int i = 0; i < NumNodes; i++)
+    for (uint d = 0; d < 3; d++)
+      if (myMesh->getX(i)(d) < 1.0e-8) {
+	BCid.push_back(3*i + d);
+	BCvalues.push_back(0.0);
+      }
+  mechSolver = new EigenNRsolver(mechModel, BCid, BCvalues, CHOL, 1.0e-10, 20);
+
+  coupled = new ElectroMechanicsSolver(activation, mechSolver, mechModel, myMesh,
+				       materials, 1.0, 0.0, Pipelined);
+}
+
+
+
+void buildCable(vector<VectorXd > & X, vector<vector<int > > & Conn,
+		int nx, int ny, int nz, Real Lx, Real Ly, Real Lz)
+{
+  for (int k = 0; k <= nz; k++)
+    for (int j = 0; j <= ny; j++)
+      for (int i = 0; i <= nx; i++) {
+	VectorXd x(3);
+	x << Lx*Real(i)/Real(nx), Ly*Real(j)/Real(ny), Lz*Real(k)/Real(nz);
+	X.push_back(x);
+      }
+
+  // Kuhn triangulation of each hexahedron
+  const int tets[6][4] = { {0,1,3,7}, {0,1,7,5}, {0,4,5,7},
+			   {0,2,7,3}, {0,4,7,6}, {0,2,6,7} };
+  for (int k = 0; k < nz; k++)
+    for (int j = 0; j < ny; j++)
+      for (int i = 0; i < nx; i++) {
+	int v[8];
+	for (int c = 0; c < 8; c++)
+	  v[c] = (i + (c & 1)) + (nx+1)*((j + ((c >> 1) & 1)) + (ny+1)*(k + ((c >> 2) & 1)));
+	for (int t = 0; t < 6; t++) {
+	  vector<int > tet(4);
+	  for (int a = 0; a < 4; a++) tet[a] = v[tets[t][a]];
+	  // Keep positive orientation
+	  Vector3d e1 = X[tet[1]].head(3) - X[tet[0]].head(3);
+	  Vector3d e2 = X[tet[2]].head(3) - X[tet[0]].head(3);
+	  Vector3d e3 = X[tet[3]].head(3) - X[tet[0]].head(3);
+	  if (e1.cross(e2).dot(e3) < 0.0) swap(tet[1], tet[2]);
+	  Conn.push_back(tet);
+	}
+      }
+}
@@ -0,0 +1,123 @@
+#include "LoopShellMesh.h"
+#include "SCElastic.h"
+#include "LoopShellModel.h"
+#include "EigenNRsolver.h"
+
+using namespace voom;
+
+// Icosahedron subdivided Level times and projected on the unit sphere,
+// written in the LoopShellMesh node and connectivity formats
+void writeIcosphere(int Level, string NodeFile, string ConnFile)
+{
+  const Real t = (1.0 + sqrt(5.0))/2.0;
+  const Real v[12][3] = {{-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0},
+			 {0, -1, t}, {0, 1, t}, {0, -1, -t}, {0, 1, -t},
+			 {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1}};
+  const int f[20][3] = {{0, 11, 5}, {0, 5, 1}, {0, 1, 7}, {0, 7, 10}, {0, 10, 11},
+			{1, 5, 9}, {5, 11, 4}, {11, 10, 2}, {10, 7, 6}, {7, 1, 8},
+			{3, 9, 4}, {3, 4, 2}, {3, 2, 6}, {3, 6, 8}, {3, 8, 9},
+			{4, 9, 5}, {2, 4, 11}, {6, 2, 10}, {8, 6, 7}, {9, 8, 1}};
+  vector<Vector3d > X;
+  vector<Vector3i > F;
+  for (int i = 0; i < 12; i++)
+    X.push_back(Vector3d(v[i][0], v[i][1], v[i][2]).normalized());
+  for (int i = 0; i < 20; i++)
+    F.push_back(Vector3i(f[i][0], f[i][1], f[i][2]));
+
+  for (int l = 0; l < Level; l++) {
+    map<pair<int, int >, int > midNodes;
+    vector<Vector3i > newF;
+    for (uint i = 0; i < F.size(); i++) {
+      int m[3];
+      for (int k = 0; k < 3; k++) {
+	const int a = F[i](k), b = F[i]((k + 1)%3);
+	const pair<int, int > edge(min(a, b), max(a, b));
+	if (midNodes.find(edge) == midNodes.end()) {
+	  midNodes[edge] = X.size();
+	  X.push_back((X[a] + X[b]).normalized());
+	}
+	m[k] = midNodes[edge];
+      }
+      newF.push_back(Vector3i(F[i](0), m[0], m[2]));
+      newF.push_back(Vector3i(F[i](1), m[1], m[0]));
+      newF.push_back(Vector3i(F[i](2), m[2], m[1]));
+      newF.push_back(Vector3i(m[0], m[1], m[2]));
+    }
+    F = newF;
+  }
+
+  ofstream nodes(NodeFile.c_str());
+  nodes << X.size() << " 3" << endl << setprecision(16);
+  for (uint i = 0; i < X.size(); i++)
+    nodes << X[i](0) << " " << X[i](1) << " " << X[i](2) << endl;
+  ofstream conn(ConnFile.c_str());
+  conn << F.size() << " LoopShell" << endl;
+  for (uint i = 0; i < F.size(); i++)
+    conn << i << " " << F[i](0) << " " << F[i](1) << " " << F[i](2) << endl;
+}
+
+
+
+int main()
+{
+  cout << endl << "Testing Newton solver for Loop shells ... " << endl;
+
+  {
+    // Shell stiffness against finite differences of the residual
+    writeIcosphere(1, "Icosphere1.node", "Icosphere1.conn");
+    LoopShellMesh mesh("Icosphere1.node", "Icosphere1.conn");
+    // Materials are deleted by the model
+    vector<SCElastic *> materials;
+    for (int e = 0; e < mesh.getNumberOfElements(); e++)
+      materials.push_back(new SCElastic(1.0, 0.3, -1.0));
+    LoopShellModel model(&mesh, materials, 3);
+
+    EigenResult myResults(mesh.getNumberOfNodes()*3, 0);
+    model.checkConsistency(&myResults, 0.05, FORCE | STIFFNESS, 1.0e-6, 1.0e-6);
+  }
+
+  {
+    // Perturbed sphere relaxed by Newton iterations. Helfrich energy has
+    // no in-plane stiffness, so each node only moves along the coordinate
+    // axis closest to its normal.
+    writeIcosphere(2, "Icosphere2.node", "Icosphere2.conn");
+    LoopShellMesh mesh("Icosphere2.node", "Icosphere2.conn");
+    const int NumNodes = mesh.getNumberOfNodes();
+    // Materials are deleted by the model
+    vector<SCElastic *> materials;
+    for (int e = 0; e < mesh.getNumberOfElements(); e++)
+      materials.push_back(new SCElastic(1.0, 0.3, -2.0));
+    LoopShellModel model(&mesh, materials, 3);
+
+    vector<int > DoFid;
+    vector<Real > DoFvalues;
+    for (int n = 0; n < NumNodes; n++) {
+      Vector3d X(mesh.getX(n, 0), mesh.getX(n, 1), mesh.getX(n, 2));
+      int k = 0;
+      X.cwiseAbs().maxCoeff(&k);
+      for (int i = 0; i < 3; i++)
+	if (i != k) {
+	  DoFid.push_back(n*3 + i);
+	  DoFvalues.push_back(X(i));
+	}
+    }
+    srand(1);
+    for (int n = 0; n < NumNodes; n++)
+      for (int i = 0; i < 3; i++)
+	model.linearizedUpdate(n, i, 0.05*(Real(rand())/RAND_MAX - 0.5));
+
+    EigenNRsolver solver(&model, DoFid, DoFvalues, LU, 1.0e-10, 10);
+    solver.solve(DISP);
+
+    // Residual at the free DoF
+    EigenResult myResults(NumNodes*3, 0);
+    myResults.setRequest(FORCE);
+    model.compute(&myResults);
+    for (uint i = 0; i < DoFid.size(); i++)
+      myResults.setResidual(DoFid[i], 0.0);
+    cout << "Free residual after Newton iterations = " << myResults._residual->norm() << " - "
+	 << (myResults._residual->norm() < 1.0e-8 ? "PASSED" : "FAILED") << endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,85 @@
+//-*-C++-*-
+/*!\brief
+  A base class for ionic models integrated over many cells at once. State
+  variables are stored as structure of arrays: state s of cell c is
+  _state[s*_numCells + c], so every state variable is a contiguous array over
+  all cells. One call advances all cells, in blocks of BLOCK cells shared
+  among the OpenMP threads, instead of one virtual call and one state
+  vector per cell. The kernels evaluate the rates on packets of IonicLanes
+  cells with Eigen arrays (IonicPacket.h), so exp and log are vectorized
+  with the SIMD width the code is compiled for. The state layout of a cell
+  is the same as getInternalParameters of the corresponding IonicMaterial.
+*/
+
+#ifndef __IonicArray_h__
+#define __IonicArray_h__
+#include "voom.h"
+#include "IonicMaterial.h"
+#include <vector>
+
+namespace voom {
+  class IonicArray{
+  public:
+    //! Number of cells processed by one thread at a time
+    static const int BLOCK = 256;
+
+    //! Constructor
+    IonicArray(const uint NumCells, const uint NumStates):
+      _numCells(NumCells), _numStates(NumStates), _xi(1.0), _capacitance(1.0),
+      _state(NumCells*NumStates, 0.0) {;}
+
+    //! Destructor
+    virtual ~IonicArray() {;}
+
+    //! Number of cells and state variables per cell
+    uint getNumCells() const {return _numCells;}
+    uint getNumStates() const {return _numStates;}
+
+    //! Contiguous array of state variable s over all cells
+    Real * getStateArray(const uint s) {return &_state[s*_numCells];}
+
+    //! get/set State of a single cell (same layout as IonicMaterial)
+    void getState(const uint cell, vector<Real> & state) const {
+      state.resize(_numStates);
+      for (uint s = 0; s < _numStates; s++)
+	state[s] = _state[s*_numCells + cell];
+    }
+    void setState(const uint cell, const vector<Real> & state) {
+      for (uint s = 0; s < _numStates; s++)
+	_state[s*_numCells + cell] = state[s];
+    }
+
+    //! Copy state from a per cell ionic material
+    void setState(const uint cell, const IonicMaterial * material) {
+      int nData = 0;
+      const vector<Real> & state = material->getInternalParameters(nData);
+      assert(nData == int(_numStates));
+      this->setState(cell, state);
+    }
+
+    //! Surface Area to Volume Ratio Xi
+    Real getXi() const {return _xi;}
+    void setXi(const Real Xi) {_xi = Xi;}
+
+    //! Capacitance
+    Real getCapacitance() const {return _capacitance;}
+    void setCapacitance(const Real capacitance) {_capacitance = capacitance;}
+
+    /*!
+      Advance all cells over dt. Same arguments as IonicMaterial::compute,
+      one entry per cell in Volt, istim and dVdt.
+    */
+    virtual void compute(const Real Xi, const Real C_m, const Real dt,
+			 const Real * Volt, const Real * istim,
+			 Real * dVdt) = 0;
+
+    //! Magnitude of active deformation at each cell
+    virtual void getGamma(Real * gamma) = 0;
+
+  protected:
+    uint         _numCells, _numStates;
+    Real         _xi, _capacitance;
+    vector<Real> _state;
+  };
+}
+#endif
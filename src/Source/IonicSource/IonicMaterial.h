@@ -18,16 +18,52 @@ namespace voom {
     Real        _xi, _capacitance, _gamma;
     vector<Real> _state, _rate;
 
+    //! Substepping of explicitly integrated states (see setSubstepping)
+    Real        _maxDV, _maxRelChange;
+    uint        _maxSubsteps, _numSubsteps;
+
+    //! Rush-Larsen update of a gate with steady state yInf and time constant tau
+    static Real rushLarsen(const Real y, const Real yInf, const Real tau,
+			   const Real dt) {
+      return yInf - (yInf - y)*exp(-dt/tau);
+    }
+
+    /*!
+      Length of the next substep when TimeLeft of the step dt remains. Rates
+      are evaluated at State, state 0 is the voltage and Controlled lists the
+      other states whose relative change is limited. The remaining time is
+      split evenly among the substeps still needed.
+    */
+    Real substepLength(const Real *State, const Real *Rates,
+		       const int *Controlled, const int NumControlled,
+		       const Real TimeLeft, const Real dt) const {
+      Real h = TimeLeft;
+      if (fabs(Rates[0])*h > _maxDV)
+	h = _maxDV/fabs(Rates[0]);
+      for (int i = 0; i < NumControlled; i++) {
+	const int s = Controlled[i];
+	const Real allowed = _maxRelChange*fabs(State[s]);
+	if (fabs(Rates[s])*h > allowed)
+	  h = allowed/fabs(Rates[s]);
+      }
+      h = max(h, dt/Real(_maxSubsteps));
+      return TimeLeft/ceil(TimeLeft/h - 1.0e-8);
+    }
+
   public:
     //! Constructor
-    IonicMaterial(){;}
+    IonicMaterial(): _maxDV(1.0), _maxRelChange(0.1), _maxSubsteps(100),
+		     _numSubsteps(1) {;}
 
     //! Destructor
-    ~IonicMaterial(){;}
+    virtual ~IonicMaterial(){;}
 
     //! set Xi - Surface Area to Volume Ratio
     void setXi(const Real Xi){_xi = Xi;}
 
+    //! get Xi - Surface Area to Volume Ratio
+    Real getXi() const{return _xi;}
+
     //! get State
     vector<Real> getState() const{return _state;}
 
@@ -46,6 +82,22 @@ namespace voom {
     //! set Capacitance
     void setCapacitance(const Real capacitance){_capacitance = capacitance;}
 
+    /*!
+      Models integrating their non gating states explicitly (Purkinje,
+      Mahajan) split each compute call into substeps such that the voltage
+      changes by at most MaxDV (mV) and the controlled concentrations by at
+      most MaxRelChange of their value per substep, using at most MaxSubsteps
+      substeps. Gates are advanced with Rush-Larsen. Cells at rest take a
+      single step of the caller's dt.
+    */
+    void setSubstepping(const Real MaxDV, const Real MaxRelChange,
+			const uint MaxSubsteps) {
+      _maxDV = MaxDV; _maxRelChange = MaxRelChange; _maxSubsteps = MaxSubsteps;
+    }
+
+    //! Number of substeps taken in the last compute call
+    uint getNumSubsteps() const {return _numSubsteps;}
+
     //! Compute Ion virtual function. Return dV/dt to body class
     virtual Real compute(Real Xi, Real C_m, Real dt, 
 			     Real Volt, Real istim) = 0;
@@ -0,0 +1,76 @@
+//-*-C++-*-
+/*!\brief
+  Packets of cells for the IonicArray kernels. The rates of an ionic model
+  are written once as templates on the value type T: T = Real advances one
+  cell (IonicMaterial), T = IonicPacket advances IonicLanes cells at once
+  with Eigen arrays, whose exp and log are vectorized. The helpers below
+  have a Real and an IonicPacket overload so that the same code compiles
+  for both; branches of the rates are replaced by ionicSelect, which
+  evaluates both sides.
+*/
+
+#ifndef __IonicPacket_h__
+#define __IonicPacket_h__
+#include "voom.h"
+
+namespace voom {
+  //! Number of cells in a packet
+  const int IonicLanes = 16;
+
+  typedef Array<Real, IonicLanes, 1> IonicPacket;
+  typedef Array<bool, IonicLanes, 1> IonicMask;
+
+  //! Contiguous array of cells, used as an Eigen array
+  typedef Map<Array<Real, Dynamic, 1> > IonicMap;
+  typedef Map<const Array<Real, Dynamic, 1> > IonicConstMap;
+
+  //! Mask type of T (bool for Real), all() has every lane set
+  template<class T> struct IonicMaskOf {
+    typedef bool type;
+    static type all() {return true;}
+  };
+  template<> struct IonicMaskOf<IonicPacket> {
+    typedef IonicMask type;
+    static type all() {return IonicMask::Constant(true);}
+  };
+
+  //! Condition ? A : B, for packets lane by lane
+  inline Real ionicSelect(const bool Cond, const Real A, const Real B) {
+    return Cond ? A : B;
+  }
+  inline IonicPacket ionicSelect(const IonicMask & Cond, const IonicPacket & A,
+				 const IonicPacket & B) {
+    return Cond.select(A, B);
+  }
+  inline IonicPacket ionicSelect(const IonicMask & Cond, const IonicPacket & A,
+				 const Real B) {
+    return Cond.select(A, B);
+  }
+  inline IonicPacket ionicSelect(const IonicMask & Cond, const Real A,
+				 const IonicPacket & B) {
+    return Cond.select(A, B);
+  }
+
+  //! x^2 and x^3 (pow of an Eigen array is not vectorized)
+  inline Real ionicSquare(const Real x) {return x*x;}
+  inline IonicPacket ionicSquare(const IonicPacket & x) {return x.square();}
+  inline Real ionicCube(const Real x) {return x*x*x;}
+  inline IonicPacket ionicCube(const IonicPacket & x) {return x.cube();}
+
+  //! True if any lane is set
+  inline bool ionicAny(const bool Cond) {return Cond;}
+  inline bool ionicAny(const IonicMask & Cond) {return Cond.any();}
+
+  //! Load lanes from Src, cells past n repeat the last one
+  inline void ionicLoad(const Real * Src, const int, Real & x) {x = Src[0];}
+  inline void ionicLoad(const Real * Src, const int n, IonicPacket & x) {
+    for (int l = 0; l < IonicLanes; l++) x(l) = Src[l < n ? l : n - 1];
+  }
+
+  //! Store the first n lanes to Dst
+  inline void ionicStore(const Real x, const int, Real * Dst) {Dst[0] = x;}
+  inline void ionicStore(const IonicPacket & x, const int n, Real * Dst) {
+    for (int l = 0; l < n; l++) Dst[l] = x(l);
+  }
+}
+#endif
@@ -6,6 +6,7 @@
 #include <math.h>
 #include <stdlib.h>
 #include "voom.h"
+#include "LRRates.h"
 #include "LRGateTable.h"
 #include "IonicMaterial.h"
 
@@ -26,7 +27,8 @@ namespace voom {
     //! default constructor
     LuoRudy(bool useGate, LuoRudyGateTable* Gate){
       _useGate = useGate;
-      gate = Gate;
+      // Use the process wide table if none is given
+      gate = (useGate && Gate == NULL) ? LuoRudyGateTable::getShared() : Gate;
       _in.resize(8);
       initialize();
     }
@@ -0,0 +1,120 @@
+//-*-C++-*-
+// Luo Rudy ionic model integrated over an array of cells
+#include "LRArray.h"
+
+namespace voom {
+  LuoRudyArray::LuoRudyArray(const uint NumCells, LuoRudyGateTable * Gate):
+    IonicArray(NumCells, 8), _gate(Gate) {
+    // Same initial values and parameters as LuoRudy::initialize
+    const Real init[8] = {.001, 0.0001, 0.99, .001, 0.9, .001, 0.0000001, 0.};
+    for (uint s = 0; s < 8; s++) {
+      Real * S = this->getStateArray(s);
+      for (uint c = 0; c < _numCells; c++) S[c] = init[s];
+    }
+
+    Real r = 11e-4, L = 100E-4;
+    _xi = 2.*(r + L)/(r*L);
+
+    Gna = 12.00;
+    Gsi = 0.07;
+    c_K0 = 5.4;
+    GK = 0.705*sqrt(c_K0/5.4);
+
+    c_Nai=18.0;
+    c_Na0=140.0;
+    c_Ki=145.0;
+    RT_F=26.73;
+    E_Na=RT_F*log(c_Na0/c_Nai);
+    E_K=RT_F*log((c_K0+.01833*c_Na0)/(c_Ki+.01833*c_Nai));
+    E_K1=RT_F*log(c_K0/c_Ki);
+    E_kp=E_K1;
+    G_K1=.6047*sqrt(c_K0/5.4);
+  }
+
+
+
+  void LuoRudyArray::compute(const Real, const Real C_m, const Real dt,
+			     const Real * Volt, const Real * istim, Real * dVdt) {
+    Real * m  = this->getStateArray(0);
+    Real * h  = this->getStateArray(1);
+    Real * j  = this->getStateArray(2);
+    Real * d  = this->getStateArray(3);
+    Real * f  = this->getStateArray(4);
+    Real * x  = this->getStateArray(5);
+    Real * ca = this->getStateArray(6);
+    Real * V  = this->getStateArray(7);
+    // As in LuoRudy::compute the stimulus is scaled with the model _xi
+    const Real stimScale = 1.0/(_xi*C_m);
+    const Real gna = Gna, gsi = Gsi, gk = GK, ek1 = E_K1, gk1 = G_K1;
+    const int N = _numCells;
+    const int nBlocks = (N + BLOCK - 1)/BLOCK;
+    // Currents of a block
+    typedef Array<Real, Dynamic, 1, 0, BLOCK, 1> BlockArray;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int b = 0; b < nBlocks; b++) {
+      const int c0 = b*BLOCK;
+      const int n  = (c0 + BLOCK < N ? BLOCK : N - c0);
+      // Rates of the block, one contiguous array per quantity
+      Real tab[14*BLOCK];
+      if (_gate) {
+	_gate->get_parameters(&Volt[c0], n, tab, BLOCK);
+	// Outside of the table range use the analytical rates as LuoRudy
+	// does, for all those cells of the block in one call
+	Real vOut[BLOCK], tabOut[14*BLOCK];
+	int cellOut[BLOCK], nOut = 0;
+	for (int i = 0; i < n; i++)
+	  if (!_gate->inRange(Volt[c0 + i])) {
+	    cellOut[nOut] = i;
+	    vOut[nOut++] = Volt[c0 + i];
+	  }
+	if (nOut > 0) {
+	  LuoRudyRates(vOut, nOut, ek1, gk1, tabOut, BLOCK);
+	  for (int k = 0; k < 14; k++)
+	    for (int o = 0; o < nOut; o++)
+	      tab[k*BLOCK + cellOut[o]] = tabOut[k*BLOCK + o];
+	}
+      }
+      else
+	for (int i = 0; i < n; i += IonicLanes) {
+	  const int nl = (i + IonicLanes < n ? IonicLanes : n - i);
+	  IonicPacket v, rates[14];
+	  ionicLoad(&Volt[c0 + i], nl, v);
+	  LuoRudyRates(v, ek1, gk1, rates);
+	  for (int k = 0; k < 14; k++)
+	    ionicStore(rates[k], nl, &tab[k*BLOCK + i]);
+	}
+
+      // Gates relax to their inf value (rate 2g) with the rate 2g + 1
+      Real * gate[6] = {m, h, j, d, f, x};
+      for (int g = 0; g < 6; g++) {
+	IonicMap G(&gate[g][c0], n);
+	IonicConstMap inf(&tab[2*g*BLOCK], n), rate(&tab[(2*g + 1)*BLOCK], n);
+	G = inf - (inf - G)*(-dt*rate).exp();
+      }
+
+      IonicConstMap v(&Volt[c0], n), stim(&istim[c0], n);
+      // i_k1 is I_K1 + I_Kp + I_b
+      IonicConstMap x1(&tab[12*BLOCK], n), i_k1(&tab[13*BLOCK], n);
+      IonicMap M(&m[c0], n), H(&h[c0], n), J(&j[c0], n), D(&d[c0], n);
+      IonicMap F(&f[c0], n), X(&x[c0], n), Ca(&ca[c0], n);
+      const BlockArray i_na = gna*M.cube()*H*J*(v - 54.4);
+      const BlockArray i_si = gsi*D*F*(v - (7.7 - 13.0287*Ca.log()));
+      const BlockArray i_k  = gk*x1*X*(v + 77.0);
+      Ca += (-.0001*i_si + 0.07*(0.0001 - Ca))*dt;
+      IonicMap(&V[c0], n) = v;
+
+      IonicMap(&dVdt[c0], n) = -(i_k1 + i_k + i_na + i_si) + stim*stimScale;
+    }
+  }
+
+
+
+  void LuoRudyArray::getGamma(Real * gamma) {
+    const Real * ca = this->getStateArray(6);
+    for (uint c = 0; c < _numCells; c++)
+      gamma[c] = 0.2126*(4. - 0.7*tanh(1.4*log(ca[c]) + 9.5));
+  }
+}  // namespace voom
@@ -0,0 +1,38 @@
+//-*-C++-*-
+// Luo Rudy ionic model integrated over an array of cells
+#if !defined(__LRArray_h__)
+#define __LRArray_h__
+#include "LR.h"
+#include "IonicArray.h"
+
+namespace voom {
+  /*!
+    Structure of arrays version of LuoRudy. Uses the same rates and update
+    as LuoRudy::compute, states are m, h, j, d, f, x,
+    Ca_i and V (same layout as LuoRudy::getInternalParameters).
+  */
+  class LuoRudyArray: public IonicArray{
+  public:
+    //! Constructor (Gate = NULL evaluates the rates analytically)
+    LuoRudyArray(const uint NumCells, LuoRudyGateTable * Gate = NULL);
+
+    //! Destructor
+    ~LuoRudyArray() {;}
+
+    void setGna(Real val) {Gna = val;}
+    void setGsi(Real val) {Gsi = val;}
+
+    void compute(const Real Xi, const Real C_m, const Real dt,
+		 const Real * Volt, const Real * istim, Real * dVdt);
+
+    void getGamma(Real * gamma);
+
+  protected:
+    Real Gna,Gsi,c_K0,GK;
+    Real c_Na0,c_Nai,c_Ki,RT_F;
+    Real E_Na, E_K,E_K1,E_kp,G_K1;
+    LuoRudyGateTable * _gate;
+  };
+}  // namespace voom
+
+#endif
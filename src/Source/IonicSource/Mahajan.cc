@@ -4,7 +4,8 @@
 #define min(a,b) (a < b ? a : b)
 
 namespace voom {
-  Mahajan::Mahajan(Real *Constants, int pos) {
+  Mahajan::Mahajan(Real *Constants, const int pos, VoltageTable *Table):
+    _table(Table) {
     // Define the Initial State Variables
     _nVar = 26;
     _State.resize( 26 );
@@ -145,6 +146,111 @@ namespace voom {
     */
     _xi = 1.55E-4/2.58E-8;
   }
+  /*!
+    Voltage dependent quantities of the current and Ca cycling functions,
+    moved out of comp_ina, comp_ikr, ... so that they can be tabulated.
+  */
+  void MahajanVoltageRates(const Real *Constants, const Real V, Real *Values) {
+    // Sodium current (Hund-Rudy, newer formulation by Leonid Livschitz)
+    Real a = 1.0 - 1.0/(1.0+exp(-(V+40.0)/0.24));
+    Values[MAH_AH] = a*0.135*exp((80.0+V)/(-6.8));
+    Values[MAH_BH] = (1.0-a)/(0.13*(1+exp((V+10.66)/(-11.1)))) +	\
+      a*(3.56*exp(0.079*V)+3.1*1.0e5*exp(0.35*V));
+    Values[MAH_AJ] =  a*(-1.2714e5*exp(0.2444*V)-3.474e-5*exp(-0.04391*V))*(V+37.78)/(1.0+exp(0.311*(V+79.23)));
+    Values[MAH_BJ] = (1.0-a)*(0.3*exp(-2.535e-7*V)/(1+exp(-0.1*(V+32)))) + \
+      a*(0.1212*exp(-0.01052*V)/(1+exp(-0.1378*(V+40.14))));
+    if (fabsf(V+47.13) < 0.01)
+      Values[MAH_AM] = 3.2;
+    else
+      Values[MAH_AM] = 0.32*(V+47.13)/(1.0 - exp(-0.1*(V+47.13)));
+    Values[MAH_BM] = 0.08*exp(-V/11.0);
+
+    // Ikr
+    Real xkrv1, xkrv2;
+    if (fabsf(V + 7.0) < 0.001/0.123)
+      xkrv1=0.00138/0.123;
+    else
+      xkrv1=0.00138*(V + 7.0)/(1.0 - exp(-0.123*(V + 7.0)));
+    if (fabsf(V + 10.0) < 0.001/0.145 )
+      xkrv2=0.00061/0.145;
+    else
+      xkrv2=0.00061*(V+10.0)/(exp(0.145*(V+10.0)) - 1.0);
+    Values[MAH_TAUKR] = 1.0/(xkrv1 + xkrv2);
+    Values[MAH_XKRINF] = 1.0/(1.0 + exp(-(V + 50.0)/7.5));
+    Values[MAH_RG] = 1.0/(1.0 + exp((V + 33.0)/22.4));
+
+    // Iks
+    Values[MAH_XS1SS] = 1.0/(1.0 + exp(-(V-1.50)/16.70));
+    if (fabsf(V + 30.0) < 0.001/0.0687)
+      Values[MAH_TAUXS1] = 1.0/(0.0000719/0.148+0.000131/0.0687);
+    else
+      Values[MAH_TAUXS1] = 1.0/(0.0000719*(V + 30.0)/(1.0 - exp(-0.148*(V + 30.0))) +
+				0.000131*(V + 30.0)/(exp(0.0687*(V + 30.0)) - 1.0));
+
+    // Ik1
+    const Real ek = (1.0/Constants[24])*log(Constants[2]/Constants[1]);
+    Real aki = 1.02/ ( 1.0+exp ( 0.2385* ( V-ek-59.215 ) ) );
+    Real bki = (0.49124*exp(0.08032*(V - ek + 5.476)) +
+		exp(0.061750*(V - ek - 594.31)))/(1.0 + exp(-0.5143*(V - ek + 4.753)));
+    Values[MAH_XKIN] = aki/(aki + bki);
+
+    // Ito slow and fast
+    Real rt1 = -(V + 3.0)/15.0;
+    Real rt2 = (V + 33.5)/10.0;
+    Real rt3 = (V + 60.0)/10.0;
+    Values[MAH_XTOS_INF] = 1.0/(1.0 + exp(rt1));
+    Values[MAH_YTOS_INF] = 1.0/(1.0 + exp(rt2));
+    Values[MAH_TXS] = 9.0/(1.0+exp(-rt1)) + 0.5;
+    Values[MAH_TYS] = 3000.0/(1.0+exp(rt3)) + 30.0;
+    Values[MAH_TXF] = 3.5*exp(-(V/30.0)*(V/30.0)) + 1.5;
+    Values[MAH_TYF] = 20.0/(1.0+exp(rt2)) + 20.0;
+
+    // Inak
+    const Real sigma = ( exp ( Constants[0]/67.3 )-1.0 ) /7.0;
+    Values[MAH_FNAK] = 1.0/ ( 1+0.1245*exp ( -0.1*V*Constants[24] ) +0.0365*sigma*exp ( -V*Constants[24] ) );
+
+    // Inaca
+    Values[MAH_ENACA1] = exp(V*0.35*Constants[24]);
+    Values[MAH_ENACA2] = exp(V*(0.35-1.)*Constants[24]);
+
+    // Driving force rxa = Values[MAH_RXA]*(csm*Values[MAH_EXPZA] - 0.341*Ca_o)
+    const Real pca = 0.00054;
+    Real za = V*2.0*Constants[24];
+    Real factor1 = 4.0*pca*Constants[23]*Constants[23]/(Constants[22]*Constants[20]); // Temperature is a factor here!
+    Values[MAH_EXPZA] = exp(za);
+    if (fabsf(za) < 0.001)
+      Values[MAH_RXA] = factor1/(2.0*Constants[24]);
+    else
+      Values[MAH_RXA] = V*factor1/(exp(za) - 1.0);
+
+    // Markovian Ca current
+    Values[MAH_PO_INF] = 1.0/(1.0 + exp(-V/8.0));
+    Values[MAH_PR] = 1.0-1.0/(1.0+exp(-(V+40.0)/4.0)); // Erratum in Mahajan et al.
+    Values[MAH_PS] = 1.0/(1.0+exp(-(V+40.0)/11.32));
+    Real P_tmp = exp(-(V+40.0)/3.0);    // For readability (not in original publication)
+    Values[MAH_K3] = P_tmp/(3.0*(1.0+P_tmp));
+    Values[MAH_RV] = 10.0 + 4954.0*exp(V/15.6);
+
+    // Release and dyadic junction
+    const Real ay = 0.05;
+    const Real ax = 0.3576f;
+    Values[MAH_GRYRV] = exp(-ay*(V+30.0))/(1.0+exp(-ay*(V+30.0)));
+    Values[MAH_GSRV] = exp(-ax*(V+30.0))/(1.0+exp(-ax*(V+30.0)));
+  }
+
+
+
+  VoltageTable * Mahajan::makeVoltageTable(Real *Constants, const Real dv) {
+    VoltageTable * table = new VoltageTable(MahajanVoltageRates, Constants,
+					    MAH_NUM_VOLTAGE_RATES, -100., 100., dv);
+    for (int k = 0; k < MAH_NUM_VOLTAGE_RATES; k++)
+      table->addRate(k);
+    table->build();
+    return table;
+  }
+
+
+
   //! Compute the Right hand side of the function
   void Mahajan::ucla_rhsfun(const Real h, const Real istim) {
     Real xik1, xito, xinak, xinacaq, xdif, xiup, xileak;
@@ -160,6 +266,11 @@ namespace voom {
     // note: sodium is in m molar so need to divide by 
     const Real xrr=(1.0f/wca)/1000.0f;   
     Real v_old = _State[0]; // For AP onset detection.
+
+    if (_table && _table->inRange(_State[0]))
+      _table->interpolate(_State[0], _VoltageRates);
+    else
+      MahajanVoltageRates(_Constants, _State[0], _VoltageRates);
     
     // -------- Compute ion channel currents.
     // Sodium current
@@ -221,26 +332,14 @@ namespace voom {
    */
   //-----------	sodium current following Hund-Rudy -------------------
   Real Mahajan::comp_ina(const Real dt){
-    Real ena, a, am, bm, ah, bh, aj, bj;
+    Real ena;
     Real taum, tauj, tauh;
     Real xina;
+    const Real am = _VoltageRates[MAH_AM], bm = _VoltageRates[MAH_BM];
+    const Real ah = _VoltageRates[MAH_AH], bh = _VoltageRates[MAH_BH];
+    const Real aj = _VoltageRates[MAH_AJ], bj = _VoltageRates[MAH_BJ];
     ena = (1.0/_Constants[24])*log(_Constants[0]/_State[19]);
     
-    // Newer formulation (Leonid Livschitz).
-    a = 1.0 - 1.0/(1.0+exp(-(_State[0]+40.0)/0.24));
-    ah = a*0.135*exp((80.0+_State[0])/(-6.8));
-    bh = (1.0-a)/(0.13*(1+exp((_State[0]+10.66)/(-11.1)))) +		\
-      a*(3.56*exp(0.079*_State[0])+3.1*1.0e5*exp(0.35*_State[0]));
-    aj =  a*(-1.2714e5*exp(0.2444*_State[0])-3.474e-5*exp(-0.04391*_State[0]))*(_State[0]+37.78)/(1.0+exp(0.311*(_State[0]+79.23)));
-    bj = (1.0-a)*(0.3*exp(-2.535e-7*_State[0])/(1+exp(-0.1*(_State[0]+32)))) + \
-      a*(0.1212*exp(-0.01052*_State[0])/(1+exp(-0.1378*(_State[0]+40.14))));
-    
-    if (fabsf(_State[0]+47.13) < 0.01)
-      am = 3.2;
-    else
-      am = 0.32*(_State[0]+47.13)/(1.0 - exp(-0.1*(_State[0]+47.13)));
-    bm = 0.08*exp(-_State[0]/11.0);    
-    
     xina= _Constants[15]*_State[2]*_State[3]*_State[1]*_State[1]*_State[1]*(_State[0] - ena);
     
     // Rush-Larsen method.
@@ -259,21 +358,11 @@ namespace voom {
   {
     const Real ek = (1.0/_Constants[24])*log (_Constants[2]/_Constants[1]);// K reversal potential
     const Real gss = sqrt(_Constants[2]/5.4);
-    Real xkrv1, xkrv2, taukr, xkrinf, rg, xikr;
+    const Real taukr = _VoltageRates[MAH_TAUKR];
+    const Real xkrinf = _VoltageRates[MAH_XKRINF];
+    const Real rg = _VoltageRates[MAH_RG];
+    Real xikr;
     
-    if (fabsf(_State[0] + 7.0) < 0.001/0.123)
-      xkrv1=0.00138/0.123;
-    else
-      xkrv1=0.00138*(_State[0] + 7.0)/(1.0 - exp(-0.123*(_State[0] + 7.0)));
-    
-    if (fabsf(_State[0] + 10.0) < 0.001/0.145 )
-      xkrv2=0.00061/0.145;
-    else
-      xkrv2=0.00061*(_State[0]+10.0)/(exp(0.145*(_State[0]+10.0)) - 1.0);
-    
-    taukr = 1.0/(xkrv1 + xkrv2);
-    xkrinf = 1.0/(1.0 + exp(-(_State[0] + 50.0)/7.5));
-    rg = 1.0/(1.0 + exp((_State[0] + 33.0)/22.4));
     xikr = _Constants[9]*gss*_State[4]*rg*(_State[0] - ek);
     // Rush-Larsen method.
     _Rates[4] = (xkrinf - (xkrinf - _State[4])*exp(-dt/taukr) - _State[4])/dt;
@@ -286,15 +375,9 @@ namespace voom {
     Real eks, xs1ss, xs2ss, tauxs1, tauxs2, gksx, xiks;
     
     eks = (1.0/_Constants[24])*log((_Constants[2]+prnak*_Constants[0])/(_Constants[1]+prnak*_State[19]));
-    xs1ss = 1.0/(1.0 + exp(-(_State[0]-1.50)/16.70));
+    xs1ss = _VoltageRates[MAH_XS1SS];
     xs2ss = xs1ss;
-    
-    // Adapted from original.
-    if (fabsf(_State[0] + 30.0) < 0.001/0.0687)
-      tauxs1=1.0/(0.0000719/0.148+0.000131/0.0687);
-    else
-      tauxs1 = 1.0/(0.0000719*(_State[0] + 30.0)/(1.0 - exp(-0.148*(_State[0] + 30.0))) + 
-		    0.000131*(_State[0] + 30.0)/(exp(0.0687*(_State[0] + 30.0)) - 1.0));
+    tauxs1 = _VoltageRates[MAH_TAUXS1];
     tauxs2 = 4.0*tauxs1;
     gksx = 0.433*(1.0 + 0.8/(1.0 + pow((Real)(0.5/_State[9]),3))); // (q_Ks)
     
@@ -309,14 +392,11 @@ namespace voom {
   
   //------Ik1 following Luo-Rudy formulation (from Shannon model) ------
   Real Mahajan::comp_ik1 ( ){
-    Real ek, aki, bki, xkin, xik1;
+    Real ek, xkin, xik1;
     const Real gki = sqrt(_Constants[2]/5.4);
     
     ek = (1.0/_Constants[24])*log(_Constants[2]/_Constants[1]); // K reversal potential
-    aki =1.02/ ( 1.0+exp ( 0.2385* ( _State[0]-ek-59.215 ) ) );
-    bki = (0.49124*exp(0.08032*(_State[0] - ek + 5.476)) +
-	   exp(0.061750*(_State[0] - ek - 594.31)))/(1.0 + exp(-0.5143*(_State[0] - ek + 4.753)));
-    xkin = aki/(aki + bki);
+    xkin = _VoltageRates[MAH_XKIN];
     xik1 = _Constants[11]*gki*xkin* (_State[0] - ek);
     return xik1;
   }
@@ -326,21 +406,18 @@ namespace voom {
   Real Mahajan::comp_ito(Real dt) {
     // -- Ito,s
     Real ek = 1.0/_Constants[24]*log(_Constants[2]/_Constants[1]);// K reversal potential
-    Real rt1 = -(_State[0] + 3.0)/15.0;
-    Real rt2 = (_State[0] + 33.5)/10.0;
-    Real rt3 = (_State[0] + 60.0)/10.0;
-    Real xtos_inf = 1.0/(1.0 + exp(rt1));
-    Real ytos_inf = 1.0/(1.0 + exp(rt2));
-    Real rs_inf = 1.0/(1.0 + exp(rt2));
-    Real txs = 9.0/(1.0+exp(-rt1)) + 0.5;
-    Real tys = 3000.0/(1.0+exp(rt3)) + 30.0;
+    Real xtos_inf = _VoltageRates[MAH_XTOS_INF];
+    Real ytos_inf = _VoltageRates[MAH_YTOS_INF];
+    Real rs_inf = ytos_inf;
+    Real txs = _VoltageRates[MAH_TXS];
+    Real tys = _VoltageRates[MAH_TYS];
     Real xitos = _Constants[6]*_State[22]*(_State[23] + 0.5*rs_inf)*(_State[0] - ek); // ito slow (original)
     
     // -- Ito,f
     Real xtof_inf = xtos_inf;
     Real ytof_inf = ytos_inf;
-    Real txf = 3.5*exp(-(_State[0]/30.0)*(_State[0]/30.0)) + 1.5;
-    Real tyf = 20.0/(1.0+exp(rt2)) + 20.0;
+    Real txf = _VoltageRates[MAH_TXF];
+    Real tyf = _VoltageRates[MAH_TYF];
     Real xitof = _Constants[7]*_State[20]*_State[21]*(_State[0] - ek); // ito fast
     
     // Rush-Larsen method.
@@ -358,9 +435,8 @@ namespace voom {
     const Real xkmko=1.5;	//these are Inak constants adjusted to fit
     //the experimentally measured dynamic restitution curve
     const Real xkmnai=12.0;
-    const Real sigma = ( exp ( _Constants[0]/67.3 )-1.0 ) /7.0;
     
-    fnak = 1.0/ ( 1+0.1245*exp ( -0.1*_State[0]*_Constants[24] ) +0.0365*sigma*exp ( -_State[0]*_Constants[24] ) );
+    fnak = _VoltageRates[MAH_FNAK];
     xinak = _Constants[12]*fnak* ( 1./ ( 1.+ ( xkmnai/_State[19] ) ) ) *_Constants[2]/ ( _Constants[2]+xkmko );
     
     return xinak;
@@ -377,8 +453,8 @@ namespace voom {
     const Real xmcai=0.0036;
     csm = _State[8]/1000.0; // cs is in uMol, but these eqns are in mMol
     
-    zw3 = pow(_State[19],3)*_Constants[3]*exp(_State[0]*0.35*_Constants[24]) - pow(_Constants[0],3)*csm*exp(_State[0]*(0.35-1.)*_Constants[24]);
-    zw4 = 1.0+0.2*exp ( _State[0]* ( 0.35-1.0 ) *_Constants[24] );
+    zw3 = pow(_State[19],3)*_Constants[3]*_VoltageRates[MAH_ENACA1] - pow(_Constants[0],3)*csm*_VoltageRates[MAH_ENACA2];
+    zw4 = 1.0+0.2*_VoltageRates[MAH_ENACA2];
     aloss = 1.0/(1.0+pow((xkdna/_State[8]),3));
     yz1 = xmcao*pow ( _State[19],3 ) +pow ( xmnao,3 ) *csm;
     yz2 = pow ( xmnai,3 ) *_Constants[3]* ( 1.0+csm/xmcai );
@@ -394,18 +470,11 @@ namespace voom {
   
   //	compute driving force (iCa)
   Real Mahajan::comp_rxa() {
-    Real za, factor, rxa, csm;
-    Real factor1;
-    const Real pca = 0.00054;
+    Real rxa, csm;
     csm = _State[8]/1000.0;
     
-    za = _State[0]*2.0*_Constants[24];
-    factor1 = 4.0*pca*_Constants[23]*_Constants[23]/(_Constants[22]*_Constants[20]); // Temperature is a factor here!
-    factor = _State[0]*factor1;
-    if (fabsf(za) < 0.001)
-      rxa = factor1*(csm*exp(za) - 0.341*(_Constants[3]))/(2.0*_Constants[24]);
-    else
-      rxa = factor*(csm*exp(za) - 0.341*(_Constants[3]))/(exp(za) - 1.0);
+    // See MahajanVoltageRates for the voltage dependent factor
+    rxa = _VoltageRates[MAH_RXA]*(csm*_VoltageRates[MAH_EXPZA] - 0.341*(_Constants[3]));
     return rxa;
   }
   
@@ -414,7 +483,7 @@ namespace voom {
   //	experimental current traces using a multidimensional current fitting
   //	routine.
   Real Mahajan::comp_icalpo(Real dt) {
-    Real P_o, P_o_inf, P_r, P_s, P_tmp;
+    Real P_o, P_o_inf, P_r, P_s;
     Real alpha, beta, f_c_p, R_V, T_Ca, tau_Ca, tau_Ba;
     Real s1, s2, s2_p, k1;
     Real k3, k3_p, k6, k5, k6_p, k5_p, k4, k4_p;
@@ -431,10 +500,9 @@ namespace voom {
     const Real k2_p = 0.00224;
     const Real T_Ba = 450.0;
     
-    P_o_inf = 1.0/(1.0 + exp(-_State[0]/8.0));
-    P_r = 1.0-1.0/(1.0+exp(-(_State[0]+40.0)/4.0)); // Erratum in Mahajan et al.
-    P_s = 1.0/(1.0+exp(-(_State[0]+40.0)/11.32));
-    P_tmp = exp(-(_State[0]+40.0)/3.0);    // For readability (not in original publication)
+    P_o_inf = _VoltageRates[MAH_PO_INF];
+    P_r = _VoltageRates[MAH_PR];
+    P_s = _VoltageRates[MAH_PS];
     
     alpha = P_o_inf/tau_po;
     // MOD EDL2010MAY03: Avoid potential division by zero below by taking BETA
@@ -443,7 +511,7 @@ namespace voom {
     
     f_c_p = 1.0/(1.0 + pow(((Real)(cp_tilde/_State[7])),3)); // f(c_p)
     
-    R_V = 10.0 + 4954.0*exp(_State[0]/15.6);
+    R_V = _VoltageRates[MAH_RV];
     T_Ca = (78.0329 + 0.1*(1.0 + pow(((Real)(_State[7]/cp_bar)),4)))/(1.0 + pow(((Real)(_State[7]/cp_bar)),4));
     
     tau_Ca = (R_V - T_Ca)*P_r + T_Ca;
@@ -454,7 +522,7 @@ namespace voom {
     s2 = s1*(k2/k1)*(r1/r2);
     s2_p =  s1_p*(k2_p/k1_p)*(r1/r2);
     
-    k3 = P_tmp/(3.0*(1.0+P_tmp));
+    k3 = _VoltageRates[MAH_K3];
     k3_p = k3;
     k5 = (1.0f - P_s)/tau_Ca;
     k5_p = (1.0f - P_s)/tau_Ba;
@@ -530,10 +598,9 @@ namespace voom {
   
   Real Mahajan::comp_dir(Real po, Real Qr, Real rxa, Real dcj) {
     Real spark_rate, gRyRV;
-    const Real ay = 0.05;
     const Real gRyR = 2.58079f;
     
-    gRyRV = gRyR*exp(-ay*(_State[0]+30.0))/(1.0+exp(-ay*(_State[0]+30.0)));
+    gRyRV = gRyR*_VoltageRates[MAH_GRYRV];
     spark_rate=_Constants[5]*po*fabsf(rxa)*gRyRV; // minus and without ABS?
     
     return spark_rate*_State[10]*Qr/_Constants[19] - _State[12]*(1.0-_Constants[16]*_Rates[10]/_State[10])/_Constants[16];
@@ -543,11 +610,10 @@ namespace voom {
   Real Mahajan::comp_dcp(Real po, Real Qr, Real rxa) {
     Real gSRV, JSRtld, JCatld;
     const Real gSRbar=26841.8f; // m mol/(cm C)
-    const Real ax = 0.3576f; 
     const Real gCabar = 9000.0f;; // m mol/(cm C)
     const Real taups = 0.5;
     
-    gSRV  = gSRbar*exp(-ax*(_State[0]+30.0))/(1.0+exp(-ax*(_State[0]+30.0)));
+    gSRV  = gSRbar*_VoltageRates[MAH_GSRV];
     JSRtld = gSRV*Qr*po*fabsf(rxa); // minus and without fabsf?
     JCatld = _Constants[5]*gCabar*po*fabsf(rxa); // minus and without fabsf?
     
@@ -555,20 +621,32 @@ namespace voom {
   }
   
   
-  // Runge Kutta Update
+  /*!
+    Adaptive update. Gate rates from ucla_rhsfun(h) are Rush-Larsen updates
+    over h, the other states are integrated with Forward Euler. The substep
+    limits the change of voltage and of the submembrane, dyadic and
+    cytosolic Ca (see IonicMaterial::setSubstepping).
+  */
   void Mahajan::UpdateStateVariables(const Real dt, const Real i_stim) {
-    const Real MAX_DV_DT = 20.;
-    const int EULER_ADAPT_FCT = 10;
-    ucla_rhsfun(dt, i_stim);
-    if ( abs(_Rates[0]) > MAX_DV_DT) {
-      for(int i = 0; i < EULER_ADAPT_FCT; i++) {
-	ucla_rhsfun( dt/EULER_ADAPT_FCT, i_stim);
-	for(int j = 0; j < _nVar; j++)
-	  _State[j] += _Rates[j] * dt/EULER_ADAPT_FCT;
+    const int controlled[3] = {7, 8, 9};
+    Real timeLeft = dt, h = dt;
+    _numSubsteps = 0;
+    while (timeLeft > 1.0e-12*dt) {
+      // Only the Rush-Larsen rates depend on h, the rates limiting the
+      // substep do not. Try the previous substep length first.
+      ucla_rhsfun(h, i_stim);
+      const Real hMax = substepLength(&_State[0], _Rates, controlled, 3,
+				      timeLeft, dt);
+      if (hMax < h) {
+	h = hMax;
+	ucla_rhsfun(h, i_stim);
       }
-    } else {
       for(int j = 0; j < _nVar; j++)
-	_State[j] += _Rates[j] * dt;
+	_State[j] += _Rates[j] * h;
+      timeLeft -= h;
+      _numSubsteps++;
+      if (timeLeft > 1.0e-12*dt)
+	h = timeLeft/ceil(timeLeft/h - 1.0e-8);
     }
   }
   
@@ -583,7 +661,7 @@ namespace voom {
       // Compute Data for one time step
       UpdateStateVariables(dt, i_stim);
 
-      //Return dV/dT
-      return _Rates[0];
+      // Return mean dV/dT over the substeps
+      return (_State[0] - Volt)/dt;
     }
 }
@@ -18,8 +18,27 @@
  */
 
 #include "IonicMaterial.h"
+#include "VoltageTable.h"
 
 namespace voom {
+  //! Voltage dependent quantities of the model (see MahajanVoltageRates)
+  enum MahajanVoltageRate {
+    MAH_AM, MAH_BM, MAH_AH, MAH_BH, MAH_AJ, MAH_BJ,           // I_Na gates
+    MAH_TAUKR, MAH_XKRINF, MAH_RG,                            // I_Kr
+    MAH_XS1SS, MAH_TAUXS1,                                    // I_Ks
+    MAH_XKIN,                                                 // I_K1
+    MAH_XTOS_INF, MAH_YTOS_INF, MAH_TXS, MAH_TYS, MAH_TXF, MAH_TYF, // I_to
+    MAH_FNAK,                                                 // I_NaK
+    MAH_ENACA1, MAH_ENACA2,                                   // I_NaCa
+    MAH_RXA, MAH_EXPZA,                                       // Ca driving force
+    MAH_PO_INF, MAH_PR, MAH_PS, MAH_K3, MAH_RV,               // Markov I_Ca
+    MAH_GRYRV, MAH_GSRV,                                      // Release
+    MAH_NUM_VOLTAGE_RATES
+  };
+
+  //! Evaluate all MahajanVoltageRate values at V
+  void MahajanVoltageRates(const Real *Constants, const Real V, Real *Values);
+
   class Mahajan: public IonicMaterial {
   private:
     //! Number of Variables
@@ -34,6 +53,12 @@ namespace voom {
     //! Constants
     Real *_Constants;
 
+    //! Voltage dependent quantities at the current voltage
+    Real _VoltageRates[MAH_NUM_VOLTAGE_RATES];
+
+    //! Table of the voltage dependent quantities (NULL: analytic)
+    VoltageTable *_table;
+
     //! Compute I_na
     Real comp_ina(const Real dt);
 
@@ -85,8 +110,18 @@ namespace voom {
     //! Forward Euler Update of State Variables
     void UpdateStateVariables(const Real dt, const Real i_stim);
   public:
-    //! Constructor. Pos defines Epi/Myo/Endo/Apex/Center/base 0 - 8 index
-    Mahajan(Real *Constants, const int pos = 0);
+    /*!
+      Constructor. Pos defines Epi/Myo/Endo/Apex/Center/base 0 - 8 index.
+      Table = NULL evaluates the voltage dependent quantities analytically.
+    */
+    Mahajan(Real *Constants, const int pos = 0, VoltageTable *Table = NULL);
+
+    /*!
+      Table of the voltage dependent quantities for the given constants, to
+      be shared by all cells using them. Caller owns the table.
+    */
+    static VoltageTable * makeVoltageTable(Real *Constants,
+					   const Real dv = 0.01);
 
     //! Destructor
     ~Mahajan() {;}
@@ -1,68 +1,91 @@
 #include "Purkinje.h"
 
 namespace voom {
+  // Constants are not needed (VoltageTable signature)
+  void PurkinjeVoltageRates(const Real *, const Real V,
+			    Real *Algebraic) {
+    Algebraic[1] = 1.00000/(1.00000+(exp(((V+47.8000)/-5.50000))));
+    Algebraic[3] = 1.00000/(1.00000+(exp(((V+14.6000)/-5.50000))));
+    Algebraic[6] = 1.00000/(1.00000+(exp(((V+-7.00000)/-9.00000))));
+    Algebraic[7] = 1.00000/(1.00000+(exp(((V+27.5000)/8.00000))));
+    Algebraic[8] = 1.00000/(1.00000+(exp(((V+25.0000)/-5.00000))));
+    Algebraic[9] = 1.00000/(1.00000+(exp(((V+69.0000)/3.96000))));
+    Algebraic[10] = 1.00000/(1.00000+(exp(((V+30.0000)/-5.00000))));
+    Algebraic[2] = 1.00000/(1.00000+(exp(((V+67.9000)/3.87000))));
+    Algebraic[17] =  1.42271*(exp(( -0.0511900*V)));
+    Algebraic[4] = 1.00000/(1.00000+(exp(((V+31.0000)/5.54000))));
+    Algebraic[18] = 25.1000/(0.0400000+ 0.700000*(exp(( -1.00000*(pow(( 0.0280000*(V+14.5000)), 2.00000))))));
+    Algebraic[11] = 0.100000+0.900000/(1.00000+(exp(((V+75.6000)/6.30000))));
+    Algebraic[20] = 120.000+ 1.00000*(exp(((V+100.000)/25.0000)));
+    Algebraic[13] = 1.00000/(1.00000+(exp(((V - 1.50000)/-16.7000))));
+    Algebraic[22] = ((fabs((V+30.0000)))<0.0145000 ? 417.946 : 1.00000/(( 7.19000e-05*(V+30.0000))/(1.00000 - (exp(( -0.148000*(V+30.0000)))))+( 0.000131000*(V+30.0000))/((exp(( 0.0687000*(V+30.0000)))) - 1.00000)));
+    Algebraic[14] = 1.00000/(1.00000+(exp(((V+109.000)/10.0000))));
+    Algebraic[23] = 6000.00/((exp(( -1.00000*(2.90000+ 0.0400000*V))))+(exp(( 1.00000*(3.60000+ 0.110000*V)))));
+    Algebraic[15] = 1.00000/(1.00000+(exp(((V+109.000)/10.0000))));
+    Algebraic[24] = 6000.00/((exp(( -1.00000*(2.90000+ 0.0400000*V))))+(exp(( 1.00000*(3.60000+ 0.110000*V)))));
+    Algebraic[12] = 1.00000/(1.00000+(exp(((V+50.0000)/-7.50000))));
+    Algebraic[21] = ((fabs((V+7.00000)))>0.00100000 ? ( 0.00138000*1.00000*(V+7.00000))/(1.00000 - (exp(( -0.123000*(V+7.00000))))) : 0.00138000/0.123000);
+    Algebraic[26] = ((fabs((V+10.0000)))>0.00100000 ? ( 6.10000e-05*1.00000*(V+10.0000))/((exp(( 0.145000*(V+10.0000)))) - 1.00000) : 0.000610000/0.145000);
+    Algebraic[29] = 1.00000/(Algebraic[21]+Algebraic[26]);
+    Algebraic[27] = Algebraic[13];
+    Algebraic[30] =  4.00000*Algebraic[22];
+    Algebraic[41] = 1.00000/(1.00000+(exp(((92.0000+V)/10.0000))));
+    Algebraic[34] = 1.00000/(1.00000+(exp(((5.00000 - V)/17.0000))));
+    Algebraic[44] = 1.00000/(1.00000+(exp(((33.0000+V)/22.4000))));
+    Algebraic[50] = 1.00000/(1.00000+(exp(((V+80.0000)/-45.0000))));
+    Algebraic[51] = 1.00000/(1.00000+(exp(((V+0.00000)/125.000))));
+  }
+
+  void Purkinje::ComputeVoltageRates() {
+    if (_table && _table->inRange(_State[0]))
+      _table->interpolate(_State[0], _Algebraic);
+    else
+      PurkinjeVoltageRates(_Constants, _State[0], _Algebraic);
+  }
+
+  VoltageTable * Purkinje::makeVoltageTable(Real *constants, const Real dv) {
+    VoltageTable * table = new VoltageTable(PurkinjeVoltageRates, constants,
+					    69, -100., 100., dv);
+    table->addRates(PurkinjeVoltageIndex, PurkinjeNumVoltageRates);
+    // Value of Algebraic[26] for |V + 10| < 0.001 differs from its limit
+    table->addBreakpoint(-10.);
+    table->build();
+    return table;
+  }
+
   //! Compute the Rates
   void Purkinje::ComputeRates() {
-    _Algebraic[1] = 1.00000/(1.00000+(exp(((_State[0]+47.8000)/-5.50000))));
+    ComputeVoltageRates();
     _Rates[6] = (_Algebraic[1] - _State[6])/_Constants[16];
-    _Algebraic[3] = 1.00000/(1.00000+(exp(((_State[0]+14.6000)/-5.50000))));
     _Rates[8] = (_Algebraic[3] - _State[8])/_Constants[18];
-    _Algebraic[6] = 1.00000/(1.00000+(exp(((_State[0]+-7.00000)/-9.00000))));
     _Rates[11] = (_Algebraic[6] - _State[11])/_Constants[20];
-    _Algebraic[7] = 1.00000/(1.00000+(exp(((_State[0]+27.5000)/8.00000))));
     _Rates[12] = (_Algebraic[7] - _State[12])/_Constants[21];
-    _Algebraic[8] = 1.00000/(1.00000+(exp(((_State[0]+25.0000)/-5.00000))));
     _Rates[13] = (_Algebraic[8] - _State[13])/_Constants[24];
-    _Algebraic[9] = 1.00000/(1.00000+(exp(((_State[0]+69.0000)/3.96000))));
     _Rates[14] = (_Algebraic[9] - _State[14])/_Constants[25];
-    _Algebraic[10] = 1.00000/(1.00000+(exp(((_State[0]+30.0000)/-5.00000))));
     _Rates[15] = (_Algebraic[10] - _State[15])/_Constants[27];
-    _Algebraic[2] = 1.00000/(1.00000+(exp(((_State[0]+67.9000)/3.87000))));
-    _Algebraic[17] =  1.42271*(exp(( -0.0511900*_State[0])));
     _Rates[7] = (_Algebraic[2] - _State[7])/_Algebraic[17];
-    _Algebraic[4] = 1.00000/(1.00000+(exp(((_State[0]+31.0000)/5.54000))));
-    _Algebraic[18] = 25.1000/(0.0400000+ 0.700000*(exp(( -1.00000*(pow(( 0.0280000*(_State[0]+14.5000)), 2.00000))))));
     _Rates[9] = (_Algebraic[4] - _State[9])/_Algebraic[18];
     _Algebraic[5] = 0.400000+0.600000/(1.00000+(pow((_State[1]/0.000100000), 2.00000)));
     _Algebraic[19] = 2.00000+80.0000/(1.00000+(pow((_State[1]/0.000100000), 2.00000)));
     _Rates[10] = (_Algebraic[5] - _State[10])/_Algebraic[19];
-    _Algebraic[11] = 0.100000+0.900000/(1.00000+(exp(((_State[0]+75.6000)/6.30000))));
-    _Algebraic[20] = 120.000+ 1.00000*(exp(((_State[0]+100.000)/25.0000)));
     _Rates[16] = (_Algebraic[11] - _State[16])/_Algebraic[20];
-    _Algebraic[13] = 1.00000/(1.00000+(exp(((_State[0] - 1.50000)/-16.7000))));
-    _Algebraic[22] = ((fabs((_State[0]+30.0000)))<0.0145000 ? 417.946 : 1.00000/(( 7.19000e-05*(_State[0]+30.0000))/(1.00000 - (exp(( -0.148000*(_State[0]+30.0000)))))+( 0.000131000*(_State[0]+30.0000))/((exp(( 0.0687000*(_State[0]+30.0000)))) - 1.00000)));
     _Rates[18] = (_Algebraic[13] - _State[18])/_Algebraic[22];
-    _Algebraic[14] = 1.00000/(1.00000+(exp(((_State[0]+109.000)/10.0000))));
-    _Algebraic[23] = 6000.00/((exp(( -1.00000*(2.90000+ 0.0400000*_State[0]))))+(exp(( 1.00000*(3.60000+ 0.110000*_State[0])))));
     _Rates[20] = (_Algebraic[14] - _State[20])/_Algebraic[23];
-    _Algebraic[15] = 1.00000/(1.00000+(exp(((_State[0]+109.000)/10.0000))));
-    _Algebraic[24] = 6000.00/((exp(( -1.00000*(2.90000+ 0.0400000*_State[0]))))+(exp(( 1.00000*(3.60000+ 0.110000*_State[0])))));
     _Rates[21] = (_Algebraic[15] - _State[21])/_Algebraic[24];
-    _Algebraic[12] = 1.00000/(1.00000+(exp(((_State[0]+50.0000)/-7.50000))));
-    _Algebraic[21] = ((fabs((_State[0]+7.00000)))>0.00100000 ? ( 0.00138000*1.00000*(_State[0]+7.00000))/(1.00000 - (exp(( -0.123000*(_State[0]+7.00000))))) : 0.00138000/0.123000);
-    _Algebraic[26] = ((fabs((_State[0]+10.0000)))>0.00100000 ? ( 6.10000e-05*1.00000*(_State[0]+10.0000))/((exp(( 0.145000*(_State[0]+10.0000)))) - 1.00000) : 0.000610000/0.145000);
-    _Algebraic[29] = 1.00000/(_Algebraic[21]+_Algebraic[26]);
     _Rates[17] = (_Algebraic[12] - _State[17])/_Algebraic[29];
-    _Algebraic[27] = _Algebraic[13];
-    _Algebraic[30] =  4.00000*_Algebraic[22];
     _Rates[19] = (_Algebraic[27] - _State[19])/_Algebraic[30];
-    _Algebraic[41] = 1.00000/(1.00000+(exp(((92.0000+_State[0])/10.0000))));
     _Algebraic[42] =  _Constants[58]*(log((_Constants[5]/_State[5])));
     _Algebraic[43] =  _Constants[29]*(pow((_Constants[5]/5.40000), 0.800000))*_Algebraic[41]*(_State[0] - _Algebraic[42]);
     _Algebraic[32] =  _Constants[58]*(log((_Constants[5]/_State[5])));
     _Algebraic[33] =  _Constants[22]*_State[11]*_State[12]*(_State[0] - _Algebraic[32]);
-    _Algebraic[34] = 1.00000/(1.00000+(exp(((5.00000 - _State[0])/17.0000))));
     _Algebraic[35] =  _Constants[58]*(log((_Constants[5]/_State[5])));
     _Algebraic[36] =  _Constants[23]*_Algebraic[34]*(_State[0] - _Algebraic[35]);
-    _Algebraic[44] = 1.00000/(1.00000+(exp(((33.0000+_State[0])/22.4000))));
     _Algebraic[45] =  _Constants[58]*(log((_Constants[5]/_State[5])));
     _Algebraic[46] =  _Constants[30]*(pow((_Constants[5]/5.40000), 1.00000))*_Algebraic[44]*_State[17]*(_State[0] - _Algebraic[45]);
     _Algebraic[47] =  _Constants[58]*(log((_Constants[5]/_State[5])));
     _Algebraic[48] =  _Constants[31]*_State[18]*_State[19]*(_State[0] - _Algebraic[47]);
     _Algebraic[53] =  _Constants[58]*(log((_Constants[5]/_State[5])));
     _Algebraic[54] =  _Constants[37]*(_State[0] - _Algebraic[53]);
-    _Algebraic[50] = 1.00000/(1.00000+(exp(((_State[0]+80.0000)/-45.0000))));
-    _Algebraic[51] = 1.00000/(1.00000+(exp(((_State[0]+0.00000)/125.000))));
     _Algebraic[52] =  _Constants[36]*_Algebraic[50]*_Algebraic[51]*(1.00000/(1.00000+(pow((1.90000/_Constants[5]), 1.45000))))*(1.00000/(1.00000+(pow((31.9800/_State[4]), 1.00000))));
     _Algebraic[60] =  _Constants[58]*(log((_Constants[5]/_State[5])));
     _Algebraic[62] =  _Constants[43]*_State[20]*(_State[0] - _Algebraic[60]);
@@ -104,50 +127,21 @@ namespace voom {
   }
   
   void Purkinje::ComputeVariables() {
-    _Algebraic[1] = 1.00000/(1.00000+(exp(((_State[0]+47.8000)/-5.50000))));
-    _Algebraic[3] = 1.00000/(1.00000+(exp(((_State[0]+14.6000)/-5.50000))));
-    _Algebraic[6] = 1.00000/(1.00000+(exp(((_State[0]+-7.00000)/-9.00000))));
-    _Algebraic[7] = 1.00000/(1.00000+(exp(((_State[0]+27.5000)/8.00000))));
-    _Algebraic[8] = 1.00000/(1.00000+(exp(((_State[0]+25.0000)/-5.00000))));
-    _Algebraic[9] = 1.00000/(1.00000+(exp(((_State[0]+69.0000)/3.96000))));
-    _Algebraic[10] = 1.00000/(1.00000+(exp(((_State[0]+30.0000)/-5.00000))));
-    _Algebraic[2] = 1.00000/(1.00000+(exp(((_State[0]+67.9000)/3.87000))));
-    _Algebraic[17] =  1.42271*(exp(( -0.0511900*_State[0])));
-    _Algebraic[4] = 1.00000/(1.00000+(exp(((_State[0]+31.0000)/5.54000))));
-    _Algebraic[18] = 25.1000/(0.0400000+ 0.700000*(exp(( -1.00000*(pow(( 0.0280000*(_State[0]+14.5000)), 2.00000))))));
+    ComputeVoltageRates();
     _Algebraic[5] = 0.400000+0.600000/(1.00000+(pow((_State[1]/0.000100000), 2.00000)));
     _Algebraic[19] = 2.00000+80.0000/(1.00000+(pow((_State[1]/0.000100000), 2.00000)));
-    _Algebraic[11] = 0.100000+0.900000/(1.00000+(exp(((_State[0]+75.6000)/6.30000))));
-    _Algebraic[20] = 120.000+ 1.00000*(exp(((_State[0]+100.000)/25.0000)));
-    _Algebraic[13] = 1.00000/(1.00000+(exp(((_State[0] - 1.50000)/-16.7000))));
-    _Algebraic[22] = ((fabs((_State[0]+30.0000)))<0.0145000 ? 417.946 : 1.00000/(( 7.19000e-05*(_State[0]+30.0000))/(1.00000 - (exp(( -0.148000*(_State[0]+30.0000)))))+( 0.000131000*(_State[0]+30.0000))/((exp(( 0.0687000*(_State[0]+30.0000)))) - 1.00000)));
-    _Algebraic[14] = 1.00000/(1.00000+(exp(((_State[0]+109.000)/10.0000))));
-    _Algebraic[23] = 6000.00/((exp(( -1.00000*(2.90000+ 0.0400000*_State[0]))))+(exp(( 1.00000*(3.60000+ 0.110000*_State[0])))));
-    _Algebraic[15] = 1.00000/(1.00000+(exp(((_State[0]+109.000)/10.0000))));
-    _Algebraic[24] = 6000.00/((exp(( -1.00000*(2.90000+ 0.0400000*_State[0]))))+(exp(( 1.00000*(3.60000+ 0.110000*_State[0])))));
-    _Algebraic[12] = 1.00000/(1.00000+(exp(((_State[0]+50.0000)/-7.50000))));
-    _Algebraic[21] = ((fabs((_State[0]+7.00000)))>0.00100000 ? ( 0.00138000*1.00000*(_State[0]+7.00000))/(1.00000 - (exp(( -0.123000*(_State[0]+7.00000))))) : 0.00138000/0.123000);
-    _Algebraic[26] = ((fabs((_State[0]+10.0000)))>0.00100000 ? ( 6.10000e-05*1.00000*(_State[0]+10.0000))/((exp(( 0.145000*(_State[0]+10.0000)))) - 1.00000) : 0.000610000/0.145000);
-    _Algebraic[29] = 1.00000/(_Algebraic[21]+_Algebraic[26]);
-    _Algebraic[27] = _Algebraic[13];
-    _Algebraic[30] =  4.00000*_Algebraic[22];
-    _Algebraic[41] = 1.00000/(1.00000+(exp(((92.0000+_State[0])/10.0000))));
     _Algebraic[42] =  _Constants[58]*(log((_Constants[5]/_State[5])));
     _Algebraic[43] =  _Constants[29]*(pow((_Constants[5]/5.40000), 0.800000))*_Algebraic[41]*(_State[0] - _Algebraic[42]);
     _Algebraic[32] =  _Constants[58]*(log((_Constants[5]/_State[5])));
     _Algebraic[33] =  _Constants[22]*_State[11]*_State[12]*(_State[0] - _Algebraic[32]);
-    _Algebraic[34] = 1.00000/(1.00000+(exp(((5.00000 - _State[0])/17.0000))));
     _Algebraic[35] =  _Constants[58]*(log((_Constants[5]/_State[5])));
     _Algebraic[36] =  _Constants[23]*_Algebraic[34]*(_State[0] - _Algebraic[35]);
-    _Algebraic[44] = 1.00000/(1.00000+(exp(((33.0000+_State[0])/22.4000))));
     _Algebraic[45] =  _Constants[58]*(log((_Constants[5]/_State[5])));
     _Algebraic[46] =  _Constants[30]*(pow((_Constants[5]/5.40000), 1.00000))*_Algebraic[44]*_State[17]*(_State[0] - _Algebraic[45]);
     _Algebraic[47] =  _Constants[58]*(log((_Constants[5]/_State[5])));
     _Algebraic[48] =  _Constants[31]*_State[18]*_State[19]*(_State[0] - _Algebraic[47]);
     _Algebraic[53] =  _Constants[58]*(log((_Constants[5]/_State[5])));
     _Algebraic[54] =  _Constants[37]*(_State[0] - _Algebraic[53]);
-    _Algebraic[50] = 1.00000/(1.00000+(exp(((_State[0]+80.0000)/-45.0000))));
-    _Algebraic[51] = 1.00000/(1.00000+(exp(((_State[0]+0.00000)/125.000))));
     _Algebraic[52] =  _Constants[36]*_Algebraic[50]*_Algebraic[51]*(1.00000/(1.00000+(pow((1.90000/_Constants[5]), 1.45000))))*(1.00000/(1.00000+(pow((31.9800/_State[4]), 1.00000))));
     _Algebraic[60] =  _Constants[58]*(log((_Constants[5]/_State[5])));
     _Algebraic[62] =  _Constants[43]*_State[20]*(_State[0] - _Algebraic[60]);
@@ -174,20 +168,43 @@ namespace voom {
     _Algebraic[68] =  _Constants[56]*(_State[1] - _State[2]);
   }
 
-  // Forward Euler Adaptive Update of state variables
-  // Newton Raphson update of State Variables
+  //! Rush-Larsen update of the gates 6 - 21 with the current Algebraic
+  void Purkinje::UpdateGates(const Real h) {
+    _State[6]  = rushLarsen(_State[6],  _Algebraic[1],  _Constants[16], h);
+    _State[7]  = rushLarsen(_State[7],  _Algebraic[2],  _Algebraic[17], h);
+    _State[8]  = rushLarsen(_State[8],  _Algebraic[3],  _Constants[18], h);
+    _State[9]  = rushLarsen(_State[9],  _Algebraic[4],  _Algebraic[18], h);
+    _State[10] = rushLarsen(_State[10], _Algebraic[5],  _Algebraic[19], h);
+    _State[11] = rushLarsen(_State[11], _Algebraic[6],  _Constants[20], h);
+    _State[12] = rushLarsen(_State[12], _Algebraic[7],  _Constants[21], h);
+    _State[13] = rushLarsen(_State[13], _Algebraic[8],  _Constants[24], h);
+    _State[14] = rushLarsen(_State[14], _Algebraic[9],  _Constants[25], h);
+    _State[15] = rushLarsen(_State[15], _Algebraic[10], _Constants[27], h);
+    _State[16] = rushLarsen(_State[16], _Algebraic[11], _Algebraic[20], h);
+    _State[17] = rushLarsen(_State[17], _Algebraic[12], _Algebraic[29], h);
+    _State[18] = rushLarsen(_State[18], _Algebraic[13], _Algebraic[22], h);
+    _State[19] = rushLarsen(_State[19], _Algebraic[27], _Algebraic[30], h);
+    _State[20] = rushLarsen(_State[20], _Algebraic[14], _Algebraic[23], h);
+    _State[21] = rushLarsen(_State[21], _Algebraic[15], _Algebraic[24], h);
+  }
+
+  /*!
+    Voltage and concentrations (states 0 - 5) are integrated with Forward
+    Euler, gates with Rush-Larsen. The step is split into substeps limiting
+    the change of voltage and Ca (see IonicMaterial::setSubstepping).
+  */
   void Purkinje::UpdateStateVariables(const Real dt) {
-    // TIme adaptive Forward Euler
-    const Real MAX_DV_DT = 1.5;
-    const Real EULER_ADAPT_FCT = 10;
-    ComputeRates();
-    if ( fabs(_Rates[0]) > MAX_DV_DT ){
-      for(int i = 0; i < EULER_ADAPT_FCT; i++) {
-	ComputeRates();
-	for(int j = 0; j < 22; j++) _State[j] += _Rates[j]*dt/EULER_ADAPT_FCT;
-      }
-    }else {
-      for(int j = 0; j < 22; j++) _State[j] += _Rates[j]*dt;
+    const int controlled[3] = {1, 2, 3};
+    Real timeLeft = dt;
+    _numSubsteps = 0;
+    while (timeLeft > 1.0e-12*dt) {
+      ComputeRates();
+      const Real h = substepLength(&_State[0], _Rates, controlled, 3,
+				   timeLeft, dt);
+      UpdateGates(h);
+      for(int j = 0; j < 6; j++) _State[j] += _Rates[j]*h;
+      timeLeft -= h;
+      _numSubsteps++;
     }
   }
 
@@ -205,7 +222,8 @@ namespace voom {
 
     // Update State Variables
     UpdateStateVariables(dt);
-    return _Rates[0];
+    // Mean dV/dt over the substeps
+    return (_State[0] - volt)/dt;
   }
 
   //! Get Gamma active contraction values
@@ -12,8 +12,19 @@
 #define _Purkinje_h_
 
 #include "IonicMaterial.h"
+#include "VoltageTable.h"
 
 namespace voom {
+  //! Voltage dependent gates and time constants, written to Algebraic
+  void PurkinjeVoltageRates(const Real *Constants, const Real V,
+			    Real *Algebraic);
+
+  //! Algebraic entries computed by PurkinjeVoltageRates and used afterwards
+  const int PurkinjeNumVoltageRates = 28;
+  const int PurkinjeVoltageIndex[PurkinjeNumVoltageRates] =
+    {1, 2, 3, 4, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 17, 18, 20, 22, 23, 24,
+     27, 29, 30, 34, 41, 44, 50, 51};
+
   class Purkinje: public IonicMaterial {
   private:
     //! Constants for the model
@@ -31,14 +42,24 @@ namespace voom {
     //! Surface Area of the Cell
     Real  _SurfaceArea;
 
-    //! Forward Euler Adaptive Update of State Variables
+    //! Table of the voltage dependent rates (NULL: analytic)
+    VoltageTable *_table;
+
+    //! Voltage dependent Algebraic entries at _State[0]
+    void ComputeVoltageRates();
+
+    //! Rush-Larsen update of the gating variables over h
+    void UpdateGates(const Real h);
+
+    //! Adaptive Forward Euler / Rush-Larsen Update of State Variables
     void UpdateStateVariables(const Real dt);
 
     //!
   public:
-    //! Constructor
-    Purkinje(Real *constants){
+    //! Constructor (Table = NULL evaluates the rates analytically)
+    Purkinje(Real *constants, VoltageTable *Table = NULL){
       _Constants = constants;
+      _table = Table;
       _State.resize( 22 );
       // Initialize States
       _State[0] = -88.34;      _State[1] = 0.00001;      _State[2] = 0.000032;
@@ -64,6 +85,13 @@ namespace voom {
     //! Compute Variables
     void ComputeVariables();
 
+    /*!
+      Table of the voltage dependent rates for the given constants, to be
+      shared by all cells using them. Caller owns the table.
+    */
+    static VoltageTable * makeVoltageTable(Real *constants,
+					   const Real dv = 0.01);
+
     //! Compute Ionic Current
     Real compute(Real Xi, Real C_m, Real dt, Real volt,
 		     Real istim);
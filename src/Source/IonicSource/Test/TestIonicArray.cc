@@ -0,0 +1,219 @@
+#include "LR.h"
+#include "Tusscher.h"
+#include "LRArray.h"
+#include "TusscherArray.h"
+#include "SetUpIonicConstants.h"
+#include <ctime>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace voom;
+
+// Wall clock time in seconds
+Real wallTime() {
+#ifdef _OPENMP
+  return omp_get_wtime();
+#else
+  return Real(clock())/Real(CLOCKS_PER_SEC);
+#endif
+}
+
+// Luo Rudy stimulus of cell c at step n: every other cell, first 0.5 ms
+Real lrStimulus(int n, int c, Real dt) {
+  return n*dt < 0.5 ? 1.0e5*Real(c % 2) : 0.0;
+}
+
+// Luo Rudy cells as one object each, over the same threads as the arrays.
+// Returns the wall time
+Real runObjects(vector<IonicMaterial * > & Cells, vector<Real > & V, int NumSteps,
+		Real Xi, Real Cm, Real dt) {
+  const int NumCells = Cells.size();
+  Real t0 = wallTime();
+  for (int n = 0; n < NumSteps; n++) {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int c = 0; c < NumCells; c++)
+      V[c] += dt*Cells[c]->compute(Xi, Cm, dt, V[c], lrStimulus(n, c, dt));
+  }
+  return wallTime() - t0;
+}
+
+// Luo Rudy cells as an array. Returns the wall time
+Real runArray(IonicArray & Cells, vector<Real > & V, int NumSteps,
+	      Real Xi, Real Cm, Real dt) {
+  const int NumCells = Cells.getNumCells();
+  vector<Real > istim(NumCells, 0.0), dVdt(NumCells, 0.0);
+  Real t0 = wallTime();
+  for (int n = 0; n < NumSteps; n++) {
+    for (int c = 0; c < NumCells; c++)
+      istim[c] = lrStimulus(n, c, dt);
+    Cells.compute(Xi, Cm, dt, &V[0], &istim[0], &dVdt[0]);
+    for (int c = 0; c < NumCells; c++)
+      V[c] += dt*dVdt[c];
+  }
+  return wallTime() - t0;
+}
+
+// Largest difference between A and B
+Real maxDifference(const vector<Real > & A, const vector<Real > & B) {
+  Real error = 0.0;
+  for (uint i = 0; i < A.size(); i++)
+    error = max(error, fabs(A[i] - B[i]));
+  return error;
+}
+
+int main(int argc, char** argv)
+{
+  const int NumCells = argc > 1 ? atoi(argv[1]) : 4096;
+  const Real dt = 0.01, Cm = 1.0;
+
+  // Luo Rudy gate table
+  {
+    cout << endl << "Testing LuoRudyGateTable" << endl;
+    const Real E_K1 = 26.73*log(5.4/145.0), G_K1 = .6047;
+    const Real spacing[] = {0.001, 0.01, 0.05};
+    for (int s = 0; s < 3; s++) {
+      Real t0 = wallTime();
+      LuoRudyGateTable table(-90., 200., spacing[s]);
+      Real tBuild = wallTime() - t0;
+
+      // Relative error of interpolated values at voltages between the nodes,
+      // skipping the table interval across the -40 mV branch of alpha_h/beta_h
+      Real error = 0.0;
+      for (int i = 0; i < 100000; i++) {
+	Real v = -89.9 + 289.8*Real(i)/100000.0 + 0.37*spacing[s];
+	if (fabs(v + 40.0) < spacing[s]) continue;
+	Real exact[14], interp[14];
+	LuoRudyRates(&v, 1, E_K1, G_K1, exact, 1);
+	table.get_parameters(v, interp);
+	for (int k = 0; k < 14; k++)
+	  error = max(error, fabs(interp[k] - exact[k])/max(fabs(exact[k]), 1.0e-3));
+      }
+      cout << "dv = " << spacing[s] << " mV: " << table.getMemory()/1024 << " kB, built in "
+	   << tBuild << " s, max relative error = " << error << endl;
+      if (s == 1)
+	cout << "Interpolation error at dv = 0.01 mV - "
+	     << (error < 1.0e-3 ? "PASSED" : "FAILED") << endl;
+    }
+
+    // One coarse table shared by the LuoRudy cells
+    LuoRudyGateTable * shared = LuoRudyGateTable::getShared();
+    cout << "Shared table: " << shared->getMemory()/1024 << " kB - "
+	 << (shared == LuoRudyGateTable::getShared() && shared->getSpacing() == 0.01 ?
+	     "PASSED" : "FAILED") << endl;
+  }
+
+  // Luo Rudy, per object and as an array with the same rates: analytic,
+  // then from the same gate table (dv = 0.01 mV)
+  {
+    cout << endl << "Testing LuoRudyArray with " << NumCells << " cells";
+#ifdef _OPENMP
+    cout << " on " << omp_get_max_threads() << " thread(s)";
+#endif
+    cout << endl;
+    const int NumSteps = 2000;
+    // Both scale the stimulus with their own surface to volume ratio
+    const Real Xi = 1.0;
+    LuoRudyGateTable table(-90., 200., 0.01);
+    vector<Real > V[4];
+    Real time[4];
+    for (int k = 0; k < 4; k++) {
+      LuoRudyGateTable * gate = k < 2 ? NULL : &table;
+      V[k].assign(NumCells, -84.0);
+      if (k % 2 == 0) {
+	vector<IonicMaterial * > cells(NumCells, (IonicMaterial *)(NULL));
+	for (int c = 0; c < NumCells; c++)
+	  cells[c] = new LuoRudy(gate != NULL, gate);
+	time[k] = runObjects(cells, V[k], NumSteps, Xi, Cm, dt);
+	for (int c = 0; c < NumCells; c++)
+	  delete cells[c];
+      }
+      else {
+	LuoRudyArray cellArray(NumCells, gate);
+	time[k] = runArray(cellArray, V[k], NumSteps, Xi, Cm, dt);
+      }
+    }
+
+    const Real error = maxDifference(V[0], V[1]), tableError = maxDifference(V[2], V[3]);
+    cout << "Max voltage difference, analytic = " << error << ", gate table = " << tableError
+	 << " - " << (error < 1.0e-8 && tableError < 1.0e-8 ? "PASSED" : "FAILED") << endl;
+    const Real interpError = maxDifference(V[0], V[2]);
+    cout << "Max voltage difference of the gate table to the analytic rates = " << interpError
+	 << " - " << (interpError < 1.0e-1 ? "PASSED" : "FAILED") << endl;
+    const char * names[2] = {"Analytic  ", "Gate table"};
+    for (int k = 0; k < 2; k++)
+      cout << names[k] << ": per object " << Real(NumCells)*NumSteps/time[2*k]
+	   << ", array " << Real(NumCells)*NumSteps/time[2*k + 1]
+	   << " cells*steps/s, speed up " << time[2*k]/time[2*k + 1] << endl;
+  }
+
+  // Tusscher, at the reaction steps of EigenEPsolver with dt = 0.02 ms
+  // (STRANG and LIE splitting), through the upstroke into the plateau
+  {
+    const int NumTusscher = max(NumCells/16, 1);
+    cout << endl << "Testing TusscherArray with " << NumTusscher << " cells" << endl;
+    Real *constants;
+    SetUpTusscherParameters(&constants);
+    const Real steps[] = {0.01, 0.02};
+    for (int k = 0; k < 2; k++) {
+      const Real h = steps[k];
+      const int NumSteps = int(20.0/h + 0.5);
+      vector<IonicMaterial * > cells(NumTusscher, (IonicMaterial *)(NULL));
+      for (int c = 0; c < NumTusscher; c++)
+	cells[c] = new Tusscher(constants);
+      TusscherArray cellArray(NumTusscher, constants);
+      const Real Xi = cellArray.getXi();
+
+      vector<Real > V(NumTusscher, -85.423), Va(NumTusscher, -85.423), dVdt(NumTusscher, 0.0);
+      vector<Real > istim(NumTusscher, 0.0);
+
+      Real t0 = wallTime();
+      for (int n = 0; n < NumSteps; n++) {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+	for (int c = 0; c < NumTusscher; c++) {
+	  Real is = n*h < 1.0 ? 1.0e5*Real(c % 2 + 1) : 0.0;
+	  V[c] += h*cells[c]->compute(Xi, Cm, h, V[c], is);
+	}
+      }
+      Real tObj = wallTime() - t0;
+
+      t0 = wallTime();
+      for (int n = 0; n < NumSteps; n++) {
+	for (int c = 0; c < NumTusscher; c++)
+	  istim[c] = n*h < 1.0 ? 1.0e5*Real(c % 2 + 1) : 0.0;
+	cellArray.compute(Xi, Cm, h, &Va[0], &istim[0], &dVdt[0]);
+	for (int c = 0; c < NumTusscher; c++)
+	  Va[c] += h*dVdt[c];
+      }
+      Real tArr = wallTime() - t0;
+
+      // Same update as the per cell model, also for the concentrations
+      Real error = 0.0, concError = 0.0;
+      vector<Real > state;
+      for (int c = 0; c < NumTusscher; c++) {
+	error = max(error, fabs(V[c] - Va[c]));
+	int nData = 0;
+	const vector<Real > & cellState = cells[c]->getInternalParameters(nData);
+	cellArray.getState(c, state);
+	for (int s = 1; s < nData; s++)
+	  concError = max(concError, fabs(cellState[s] - state[s])/fabs(cellState[s]));
+      }
+      cout << "dt = " << h << " ms: V per object = " << V[0] << " - V array = " << Va[0] << endl;
+      cout << "Max voltage difference = " << error << ", max relative state difference = "
+	   << concError << " - " << (error < 1.0e-8 && concError < 1.0e-10 ? "PASSED" : "FAILED")
+	   << endl;
+      cout << "Per object " << Real(NumTusscher)*NumSteps/tObj << ", array "
+	   << Real(NumTusscher)*NumSteps/tArr << " cells*steps/s, speed up " << tObj/tArr << endl;
+
+      for (int c = 0; c < NumTusscher; c++)
+	delete cells[c];
+    }
+    delete [] constants;
+  }
+
+  return 0;
+}
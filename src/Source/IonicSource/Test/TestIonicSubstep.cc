@@ -0,0 +1,73 @@
+#include "Purkinje.h"
+#include "Mahajan.h"
+#include "SetUpIonicConstants.h"
+
+using namespace voom;
+
+/*
+  Run one action potential with time step dt, return peak voltage, action
+  potential duration (time above -60 mV) and mean number of substeps
+*/
+void runAP(IonicMaterial * cell, Real V0, Real Istim, Real Xi, Real dt,
+	   Real & Vmax, Real & APD, Real & meanSubsteps, uint & restSubsteps)
+{
+  const Real Cm = 1.0, FinalTime = 400.0;
+  const int NumSteps = int(FinalTime/dt + 0.5);
+  Real V = V0, tUp = -1.0, tDown = -1.0;
+  uint substeps = 0;
+  Vmax = V0;
+  for (int n = 0; n < NumSteps; n++) {
+    Real t = n*dt;
+    Real is = t < 2.0 ? Istim : 0.0;
+    V += dt*cell->compute(Xi, Cm, dt, V, is);
+    substeps += cell->getNumSubsteps();
+    Vmax = max(Vmax, V);
+    if (tUp < 0.0 && V > -60.0) tUp = t + dt;
+    if (tUp > 0.0 && tDown < 0.0 && V < -60.0) tDown = t + dt;
+  }
+  APD = tDown - tUp;
+  meanSubsteps = Real(substeps)/Real(NumSteps);
+  restSubsteps = cell->getNumSubsteps();
+}
+
+void testModel(const string Name, IonicMaterial * Reference,
+	       IonicMaterial * Coarse, Real V0, Real Istim, Real Xi)
+{
+  cout << endl << "Testing adaptive substepping for " << Name << endl;
+  Real VmaxRef, APDRef, subRef, Vmax, APD, sub;
+  uint restRef, rest;
+  runAP(Reference, V0, Istim, Xi, 0.001, VmaxRef, APDRef, subRef, restRef);
+  runAP(Coarse, V0, Istim, Xi, 0.1, Vmax, APD, sub, rest);
+  cout << "dt = 0.001 ms: peak = " << VmaxRef << " mV, APD = " << APDRef
+       << " ms, mean substeps = " << subRef << endl;
+  cout << "dt = 0.1   ms: peak = " << Vmax << " mV, APD = " << APD
+       << " ms, mean substeps = " << sub << ", substeps at rest = " << rest << endl;
+  bool pass = APDRef > 0.0 && fabs(APD - APDRef) < 0.05*APDRef &&
+    fabs(Vmax - VmaxRef) < 5.0 && rest == 1;
+  cout << "Coarse time step - " << (pass ? "PASSED" : "FAILED") << endl;
+}
+
+
+
+int main()
+{
+  // Purkinje
+  {
+    Real *constants;
+    SetUpPurkinjeParameters(&constants);
+    Purkinje reference(constants), coarse(constants);
+    testModel("Purkinje", &reference, &coarse, -88.34, 1.0e5, 2500.);
+    delete [] constants;
+  }
+
+  // Mahajan
+  {
+    Real *constants;
+    SetUpMahajanParameters(&constants, 0);
+    Mahajan reference(constants, 0), coarse(constants, 0);
+    testModel("Mahajan", &reference, &coarse, -87.1025, 1.0e5, 1.55E-4/2.58E-8);
+    delete [] constants;
+  }
+
+  return 0;
+}
@@ -0,0 +1,108 @@
+#include "Tusscher.h"
+#include "Purkinje.h"
+#include "Mahajan.h"
+#include "SetUpIonicConstants.h"
+#include <ctime>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace voom;
+
+// Wall clock time in seconds
+Real wallTime() {
+#ifdef _OPENMP
+  return omp_get_wtime();
+#else
+  return Real(clock())/Real(CLOCKS_PER_SEC);
+#endif
+}
+
+/*
+  Check the table against the analytic rates and compare one action
+  potential of a cell using the table with one using the analytic rates
+*/
+void testTable(const string Name, VoltageTable * Table, Real BuildTime,
+	       IonicMaterial * Analytic, IonicMaterial * Tabulated,
+	       Real V0, Real Istim, Real Xi)
+{
+  cout << endl << "Testing VoltageTable for " << Name << endl;
+  vector<Real > error;
+  Real maxError = Table->checkError(error);
+  uint worst = 0;
+  for (uint k = 0; k < error.size(); k++)
+    if (error[k] > error[worst]) worst = k;
+  cout << Table->getNumRates() << " rates, dv = " << Table->getSpacing() << " mV, "
+       << Table->getMemory()/1024 << " kB, built in " << BuildTime << " s" << endl;
+  cout << "Max interpolation error = " << maxError << " (rate "
+       << Table->getRateIndex(worst) << ") - "
+       << (maxError < 1.0e-3 ? "PASSED" : "FAILED") << endl;
+
+  const Real dt = 0.02, Cm = 1.0;
+  const int NumSteps = 20000;
+  Real Va = V0, Vt = V0, Vmax = V0, diff = 0.0, tAn = 0.0, tTab = 0.0;
+  for (int n = 0; n < NumSteps; n++) {
+    Real is = n*dt < 2.0 ? Istim : 0.0;
+    Real t0 = wallTime();
+    Va += dt*Analytic->compute(Xi, Cm, dt, Va, is);
+    tAn += wallTime() - t0;
+    t0 = wallTime();
+    Vt += dt*Tabulated->compute(Xi, Cm, dt, Vt, is);
+    tTab += wallTime() - t0;
+    Vmax = max(Vmax, Va);
+    diff = max(diff, fabs(Va - Vt));
+  }
+  cout << "Peak voltage = " << Vmax << " - Max voltage difference over "
+       << NumSteps*dt << " ms = " << diff << " - "
+       << (Vmax > 0.0 && diff < 1.0 ? "PASSED" : "FAILED") << endl;
+  cout << "Speed up with table = " << tAn/tTab << endl;
+}
+
+
+
+int main()
+{
+  // Tusscher
+  {
+    Real *constants;
+    SetUpTusscherParameters(&constants);
+    Real t0 = wallTime();
+    VoltageTable * table = Tusscher::makeVoltageTable(constants);
+    Real tBuild = wallTime() - t0;
+    Tusscher analytic(constants), tabulated(constants, table);
+    testTable("Tusscher", table, tBuild, &analytic, &tabulated,
+	      -85.423, 1.0e5, 2000.);
+    delete table;
+    delete [] constants;
+  }
+
+  // Purkinje
+  {
+    Real *constants;
+    SetUpPurkinjeParameters(&constants);
+    Real t0 = wallTime();
+    VoltageTable * table = Purkinje::makeVoltageTable(constants);
+    Real tBuild = wallTime() - t0;
+    Purkinje analytic(constants), tabulated(constants, table);
+    testTable("Purkinje", table, tBuild, &analytic, &tabulated,
+	      -88.34, 1.0e5, 2500.);
+    delete table;
+    delete [] constants;
+  }
+
+  // Mahajan
+  {
+    Real *constants;
+    SetUpMahajanParameters(&constants, 0);
+    Real t0 = wallTime();
+    VoltageTable * table = Mahajan::makeVoltageTable(constants);
+    Real tBuild = wallTime() - t0;
+    Mahajan analytic(constants, 0), tabulated(constants, 0, table);
+    testTable("Mahajan", table, tBuild, &analytic, &tabulated,
+	      -87.1025, 1.0e5, 1.55E-4/2.58E-8);
+    delete table;
+    delete [] constants;
+  }
+
+  return 0;
+}
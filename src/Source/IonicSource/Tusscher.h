@@ -12,8 +12,241 @@
 #define _Tusscher_h_
 
 #include "IonicMaterial.h"
+#include "IonicPacket.h"
+#include "VoltageTable.h"
 
 namespace voom{
+  /*!
+    Voltage dependent part of the CellML rates: gates and time constants of the
+    Hodgkin-Huxley type currents, written to the same entries of Algebraic.
+    Entries used by TusscherStateRates are listed in TusscherVoltageIndex.
+    The constants are not needed, they are taken for the VoltageTable
+    signature. T is Real for one cell or IonicPacket (see IonicPacket.h).
+  */
+  template<class T>
+  inline void TusscherVoltageRates(const Real *, const T V, T *Algebraic) {
+    Algebraic[7] = 1.00000/(1.00000+(exp(((V+20.0000)/7.00000))));
+    Algebraic[20] =  1102.50*(exp((- (ionicSquare((V+27.0000)))/225.000)))+200.000/(1.00000+(exp(((13.0000 - V)/10.0000))))+180.000/(1.00000+(exp(((V+30.0000)/10.0000))))+20.0000;
+    Algebraic[8] = 0.670000/(1.00000+(exp(((V+35.0000)/7.00000))))+0.330000;
+    Algebraic[21] =  562.000*(exp((- (ionicSquare((V+27.0000)))/240.000)))+31.0000/(1.00000+(exp(((25.0000 - V)/10.0000))))+80.0000/(1.00000+(exp(((V+30.0000)/10.0000))));
+    Algebraic[10] = 1.00000/(1.00000+(exp(((V+20.0000)/5.00000))));
+    Algebraic[23] =  85.0000*(exp((- (ionicSquare((V+45.0000)))/320.000)))+5.00000/(1.00000+(exp(((V - 20.0000)/5.00000))))+3.00000;
+    Algebraic[11] = 1.00000/(1.00000+(exp(((20.0000 - V)/6.00000))));
+    Algebraic[24] =  9.50000*(exp((- (ionicSquare((V+40.0000)))/1800.00)))+0.800000;
+    Algebraic[0] = 1.00000/(1.00000+(exp(((- 26.0000 - V)/7.00000))));
+    Algebraic[13] = 450.000/(1.00000+(exp(((- 45.0000 - V)/10.0000))));
+    Algebraic[26] = 6.00000/(1.00000+(exp(((V+30.0000)/11.5000))));
+    Algebraic[34] =  1.00000*Algebraic[13]*Algebraic[26];
+    Algebraic[1] = 1.00000/(1.00000+(exp(((V+88.0000)/24.0000))));
+    Algebraic[14] = 3.00000/(1.00000+(exp(((- 60.0000 - V)/20.0000))));
+    Algebraic[27] = 1.12000/(1.00000+(exp(((V - 60.0000)/20.0000))));
+    Algebraic[35] =  1.00000*Algebraic[14]*Algebraic[27];
+    Algebraic[2] = 1.00000/(1.00000+(exp(((- 5.00000 - V)/14.0000))));
+    Algebraic[15] = 1400.00/ sqrt((1.00000+(exp(((5.00000 - V)/6.00000)))));
+    Algebraic[28] = 1.00000/(1.00000+(exp(((V - 35.0000)/15.0000))));
+    Algebraic[36] =  1.00000*Algebraic[15]*Algebraic[28]+80.0000;
+    Algebraic[3] = 1.00000/(ionicSquare((1.00000+(exp(((- 56.8600 - V)/9.03000))))));
+    Algebraic[16] = 1.00000/(1.00000+(exp(((- 60.0000 - V)/5.00000))));
+    Algebraic[29] = 0.100000/(1.00000+(exp(((V+35.0000)/5.00000))))+0.100000/(1.00000+(exp(((V - 50.0000)/200.000))));
+    Algebraic[37] =  1.00000*Algebraic[16]*Algebraic[29];
+    Algebraic[4] = 1.00000/(ionicSquare((1.00000+(exp(((V+71.5500)/7.43000))))));
+    Algebraic[17] = ionicSelect(V < - 40.0000, 0.0570000*(exp((- (V+80.0000)/6.80000))), 0.00000);
+    Algebraic[30] = ionicSelect(V < - 40.0000, 2.70000*(exp(( 0.0790000*V)))+ 310000.*(exp(( 0.348500*V))), 0.770000/( 0.130000*(1.00000+(exp(((V+10.6600)/- 11.1000))))));
+    Algebraic[38] = 1.00000/(Algebraic[17]+Algebraic[30]);
+    Algebraic[5] = 1.00000/(ionicSquare((1.00000+(exp(((V+71.5500)/7.43000))))));
+    Algebraic[18] = ionicSelect(V < - 40.0000, (( ( - 25428.0*(exp(( 0.244400*V))) -  6.94800e-06*(exp(( - 0.0439100*V))))*(V+37.7800))/1.00000)/(1.00000+(exp(( 0.311000*(V+79.2300))))), 0.00000);
+    Algebraic[31] = ionicSelect(V < - 40.0000, ( 0.0242400*(exp(( - 0.0105200*V))))/(1.00000+(exp(( - 0.137800*(V+40.1400))))), ( 0.600000*(exp(( 0.0570000*V))))/(1.00000+(exp(( - 0.100000*(V+32.0000))))));
+    Algebraic[39] = 1.00000/(Algebraic[18]+Algebraic[31]);
+    Algebraic[6] = 1.00000/(1.00000+(exp(((- 8.00000 - V)/7.50000))));
+    Algebraic[19] = 1.40000/(1.00000+(exp(((- 35.0000 - V)/13.0000))))+0.250000;
+    Algebraic[32] = 1.40000/(1.00000+(exp(((V+5.00000)/5.00000))));
+    Algebraic[40] = 1.00000/(1.00000+(exp(((50.0000 - V)/20.0000))));
+    Algebraic[42] =  1.00000*Algebraic[19]*Algebraic[32]+Algebraic[40];
+  }
+
+  //! Algebraic entries computed by TusscherVoltageRates and used afterwards
+  const int TusscherNumVoltageRates = 22;
+  const int TusscherVoltageIndex[TusscherNumVoltageRates] =
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 10, 11, 20, 21, 23, 24, 34, 35, 36, 37, 38, 39, 42};
+
+  /*!
+    CellML generated rates of the model for given voltage dependent
+    Algebraic entries (see TusscherVoltageRates). State is 19, Algebraic 70
+    and Rates 19 long, T as in TusscherVoltageRates.
+  */
+  template<class T>
+  inline void TusscherStateRates(const Real *Constants, const T *State,
+				 T *Algebraic, T *Rates) {
+    Rates[12] = (Algebraic[7] - State[12])/Algebraic[20];
+    Rates[13] = (Algebraic[8] - State[13])/Algebraic[21];
+    Algebraic[9] = 0.600000/(1.00000+(ionicSquare((State[10]/0.0500000))))+0.400000;
+    Algebraic[22] = 80.0000/(1.00000+(ionicSquare((State[10]/0.0500000))))+2.00000;
+    Rates[14] = (Algebraic[9] - State[14])/Algebraic[22];
+    Rates[15] = (Algebraic[10] - State[15])/Algebraic[23];
+    Rates[16] = (Algebraic[11] - State[16])/Algebraic[24];
+    Rates[4] = (Algebraic[0] - State[4])/Algebraic[34];
+    Rates[5] = (Algebraic[1] - State[5])/Algebraic[35];
+    Rates[6] = (Algebraic[2] - State[6])/Algebraic[36];
+    Rates[7] = (Algebraic[3] - State[7])/Algebraic[37];
+    Rates[8] = (Algebraic[4] - State[8])/Algebraic[38];
+    Rates[9] = (Algebraic[5] - State[9])/Algebraic[39];
+    Rates[11] = (Algebraic[6] - State[11])/Algebraic[42];
+    Algebraic[55] = (( (( Constants[21]*Constants[10])/(Constants[10]+Constants[22]))*State[2])/(State[2]+Constants[23]))/(1.00000+ 0.124500*(exp((( - 0.100000*State[0]*Constants[2])/( Constants[0]*Constants[1]))))+ 0.0353000*(exp((( - State[0]*Constants[2])/( Constants[0]*Constants[1])))));
+    Algebraic[25] =  (( Constants[0]*Constants[1])/Constants[2])*(log((Constants[11]/State[2])));
+
+    Algebraic[50] =  Constants[16]*(ionicCube(State[7]))*State[8]*State[9]*(State[0] - Algebraic[25]);
+    Algebraic[51] =  Constants[17]*(State[0] - Algebraic[25]);
+    Algebraic[56] = ( Constants[24]*( (exp((( Constants[27]*State[0]*Constants[2])/( Constants[0]*Constants[1]))))*(ionicCube(State[2]))*Constants[12] -  (exp((( (Constants[27] - 1.00000)*State[0]*Constants[2])/( Constants[0]*Constants[1]))))*(pow(Constants[11], 3.00000))*State[3]*Constants[26]))/( ((pow(Constants[29], 3.00000))+(pow(Constants[11], 3.00000)))*(Constants[28]+Constants[12])*(1.00000+ Constants[25]*(exp((( (Constants[27] - 1.00000)*State[0]*Constants[2])/( Constants[0]*Constants[1]))))));
+    Rates[2] =  (( - 1.00000*(Algebraic[50]+Algebraic[51]+ 3.00000*Algebraic[55]+ 3.00000*Algebraic[56]))/( 1.00000*Constants[4]*Constants[2]))*Constants[3];
+    Algebraic[33] =  (( Constants[0]*Constants[1])/Constants[2])*(log((Constants[10]/State[1])));
+    Algebraic[44] = 0.100000/(1.00000+(exp(( 0.0600000*((State[0] - Algebraic[33]) - 200.000)))));
+    Algebraic[45] = ( 3.00000*(exp(( 0.000200000*((State[0] - Algebraic[33])+100.000))))+(exp(( 0.100000*((State[0] - Algebraic[33]) - 10.0000)))))/(1.00000+(exp(( - 0.500000*(State[0] - Algebraic[33])))));
+    Algebraic[46] = Algebraic[44]/(Algebraic[44]+Algebraic[45]);
+    Algebraic[47] =  Constants[13]*Algebraic[46]* pow((Constants[10]/5.40000), 1.0 / 2)*(State[0] - Algebraic[33]);
+    Algebraic[54] =  Constants[20]*State[16]*State[15]*(State[0] - Algebraic[33]);
+    Algebraic[48] =  Constants[14]* pow((Constants[10]/5.40000), 1.0 / 2)*State[4]*State[5]*(State[0] - Algebraic[33]);
+    Algebraic[41] =  (( Constants[0]*Constants[1])/Constants[2])*(log(((Constants[10]+ Constants[9]*Constants[11])/(State[1]+ Constants[9]*State[2]))));
+    Algebraic[49] =  Constants[15]*(ionicSquare(State[6]))*(State[0] - Algebraic[41]);
+    Algebraic[52] = ( (( Constants[18]*State[11]*State[12]*State[13]*State[14]*4.00000*(State[0] - 15.0000)*(pow(Constants[2], 2.00000)))/( Constants[0]*Constants[1]))*( 0.250000*State[10]*(exp((( 2.00000*(State[0] - 15.0000)*Constants[2])/( Constants[0]*Constants[1])))) - Constants[12]))/((exp((( 2.00000*(State[0] - 15.0000)*Constants[2])/( Constants[0]*Constants[1])))) - 1.00000);
+    Algebraic[43] =  (( 0.500000*Constants[0]*Constants[1])/Constants[2])*(log((Constants[12]/State[3])));
+    Algebraic[53] =  Constants[19]*(State[0] - Algebraic[43]);
+    Algebraic[58] = ( Constants[32]*(State[0] - Algebraic[33]))/(1.00000+(exp(((25.0000 - State[0])/5.98000))));
+    Algebraic[57] = ( Constants[30]*State[3])/(State[3]+Constants[31]);
+    // dV/dt
+    Rates[0] = - (Algebraic[47]+Algebraic[54]+Algebraic[48]+Algebraic[49]+Algebraic[52]+Algebraic[55]+Algebraic[50]+Algebraic[51]+Algebraic[56]+Algebraic[53]+Algebraic[58]+Algebraic[57]+Algebraic[12]);
+
+    Rates[1] =  (( - 1.00000*((Algebraic[47]+Algebraic[54]+Algebraic[48]+Algebraic[49]+Algebraic[58]+Algebraic[12]) -  2.00000*Algebraic[55]))/( 1.00000*Constants[4]*Constants[2]))*Constants[3];
+    Algebraic[59] = Constants[44]/(1.00000+(pow(Constants[42], 2.00000))/(ionicSquare(State[3])));
+    Algebraic[60] =  Constants[43]*(State[17] - State[3]);
+    Algebraic[61] =  Constants[41]*(State[10] - State[3]);
+    Algebraic[63] = 1.00000/(1.00000+( Constants[45]*Constants[46])/(ionicSquare((State[3]+Constants[46]))));
+    Rates[3] =  Algebraic[63]*((( (Algebraic[60] - Algebraic[59])*Constants[51])/Constants[4]+Algebraic[61]) - ( 1.00000*((Algebraic[53]+Algebraic[57]) -  2.00000*Algebraic[56])*Constants[3])/( 2.00000*1.00000*Constants[4]*Constants[2]));
+    Algebraic[62] = Constants[38] - (Constants[38] - Constants[39])/(1.00000+(ionicSquare((Constants[37]/State[17]))));
+    Algebraic[65] =  Constants[34]*Algebraic[62];
+    Rates[18] =  - Algebraic[65]*State[10]*State[18]+ Constants[36]*(1.00000 - State[18]);
+    Algebraic[64] = Constants[33]/Algebraic[62];
+    Algebraic[66] = ( Algebraic[64]*(ionicSquare(State[10]))*State[18])/(Constants[35]+ Algebraic[64]*(ionicSquare(State[10])));
+    Algebraic[67] =  Constants[40]*Algebraic[66]*(State[17] - State[10]);
+    Algebraic[68] = 1.00000/(1.00000+( Constants[47]*Constants[48])/(ionicSquare((State[17]+Constants[48]))));
+    Rates[17] =  Algebraic[68]*(Algebraic[59] - (Algebraic[67]+Algebraic[60]));
+    Algebraic[69] = 1.00000/(1.00000+( Constants[49]*Constants[50])/(ionicSquare((State[10]+Constants[50]))));
+    Rates[10] =  Algebraic[69]*((( - 1.00000*Algebraic[52]*Constants[3])/( 2.00000*1.00000*Constants[52]*Constants[2])+( Algebraic[67]*Constants[51])/Constants[52]) - ( Algebraic[61]*Constants[4])/Constants[52]);
+  }
+
+  /*!
+    Update as suggested by Whiteley. We have equations of the form
+    \f[
+    \frac{du_i}{dt} = a_i(V^n) + b_i(V^m)u_i
+    \f]
+    which will be solved explicitly using backward difference. Other nonlinear
+    ODE's will be solved as stated below
+    \f[
+    \frac{d}{dt} State[i] = f( State[0],.. State[k])
+    \f]
+    We rewrite this as
+    \f[
+    State^{n+1}[i] - State^n[i] - \Delta t * f() = 0
+    \f]
+    We will use Newton Raphson on these ODE's. Since the ODE's are very 
+    nonlinear we will use numerical derivatives to construct the Hessian.
+    Algebraic holds the voltage dependent entries of State[0] on entry,
+    Rates are the rates at the new state on return. For T = IonicPacket all
+    lanes iterate together, a lane that has converged keeps its state until
+    the last one has.
+  */
+  template<class T>
+  inline void TusscherUpdateStateVariables(const Real *Constants, const Real dt,
+					   T *State, T *Algebraic, T *Rates) {
+    /* First update gating equations of the form du_i/dt = a_i + b_i u_i
+       We have 19 gating variables. We can neglect 0 which is Voltage. Hence
+       we totally have 18 variables left. We have States 4,5,6,7,8,9,11,12,13,
+       14, 15 and 16 of this form
+    */
+    const int ind[]={4,5,6,7,8,9,11,12,13,14,15,16}; // 12 values
+    const int nLinear = 12; // Variables needing Linear Solution
+    const int nVar = 6; // Variables needing Newton Raphson
+    const int dind[]={34,35,36,37,38,39,42,20,21,22,23,24};// Index for denominator
+    const int NRind[]={1,2,3,10,17,18}; // 6 variable
+    const Real TOLER = 1e-6;
+    T fxph[nVar], fxmh[nVar], oldRates[nVar], StateN[nVar], StateK[nVar];
+    T Jacobian[nVar*nVar], B[nVar];
+
+    for(int i = 0; i < nVar; i++)  
+      StateN[i] = State[ NRind[i] ];
+
+    TusscherStateRates(Constants, State, Algebraic, Rates);
+    for(int i = 0; i < nLinear; i++) {
+      const T b = -1./Algebraic[ dind[i] ];
+      const T a = Algebraic[i]/ Algebraic[ dind[i] ];
+      // Forward Euler Update
+      State[ ind[i] ] = (State[ ind[i] ] + dt *a)/
+	(1. - dt* b);
+    }
+
+    // For rest of the state variables
+    TusscherStateRates(Constants, State, Algebraic, Rates);
+    for(int i = 0; i < nVar; i++)  
+      oldRates[i] = Rates[ NRind[i] ];  
+
+    typename IonicMaskOf<T>::type active = IonicMaskOf<T>::all();
+    while ( ionicAny(active) ) {
+      /* We will use numerical derivatives to get the Hessian. Vary each
+	 state variable and see how each rate changes
+	 We have Rates[i] = f(State[1], State[2] ..State[6], u^(n+1) )
+	 State*[i] - f() *dt - State[i] = g() = 0
+	 Use NR on g()
+      */ 
+      for(int i = 0; i < nVar; i++)
+	StateK[i] = State[ NRind[i] ];
+      for(int i = 0; i < nVar; i++) {
+	const T eps = 1e-3*State[ NRind[i] ];
+	State[ NRind[i] ] += eps;
+	TusscherStateRates(Constants, State, Algebraic, Rates);
+	for(int j = 0; j < nVar; j++) 
+	  fxph[j] = State[ NRind[j] ] - StateN[j] - dt*Rates[ NRind[j] ];
+	
+	State[ NRind[i] ] -= 2.*eps;
+	TusscherStateRates(Constants, State, Algebraic, Rates);
+	for(int j = 0; j < nVar; j++) 
+	  fxmh[j] = State[ NRind[j] ] - StateN[j] - dt*Rates[ NRind[j] ];
+	
+	State[ NRind[i] ] += eps;
+	// Fill in terms for the Jacobian, row major
+	for(int j = 0; j < nVar; j++)
+	  Jacobian[j*nVar + i] = (fxph[j] - fxmh[j])/(2.*eps);
+      } // End of Jacobian
+      
+      for(int i = 0; i < nVar; i++) 
+	B[i] = State[ NRind[i] ] - StateN[i] - dt* oldRates[i];
+      
+      // Solve J^-1 f(x_n) by Gaussian elimination. J = I - dt df/dx has a
+      // dominant diagonal, so it is not pivoted (the pivots would differ
+      // from lane to lane)
+      for(int k = 0; k < nVar; k++)
+	for(int i = k + 1; i < nVar; i++) {
+	  const T l = Jacobian[i*nVar + k]/Jacobian[k*nVar + k];
+	  for(int j = k + 1; j < nVar; j++)
+	    Jacobian[i*nVar + j] -= l*Jacobian[k*nVar + j];
+	  B[i] -= l*B[k];
+	}
+      for(int k = nVar - 1; k >= 0; k--) {
+	for(int j = k + 1; j < nVar; j++) B[k] -= Jacobian[k*nVar + j]*B[j];
+	B[k] /= Jacobian[k*nVar + k];
+      }
+      // Update Solution, converged lanes go back to their state
+      for(int i = 0; i < nVar; i++)
+	State[ NRind[i] ] = ionicSelect(active, State[ NRind[i] ] - B[i], StateK[i]);
+      TusscherStateRates(Constants, State, Algebraic, Rates);
+      // Store Old Rates
+      for(int i = 0; i < nVar; i++) oldRates[i] = Rates[ NRind[i] ];
+      // Compute Residual
+      T resid = B[0]*B[0];
+      for(int i = 1; i < nVar; i++) resid += B[i] * B[i];
+      resid = sqrt( resid );
+      active = active && resid > TOLER;
+    } // while loop
+  }
+
   class Tusscher: public IonicMaterial {
   private:
     //! Constants for the model
@@ -28,13 +261,24 @@ namespace voom{
     //! Algebraic Variables
     Real _Algebraic[70];
 
+    //! Table of the voltage dependent rates (NULL: analytic)
+    VoltageTable *_table;
+
+    //! Voltage dependent Algebraic entries at _State[0]
+    void ComputeVoltageRates();
+
+    //! Rates from the voltage dependent entries of the last
+    //! ComputeVoltageRates, the voltage is constant during the state update
+    void ComputeStateRates();
+
     //! Adaptive Update of State Variables
     void UpdateStateVariables(const Real dt);
 
   public:
-    //! Constructor
-    Tusscher(Real *constants){
+    //! Constructor (Table = NULL evaluates the rates analytically)
+    Tusscher(Real *constants, VoltageTable *Table = NULL){
       _Constants = constants;
+      _table = Table;
       _State.resize( 19 );
       /* As in Tusscher Paper
       // State Variables
@@ -75,9 +319,16 @@ namespace voom{
     //! Destructor
     ~Tusscher() {;}
 
-    //! Compute Rates
+    //! Compute Rates at the current state
     void ComputeRates();
 
+    /*!
+      Table of the voltage dependent rates for the given constants, to be
+      shared by all cells using them. Caller owns the table.
+    */
+    static VoltageTable * makeVoltageTable(Real *constants,
+					   const Real dv = 0.01);
+
     //! Compute Ionic Current
     Real compute(Real Xi, Real C_m, Real dt, Real volt,
 		     Real istim);
@@ -0,0 +1,59 @@
+#include "TusscherArray.h"
+
+namespace voom {
+  TusscherArray::TusscherArray(const uint NumCells, Real *constants):
+    IonicArray(NumCells, 19), _Constants(constants) {
+    // Same initial values as Tusscher
+    const Real init[19] = {-85.423, 136.89, 8.604, 0.000126, 0.00621, 0.4712,
+			   0.0095, 0.00172, 0.7444, 0.7045, 0.00036, 3.373e-5,
+			   0.7888, 0.9755, 0.9953, 0.999998, 2.42e-8, 3.64,
+			   0.9073};
+    for (uint s = 0; s < 19; s++) {
+      Real * S = this->getStateArray(s);
+      for (uint c = 0; c < _numCells; c++) S[c] = init[s];
+    }
+    _xi = 2000.;
+  }
+
+
+
+  void TusscherArray::compute(const Real Xi, const Real C_m, const Real dt,
+			      const Real * Volt, const Real * istim,
+			      Real * dVdt) {
+    Real * S[19];
+    for (int s = 0; s < 19; s++) S[s] = this->getStateArray(s);
+    const Real * Constants = _Constants;
+    const Real stimScale = -1.0/(C_m*Xi);
+    const int N = _numCells;
+    const int nPackets = (N + IonicLanes - 1)/IonicLanes;
+
+    // The number of Newton iterations varies from packet to packet
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, BLOCK/IonicLanes)
+#endif
+    for (int p = 0; p < nPackets; p++) {
+      const int c0 = p*IonicLanes;
+      const int n  = (c0 + IonicLanes < N ? IonicLanes : N - c0);
+      IonicPacket State[19], Algebraic[70], Rates[19], stim;
+      for (int s = 1; s < 19; s++) ionicLoad(&S[s][c0], n, State[s]);
+      ionicLoad(&Volt[c0], n, State[0]);
+      ionicLoad(&istim[c0], n, stim);
+      TusscherVoltageRates(Constants, State[0], Algebraic);
+      // iStim is in uA/cc. We need to send pA/pF
+      Algebraic[12] = stim*stimScale;
+
+      TusscherUpdateStateVariables(Constants, dt, State, Algebraic, Rates);
+
+      for (int s = 0; s < 19; s++) ionicStore(State[s], n, &S[s][c0]);
+      ionicStore(Rates[0], n, &dVdt[c0]);
+    }
+  }
+
+
+
+  void TusscherArray::getGamma(Real * gamma) {
+    const Real * ca = this->getStateArray(3);
+    for (uint c = 0; c < _numCells; c++)
+      gamma[c] = 0.9135*(1. - 0.095*tanh(4.*log10(ca[c]) + 13.5) );
+  }
+}
@@ -0,0 +1,36 @@
+//-*-C++-*-
+/*! \brief
+  Tusscher ionic model integrated over an array of cells (structure of
+  arrays). Same state layout as Tusscher::getInternalParameters.
+  Cells are advanced IonicLanes at a time with the same rates and update as
+  Tusscher (TusscherUpdateStateVariables with T = IonicPacket): the rates
+  of a packet are vectorized and the Newton iterations of the
+  concentrations are batched, a packet iterates until its last cell has
+  converged.
+*/
+#ifndef _TusscherArray_h_
+#define _TusscherArray_h_
+
+#include "Tusscher.h"
+#include "IonicArray.h"
+
+namespace voom{
+  class TusscherArray: public IonicArray {
+  public:
+    //! Constructor - constants from SetUpTusscherParameters
+    TusscherArray(const uint NumCells, Real *constants);
+
+    //! Destructor
+    ~TusscherArray() {;}
+
+    void compute(const Real Xi, const Real C_m, const Real dt,
+		 const Real * Volt, const Real * istim, Real * dVdt);
+
+    void getGamma(Real * gamma);
+
+  protected:
+    //! Constants for the model (shared by all cells)
+    Real *_Constants;
+  };
+}
+#endif
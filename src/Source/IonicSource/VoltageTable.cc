@@ -0,0 +1,106 @@
+#include "VoltageTable.h"
+
+namespace voom {
+  VoltageTable::VoltageTable(VoltageFunction Function, const Real *Constants,
+			     const uint NumValues, const Real vMin,
+			     const Real vMax, const Real dv):
+    _function(Function), _constants(Constants), _numValues(NumValues),
+    _numRates(0), _vMin(vMin), _dv(dv) {
+    if (dv <= 0.0 || vMax <= vMin) {
+      cout << "** VoltageTable: invalid range [" << vMin << ", " << vMax
+	   << "] with spacing " << dv << endl;
+      exit(1);
+    }
+    _numV  = int((vMax - vMin)/dv + 0.5) + 1;
+    _vMax  = vMin + Real(_numV - 1)*dv;
+    _invDv = 1.0/dv;
+  }
+
+
+
+  void VoltageTable::addRate(const uint Index, const string Name) {
+    if (Index >= _numValues) {
+      cout << "** VoltageTable: rate index " << Index << " out of range" << endl;
+      exit(1);
+    }
+    _index.push_back(Index);
+    _name.push_back(Name);
+    _numRates = _index.size();
+  }
+
+
+
+  void VoltageTable::addRates(const int *Index, const uint NumRates) {
+    for (uint k = 0; k < NumRates; k++)
+      this->addRate(Index[k]);
+  }
+
+
+
+  void VoltageTable::addBreakpoint(const Real V) {
+    _breakpoints.push_back(V);
+  }
+
+
+
+  void VoltageTable::build() {
+    _table.assign(_numV*_numRates, 0.0);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+      vector<Real> values(_numValues, 0.0);
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+      for (int i = 0; i < _numV; i++) {
+	_function(_constants, _vMin + Real(i)*_dv, &values[0]);
+	for (uint k = 0; k < _numRates; k++)
+	  _table[i*_numRates + k] = values[_index[k]];
+      }
+    }
+
+    _analytic.assign(_numV, 0);
+    _analytic[_numV - 1] = 1;
+    for (uint b = 0; b < _breakpoints.size(); b++) {
+      Real s = (_breakpoints[b] - _vMin)*_invDv;
+      if (s < 0.0 || s > Real(_numV - 1)) continue;
+      // The node next to the breakpoint may be on either branch after
+      // rounding, so its neighbouring intervals are excluded as well
+      int i = int(s);
+      for (int j = max(i - 1, 0); j <= min(i + 1, _numV - 1); j++)
+	_analytic[j] = 1;
+    }
+  }
+
+
+
+  Real VoltageTable::checkError(vector<Real> & Error, const uint NumSamples) const {
+    vector<Real> exact(_numValues, 0.0), interp(_numValues, 0.0);
+    vector<Real> scale(_numRates, 0.0);
+    Error.assign(_numRates, 0.0);
+
+    for (int i = 0; i < _numV; i++)
+      for (uint k = 0; k < _numRates; k++)
+	scale[k] = max(scale[k], fabs(_table[i*_numRates + k]));
+
+    for (uint n = 0; n < NumSamples; n++) {
+      // Irrational offset keeps the samples away from the grid nodes
+      Real V = _vMin + (_vMax - _vMin)*(Real(n) + 0.618034)/Real(NumSamples);
+      if (!this->inRange(V)) continue;
+      _function(_constants, V, &exact[0]);
+      this->interpolate(V, &interp[0]);
+      for (uint k = 0; k < _numRates; k++) {
+	uint j = _index[k];
+	Real err = fabs(interp[j] - exact[j])/(scale[k] > 0.0 ? scale[k] : 1.0);
+	Error[k] = max(Error[k], err);
+      }
+    }
+
+    Real maxError = 0.0;
+    for (uint k = 0; k < _numRates; k++)
+      maxError = max(maxError, Error[k]);
+    return maxError;
+  }
+}
@@ -0,0 +1,95 @@
+//-*-C++-*-
+/*!\brief
+  Lookup table for the voltage dependent rates of an ionic model.
+
+  A model provides one function that evaluates all its voltage only
+  quantities (gates, time constants, voltage exponentials) into an array of
+  values, e.g. the CellML Algebraic array, and registers with addRate the
+  entries to tabulate. The table evaluates the function once on a uniform
+  grid over [vMin, vMax] and interpolate() then replaces the function call by
+  a linear interpolation that writes the same entries of the same array.
+  Intervals containing a registered breakpoint (a voltage where the model
+  switches between two expressions) and voltages outside the range are
+  reported by inRange() as not tabulated, the caller then uses the analytic
+  function. checkError() bounds the interpolation error against the
+  analytic expressions.
+*/
+
+#ifndef __VoltageTable_h__
+#define __VoltageTable_h__
+#include "voom.h"
+#include <vector>
+#include <string>
+
+namespace voom {
+  //! Evaluates the voltage dependent values of a model at V
+  typedef void (*VoltageFunction)(const Real *Constants, const Real V,
+				  Real *Values);
+
+  class VoltageTable {
+  public:
+    //! Constructor, NumValues is the length of the array Function fills
+    VoltageTable(VoltageFunction Function, const Real *Constants,
+		 const uint NumValues, const Real vMin = -100.,
+		 const Real vMax = 100., const Real dv = 0.01);
+
+    //! Register entry Index of the value array to be tabulated
+    void addRate(const uint Index, const string Name = "");
+
+    //! Register several entries at once
+    void addRates(const int *Index, const uint NumRates);
+
+    //! Voltage at which the function is discontinuous
+    void addBreakpoint(const Real V);
+
+    //! Evaluate Function on the grid (in parallel with OpenMP)
+    void build();
+
+    //! True if V can be interpolated (false before build)
+    bool inRange(const Real V) const {
+      if (!(V >= _vMin && V < _vMax) || _analytic.empty()) return false;
+      return !_analytic[int((V - _vMin)*_invDv)];
+    }
+
+    //! Interpolated values at V, written to Values[Index] of registered rates
+    void interpolate(const Real V, Real *Values) const {
+      Real s = (V - _vMin)*_invDv;
+      int i = int(s);
+      if (i > _numV - 2) i = _numV - 2;
+      const Real w = s - Real(i);
+      const Real *a = &_table[i*_numRates];
+      const Real *b = a + _numRates;
+      for (uint k = 0; k < _numRates; k++)
+	Values[_index[k]] = a[k] + w*(b[k] - a[k]);
+    }
+
+    /*!
+      Maximum interpolation error of each registered rate over NumSamples
+      voltages (off the grid nodes), relative to the largest magnitude of
+      the rate over the range. Returns the largest of these errors.
+    */
+    Real checkError(vector<Real> & Error, const uint NumSamples = 100000) const;
+
+    //! Accessors
+    uint getNumRates() const {return _numRates;}
+    uint getRateIndex(const uint k) const {return _index[k];}
+    const string & getRateName(const uint k) const {return _name[k];}
+    Real getSpacing() const {return _dv;}
+    size_t getMemory() const {return _table.size()*sizeof(Real);}
+
+  private:
+    VoltageFunction _function;
+    const Real     *_constants;
+    uint            _numValues, _numRates;
+    int             _numV;
+    Real            _vMin, _vMax, _dv, _invDv;
+    vector<uint>    _index;
+    vector<string>  _name;
+    vector<Real>    _breakpoints;
+    //! One row of _numRates values per grid voltage
+    vector<Real>    _table;
+    //! Intervals evaluated analytically
+    vector<char>    _analytic;
+  };
+}
+#endif
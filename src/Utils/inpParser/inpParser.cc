@@ -9,6 +9,12 @@
   MODEL  - Input FE model Abaqus or vtk format
   ELEMENTMAP - What elemental mapping has to be used. 
 
+  The nodes, elements and element sets of an Abaqus model are read with
+  InpFile (Mesh/InpFile.h), which parses the *NODE and *ELEMENT data in
+  parallel. Node and element numbers need not start at 1 or be in
+  order, loads are renumbered with the model. A FEMesh can also be built
+  from the .inp directly, without the .v2i deck.
+
   Output
   ******
   The output v2i files writes information in pseudo abaqus format. We use
@@ -78,6 +84,9 @@
 #include <set>
 #include <map>
 
+// Abaqus input file reader (libMesh)
+#include "InpFile.h"
+
 // Vtk Headers
 #include <vtkSmartPointer.h>
 #include <vtkIdList.h>
@@ -180,7 +189,7 @@ int main(int argc, char** argv){
   vector< MaterialData> matData;
   // For a global element ID we get which CPU it lives on and its
   // local element number. Use by Distributed load boundary condition.
-  map<int, vector<int> > globalToLocalElemId;
+  vector< vector<int> > globalToLocalElemId;
 
   //******************************************************************
   // Parse Control deck if present
@@ -190,6 +199,8 @@ int main(int argc, char** argv){
   inp.open( ctrlFile.c_str() );
   while (inp.good() ) {
     getline(inp, line);
+    // Only keyword lines start a card; skips the node and element data
+    if (line.find('*') == string::npos) continue;
     to_upper(line);
     // Read Material Data
     if (find_first(line, "*MATERIAL")) {
@@ -249,7 +260,7 @@ int main(int argc, char** argv){
 	      sprintf(buf, "%10d", dof);
 	      a += " " +  string(buf);
 	    }
-	    char buf[20]; sprintf(buf, "%10s", strs.back() );
+	    char buf[20]; snprintf(buf, sizeof(buf), "%10s", strs.back().c_str() );
 	    a += " " + string( buf );
 	    loadStep.boundary.data.push_back( a );
 	  }
@@ -272,7 +283,7 @@ int main(int argc, char** argv){
 	    if ( extension == "inp") dof --;
 	    char buf[20]; sprintf( buf, "%10d", dof);
 	    string a = string(buf);
-	    sprintf(buf, "%15s", strs.back() );
+	    snprintf(buf, sizeof(buf), "%15s", strs.back().c_str() );
 	    a += string(buf);
 	    loadStep.cload.data.push_back( a );
 	  }
@@ -294,7 +305,7 @@ int main(int argc, char** argv){
 	    string a;
 	    for(vector<string>::iterator it = strs.begin() + 1;
 		it != strs.end(); it++) {
-	      char buf[20]; sprintf(buf, "%15s", *it );
+	      char buf[20]; snprintf(buf, sizeof(buf), "%15s", it->c_str() );
 	      a += string( buf );
 	    }
 	    loadStep.dload.data.push_back( a );
@@ -343,54 +354,57 @@ int main(int argc, char** argv){
       elementType[i] = lexical_cast<string>( dataSet->GetCellType(i) );
     }
   } else if ( extension == "inp" ) {
-    inp.open( ctrlFile.c_str() );
-    while( getline(inp, line) ) {
-      // Read nodal info
-      trim(line), to_upper(line);
-      if (find_first(line, "*NODE")) {
-	while( getline(inp, line) ) {
-	  if ( find_first(line, "**" )) continue;
-	  if ( find_first(line, "*" )) { 
-	    inp.seekg( int(inp.tellg()) - line.length() - 1);
-	    break;
+    cout << "** Parsing input Abaqus File\n";
+    // Nodes and elements are read (in parallel) by InpFile, numbered from 0
+    // in file order, element sets one after the other
+    voom::InpFile model( fileName );
+    const int dim = model.getDimension();
+    position.resize( model.getNumberOfNodes(), vector<double>(3, 0.) );
+    for(int i = 0; i < model.getNumberOfNodes(); i++)
+      for(int m = 0; m < dim; m++)
+	position[i][m] = model.getNodes()[i*dim + m];
+
+    // Abaqus element number to element index
+    map<int, int> elementIndex;
+    for(int s = 0; s < model.getNumberOfElementSets(); s++) {
+      const int nodesPerElement = model.getNodesPerElement(s);
+      const int *conn = model.getConnectivity(s), *ids = model.getElementIds(s);
+      string setName = model.getElementSetName(s); to_upper(setName);
+      for(int e = 0; e < model.getNumberOfElements(s); e++) {
+	elementIndex[ ids[e] ] = connectivity.size();
+	connectivity.push_back( vector<int>(conn + e*nodesPerElement,
+					    conn + (e + 1)*nodesPerElement) );
+	elementType.push_back( model.getElementType(s) );
+	eSets.push_back( setName );
+      }
+    }
+
+    // Loads were read with Abaqus numbers - 1, the node and element numbers
+    // need not be 1 to N in order
+    for(uint stepId = 0; stepId < loadSteps.size(); stepId++) {
+      vector<int> * nodalIDs[2] = { &loadSteps[stepId].boundary.nodalID,
+				    &loadSteps[stepId].cload.nodalID };
+      for(int k = 0; k < 2; k++)
+	for(uint m = 0; m < nodalIDs[k]->size(); m++) {
+	  int & id = (*nodalIDs[k])[m];
+	  if ( model.findNode(id + 1) < 0 ) {
+	    cerr << "** ERROR: Load step " << stepId << " refers to node "
+		 << id + 1 << " which is not in the model\n";
+	    exit(1);
 	  }
-	  strs.clear(); trim(line);
-	  split( strs, line, is_any_of(","));
-	  vector<double> pos;
-	  for(uint m = 1; m < strs.size(); m++) 
-	    pos.push_back( atof( strs[m].c_str() ) );
-	  position.push_back( pos );
+	  id = model.findNode(id + 1);
 	}
-      } // Nodal reading
-      // Read Element Info
-      if (find_first(line, "*ELEMENT")) {
-	// Get element Type first
-	strs.clear(); split( strs, line, is_any_of(",") );
-	vector<string> data; split( data, strs[1], is_any_of("="));
-	string eType = data[1]; data.clear();
-	split( data, strs[2], is_any_of("="));
-	string setName = data[1];
-	while( getline(inp, line) ) {
-	  if ( find_first(line, "**" )) continue;
-	  if ( find_first(line, "*" )) { 
-	    inp.seekg( int(inp.tellg()) - line.length() - 1);
-	    break;
-	  }
-	  if ( eType == "C3D8" || eType == "C3D8R" ) {
-	    string nLine; getline( inp, nLine); line += nLine;
-	  }
-	  strs.clear(); trim(line);
-	  split( strs, line, is_any_of(","));
-	  vector<int> conn;
-	  elementType.push_back( eType );
-	  for(uint m = 1; m < strs.size(); m++) 
-	    conn.push_back( atoi( strs[m].c_str() ) - 1 );
-	  eSets.push_back( setName );
-	  connectivity.push_back( conn );
-	} // Inner getline loop
-      } // Elemental reading
-    } // Reading the file
-    inp.close();
+      vector<int> & elementIDs = loadSteps[stepId].dload.elementID;
+      for(uint m = 0; m < elementIDs.size(); m++) {
+	map<int, int>::iterator it = elementIndex.find( elementIDs[m] + 1 );
+	if ( it == elementIndex.end() ) {
+	  cerr << "** ERROR: Load step " << stepId << " refers to element "
+	       << elementIDs[m] + 1 << " which is not in the model\n";
+	  exit(1);
+	}
+	elementIDs[m] = it->second;
+      }
+    }
   } else {
     cerr << "** ERROR: Unknown extension " << extension << endl;
     cerr << "** Exiting...\n";
@@ -437,7 +451,7 @@ int main(int argc, char** argv){
       localElements[cpuNumber].insert( id );
       vector<int> data(2); 
       data[0] = cpuNumber; data[1] = localElements[cpuNumber].size();
-      globalToLocalElemId[id] = data;
+      globalToLocalElemId.push_back( data );
       id++;
     }
     nfile.close(); efile.close();
@@ -469,87 +483,97 @@ int main(int argc, char** argv){
   } // Loop to read metis file
   else {
     // Job is on one cpu so all data is trivial.
-    // Fill Local Node Info
+    // Fill Local Node Info, in order (inserted at the end)
     for(int i = 0; i < position.size(); i++) {
-      localNodes[0].insert(i);
-      nodalRenum[0][i] = i;
+      localNodes[0].insert(localNodes[0].end(), i);
+      nodalRenum[0].insert(nodalRenum[0].end(), make_pair(i, i));
     }
     // Fill local elements info
     for(int i = 0; i < connectivity.size(); i++) {
-      localElements[0].insert(i);
+      localElements[0].insert(localElements[0].end(), i);
       vector<int> data(2); data[0] = 0; data[1] = i;
-      globalToLocalElemId[i] = data;
+      globalToLocalElemId.push_back( data );
     }    
   } // End of domain decomposition data parsing
 
   //******************************************************************
   // Writing model and domain decomposition data
   //******************************************************************    
-  // Writing input for voom2
-  for(unsigned int cpuId = 0; cpuId < nCpu; cpuId++) {
+  // Writing input for voom2, one file per cpu written by each thread
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+  for(int cpuId = 0; cpuId < nCpu; cpuId++) {
     char outfile[200];
     sprintf(outfile, "%s.%03d.v2i", file.c_str(), cpuId);
     ofstream out( outfile );
-    out<< "**\n** Voom2 input for Processor = " << cpuId << endl;
+    out<< "**\n** Voom2 input for Processor = " << cpuId << "\n";
 
     // Nodal Data      
     out << "** Nodes are assumed to be sequentially numbered from "
         << "0\n";
     out << "**\n*NUMBEROFNODES\n"  
-        << localNodes[cpuId].size() + ghostNodes[cpuId].size() << endl;
+        << localNodes[cpuId].size() + ghostNodes[cpuId].size() << "\n";
     out << "*NODE\n";
     // Write Local Nodes first
     for(set<int>::iterator it = localNodes[cpuId].begin();
 	it != localNodes[cpuId].end(); ++it) 
       out << setw(width) << position[*it][0] << setw(width)
 	  << position[*it][1] << setw(width) 
-	  << position[*it][2] << endl;
+	  << position[*it][2] << "\n";
     // Write ghost nodes next
     for(set<int>::iterator it = ghostNodes[cpuId].begin();
 	it != ghostNodes[cpuId].end(); ++it) 
       out << setw(width) << position[*it][0] << setw(width)
 	  << position[*it][1] << setw(width) 
-	  << position[*it][2] << endl;
+	  << position[*it][2] << "\n";
       
     out << "** Elements are assumed to be sequentially numbered from "
         << "0\n";    
     out << "**\n*NUMBEROFELEMENTS\n" << localElements[cpuId].size() 
-        << endl;
+        << "\n";
     out << "*ELEMENT\n";
+    // Dense copy of the renumbering of this cpu, looked up for every
+    // element node
+    vector<int> renum( position.size(), -1 );
+    for(map<int, int>::const_iterator it = nodalRenum[cpuId].begin();
+	it != nodalRenum[cpuId].end(); ++it)
+      renum[it->first] = it->second;
     // Filling Cell Data
     for( set<int>::iterator it = localElements[cpuId].begin(); 
 	 it != localElements[cpuId].end(); it++){
       string eType = elementType[*it];
-      if ( elementMap.find(eType) != elementMap.end() ) 
-	eType = elementMap[eType];
+      map<string, string>::const_iterator mapped = elementMap.find(eType);
+      if ( mapped != elementMap.end() )
+	eType = mapped->second;
       out << setw(width) << eType;
       for(unsigned int nodeId = 0; nodeId < connectivity[*it].size(); 
 	  nodeId++) 
-	out << setw(width) << nodalRenum[cpuId][connectivity[*it][nodeId]];
+	out << setw(width) << renum[connectivity[*it][nodeId]];
       out << setw(width) << eSets[*it];
-      out << endl;
+      out << "\n";
     }
     // Number of Local Nodes in the cpu
     out << "**\n** Number of Local Nodes\n**\n";
-    out << "*NUMLOCALNODES\n" << localNodes[cpuId].size() << endl;
+    out << "*NUMLOCALNODES\n" << localNodes[cpuId].size() << "\n";
 
     //  A map of local node number to global node number
     out << "**\n** MPI Info LocalNodeID - GlobalNodeID\n**\n";
     out << "*GLOBALID\n";
     for(set<int>::iterator it = localNodes[cpuId].begin();
 	it != localNodes[cpuId].end(); ++it) 
-      out << setw(width) << *it << endl;
+      out << setw(width) << *it << "\n";
     
     for(set<int>::iterator it = ghostNodes[cpuId].begin();
 	it != ghostNodes[cpuId].end(); ++it) 
-      out << setw(width) << *it << endl;
+      out << setw(width) << *it << "\n";
 
     // Writing Material data
     out << "**\n** Material data\n**\n";
     for(uint m = 0; m < matData.size(); m++)
       for(vector<string>::iterator it = matData[m].data.begin();
 	  it != matData[m].data.end(); it++)
-	out << *it << endl;
+	out << *it << "\n";
     out.close();
   }// Cpu Loop
 
@@ -577,7 +601,7 @@ int main(int argc, char** argv){
 	int localId = nodalRenum[cpuId][ nodeID ];
 	out[cpuId] << setw(width) << localId << setw(width) 
 		   << loadSteps[stepId].boundary.data[m]
-		   << endl;
+		   << "\n";
       } 
 
     // Write *CLOAD cards
@@ -590,7 +614,7 @@ int main(int argc, char** argv){
 	int localId = nodalRenum[cpuId][ nodeID ];
 	out[cpuId] << setw(width) << localId << setw(width) 
 		   << loadSteps[stepId].cload.data[m]
-		   << endl;
+		   << "\n";
       } 
 
     // Write *DLOAD cards
@@ -603,7 +627,7 @@ int main(int argc, char** argv){
 	int localId = globalToLocalElemId[ elemID ][1];
 	out[cpuId] << setw(width) << localId << setw(width)
 		   << loadSteps[stepId].dload.data[m]
-		   << endl;
+		   << "\n";
       } 
     
     for(unsigned int cpuId = 0; cpuId < nCpu; cpuId++) 
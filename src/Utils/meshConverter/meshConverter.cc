@@ -0,0 +1,175 @@
+/*
+  Convert text mesh files or an Abaqus input file to a binary MeshFile.
+
+  meshConverter Output Nodes Elements [-elset Name File] [-nodeset Name File]
+                [-field Name Components File]
+  meshConverter Output Model.inp [options]
+
+  Nodes     : .node file (NumNodes Dim, then the coordinates)
+  Elements  : .ele file (NumElements Type, then the connectivity), stored
+              as element set "Elements"
+  Model.inp : Abaqus input file, all its element sets (Abaqus types as
+              named by FEMesh, e.g. S3 -> TD3; a set name used for two
+              types gets the type appended to the second) and node sets
+  -elset    : additional .ele file on the same nodes (e.g. a surface)
+  -nodeset  : node list (Count, then the node ids)
+  -field    : any number of reals, Components per entry (e.g. 9 for the
+              fiber, sheet and normal vectors at every quadrature point)
+*/
+
+#include "MeshFile.h"
+#include "InpFile.h"
+#include <cstdlib>
+
+using namespace voom;
+
+// Nodes per element of the element types known to FEMesh
+int nodesPerElement(const string Type)
+{
+  if (Type == "C3D8" || Type == "C3D8R") return 8;
+  if (Type == "C3D4" || Type == "Q4") return 4;
+  if (Type == "C3D10") return 10;
+  if (Type == "TD3") return 3;
+  if (Type == "TD6") return 6;
+  cout << "** meshConverter: unknown element type " << Type << endl;
+  exit(1);
+}
+
+void readElements(const string FileName, string & Type, vector<int > & Conn)
+{
+  ifstream inp(FileName.c_str());
+  if (!inp) {
+    cout << "** meshConverter: cannot open " << FileName << endl;
+    exit(1);
+  }
+  uint NumEl = 0;
+  inp >> NumEl >> Type;
+  Conn.resize(NumEl*nodesPerElement(Type));
+  for (uint i = 0; i < Conn.size(); i++)
+    inp >> Conn[i];
+  if (!inp) {
+    cout << "** meshConverter: " << FileName << " is truncated" << endl;
+    exit(1);
+  }
+}
+
+// Nodes and the element set "Elements" from .node and .ele files
+MeshFile::Writer * readText(const string NodeFile, const string ElementFile)
+{
+  ifstream inp(NodeFile.c_str());
+  if (!inp) {
+    cout << "** meshConverter: cannot open " << NodeFile << endl;
+    exit(1);
+  }
+  uint NumNodes = 0, dim = 0;
+  inp >> NumNodes >> dim;
+  vector<Real > nodes(NumNodes*dim);
+  for (uint i = 0; i < nodes.size(); i++)
+    inp >> nodes[i];
+  if (!inp) {
+    cout << "** meshConverter: " << NodeFile << " is truncated" << endl;
+    exit(1);
+  }
+  inp.close();
+  MeshFile::Writer * writer = new MeshFile::Writer(nodes, dim);
+
+  string type;
+  vector<int > conn;
+  readElements(ElementFile, type, conn);
+  writer->addElementSet("Elements", type, nodesPerElement(type), conn);
+  cout << "Elements: " << conn.size()/nodesPerElement(type) << " " << type << endl;
+  return writer;
+}
+
+// Nodes, element sets and node sets of an Abaqus input file
+MeshFile::Writer * readInp(const string FileName)
+{
+  InpFile file(FileName);
+  const Real * nodes = file.getNodes();
+  MeshFile::Writer * writer = new MeshFile::Writer(
+    vector<Real >(nodes, nodes + file.getNumberOfNodes()*file.getDimension()),
+    file.getDimension());
+  cout << "Nodes: " << file.getNumberOfNodes() << endl;
+
+  for (int s = 0; s < file.getNumberOfElementSets(); s++) {
+    string name = file.getElementSetName(s);
+    if (file.findElementSet(name) != s)
+      name += "_" + file.getElementType(s);
+    const string type = InpFile::voomElementType(file.getElementType(s));
+    const int * conn = file.getConnectivity(s);
+    writer->addElementSet(name, type, file.getNodesPerElement(s),
+			  vector<int >(conn, conn + file.getNumberOfElements(s)*file.getNodesPerElement(s)));
+    cout << name << ": " << file.getNumberOfElements(s) << " " << type << endl;
+  }
+  for (int s = 0; s < file.getNumberOfNodeSets(); s++) {
+    const int * ids = file.getNodeSet(s);
+    writer->addNodeSet(file.getNodeSetName(s), vector<int >(ids, ids + file.getNodeSetSize(s)));
+    cout << file.getNodeSetName(s) << ": " << file.getNodeSetSize(s) << " nodes" << endl;
+  }
+  return writer;
+}
+
+int main(int argc, char** argv)
+{
+  const bool abaqus = argc > 2 && string(argv[2]).size() > 4 &&
+    string(argv[2]).substr(string(argv[2]).size() - 4) == ".inp";
+  if (argc < (abaqus ? 3 : 4)) {
+    cout << "Usage: meshConverter Output Nodes Elements [-elset Name File]"
+	 << " [-nodeset Name File] [-field Name Components File]" << endl
+	 << "       meshConverter Output Model.inp [options]" << endl;
+    return 1;
+  }
+  MeshFile::Writer * writer = abaqus ? readInp(argv[2]) : readText(argv[2], argv[3]);
+
+  string type;
+  vector<int > conn;
+  for (int a = abaqus ? 3 : 4; a < argc; a++) {
+    string option(argv[a]);
+    if (option == "-elset" && a + 2 < argc) {
+      readElements(argv[a + 2], type, conn);
+      writer->addElementSet(argv[a + 1], type, nodesPerElement(type), conn);
+      cout << argv[a + 1] << ": " << conn.size()/nodesPerElement(type) << " " << type << endl;
+      a += 2;
+    }
+    else if (option == "-nodeset" && a + 2 < argc) {
+      ifstream set(argv[a + 2]);
+      uint count = 0;
+      set >> count;
+      vector<int > ids(count);
+      for (uint i = 0; i < count; i++)
+	set >> ids[i];
+      if (!set) {
+	cout << "** meshConverter: cannot read " << argv[a + 2] << endl;
+	return 1;
+      }
+      writer->addNodeSet(argv[a + 1], ids);
+      cout << argv[a + 1] << ": " << count << " nodes" << endl;
+      a += 2;
+    }
+    else if (option == "-field" && a + 3 < argc) {
+      const int components = atoi(argv[a + 2]);
+      ifstream field(argv[a + 3]);
+      if (!field || components <= 0) {
+	cout << "** meshConverter: cannot read " << argv[a + 3] << endl;
+	return 1;
+      }
+      vector<Real > values;
+      Real v;
+      while (field >> v)
+	values.push_back(v);
+      values.resize(values.size() - values.size() % components);
+      writer->addField(argv[a + 1], components, values);
+      cout << argv[a + 1] << ": " << values.size()/components << " x " << components << endl;
+      a += 3;
+    }
+    else {
+      cout << "** meshConverter: unknown or incomplete option " << option << endl;
+      return 1;
+    }
+  }
+
+  writer->write(argv[1]);
+  delete writer;
+  cout << "Written " << argv[1] << endl;
+  return 0;
+}
@@ -0,0 +1,78 @@
+//-*-C++-*-
+/*!
+  \file HyperDual.h
+  \brief Hyper-dual numbers f + f1 e1 + f2 e2 + f12 e1e2, with
+  e1^2 = e2^2 = 0. A function evaluated at x + e1 u + e2 v returns its
+  value, the derivatives along u and v and the second derivative u^T H v,
+  all exact to round-off (no step size). Used to compute material tangents
+  from templated energy functions.
+*/
+
+#ifndef __HyperDual_h__
+#define __HyperDual_h__
+
+#include "voom.h"
+
+namespace voom
+{
+  // Keep the Real overload visible next to the HyperDual one
+  using std::sqrt;
+
+  class HyperDual
+  {
+  public:
+    Real f, f1, f2, f12;
+
+    HyperDual(): f(0.0), f1(0.0), f2(0.0), f12(0.0) {};
+    HyperDual(Real a): f(a), f1(0.0), f2(0.0), f12(0.0) {};
+    HyperDual(Real a, Real a1, Real a2, Real a12): f(a), f1(a1), f2(a2), f12(a12) {};
+
+    HyperDual & operator+=(const HyperDual & b) {
+      f += b.f; f1 += b.f1; f2 += b.f2; f12 += b.f12;
+      return *this;
+    }
+    HyperDual & operator-=(const HyperDual & b) {
+      f -= b.f; f1 -= b.f1; f2 -= b.f2; f12 -= b.f12;
+      return *this;
+    }
+  };
+
+  inline HyperDual operator+(const HyperDual & a, const HyperDual & b) {
+    return HyperDual(a.f + b.f, a.f1 + b.f1, a.f2 + b.f2, a.f12 + b.f12);
+  }
+  inline HyperDual operator-(const HyperDual & a, const HyperDual & b) {
+    return HyperDual(a.f - b.f, a.f1 - b.f1, a.f2 - b.f2, a.f12 - b.f12);
+  }
+  inline HyperDual operator-(const HyperDual & a) {
+    return HyperDual(-a.f, -a.f1, -a.f2, -a.f12);
+  }
+  inline HyperDual operator*(const HyperDual & a, const HyperDual & b) {
+    return HyperDual(a.f*b.f, a.f1*b.f + a.f*b.f1, a.f2*b.f + a.f*b.f2,
+		     a.f12*b.f + a.f1*b.f2 + a.f2*b.f1 + a.f*b.f12);
+  }
+  inline HyperDual operator*(Real s, const HyperDual & a) {
+    return HyperDual(s*a.f, s*a.f1, s*a.f2, s*a.f12);
+  }
+  inline HyperDual operator*(const HyperDual & a, Real s) {
+    return s*a;
+  }
+
+  //! Functions of one variable g(a): value g, first and second derivatives
+  inline HyperDual chain(const HyperDual & a, Real g, Real dg, Real ddg) {
+    return HyperDual(g, dg*a.f1, dg*a.f2, dg*a.f12 + ddg*a.f1*a.f2);
+  }
+  inline HyperDual operator/(const HyperDual & a, const HyperDual & b) {
+    const Real inv = 1.0/b.f;
+    return a*chain(b, inv, -inv*inv, 2.0*inv*inv*inv);
+  }
+  inline HyperDual operator/(const HyperDual & a, Real s) {
+    return (1.0/s)*a;
+  }
+  inline HyperDual sqrt(const HyperDual & a) {
+    const Real s = std::sqrt(a.f);
+    return chain(a, s, 0.5/s, -0.25/(s*a.f));
+  }
+
+} // namespace voom
+
+#endif // __HyperDual_h__